@@ -2,7 +2,20 @@
 
 #include <windows.h>
 #include <assert.h>
+#include <stddef.h>
+#include <malloc.h>
+#include <new>
+#include <atomic>
 #include "misc.h"
+#include "ring_core.h"
+#include "Lock.h"
+#pragma comment(lib, "Synchronization.lib")
+
+// ҋ@Xbh̓o^(XbhƋN̍ŏl164bitlɂ܂Ƃ߂)
+#define RING_WAIT_PACK(n, mark)		(((long long)(n) << 32) | (unsigned int)(mark))
+#define RING_WAIT_COUNT(v)			((int)((v) >> 32))
+#define RING_WAIT_MARK(v)			((int)((v) & 0x7FFFFFFF))
+#define RING_WAIT_IDLE				RING_WAIT_PACK(0, 0x7FFFFFFF)		//!< ҋ@Xbh
 
 
 /**
@@ -11,26 +24,88 @@
  */
 class CByteRingBuffer
 {
+public:
+	/**
+	 * @enum		RING_MODE
+	 * @brief		r䃂[h
+	 */
+	enum RING_MODE {
+		RING_MODE_LOCK = 0,						//!< NeBJZNV(CLockCS)ɂr(XbhPush/Pop)
+		RING_MODE_SPSC,							//!< bNt[(Pvf[T/PRV[}p)
+	};
+
+	/**
+	 * @enum		RING_POLICY
+	 * @brief		obt@t̓
+	 */
+	enum RING_POLICY {
+		RING_POLICY_DROP = 0,					//!< 肫Ȃf[^j
+		RING_POLICY_OVERWRITE,					//!< Âf[^㏑(RING_MODE_LOCK ̂)
+		RING_POLICY_GROW,						//!< TCY܂Ŕ{XɊg(RING_MODE_LOCK ̂)
+	};
+
+	/**
+	 * @struct		RING_SPAN
+	 * @brief		Oobt@̘Ä(܂Ԃɂő2ɕ)
+	 */
+	struct RING_SPAN {
+		unsigned char*		apbyData[2];		//!< ë̐擪AhX
+		int					anLen[2];			//!< ë̑傫(gp̗̈0)
+	};
+
+private:
 	/**
 	 * @struct		RING_BUFFER
 	 * @brief		Oobt@f[^\
+	 * @remarks
+	 *		ǂݏʒu͒P̃JE^ƂĕێA&nModMask Ńobt@̈ʒuɕϊ܂B
+	 *		f[^ (uiWritePos - uiReadPos) ŋ܂邽߁AݑƓǏo
+	 *		ϐXV邱Ƃ͂܂B
+	 *		ݑEǏoXV郁o͂ꂼʂ̃LbVCɔzu(ULh~)A
+	 *		葤̈ʒu̓LbV(uiReadPosCache/uiWritePosCache)QƂāA
+	 *		ŝݑ葤̃LbVCǂݍ݂܂B
 	 */
 	struct RING_BUFFER {
-		CRITICAL_SECTION	stCS;				//!< rbNIuWFNg
-		unsigned char*		pbyBuff;			//!< obt@
-		int					nBuffSize;			//!< obt@TCY
-		int					nDataHead;			//!< f[^̐擪AhX
-		int					nDataLength;		//!< f[^̒
-		int					nModMask;			//!< &Zŏ]߂邽߂̃rbg}XN
+		// L(͂قړǏô)
+		unsigned char*				pbyBuff;			//!< obt@
+		int							nBuffSize;			//!< obt@TCY
+		int							nModMask;			//!< &Zŏ]߂邽߂̃rbg}XN
+		RING_MODE					enMode;				//!< r䃂[h
+		RING_POLICY					enPolicy;			//!< obt@t̓
+		int							nMaxSize;			//!< g̏TCY(RING_POLICY_GROW)
+		unsigned char*				pbyRetired;			//!< gÕobt@(PeekSpan Qƒ͉)
+		BOOL						bPeeking;			//!< PeekSpan`Consume ̊ TRUE
+		std::atomic<long long>		llDataWait;			//!< f[^҂̃Xbh(32bit)ƋNf[^̍ŏl(32bit)
+		std::atomic<long long>		llSpaceWait;		//!< 󂫑҂̃Xbh(32bit)ƋN󂫗eʂ̍ŏl(32bit)
+		// ݑ(LbVCEzu)
+		alignas(CACHE_LINE_SIZE) std::atomic<unsigned int>	uiWritePos;	//!< ݈ʒu(PusĥݍXV)
+		unsigned int				uiReadPosCache;		//!< ݑŌɓǂ񂾓Ǐoʒu
+		std::atomic<int>			nHighWater;			//!< f[^̍ől(PusĥݍXV)
+		std::atomic<long long>		llDropped;			//!< obt@tŒǉłȂ(㏑ꂽ)oCg(PusĥݍXV)
+		// Ǐo(LbVCEzu)
+		alignas(CACHE_LINE_SIZE) std::atomic<unsigned int>	uiReadPos;	//!< Ǐoʒu(Pop̂ݍXV)
+		unsigned int				uiWritePosCache;	//!< ǏoŌɓǂ񂾏݈ʒu
+		// RING_MODE_LOCK ̂ݎgp(Ǐoƕʂ̃LbVCɔzu)
+		alignas(CACHE_LINE_SIZE) CLockCS<>			cLock;				//!< rbNIuWFNg
 	};
+	static_assert(offsetof(RING_BUFFER, uiWritePos) % CACHE_LINE_SIZE == 0, "RING_BUFFER write side must start on a cache line");
+	static_assert(offsetof(RING_BUFFER, llDropped) + sizeof(long long) <= offsetof(RING_BUFFER, uiReadPos), "RING_BUFFER write side overlaps read side");
+	static_assert(offsetof(RING_BUFFER, uiReadPos) - offsetof(RING_BUFFER, uiWritePos) == CACHE_LINE_SIZE, "RING_BUFFER write side must fit in one cache line");
+	static_assert(offsetof(RING_BUFFER, uiReadPos) % CACHE_LINE_SIZE == 0, "RING_BUFFER read side must start on a cache line");
+	static_assert(offsetof(RING_BUFFER, cLock) % CACHE_LINE_SIZE == 0, "RING_BUFFER lock must start on a cache line");
 
 private:
 	RING_BUFFER			m_stRing;				//!< Oobt@f[^
 
 public:
-	CByteRingBuffer(int nSize = 1024);
+	CByteRingBuffer(int nSize = 1024, RING_MODE enMode = RING_MODE_LOCK, RING_POLICY enPolicy = RING_POLICY_DROP, int nMaxSize = 0);
 	~CByteRingBuffer();
 
+	//! LbVCEɊmۂ
+	static void*		operator new(size_t nSize);
+	//! operator new Ŋmۂ̈
+	static void			operator delete(void* p);
+
 	//! Oobt@\̂NA
 	int					Clear();
 	//! Oobt@Ƀf[^ǉ
@@ -39,19 +114,67 @@ public:
 	int					Pop(unsigned char* pbyDest, int nLen);
 	//! Oobt@f[^擾(obt@̃f[^͍폜Ȃ)
 	int					Peek(unsigned char* pbyDest, int nLen);
+	//! Oobt@̋󂫗̈ݗpɗ\񂷂(f[^͒ǉȂ)
+	int					Reserve(int nLen, RING_SPAN* pstSpan);
+	//! \񂵂̈ɏ񂾃f[^Oobt@ɒǉ
+	int					Commit(int nLen);
+	//! Oobt@̃f[^̈擾(obt@̃f[^͍폜Ȃ)
+	int					PeekSpan(RING_SPAN* pstSpan);
+	//! Oobt@̐擪wTCỸf[^폜
+	int					Consume(int nLen);
+	//! w萔ȏ̃f[^i[܂őҋ@ăf[^擾
+	int					PopWait(unsigned char* pbyDest, int nLen, DWORD dwTimeout, int nWatermark = 1);
+	//! 󂫗̈悪ł܂őҋ@Ȃf[^ǉ
+	int					PushWait(const unsigned char* pbySrc, int nLen, DWORD dwTimeout);
+	//! w萔ȏ̃f[^i[܂őҋ@
+	int					WaitData(int nWatermark, DWORD dwTimeout);
+	//! wTCYȏ̋󂫗̈悪ł܂őҋ@
+	int					WaitSpace(int nWatermark, DWORD dwTimeout);
 	//! Oobt@̃f[^擾
 	int					Count();
+	//! r䃂[h擾
+	RING_MODE			GetMode();
+	//! obt@t̓擾
+	RING_POLICY			GetPolicy();
+	//! ݂̃obt@TCY擾
+	int					GetBuffSize();
+	//! f[^̍ől(ݑ猩l̂ߎۈȏ̂Ƃ)擾
+	int					GetHighWater() { return m_stRing.nHighWater.load(std::memory_order_relaxed); }
+	//! obt@tŒǉłȂ(RING_POLICY_OVERWRITE ł͏㏑)oCg擾
+	long long			GetDropCount() { return m_stRing.llDropped.load(std::memory_order_relaxed); }
+	//! ݈ʒu(ǉoCg̗݌vA32rbgŎ)擾
+	unsigned int		GetWritePos() { return m_stRing.uiWritePos.load(std::memory_order_acquire); }
+	//! Ǐoʒu(폜oCg̗݌vA32rbgŎ)擾
+	unsigned int		GetReadPos() { return m_stRing.uiReadPos.load(std::memory_order_acquire); }
+	void				ResetStats();
 
 private:
 	//! wTCY傫2ׂ̂̃TCYԂ
 	int					calcBuffsize(int nSize);
+	//! 󂫗eʂ擾(ݑAŝݓǏoʒuĎ擾)
+	inline int			spaceCount(int nLen);
+	//! f[^擾(ǏoAŝݏ݈ʒuĎ擾)
+	inline int			dataCount(int nLen);
+	//! obt@t̓ɏ]AwTCY̏ݗ̈mۂ
+	int					makeRoom(int nLen, BOOL bOverwrite);
+	//! obt@g
+	int					grow(int nRequired);
+	//! wʒu̘Ä쐬
+	void				makeSpan(unsigned int uiPos, int nLen, RING_SPAN* pstSpan);
+	inline void			updateStats(unsigned int uiWritePos, int nRequest, int nWritten);
+	//! f[^(bData=TRUE)܂͋󂫗eʂwlȏɂȂ܂őҋ@
+	int					waitCount(BOOL bData, int nWatermark, DWORD dwTimeout);
+	//! f[^҂̃XbhN(N𖞂ꍇ̂)
+	inline void			notifyData();
+	//! 󂫑҂̃XbhN(N𖞂ꍇ̂)
+	inline void			notifySpace();
 	//! Oobt@̔r
 	inline void			initLock();
 	//! Oobt@̔rI
 	inline void			deleteLock();
-	//! Oobt@rbN
+	//! Oobt@rbN(RING_MODE_SPSC͉Ȃ)
 	inline void			lock();
-	//! Oobt@̔rbN
+	//! Oobt@̔rbN(RING_MODE_SPSC͉Ȃ)
 	inline void			unlock();
 	//! debug
 	void				debugPrint(const char* szProc);
@@ -62,19 +185,73 @@ private:
 };
 
 
+/**
+ * @fn			operator new
+ * @brief		Oobt@LbVCEɊmۂ
+ * @param[in]	size_t nSize		: mۂTCY
+ * @return		mۂ̈(s std::bad_alloc)
+ * @remarks
+ *		RING_BUFFER ̓ǂݏʒu alignas(CACHE_LINE_SIZE) ŔzuĂ邽߁ANXŜEv܂B
+ *		C++17 O new  alignas ̋Eۏ؂Ȃ߁A_aligned_malloc Ŋmۂ܂B
+ *		̃NX̃oɎƁÃNXEv_ɒӂĂB
+ */
+void* CByteRingBuffer::operator new(size_t nSize)
+{
+	void* p = _aligned_malloc(nSize, alignof(CByteRingBuffer));
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+/**
+ * @fn			operator delete
+ * @brief		operator new Ŋmۂ̈
+ * @param[in]	void* p				: ̈
+ */
+void CByteRingBuffer::operator delete(void* p)
+{
+	_aligned_free(p);
+}
+
 /**
  * @fn			RXgN^
  * @brief		Oobt@\̂𐶐A
  * @param[in]	int nSize			: Oobt@̃TCY
+ * @param[in]	RING_MODE enMode	: r䃂[h
+ * @param[in]	RING_POLICY enPolicy	: obt@t̓
+ * @param[in]	int nMaxSize		: g̏TCY(RING_POLICY_GROW ̂ݗLAnSize ȉȂgȂ)
  * @remarks
  *		ۂɊmۂ郊Oobt@̃TCY͎wTCY傫2ׂ̂̒lƂȂ܂B
  *      (&Zŏ]߂邽)
+ *		RING_MODE_SPSC w肵ꍇAPush()sXbh Pop/Peek(Ǐo)sXbh
+ *		ꂼ1Ɍ܂B̏ꍇbN͎擾Aǂݏʒu acquire/release ݂̂œ܂B
+ *		RING_POLICY_OVERWRITE/RING_POLICY_GROW ͏ݑǏoʒuobt@ύX邽߁A
+ *		RING_MODE_SPSC ł͎gpł܂(RING_POLICY_DROP Ƃē삵܂)B
  */
-CByteRingBuffer::CByteRingBuffer(int nSize/*=1024*/)
+CByteRingBuffer::CByteRingBuffer(int nSize/*=1024*/, RING_MODE enMode/*=RING_MODE_LOCK*/, RING_POLICY enPolicy/*=RING_POLICY_DROP*/, int nMaxSize/*=0*/)
 {
-	memset(&m_stRing, 0, sizeof(RING_BUFFER));
 	m_stRing.nBuffSize = calcBuffsize(nSize);
 	m_stRing.nModMask = m_stRing.nBuffSize - 1;
+	m_stRing.enMode = enMode;
+	m_stRing.enPolicy = enPolicy;
+	if (enMode == RING_MODE_SPSC && enPolicy != RING_POLICY_DROP) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		m_stRing.enPolicy = RING_POLICY_DROP;
+	}
+	m_stRing.nMaxSize = (m_stRing.nBuffSize < nMaxSize) ? (calcBuffsize(nMaxSize)) : (m_stRing.nBuffSize);
+	m_stRing.pbyRetired = NULL;
+	m_stRing.bPeeking = FALSE;
+	m_stRing.uiWritePos.store(0, std::memory_order_relaxed);
+	m_stRing.uiReadPos.store(0, std::memory_order_relaxed);
+	m_stRing.uiReadPosCache = 0;
+	m_stRing.uiWritePosCache = 0;
+	m_stRing.nHighWater.store(0, std::memory_order_relaxed);
+	m_stRing.llDropped.store(0, std::memory_order_relaxed);
+	m_stRing.llDataWait.store(RING_WAIT_IDLE, std::memory_order_relaxed);
+	m_stRing.llSpaceWait.store(RING_WAIT_IDLE, std::memory_order_relaxed);
 	m_stRing.pbyBuff = new unsigned char[m_stRing.nBuffSize];
 	if (m_stRing.pbyBuff == NULL) {
 		return;
@@ -90,7 +267,8 @@ CByteRingBuffer::CByteRingBuffer(int nSize/*=1024*/)
  */
 CByteRingBuffer::~CByteRingBuffer()
 {
-	delete(m_stRing.pbyBuff);
+	delete[] m_stRing.pbyBuff;
+	delete[] m_stRing.pbyRetired;
 	deleteLock();
 }
 
@@ -99,15 +277,20 @@ CByteRingBuffer::~CByteRingBuffer()
  * @fn			Clear
  * @brief		Oobt@\̂NA
  * @return		0:, -1:s
+ * @remarks		RING_MODE_SPSC ̏ꍇAݑEǏôǂ삵ĂȂԂŌĂłB
  */
 int CByteRingBuffer::Clear()
 {
 	lock();
 	memset(m_stRing.pbyBuff, 0, sizeof(unsigned char) * m_stRing.nBuffSize);
-	m_stRing.nDataHead = 0;
-	m_stRing.nDataLength = 0;
+	m_stRing.uiWritePos.store(0, std::memory_order_relaxed);
+	m_stRing.uiReadPos.store(0, std::memory_order_release);
+	m_stRing.uiReadPosCache = 0;
+	m_stRing.uiWritePosCache = 0;
 	unlock();
 
+	notifySpace();
+
 	return 0;
 }
 
@@ -117,8 +300,12 @@ int CByteRingBuffer::Clear()
  * @brief		Oobt@Ƀf[^ǉ
  * @param[in]	const unsigned char* pbySrc	: ǉf[^ւ̃|C^
  * @param[in]	int nLen						: ǉf[^̑傫
- * @return		0:, -1:s
- * @remarks		obt@t̎͒ǉł܂
+ * @return		0`:ǉf[^, -1:s
+ * @remarks
+ *		obt@t̎̓ RING_POLICY ɏ]܂B
+ *		RING_POLICY_DROP : 肫Ȃf[^͒ǉ܂B
+ *		RING_POLICY_OVERWRITE : Âf[^폜Ēǉ܂(obt@TCY𒴂镪͒ǉf[^̐擪j)B
+ *		RING_POLICY_GROW : TCY܂ŊgĒǉA𒴂镪͒ǉ܂B
  */
 int CByteRingBuffer::Push(const unsigned char* pbySrc, int nLen)
 {
@@ -130,20 +317,28 @@ int CByteRingBuffer::Push(const unsigned char* pbySrc, int nLen)
 	}
 
 	int count = 0;
-	int ptr = 0;
+	int request = nLen;
 
 	lock();
-	for (int i = 0; i < nLen; i++) {
-		if (m_stRing.nDataLength < m_stRing.nBuffSize) {
-			ptr = ((m_stRing.nDataHead + m_stRing.nDataLength) & m_stRing.nModMask);
-			m_stRing.pbyBuff[ptr] = pbySrc[i];
-			m_stRing.nDataLength++;
-			count++;
-		}
+	if (m_stRing.enPolicy == RING_POLICY_OVERWRITE && m_stRing.nBuffSize < nLen) {
+		// obt@ɓ肫Ȃ擪́AǉĂɏ㏑邽ߔj
+		pbySrc += nLen - m_stRing.nBuffSize;
+		nLen = m_stRing.nBuffSize;
 	}
+	// ݈ʒu͎Xbĥ݂XVAǏoʒu Pop  release Ƒ΂ɂ
+	count = ring_count(nLen, makeRoom(nLen, TRUE));
+	unsigned int wpos = m_stRing.uiWritePos.load(std::memory_order_relaxed);
+	ring_write(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(wpos & m_stRing.nModMask), pbySrc, count);
+	// f[^݊ɏ݈ʒuJ
+	m_stRing.uiWritePos.store(wpos + count, std::memory_order_release);
+	updateStats(wpos + count, request, count);
 	unlock();
 
+	notifyData();
+
+#if _DEBUG
 	debugPrint("Push");
+#endif
 
 	return count;
 }
@@ -154,7 +349,7 @@ int CByteRingBuffer::Push(const unsigned char* pbySrc, int nLen)
  * @brief			Oobt@f[^擾Aobt@̃f[^폜
  * @param[in,out]	unsigned char* pbyDest		: 擾f[^i[̈ւ̃|C^
  * @param[in]		int nLen					; 擾f[^̑傫
- * @return			0:, -1:s
+ * @return			0`:擾f[^, -1:s
  */
 int CByteRingBuffer::Pop(unsigned char* pbyDest, int nLen)
 {
@@ -168,21 +363,20 @@ int CByteRingBuffer::Pop(unsigned char* pbyDest, int nLen)
 	int count = 0;
 
 	lock();
-	for (int i = 0; i < nLen; i++) {
-		if (0 < m_stRing.nDataLength) {
-			pbyDest[i] = m_stRing.pbyBuff[m_stRing.nDataHead];
-			m_stRing.pbyBuff[m_stRing.nDataHead] = 0;
-			m_stRing.nDataHead = ((m_stRing.nDataHead + 1) & m_stRing.nModMask);
-			m_stRing.nDataLength--;
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	// Ǐoʒu͎Xbĥ݂XVA݈ʒu Push  release Ƒ΂ɂ
+	count = ring_count(nLen, dataCount(nLen));
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_relaxed);
+	ring_read(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(rpos & m_stRing.nModMask), pbyDest, count);
+	ring_erase(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(rpos & m_stRing.nModMask), count);
+	// f[^ǏoɓǏoʒuJ(ȍ~APush ̈ėpł)
+	m_stRing.uiReadPos.store(rpos + count, std::memory_order_release);
 	unlock();
 
+	notifySpace();
+
+#if _DEBUG
 	debugPrint("Pop");
+#endif
 
 	return count;
 }
@@ -193,7 +387,8 @@ int CByteRingBuffer::Pop(unsigned char* pbyDest, int nLen)
  * @brief			Oobt@f[^擾(obt@̃f[^͍폜Ȃ)
  * @param[in,out]	unsigned char* pbyDest		: 擾f[^i[̈ւ̃|C^
  * @param[in]		int nLen					: 擾f[^̑傫
- * @return			0:, -1:s
+ * @return			0`:擾f[^, -1:s
+ * @remarks			RING_MODE_SPSC ̏ꍇAPop ƓXbhĂłB
  */
 int CByteRingBuffer::Peek(unsigned char* pbyDest, int nLen)
 {
@@ -204,36 +399,343 @@ int CByteRingBuffer::Peek(unsigned char* pbyDest, int nLen)
 		return -1;
 	}
 
-	int ptr = m_stRing.nDataHead;
 	int count = 0;
 
 	lock();
-	for (int i = 0; i < nLen; i++) {
-		if (0 < m_stRing.nDataLength) {
-			pbyDest[i] = m_stRing.pbyBuff[ptr];
-			ptr = ((ptr + 1) & m_stRing.nModMask);
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	count = ring_count(nLen, dataCount(nLen));
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_relaxed);
+	ring_read(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(rpos & m_stRing.nModMask), pbyDest, count);
 	unlock();
 
+#if _DEBUG
 	debugPrint("Peek");
+#endif
+
+	return count;
+}
+
+
+/**
+ * @fn				Reserve
+ * @brief			Oobt@̋󂫗̈ݗpɗ\񂷂(f[^͒ǉȂ)
+ * @param[in]		int nLen					: \񂷂傫
+ * @param[out]		RING_SPAN* pstSpan			: \񂵂̈(ő2)
+ * @return			0`:\񂵂傫, -1:s
+ * @remarks
+ *		\񂵂̈֒ڃf[^(ReadFile ̎MɎw肷铙)ACommit Œǉm肵܂B
+ *		Reserve`Commit ̊Ԃ͏ݑ̑̏(Push/Reserve)Ă΂ȂłB
+ *		RING_MODE_LOCK ̏ꍇAReserve`Commit s݃Xbh1Ɍ܂B
+ *		RING_POLICY_GROW ̏ꍇ͕KvɉĊg܂BRING_POLICY_OVERWRITE ̏ꍇÂf[^͍폜A
+ *		󂫗݂̈̂\񂵂܂B
+ */
+int CByteRingBuffer::Reserve(int nLen, RING_SPAN* pstSpan)
+{
+	if (m_stRing.pbyBuff == NULL || pstSpan == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int count = 0;
+
+	lock();
+	count = ring_count(nLen, makeRoom(nLen, FALSE));
+	unsigned int wpos = m_stRing.uiWritePos.load(std::memory_order_relaxed);
+	makeSpan(wpos, count, pstSpan);
+	unlock();
+
+	return count;
+}
+
+
+/**
+ * @fn				Commit
+ * @brief			\񂵂̈ɏ񂾃f[^Oobt@ɒǉ
+ * @param[in]		int nLen					: ǉf[^̑傫(Reserve ŗ\񂵂傫ȉ)
+ * @return			0`:ǉf[^, -1:s
+ */
+int CByteRingBuffer::Commit(int nLen)
+{
+	if (m_stRing.pbyBuff == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int count = 0;
+
+	lock();
+	count = ring_count(nLen, spaceCount(nLen));
+	unsigned int wpos = m_stRing.uiWritePos.load(std::memory_order_relaxed);
+	m_stRing.uiWritePos.store(wpos + count, std::memory_order_release);
+	updateStats(wpos + count, nLen, count);
+	unlock();
+
+	notifyData();
+
+	return count;
+}
+
+
+/**
+ * @fn				PeekSpan
+ * @brief			Oobt@̃f[^̈擾(obt@̃f[^͍폜Ȃ)
+ * @param[out]		RING_SPAN* pstSpan			: f[^̈(ő2)
+ * @return			0`:f[^̑傫, -1:s
+ * @remarks
+ *		擾̈̃f[^̓Rs[ɎQƂł܂BQƂI Consume ō폜ĂB
+ *		PeekSpan`Consume ̊Ԃ͓Ǐȏ̏(Pop/Consume)Ă΂ȂłB
+ *		RING_POLICY_GROW ŊgꂽꍇAConsume ܂ł͎擾̈QƂł܂B
+ *		RING_POLICY_OVERWRITE ̏ꍇ͎Qƒ̗̈悪㏑邱Ƃ邽߁APop gpĂB
+ */
+int CByteRingBuffer::PeekSpan(RING_SPAN* pstSpan)
+{
+	if (m_stRing.pbyBuff == NULL || pstSpan == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int count = 0;
+
+	lock();
+	// i[ĂSf[^ΏۂƂ邽߁Aɏ݈ʒuĎ擾
+	count = dataCount(m_stRing.nBuffSize + 1);
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_relaxed);
+	makeSpan(rpos, count, pstSpan);
+	m_stRing.bPeeking = TRUE;
+	unlock();
+
+	return count;
+}
+
+
+/**
+ * @fn				Consume
+ * @brief			Oobt@̐擪wTCỸf[^폜
+ * @param[in]		int nLen					: 폜f[^̑傫
+ * @return			0`:폜f[^, -1:s
+ */
+int CByteRingBuffer::Consume(int nLen)
+{
+	if (m_stRing.pbyBuff == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int count = 0;
+
+	lock();
+	count = ring_count(nLen, dataCount(nLen));
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_relaxed);
+	ring_erase(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(rpos & m_stRing.nModMask), count);
+	m_stRing.uiReadPos.store(rpos + count, std::memory_order_release);
+	// PeekSpan ̎QƂI߁AgÕobt@
+	m_stRing.bPeeking = FALSE;
+	if (m_stRing.pbyRetired != NULL) {
+		delete[] m_stRing.pbyRetired;
+		m_stRing.pbyRetired = NULL;
+	}
+	unlock();
+
+	notifySpace();
 
 	return count;
 }
 
 
+/**
+ * @fn				PopWait
+ * @brief			w萔ȏ̃f[^i[܂őҋ@ăf[^擾
+ * @param[in,out]	unsigned char* pbyDest		: 擾f[^i[̈ւ̃|C^
+ * @param[in]		int nLen					: 擾f[^̑傫
+ * @param[in]		DWORD dwTimeout				: ^CAEg(ms, INFINITE:)
+ * @param[in]		int nWatermark				: Nf[^(nLen ȉɐ)
+ * @return			0`:擾f[^, -1:s
+ * @remarks
+ *		^CAEgꍇ́A̎_Ŋi[Ăf[^(nWatermark )擾܂B
+ *		RING_MODE_LOCK ŕXbhɑҋ@ꍇANɑXbhɎ擾邱Ƃ܂B
+ */
+int CByteRingBuffer::PopWait(unsigned char* pbyDest, int nLen, DWORD dwTimeout, int nWatermark/*=1*/)
+{
+	if (m_stRing.pbyBuff == NULL || pbyDest == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	if (nLen < nWatermark) {
+		nWatermark = nLen;
+	}
+	waitCount(TRUE, nWatermark, dwTimeout);
+
+	return Pop(pbyDest, nLen);
+}
+
+
+/**
+ * @fn			PushWait
+ * @brief		󂫗̈悪ł܂őҋ@Ȃf[^ǉ
+ * @param[in]	const unsigned char* pbySrc	: ǉf[^ւ̃|C^
+ * @param[in]	int nLen						: ǉf[^̑傫
+ * @param[in]	DWORD dwTimeout					: ^CAEg(ms, INFINITE:)
+ * @return		0`:ǉf[^, -1:s
+ * @remarks		Sf[^ǉ邩A^CAEg܂ŋ󂫑҂ƒǉJԂ܂B
+ */
+int CByteRingBuffer::PushWait(const unsigned char* pbySrc, int nLen, DWORD dwTimeout)
+{
+	if (m_stRing.pbyBuff == NULL || pbySrc == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int total = 0;
+	ULONGLONG ullStart = ::GetTickCount64();
+
+	while (total < nLen) {
+		total += Push(pbySrc + total, nLen - total);
+		if (nLen <= total) {
+			break;
+		}
+
+		DWORD wait = INFINITE;
+		if (dwTimeout != INFINITE) {
+			ULONGLONG elapsed = ::GetTickCount64() - ullStart;
+			if (dwTimeout <= elapsed) {
+				break;
+			}
+			wait = dwTimeout - (DWORD)elapsed;
+		}
+		waitCount(FALSE, nLen - total, wait);
+	}
+
+	return total;
+}
+
+
+/**
+ * @fn			WaitData
+ * @brief		w萔ȏ̃f[^i[܂őҋ@
+ * @param[in]	int nWatermark		: Nf[^(obt@TCYȉɐ)
+ * @param[in]	DWORD dwTimeout		: ^CAEg(ms, INFINITE:)
+ * @return		0`:ҋ@Ĩf[^(^CAEg nWatermark )
+ * @remarks		PeekSpan/Consume ŏꍇ̑ҋ@Ɏgp܂B
+ */
+int CByteRingBuffer::WaitData(int nWatermark, DWORD dwTimeout)
+{
+	return waitCount(TRUE, nWatermark, dwTimeout);
+}
+
+
+/**
+ * @fn			WaitSpace
+ * @brief		wTCYȏ̋󂫗̈悪ł܂őҋ@
+ * @param[in]	int nWatermark		: N󂫗e(obt@TCYȉɐ)
+ * @param[in]	DWORD dwTimeout		: ^CAEg(ms, INFINITE:)
+ * @return		0`:ҋ@I̋󂫗e(^CAEg nWatermark )
+ * @remarks		Reserve/Commit ŏꍇ̑ҋ@Ɏgp܂B
+ */
+int CByteRingBuffer::WaitSpace(int nWatermark, DWORD dwTimeout)
+{
+	return waitCount(FALSE, nWatermark, dwTimeout);
+}
+
+
 /**
  * @fn			Count
  * @brief		Oobt@̃f[^擾
  * @return		0`:f[^̐, -1:s
+ * @remarks		RING_MODE_SPSC ̏ꍇAݑEǏoȊÕXbhĂԂƊTZlƂȂ܂B
  */
 int CByteRingBuffer::Count()
 {
-	return m_stRing.nDataLength;
+	unsigned int wpos = m_stRing.uiWritePos.load(std::memory_order_acquire);
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_acquire);
+	int length = (int)(wpos - rpos);
+	if (length < 0) {
+		return 0;
+	}
+	return (m_stRing.nBuffSize < length) ? (m_stRing.nBuffSize) : (length);
+}
+
+
+/**
+ * @fn			GetMode
+ * @brief		r䃂[h擾
+ * @return		r䃂[h
+ */
+CByteRingBuffer::RING_MODE CByteRingBuffer::GetMode()
+{
+	return m_stRing.enMode;
+}
+
+
+/**
+ * @fn			GetPolicy
+ * @brief		obt@t̓擾
+ * @return		obt@t̓
+ */
+CByteRingBuffer::RING_POLICY CByteRingBuffer::GetPolicy()
+{
+	return m_stRing.enPolicy;
+}
+
+
+/**
+ * @fn			GetBuffSize
+ * @brief		݂̃obt@TCY擾
+ * @return		obt@TCY(RING_POLICY_GROW ̏ꍇ͊g̃TCY)
+ */
+int CByteRingBuffer::GetBuffSize()
+{
+	int size = 0;
+
+	lock();
+	size = m_stRing.nBuffSize;
+	unlock();
+
+	return size;
+}
+
+/**
+ * @fn			ResetStats
+ * @brief		f[^̍őlƔjoCg0ɖ߂
+ * @remarks		ݑƓɌĂ񂾏ꍇÅԂ̍XV͎邱Ƃ܂(vp)B
+ */
+void CByteRingBuffer::ResetStats()
+{
+	m_stRing.nHighWater.store(0, std::memory_order_relaxed);
+	m_stRing.llDropped.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @fn			updateStats
+ * @brief		݌̓v(f[^̍őlAjoCg)XV
+ * @param[in]	unsigned int uiWritePos	: ݌݈̏ʒu
+ * @param[in]	int nRequest			: ǉ悤ƂoCg
+ * @param[in]	int nWritten			: ǉoCg
+ * @remarks
+ *		ݑ݂̂XV邽߁AAg~bN(lock t)͎gp܂B
+ *		f[^͏ݑ̓ǏoʒuLbV狁߂邽߁Aۈȏ̒lɂȂ邱Ƃ܂
+ *		(obt@܂肩̓LbVXV邽߁Att߂̒l͐mł)B
+ */
+inline void CByteRingBuffer::updateStats(unsigned int uiWritePos, int nRequest, int nWritten)
+{
+	int count = (int)(uiWritePos - m_stRing.uiReadPosCache);
+	if (m_stRing.nHighWater.load(std::memory_order_relaxed) < count) {
+		m_stRing.nHighWater.store(count, std::memory_order_relaxed);
+	}
+	if (nWritten < nRequest) {
+		m_stRing.llDropped.store(m_stRing.llDropped.load(std::memory_order_relaxed) + (nRequest - nWritten), std::memory_order_relaxed);
+	}
 }
 
 
@@ -262,13 +764,287 @@ int CByteRingBuffer::calcBuffsize(int nSize)
 }
 
 
+/**
+ * @fn			spaceCount
+ * @brief		󂫗eʂ擾(ݑAŝݓǏoʒuĎ擾)
+ * @param[in]	int nLen		: ݂f[^̑傫
+ * @return		󂫗e
+ * @remarks
+ *		LbVǏoʒu͎ۂ̈ʒuȑÔ߁A󂫗eʂ͏Ȃ߂ɋ܂܂B
+ *		nLen ɑ΂ĕsꍇ̂ݓǏõLbVCǂݍ݂܂B
+ */
+int CByteRingBuffer::spaceCount(int nLen)
+{
+	unsigned int wpos = m_stRing.uiWritePos.load(std::memory_order_relaxed);
+	int free = m_stRing.nBuffSize - (int)(wpos - m_stRing.uiReadPosCache);
+	if (free < nLen) {
+		m_stRing.uiReadPosCache = m_stRing.uiReadPos.load(std::memory_order_acquire);
+		free = m_stRing.nBuffSize - (int)(wpos - m_stRing.uiReadPosCache);
+	}
+	return free;
+}
+
+
+/**
+ * @fn			dataCount
+ * @brief		f[^擾(ǏoAŝݏ݈ʒuĎ擾)
+ * @param[in]	int nLen		: ǂݏof[^̑傫
+ * @return		f[^(̏ꍇ0ƂĈ)
+ * @remarks		spaceCount ƓlɁAnLen ɑ΂ĕsꍇ̂ݏݑ̃LbVCǂݍ݂܂B
+ */
+int CByteRingBuffer::dataCount(int nLen)
+{
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_relaxed);
+	int count = (int)(m_stRing.uiWritePosCache - rpos);
+	if (count < nLen) {
+		m_stRing.uiWritePosCache = m_stRing.uiWritePos.load(std::memory_order_acquire);
+		count = (int)(m_stRing.uiWritePosCache - rpos);
+	}
+	return count;
+}
+
+
+/**
+ * @fn			makeRoom
+ * @brief		obt@t̓ɏ]AwTCY̏ݗ̈mۂ
+ * @param[in]	int nLen			: ރf[^̑傫
+ * @param[in]	BOOL bOverwrite		: TRUE:RING_POLICY_OVERWRITE ̏ꍇɌÂf[^폜
+ * @return		mی̋󂫗e(nLen ̏ꍇ)
+ * @remarks		bN擾ɌĂłBRING_POLICY_DROP ̏ꍇ͋󂫗eʂԂ݂̂łB
+ */
+int CByteRingBuffer::makeRoom(int nLen, BOOL bOverwrite)
+{
+	int free = spaceCount(nLen);
+
+	if (nLen <= free || m_stRing.enPolicy == RING_POLICY_DROP) {
+		return free;
+	}
+
+	// ȍ~ RING_MODE_LOCK ̂(spaceCount ɂ uiReadPosCache ͍ŐV)
+	unsigned int rpos = m_stRing.uiReadPosCache;
+	int count = m_stRing.nBuffSize - free;
+
+	switch (m_stRing.enPolicy) {
+	case RING_POLICY_OVERWRITE:
+		if (bOverwrite) {
+			// sÂf[^폜
+			int discard = ring_count(nLen - free, count);
+			ring_erase(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(rpos & m_stRing.nModMask), discard);
+			m_stRing.uiReadPos.store(rpos + discard, std::memory_order_release);
+			m_stRing.uiReadPosCache = rpos + discard;
+			m_stRing.llDropped.store(m_stRing.llDropped.load(std::memory_order_relaxed) + discard, std::memory_order_relaxed);
+			free += discard;
+		}
+		break;
+	case RING_POLICY_GROW:
+		if (grow(count + nLen) == 0) {
+			free = m_stRing.nBuffSize - count;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return free;
+}
+
+
+/**
+ * @fn			grow
+ * @brief		obt@g
+ * @param[in]	int nRequired	: Kvȃobt@TCY
+ * @return		0:, -1:s(TCYɒBĂ)
+ * @remarks
+ *		bN擾ɌĂłB
+ *		VTCY͕KvTCYȏ2ׂ̂悩݂2{ȏƂ(TCY܂)A
+ *		f[^̓obt@擪֋l߂Ĉڂ܂Bg񐔂̓f[^ʂɑ΂đΐɗ}܂B
+ */
+int CByteRingBuffer::grow(int nRequired)
+{
+	if (m_stRing.nMaxSize <= m_stRing.nBuffSize) {
+		return -1;
+	}
+
+	int size = calcBuffsize(nRequired);
+	if (size < m_stRing.nBuffSize * 2) {
+		size = m_stRing.nBuffSize * 2;
+	}
+	if (m_stRing.nMaxSize < size) {
+		size = m_stRing.nMaxSize;
+	}
+
+	unsigned char* pbyNew = new unsigned char[size];
+	if (pbyNew == NULL) {
+		return -1;
+	}
+	memset(pbyNew, 0, sizeof(unsigned char) * size);
+
+	unsigned int wpos = m_stRing.uiWritePos.load(std::memory_order_relaxed);
+	unsigned int rpos = m_stRing.uiReadPos.load(std::memory_order_relaxed);
+	int count = (int)(wpos - rpos);
+	ring_read(m_stRing.pbyBuff, m_stRing.nBuffSize, (int)(rpos & m_stRing.nModMask), pbyNew, count);
+
+	if (m_stRing.bPeeking && m_stRing.pbyRetired == NULL) {
+		// PeekSpan Ŏ擾̈悪Qƒ̂߁AConsume ܂ŉȂ
+		m_stRing.pbyRetired = m_stRing.pbyBuff;
+	}
+	else {
+		// Qƒ̗̈ PeekSpan _̃obt@(ێς)̂߁Ã݂obt@͉ł
+		delete[] m_stRing.pbyBuff;
+	}
+	m_stRing.pbyBuff = pbyNew;
+	m_stRing.nBuffSize = size;
+	m_stRing.nModMask = size - 1;
+	m_stRing.uiReadPos.store(0, std::memory_order_relaxed);
+	m_stRing.uiWritePos.store((unsigned int)count, std::memory_order_release);
+	m_stRing.uiReadPosCache = 0;
+	m_stRing.uiWritePosCache = (unsigned int)count;
+
+	return 0;
+}
+
+
+/**
+ * @fn			makeSpan
+ * @brief		wʒu̘Ä쐬
+ * @param[in]	unsigned int uiPos		: Jnʒu(ǂݏʒũJE^l)
+ * @param[in]	int nLen				: ̈̑傫
+ * @param[out]	RING_SPAN* pstSpan		: Ä
+ */
+void CByteRingBuffer::makeSpan(unsigned int uiPos, int nLen, RING_SPAN* pstSpan)
+{
+	int pos = (int)(uiPos & m_stRing.nModMask);
+	int first = m_stRing.nBuffSize - pos;
+	if (nLen < first) {
+		first = nLen;
+	}
+	pstSpan->apbyData[0] = m_stRing.pbyBuff + pos;
+	pstSpan->anLen[0] = first;
+	pstSpan->apbyData[1] = m_stRing.pbyBuff;
+	pstSpan->anLen[1] = nLen - first;
+}
+
+
+/**
+ * @fn			waitCount
+ * @brief		f[^(bData=TRUE)܂͋󂫗eʂwlȏɂȂ܂őҋ@
+ * @param[in]	BOOL bData			: TRUE:f[^, FALSE:󂫗e
+ * @param[in]	int nWatermark		: Nl(1`obt@TCYɐ)
+ * @param[in]	DWORD dwTimeout		: ^CAEg(ms, INFINITE:)
+ * @return		0`:ҋ@Ĩf[^܂͋󂫗e
+ * @remarks
+ *		葤XVʒu(f[^҂͏݈ʒuA󂫑҂͓Ǐoʒu) WaitOnAddress ŊĎ܂B
+ *		ҋ@OɋNo^A葤͏𖞂̂ WakeByAddressAll Ăт܂B
+ *		̃Xbhҋ@ꍇAN͑ҋ@̑SXbh̍ŏlƂ(ҋ@Xbh̐
+ *		1̒lɂ܂Ƃ߂čXV)AeXbh͋NɎg̏ĊmF܂B
+ *		̂ߋNR͖Ȃ傫Xbh߂邱Ƃ܂(ēxҋ@܂)B
+ */
+int CByteRingBuffer::waitCount(BOOL bData, int nWatermark, DWORD dwTimeout)
+{
+	std::atomic<unsigned int>& uiPos = (bData) ? (m_stRing.uiWritePos) : (m_stRing.uiReadPos);
+	std::atomic<long long>& llWait = (bData) ? (m_stRing.llDataWait) : (m_stRing.llSpaceWait);
+
+	if (nWatermark < 1) {
+		nWatermark = 1;
+	}
+	if (m_stRing.nBuffSize < nWatermark) {
+		nWatermark = m_stRing.nBuffSize;
+	}
+
+	int count = 0;
+	ULONGLONG ullStart = ::GetTickCount64();
+
+	// No^ĂʒumF(notifyData/notifySpace ̊mFƑ΂ɂċNRh)
+	long long cur = llWait.load(std::memory_order_relaxed);
+	long long next;
+	do {
+		int mark = RING_WAIT_MARK(cur);
+		next = RING_WAIT_PACK(RING_WAIT_COUNT(cur) + 1, (nWatermark < mark) ? (nWatermark) : (mark));
+	} while (!llWait.compare_exchange_weak(cur, next, std::memory_order_seq_cst));
+
+	while (TRUE) {
+		unsigned int observed = uiPos.load(std::memory_order_seq_cst);
+		if (bData) {
+			count = (int)(observed - m_stRing.uiReadPos.load(std::memory_order_acquire));
+		}
+		else {
+			count = m_stRing.nBuffSize - (int)(m_stRing.uiWritePos.load(std::memory_order_acquire) - observed);
+		}
+		if (nWatermark <= count) {
+			break;
+		}
+
+		DWORD wait = INFINITE;
+		if (dwTimeout != INFINITE) {
+			ULONGLONG elapsed = ::GetTickCount64() - ullStart;
+			if (dwTimeout <= elapsed) {
+				break;
+			}
+			wait = dwTimeout - (DWORD)elapsed;
+		}
+		// ʒu observed ωĂΑɖ߂(ŰN邽ߍĊmF)
+		::WaitOnAddress(&uiPos, &observed, sizeof(observed), wait);
+	}
+
+	// Ō̑ҋ@Xbh鎞̂݋N(̃Xbh͎̏c)
+	cur = llWait.load(std::memory_order_relaxed);
+	do {
+		int waiters = RING_WAIT_COUNT(cur) - 1;
+		next = (waiters <= 0) ? (RING_WAIT_IDLE) : (RING_WAIT_PACK(waiters, RING_WAIT_MARK(cur)));
+	} while (!llWait.compare_exchange_weak(cur, next, std::memory_order_relaxed));
+
+	return (count < 0) ? (0) : (count);
+}
+
+
+/**
+ * @fn			notifyData
+ * @brief		f[^҂̃XbhN(N𖞂ꍇ̂)
+ * @remarks
+ *		ҋ@XbhȂꍇ̓tFXƓǍ݂݂̂Ŗ߂܂B
+ *		f[^ҋ@Xbh̋N(ŏl)ɒB̂݋N܂B
+ */
+void CByteRingBuffer::notifyData()
+{
+	// ʒǔJɑҋ@XbhmF(waitCount ̓o^Ƒ)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long wait = m_stRing.llDataWait.load(std::memory_order_acquire);
+	if (RING_WAIT_COUNT(wait) == 0) {
+		return;
+	}
+	if (Count() < RING_WAIT_MARK(wait)) {
+		return;
+	}
+	::WakeByAddressAll(&m_stRing.uiWritePos);
+}
+
+
+/**
+ * @fn			notifySpace
+ * @brief		󂫑҂̃XbhN(N𖞂ꍇ̂)
+ * @remarks		notifyData ƓlłB
+ */
+void CByteRingBuffer::notifySpace()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long long wait = m_stRing.llSpaceWait.load(std::memory_order_acquire);
+	if (RING_WAIT_COUNT(wait) == 0) {
+		return;
+	}
+	if (m_stRing.nBuffSize - Count() < RING_WAIT_MARK(wait)) {
+		return;
+	}
+	::WakeByAddressAll(&m_stRing.uiReadPos);
+}
+
+
 /**
  * @fn			initLock
  * @brief		Oobt@̔r
  */
 void CByteRingBuffer::initLock()
 {
-	::InitializeCriticalSection(&(m_stRing.stCS));
+	m_stRing.cLock.Init();
 }
 
 
@@ -278,27 +1054,33 @@ void CByteRingBuffer::initLock()
  */
 void CByteRingBuffer::deleteLock()
 {
-	::DeleteCriticalSection(&(m_stRing.stCS));
+	m_stRing.cLock.Exit();
 }
 
 
 /**
  * @fn			lock
  * @brief		Oobt@rbN
+ * @remarks		RING_MODE_SPSC ̏ꍇ͉܂B
  */
 void CByteRingBuffer::lock()
 {
-	::EnterCriticalSection(&(m_stRing.stCS));
+	if (m_stRing.enMode == RING_MODE_LOCK) {
+		m_stRing.cLock.Lock();
+	}
 }
 
 
 /**
  * @fn			unlock
  * @brief		Oobt@̔rbN
+ * @remarks		RING_MODE_SPSC ̏ꍇ͉܂B
  */
 void CByteRingBuffer::unlock()
 {
-	::LeaveCriticalSection(&(m_stRing.stCS));
+	if (m_stRing.enMode == RING_MODE_LOCK) {
+		m_stRing.cLock.Unlock();
+	}
 }
 
 
@@ -312,7 +1094,7 @@ void CByteRingBuffer::debugPrint(const char* szProc)
 	char szBuff[256];
 	int size = (16 < m_stRing.nBuffSize) ? (m_stRing.nBuffSize) : (16);
 	mem_dump(m_stRing.pbyBuff, size, szBuff, sizeof(szBuff));
-	printf("%s: H:%02d,L:%02d,[%s]\r\n", szProc, m_stRing.nDataHead, m_stRing.nDataLength, szBuff);
+	printf("%s: H:%02d,L:%02d,[%s]\r\n", szProc, (int)(m_stRing.uiReadPos.load() & m_stRing.nModMask), Count(), szBuff);
 }
 
 
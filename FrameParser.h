@@ -0,0 +1,647 @@
+/**
+ * @file	FrameParser.h
+ * @brief	MoCg̃t[(Oobt@  bZ[WL[)
+ * @author	?
+ * @date	?
+ * @remarks
+ *		MXbhOobt@ɏ񂾃oCgAǏoŃt[PʂɕA
+ *		t[ CMessageQueue Ɋi[܂B
+ *		t[ CFramePool mۂobt@(FRAME_BUF)Ɋi[AL[ɂ̓|C^݂̂
+ *		i[邽߁AL[ւ̊i[EoŃt[f[^Rs[܂B
+ *		o͎gp CFramePool::Release ĂłB
+ *		t[̓r܂ł̃f[^͓̃t[obt@ɕێǍďoł
+ *		VɎMf[^݂̂𒲂ׂđ珈܂(ς݂̃f[^đȂ)B
+ *		Ήt[`͈ȉ̒ʂł(FRAME_MODE)B
+ *		- FRAME_MODE_STX_ETX	: STX ` ETX [+ BCC/LRC 1oCg]
+ *		- FRAME_MODE_LENGTH		: [JnoCg] + wb_̒tB[h
+ *		- FRAME_MODE_DELIMITER	: ؂蕶ŏIt[(DCB.EvtChar/EV_RXFLAG Ɠ؂)
+ */
+#pragma once
+
+#include <string.h>
+#include <assert.h>
+#include <windows.h>
+#include "CByteRingBuffer.h"
+#include "MessageQueue.h"
+#include "FramePool.h"
+#include "checksum.h"
+
+
+#define FRAME_MAX_SIZE			(1024)		//!< t[̍őTCY
+#define FRAME_QUEUE_SIZE		(64)		//!< t[L[̗vf(2ׂ̂)
+
+#define FRAME_STX				(0x02)
+#define FRAME_ETX				(0x03)
+
+
+/**
+ * @enum	FRAME_MODE
+ * @brief	t[`
+ */
+enum FRAME_MODE {
+	FRAME_MODE_STX_ETX = 0,			//!< STX ` ETX [+ `FbNR[h]
+	FRAME_MODE_LENGTH,				//!< tB[ht
+	FRAME_MODE_DELIMITER,			//!< ؂蕶ŏI
+};
+
+/**
+ * @enum	FRAME_CHECK
+ * @brief	`FbNR[h(t[1oCg)
+ * @remarks
+ *		FRAME_MODE_STX_ETX	: STX ̎̃oCg`ETX ΏۂƂAETX ̌ɕt܂B
+ *		FRAME_MODE_LENGTH	: JnoCg擪``FbNR[h̑OΏۂƂAt[̍ŏIoCgƂ܂B
+ *		FRAME_MODE_DELIMITER ł͎gp܂B
+ */
+enum FRAME_CHECK {
+	FRAME_CHECK_NONE = 0,			//!< `FbNR[h
+	FRAME_CHECK_BCC,				//!< BCC(XOR)
+	FRAME_CHECK_LRC,				//!< LRC(Zl2̕␔)
+};
+
+/**
+ * @struct	FRAME_CONFIG
+ * @brief	t[`̐ݒ
+ */
+struct FRAME_CONFIG {
+	FRAME_MODE			enMode;				//!< t[`
+	FRAME_CHECK			enCheck;			//!< `FbNR[h
+	int					nMaxSize;			//!< t[̍őTCY(FRAME_MAX_SIZE ȉ)
+	// FRAME_MODE_STX_ETX
+	unsigned char		byStx;				//!< JnoCg(FRAME_MODE_LENGTH łgp)
+	unsigned char		byEtx;				//!< IoCg
+	// FRAME_MODE_LENGTH
+	BOOL				bUseStart;			//!< JnoCg(byStx)TĂwb_ǂ
+	int					nLenOffset;			//!< t[擪璷tB[h܂ł̃oCg
+	int					nLenSize;			//!< tB[h̃oCg(1 or 2)
+	BOOL				bBigEndian;			//!< tB[hrbOGfBA
+	int					nLenAdjust;			//!< t[Ŝ̃oCg = tB[h̒l + nLenAdjust
+	// FRAME_MODE_DELIMITER
+	unsigned char		byDelim;			//!< ؂蕶(t[Ɋ܂߂)
+};
+
+//! t[L[(FRAME_BUF  Data() ` nLength oCgt[f[^(JnoCg``FbNR[h))
+typedef CMessageQueue<FRAME_BUF*, FRAME_QUEUE_SIZE>	CFrameQueue;
+
+
+/**
+ * @class	CFrameParser
+ * @brief	t[NX
+ * @remarks
+ *		1̃oCg(Oobt@̓Ǐo)ɑ΂1̃CX^Xgp܂B
+ *		Parse/ParseRing ͓XbhĂł(Ԃ͔r܂)B
+ *		L[tA܂̓obt@mۂłȂꍇAt[͔jăJEg܂(GetDropCount)B
+ *		FRAME_MODE_STX_ETX ł̓f[^ STX/ETX ܂܂ȂOƂAETX O STX M
+ *		ꍇ ETX 肱ڂ̂ƂāAV STX t[M܂B
+ */
+class CFrameParser
+{
+private:
+	/**
+	 * @enum	PARSE_STATE
+	 * @brief	͏
+	 */
+	enum PARSE_STATE {
+		STATE_HUNT = 0,						//!< JnoCg҂
+		STATE_BODY,							//!< {̎M(IoCg/؂蕶҂A܂͒̎M҂)
+		STATE_CHECK,						//!< `FbNR[h҂(FRAME_MODE_STX_ETX)
+		STATE_HEADER,						//!< tB[hM҂(FRAME_MODE_LENGTH)
+	};
+
+	FRAME_CONFIG		m_stConfig;							//!< t[`
+	CFrameQueue*		m_pcQueue;							//!< o͐L[
+	CFramePool*			m_pcPool;							//!< t[obt@̊mی
+	PARSE_STATE			m_enState;							//!< ͏
+	unsigned char		m_abyFrame[FRAME_MAX_SIZE];			//!< M̃t[
+	int					m_nLength;							//!< M̃t[̃oCg
+	int					m_nExpect;							//!< t[Ŝ̃oCg(FRAME_MODE_LENGTH)
+	BYTE				m_byBcc;							//!< `FbNR[hvZ̓ro(BCC)
+	DWORD				m_dwSum;							//!< `FbNR[hvZ̓ro(LRC)
+	// v
+	LONGLONG			m_llFrames;							//!< L[Ɋi[t[
+	LONGLONG			m_llCheckErrors;					//!< `FbNR[hsvŔjt[
+	LONGLONG			m_llDiscarded;						//!< t[OETCY߂ŔjoCg
+	LONGLONG			m_llDropped;						//!< L[tEobt@sŔjt[
+
+public:
+	CFrameParser(const FRAME_CONFIG* pstConfig, CFrameQueue* pcQueue, CFramePool* pcPool);
+	~CFrameParser();
+
+	int					Parse(const unsigned char* pbyData, int nLen);
+	int					ParseRing(CByteRingBuffer* pcRing);
+	void				Reset();
+
+	LONGLONG			GetFrameCount() { return m_llFrames; }
+	LONGLONG			GetCheckErrorCount() { return m_llCheckErrors; }
+	LONGLONG			GetDiscardCount() { return m_llDiscarded; }
+	LONGLONG			GetDropCount() { return m_llDropped; }
+
+	static void			DefaultConfig(FRAME_CONFIG* pstConfig, FRAME_MODE enMode);
+
+private:
+	int					parseStxEtx(const unsigned char* p, int nLen, int* pnFrames);
+	int					parseLength(const unsigned char* p, int nLen, int* pnFrames);
+	int					parseDelimiter(const unsigned char* p, int nLen, int* pnFrames);
+	BOOL				append(const unsigned char* p, int nLen, BOOL bCheck);
+	void				emit(int* pnFrames);
+	void				discard();
+	int					getLength();
+	PARSE_STATE			startState();
+};
+
+
+/**
+ * @fn			RXgN^
+ * @brief		t[
+ * @param[in]	const FRAME_CONFIG* pstConfig	: t[`(NULL:FRAME_MODE_STX_ETX ̊l)
+ * @param[in]	CFrameQueue* pcQueue			: t[̏o͐L[
+ * @param[in]	CFramePool* pcPool				: t[obt@̊mی
+ * @remarks
+ *		͈͊O nMaxSize  FRAME_MAX_SIZEAnLenSize  1 ɕ␳܂B
+ *		tB[h(nLenOffset`nLenOffset+nLenSize) nMaxSize Ɏ܂Ȃꍇ́A܂ʒuɕ␳܂B
+ */
+CFrameParser::CFrameParser(const FRAME_CONFIG* pstConfig, CFrameQueue* pcQueue, CFramePool* pcPool)
+{
+	if (pstConfig != NULL) {
+		m_stConfig = *pstConfig;
+	}
+	else {
+		DefaultConfig(&m_stConfig, FRAME_MODE_STX_ETX);
+	}
+	if (m_stConfig.nMaxSize <= 0 || FRAME_MAX_SIZE < m_stConfig.nMaxSize) {
+		m_stConfig.nMaxSize = FRAME_MAX_SIZE;
+	}
+	if ((m_stConfig.nLenSize != 1 && m_stConfig.nLenSize != 2) || m_stConfig.nMaxSize < m_stConfig.nLenSize) {
+		m_stConfig.nLenSize = 1;
+	}
+	// tB[h̓t[̍őTCY(m_abyFrame)Ɏ߂(܂Ȃƃwb_MIȂ)
+	if (m_stConfig.nLenOffset < 0 || m_stConfig.nMaxSize < m_stConfig.nLenOffset + m_stConfig.nLenSize) {
+#if _DEBUG
+		assert(m_stConfig.enMode != FRAME_MODE_LENGTH);
+#endif
+		m_stConfig.nLenOffset = (m_stConfig.nLenOffset < 0) ? (0) : (m_stConfig.nMaxSize - m_stConfig.nLenSize);
+	}
+	m_pcQueue = pcQueue;
+	m_pcPool = pcPool;
+	m_llFrames = 0;
+	m_llCheckErrors = 0;
+	m_llDiscarded = 0;
+	m_llDropped = 0;
+	Reset();
+}
+
+/**
+ * @fn			fXgN^
+ */
+CFrameParser::~CFrameParser()
+{
+}
+
+/**
+ * @fn			DefaultConfig
+ * @brief		t[`̊lݒ肷
+ * @param[out]	FRAME_CONFIG* pstConfig		: t[`
+ * @param[in]	FRAME_MODE enMode			: t[`
+ * @remarks
+ *		STX(0x02)/ETX(0x03)A`FbNR[hAtB[h͊JnoCgE擪1oCg(S̒)A
+ *		؂蕶 CR(0x0D) Ƃ܂BKvȍڂύXĎgpĂB
+ */
+void CFrameParser::DefaultConfig(FRAME_CONFIG* pstConfig, FRAME_MODE enMode)
+{
+	if (pstConfig == NULL) {
+		return;
+	}
+	memset(pstConfig, 0, sizeof(FRAME_CONFIG));
+	pstConfig->enMode = enMode;
+	pstConfig->enCheck = FRAME_CHECK_NONE;
+	pstConfig->nMaxSize = FRAME_MAX_SIZE;
+	pstConfig->byStx = FRAME_STX;
+	pstConfig->byEtx = FRAME_ETX;
+	pstConfig->bUseStart = FALSE;
+	pstConfig->nLenOffset = 0;
+	pstConfig->nLenSize = 1;
+	pstConfig->bBigEndian = FALSE;
+	pstConfig->nLenAdjust = 0;
+	pstConfig->byDelim = 0x0D;
+}
+
+/**
+ * @fn			Reset
+ * @brief		M̃t[jAJnoCg҂ɖ߂(̍Đڑ)
+ */
+void CFrameParser::Reset()
+{
+	m_enState = startState();
+	m_nLength = 0;
+	m_nExpect = 0;
+	m_byBcc = 0;
+	m_dwSum = 0;
+}
+
+/**
+ * @fn			Parse
+ * @brief		Mf[^͂At[L[Ɋi[
+ * @param[in]	const unsigned char* pbyData	: Mf[^
+ * @param[in]	int nLen						: Mf[^̃oCg
+ * @return		0`:L[Ɋi[t[, -1:s
+ * @remarks		Mf[^͑Sď(r̃t[͓ɕێ)Aďo֎c͕Ԃ܂B
+ */
+int CFrameParser::Parse(const unsigned char* pbyData, int nLen)
+{
+	if (pbyData == NULL || nLen < 0 || m_pcQueue == NULL || m_pcPool == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int frames = 0;
+	switch (m_stConfig.enMode) {
+	case FRAME_MODE_STX_ETX:
+		parseStxEtx(pbyData, nLen, &frames);
+		break;
+	case FRAME_MODE_LENGTH:
+		parseLength(pbyData, nLen, &frames);
+		break;
+	case FRAME_MODE_DELIMITER:
+		parseDelimiter(pbyData, nLen, &frames);
+		break;
+	default:
+		return -1;
+	}
+	return frames;
+}
+
+/**
+ * @fn			ParseRing
+ * @brief		Oobt@̑Sf[^͂At[L[Ɋi[
+ * @param[in]	CByteRingBuffer* pcRing		: Oobt@(Ǐo)
+ * @return		0`:L[Ɋi[t[, -1:s
+ * @remarks
+ *		PeekSpan ŎQƂ̈(܂Ԃōő2)ɉ͂Ă Consume 邽߁A
+ *		Oobt@ꎞ̈ւ̃Rs[͍s܂B
+ */
+int CFrameParser::ParseRing(CByteRingBuffer* pcRing)
+{
+	if (pcRing == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	CByteRingBuffer::RING_SPAN stSpan;
+	int count = pcRing->PeekSpan(&stSpan);
+	if (count <= 0) {
+		if (count == 0) {
+			pcRing->Consume(0);
+		}
+		return count;
+	}
+
+	int frames = 0;
+	for (int i = 0; i < 2; i++) {
+		if (0 < stSpan.anLen[i]) {
+			int ret = Parse(stSpan.apbyData[i], stSpan.anLen[i]);
+			if (0 < ret) {
+				frames += ret;
+			}
+		}
+	}
+	pcRing->Consume(count);
+	return frames;
+}
+
+/**
+ * @fn			parseStxEtx
+ * @brief		STX ` ETX [+ `FbNR[h] `̉
+ * @param[in]	const unsigned char* p	: Mf[^
+ * @param[in]	int nLen				: Mf[^̃oCg
+ * @param[out]	int* pnFrames			: L[Ɋi[t[(Z)
+ * @return		0
+ */
+int CFrameParser::parseStxEtx(const unsigned char* p, int nLen, int* pnFrames)
+{
+	const unsigned char* end = p + nLen;
+
+	while (p < end) {
+		switch (m_enState) {
+		case STATE_HUNT: {
+			const unsigned char* stx = (const unsigned char*)memchr(p, m_stConfig.byStx, end - p);
+			if (stx == NULL) {
+				m_llDiscarded += end - p;
+				return 0;
+			}
+			m_llDiscarded += stx - p;
+			m_nLength = 0;
+			m_byBcc = 0;
+			m_dwSum = 0;
+			append(stx, 1, FALSE);
+			p = stx + 1;
+			m_enState = STATE_BODY;
+			break;
+		}
+		case STATE_BODY: {
+			const unsigned char* etx = (const unsigned char*)memchr(p, m_stConfig.byEtx, end - p);
+			const unsigned char* last = (etx != NULL) ? (etx) : (end);
+			// ETX O STX ΁AETX 肱ڂt[ƂĔjV STX M
+			const unsigned char* stx = (const unsigned char*)memchr(p, m_stConfig.byStx, last - p);
+			if (stx != NULL) {
+				m_llDiscarded += m_nLength + (stx - p);
+				m_enState = STATE_HUNT;
+				p = stx;
+				break;
+			}
+			int len = (int)(last - p) + ((etx != NULL) ? (1) : (0));
+			if (!append(p, len, TRUE)) {
+				// őTCY(Mς݂̕ƒǉłȂj)
+				discard();
+				m_llDiscarded += len;
+				p += len;
+				break;
+			}
+			p += len;
+			if (etx != NULL) {
+				if (m_stConfig.enCheck == FRAME_CHECK_NONE) {
+					emit(pnFrames);
+				}
+				else {
+					m_enState = STATE_CHECK;
+				}
+			}
+			break;
+		}
+		case STATE_CHECK: {
+			BYTE expect = (m_stConfig.enCheck == FRAME_CHECK_BCC) ? (m_byBcc) : (lrc_final(m_dwSum));
+			if (!append(p, 1, FALSE)) {
+				discard();
+			}
+			else if (*p != expect) {
+				m_llCheckErrors++;
+				m_enState = STATE_HUNT;
+			}
+			else {
+				emit(pnFrames);
+			}
+			p++;
+			break;
+		}
+		default:
+			m_enState = STATE_HUNT;
+			break;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @fn			parseLength
+ * @brief		tB[ht`̉
+ * @param[in]	const unsigned char* p	: Mf[^
+ * @param[in]	int nLen				: Mf[^̃oCg
+ * @param[out]	int* pnFrames			: L[Ɋi[t[(Z)
+ * @return		0
+ * @remarks		s(wb_EőTCY)̏ꍇ͎Mς݂̃f[^jAJnoCg҂ɖ߂܂B
+ */
+int CFrameParser::parseLength(const unsigned char* p, int nLen, int* pnFrames)
+{
+	const unsigned char* end = p + nLen;
+	int header = m_stConfig.nLenOffset + m_stConfig.nLenSize;
+	int check = (m_stConfig.enCheck == FRAME_CHECK_NONE) ? (0) : (1);
+
+	while (p < end) {
+		switch (m_enState) {
+		case STATE_HUNT: {
+			const unsigned char* stx = (const unsigned char*)memchr(p, m_stConfig.byStx, end - p);
+			if (stx == NULL) {
+				m_llDiscarded += end - p;
+				return 0;
+			}
+			m_llDiscarded += stx - p;
+			m_nLength = 0;
+			m_byBcc = 0;
+			m_dwSum = 0;
+			append(stx, 1, FALSE);
+			p = stx + 1;
+			m_enState = STATE_HEADER;
+			break;
+		}
+		case STATE_HEADER: {
+			if (m_nLength == 0) {
+				m_byBcc = 0;
+				m_dwSum = 0;
+			}
+			int len = header - m_nLength;
+			if (end - p < len) {
+				len = (int)(end - p);
+			}
+			// JnoCg̓`FbNR[h̑ΏۊO(STATE_HUNT Œǉς)
+			if (!append(p, len, 0 < check)) {
+				// őTCY𒴂: ǂ񂾕jăt[̐擪(JnoCg҂A܂̓wb_)蒼
+				m_llDiscarded += len;
+				p += len;
+				discard();
+				break;
+			}
+			p += len;
+			if (m_nLength < header) {
+				break;
+			}
+			m_nExpect = getLength();
+			if (m_nExpect < header + check || m_stConfig.nMaxSize < m_nExpect) {
+				discard();
+				break;
+			}
+			m_enState = STATE_BODY;
+			// tB[ĥ݂̃t[
+			if (m_nExpect == m_nLength) {
+				emit(pnFrames);
+			}
+			break;
+		}
+		case STATE_BODY: {
+			int len = m_nExpect - check - m_nLength;
+			if (0 < len) {
+				if (end - p < len) {
+					len = (int)(end - p);
+				}
+				if (!append(p, len, TRUE)) {
+					m_llDiscarded += len;
+					p += len;
+					discard();
+					break;
+				}
+				p += len;
+				if (m_nLength < m_nExpect - check) {
+					break;
+				}
+				if (check == 0) {
+					emit(pnFrames);
+					break;
+				}
+				if (end <= p) {
+					break;
+				}
+			}
+			// `FbNR[h
+			BYTE expect = (m_stConfig.enCheck == FRAME_CHECK_BCC) ? (m_byBcc) : (lrc_final(m_dwSum));
+			append(p, 1, FALSE);
+			if (*p != expect) {
+				m_llCheckErrors++;
+				m_nLength = 0;
+				m_enState = startState();
+			}
+			else {
+				emit(pnFrames);
+			}
+			p++;
+			break;
+		}
+		default:
+			m_enState = startState();
+			break;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @fn			parseDelimiter
+ * @brief		؂蕶ŏI`̉
+ * @param[in]	const unsigned char* p	: Mf[^
+ * @param[in]	int nLen				: Mf[^̃oCg
+ * @param[out]	int* pnFrames			: L[Ɋi[t[(Z)
+ * @return		0
+ * @remarks		őTCY𒴂t[͋؂蕶܂Ŕj܂B
+ */
+int CFrameParser::parseDelimiter(const unsigned char* p, int nLen, int* pnFrames)
+{
+	const unsigned char* end = p + nLen;
+
+	while (p < end) {
+		const unsigned char* delim = (const unsigned char*)memchr(p, m_stConfig.byDelim, end - p);
+		int len = (delim != NULL) ? ((int)(delim - p) + 1) : ((int)(end - p));
+
+		if (m_enState == STATE_HUNT) {
+			// TCY߂t[̎c(؂蕶܂)ǂݎ̂Ă
+			m_llDiscarded += len;
+			if (delim != NULL) {
+				m_nLength = 0;
+				m_enState = STATE_BODY;
+			}
+		}
+		else if (!append(p, len, FALSE)) {
+			// Mς݂̕ƒǉłȂj
+			discard();
+			m_llDiscarded += len;
+			if (delim != NULL) {
+				m_enState = STATE_BODY;
+			}
+		}
+		else if (delim != NULL) {
+			emit(pnFrames);
+		}
+		p += len;
+	}
+	return 0;
+}
+
+/**
+ * @fn			append
+ * @brief		M̃t[Ƀf[^ǉ
+ * @param[in]	const unsigned char* p	: ǉf[^
+ * @param[in]	int nLen				: ǉf[^̃oCg
+ * @param[in]	BOOL bCheck				: `FbNR[ȟvZΏۂƂ
+ * @return		TRUE:, FALSE:őTCY(ǉȂ)
+ */
+BOOL CFrameParser::append(const unsigned char* p, int nLen, BOOL bCheck)
+{
+	if (m_stConfig.nMaxSize < m_nLength + nLen) {
+		return FALSE;
+	}
+	memcpy(m_abyFrame + m_nLength, p, nLen);
+	m_nLength += nLen;
+	if (bCheck) {
+		if (m_stConfig.enCheck == FRAME_CHECK_BCC) {
+			m_byBcc = bcc_update(m_byBcc, p, nLen);
+		}
+		else if (m_stConfig.enCheck == FRAME_CHECK_LRC) {
+			m_dwSum = sum_update(m_dwSum, p, nLen);
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * @fn			emit
+ * @brief		Mt[v[̃obt@ɃRs[ăL[Ɋi[Ãt[̎M҂ɖ߂
+ * @param[out]	int* pnFrames	: L[Ɋi[t[(Z)
+ */
+void CFrameParser::emit(int* pnFrames)
+{
+	FRAME_BUF* buf = m_pcPool->Alloc(m_nLength);
+	if (buf == NULL) {
+		m_llDropped++;
+	}
+	else {
+		memcpy(buf->Data(), m_abyFrame, m_nLength);
+		buf->nLength = m_nLength;
+		if (m_pcQueue->Enqueue(buf) < 0) {
+			CFramePool::Release(buf);
+			m_llDropped++;
+		}
+		else {
+			m_llFrames++;
+			(*pnFrames)++;
+		}
+	}
+	m_nLength = 0;
+	m_byBcc = 0;
+	m_dwSum = 0;
+	m_enState = startState();
+}
+
+/**
+ * @fn			discard
+ * @brief		M̃t[jAJnoCg҂ɖ߂
+ * @remarks		FRAME_MODE_DELIMITER ł͎̋؂蕶܂łǂݎ̂Ă(STATE_HUNT)ɂȂ܂B
+ */
+void CFrameParser::discard()
+{
+	m_llDiscarded += m_nLength;
+	m_nLength = 0;
+	m_byBcc = 0;
+	m_dwSum = 0;
+	m_enState = (m_stConfig.enMode == FRAME_MODE_LENGTH) ? (startState()) : (STATE_HUNT);
+}
+
+/**
+ * @fn			getLength
+ * @brief		Mς݂̃wb_t[Ŝ̃oCg𓾂
+ * @return		t[Ŝ̃oCg
+ */
+int CFrameParser::getLength()
+{
+	const unsigned char* f = m_abyFrame + m_stConfig.nLenOffset;
+	int value = f[0];
+	if (m_stConfig.nLenSize == 2) {
+		value = (m_stConfig.bBigEndian) ? ((f[0] << 8) | f[1]) : (f[0] | (f[1] << 8));
+	}
+	return value + m_stConfig.nLenAdjust;
+}
+
+/**
+ * @fn			startState
+ * @brief		t[擪̉͏Ԃ𓾂
+ * @return		STATE_HUNT:JnoCg҂, STATE_HEADER:tB[h҂, STATE_BODY:؂蕶҂
+ */
+CFrameParser::PARSE_STATE CFrameParser::startState()
+{
+	switch (m_stConfig.enMode) {
+	case FRAME_MODE_LENGTH:
+		return (m_stConfig.bUseStart) ? (STATE_HUNT) : (STATE_HEADER);
+	case FRAME_MODE_DELIMITER:
+		return STATE_BODY;
+	default:
+		return STATE_HUNT;
+	}
+}
@@ -0,0 +1,551 @@
+/**
+ * @file	FramePool.h
+ * @brief	t[obt@̃v[(TCYNXʁEQƃJEgt)
+ * @author	?
+ * @date	?
+ * @remarks
+ *		Mt[ I/O Xbh́EOõ͓Xbh֎󂯓n߂̃obt@A
+ *		TCYNX(64, 128, ... 8192 oCg)ɂ܂Ƃ߂Ċmۂčėp܂B
+ *		eTCYNX̋󂫃obt@ SLIST(bNt[)ŕێAɃXbh̃LbV
+ *		(TLS)ɏێ邽߁AԂ Alloc/Release  malloc bNgp܂B
+ *		󂫃obt@ꍇ̂݁A`N(FRAME_POOL_CHUNK_SIZE)PʂŊmۂĕ܂B
+ *		obt@(FRAME_BUF)͎QƃJEgAAddRef ŕ̎󂯎葤ɓnA
+ *		Ō Release Ńv[ɖ߂܂(ǂ̃Xbh Release Ă悢)B
+ *		_DEBUG rhł͏LXbh/LҖL^ADumpOutstanding Ŗ̃obt@\܂B
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include <intrin.h>
+#include <windows.h>
+#include "ring_core.h"
+
+
+#define FRAME_POOL_MIN_SHIFT		(6)			//!< ŏTCYNX(1 << 6 = 64 oCg)
+#define FRAME_POOL_CLASS_NUM		(8)			//!< TCYNX(64 ` 8192 oCg)
+#define FRAME_POOL_MAX_SIZE			(1 << (FRAME_POOL_MIN_SHIFT + FRAME_POOL_CLASS_NUM - 1))	//!< mۂłőTCY
+#define FRAME_POOL_CHUNK_SIZE		(64 * 1024)	//!< `N(܂Ƃ߂ĊmۂP)̑傫
+#define FRAME_POOL_CACHE_SIZE		(32)		//!< Xbh̃LbVɕێTCYNX̍ő吔
+#define FRAME_POOL_BATCH			(FRAME_POOL_CACHE_SIZE / 2)	//!< LbVƋ󂫃XgԂňxɈړ鐔
+
+
+class CFramePool;
+
+/**
+ * @struct	FRAME_BUF
+ * @brief	t[obt@(wb_̒Ƀf[^̈悪)
+ * @remarks	󂫃obt@ InterlockedPushEntrySList ŕێ邽߁ASLIST_ENTRY 擪ɒu܂B
+ */
+struct DECLSPEC_ALIGN(MEMORY_ALLOCATION_ALIGNMENT) FRAME_BUF {
+	SLIST_ENTRY			stEntry;							//!< 󂫃Xg
+	CFramePool*			pcPool;								//!< mی̃v[
+	volatile LONG		lRef;								//!< QƐ(0:)
+	int					nClass;								//!< TCYNX
+	int					nCapacity;							//!< f[^̈̑傫
+	int					nLength;							//!< f[^̃oCg(pŐݒ)
+	LONGLONG			llStamp;							//!< M(pŐݒAQueryPerformanceCounter ̒lȂ)
+#ifdef _DEBUG
+	DWORD				dwOwner;							//!< LXbhID(Alloc/SetOwner Xbh)
+	const char*			szOwner;							//!< LҖ(SetOwnerAÓIȕw)
+#endif
+
+	//! f[^̈̐擪
+	unsigned char*		Data() { return (unsigned char*)(this + 1); }
+};
+
+/**
+ * @struct	FRAME_POOL_CHUNK
+ * @brief	`Ñwb_(`N̐擪ɒuAォ FRAME_BUF ׂ)
+ */
+struct DECLSPEC_ALIGN(CACHE_LINE_SIZE) FRAME_POOL_CHUNK {
+	FRAME_POOL_CHUNK*	pstNext;							//!< ̃`N
+	int					nClass;								//!< TCYNX
+	int					nBlocks;							//!< obt@
+	int					nStride;							//!< obt@1̑傫(wb_ + f[^̈)
+};
+
+/**
+ * @struct	FRAME_POOL_CACHE
+ * @brief	Xbh̃LbV
+ */
+struct FRAME_POOL_CACHE {
+	FRAME_BUF*			apBuf[FRAME_POOL_CLASS_NUM][FRAME_POOL_CACHE_SIZE];	//!< 󂫃obt@
+	int					anCount[FRAME_POOL_CLASS_NUM];						//!< 󂫃obt@
+	FRAME_POOL_CACHE*	pstNext;											//!< v[̑SLbṼXg(jp)
+	DWORD				dwThreadId;											//!< LXbhID
+};
+
+
+/**
+ * @class	CFramePool
+ * @brief	t[obt@̃v[
+ */
+class CFramePool
+{
+private:
+	SLIST_HEADER			m_astFree[FRAME_POOL_CLASS_NUM];		//!< TCYNX̋󂫃obt@
+	DWORD					m_dwTlsIndex;							//!< Xbh̃LbV(TLS_OUT_OF_INDEXES:LbV)
+	FRAME_POOL_CACHE* volatile	m_pstCaches;						//!< 쐬SLbV
+	FRAME_POOL_CHUNK*		m_pstChunks;							//!< mۂS`N
+	SRWLOCK					m_srwGrow;								//!< `Nǉ̔r
+	volatile LONG			m_lChunks;								//!< `N
+	volatile LONG			m_alBlocks[FRAME_POOL_CLASS_NUM];		//!< TCYNX̃obt@
+#ifdef _DEBUG
+	volatile LONG			m_lOutstanding;							//!< ̃obt@
+#endif
+
+public:
+	CFramePool();
+	~CFramePool();
+
+	FRAME_BUF*			Alloc(int nSize);
+	static void			AddRef(FRAME_BUF* pstBuf);
+	static void			Release(FRAME_BUF* pstBuf);
+	static void			SetOwner(FRAME_BUF* pstBuf, const char* szOwner);
+	int					Reserve(int nSize, int nCount);
+	void				FlushThreadCache();
+
+	int					GetChunkCount() { return (int)m_lChunks; }
+	int					GetBlockCount(int nSize);
+	int					GetOutstanding();
+	void				DumpOutstanding(FILE* fp);
+
+	static int			SizeToClass(int nSize);
+	static int			ClassToSize(int nClass) { return 1 << (FRAME_POOL_MIN_SHIFT + nClass); }
+
+private:
+	void				recycle(FRAME_BUF* pstBuf);
+	FRAME_POOL_CACHE*	getCache();
+	FRAME_BUF*			refill(FRAME_POOL_CACHE* pstCache, int nClass);
+	void				spill(FRAME_POOL_CACHE* pstCache, int nClass, int nCount);
+	int					grow(int nClass);
+};
+
+
+/**
+ * @brief	RXgN^
+ */
+CFramePool::CFramePool() :
+	m_pstCaches(NULL)
+	, m_pstChunks(NULL)
+	, m_lChunks(0)
+#ifdef _DEBUG
+	, m_lOutstanding(0)
+#endif
+{
+	for (int i = 0; i < FRAME_POOL_CLASS_NUM; i++) {
+		InitializeSListHead(&m_astFree[i]);
+		m_alBlocks[i] = 0;
+	}
+	InitializeSRWLock(&m_srwGrow);
+	m_dwTlsIndex = TlsAlloc();		// s̓LbV(󂫃Xg𒼐ڎgp)œ삷
+}
+
+
+/**
+ * @brief	fXgN^
+ * @remarks	̃obt@ԂŔjȂł(_DEBUG ł assert)B
+ */
+CFramePool::~CFramePool()
+{
+#ifdef _DEBUG
+	if (m_lOutstanding != 0) {
+		DumpOutstanding(stdout);
+		assert(FALSE);
+	}
+#endif
+	FRAME_POOL_CACHE* pstCache = m_pstCaches;
+	while (pstCache != NULL) {
+		FRAME_POOL_CACHE* pstNext = pstCache->pstNext;
+		delete pstCache;
+		pstCache = pstNext;
+	}
+	FRAME_POOL_CHUNK* pstChunk = m_pstChunks;
+	while (pstChunk != NULL) {
+		FRAME_POOL_CHUNK* pstNext = pstChunk->pstNext;
+		_aligned_free(pstChunk);
+		pstChunk = pstNext;
+	}
+	if (m_dwTlsIndex != TLS_OUT_OF_INDEXES) {
+		TlsFree(m_dwTlsIndex);
+	}
+}
+
+
+/**
+ * @fn		Alloc
+ * @brief	t[obt@mۂ
+ * @param[in]	int nSize			: Kvȃf[^̈̑傫(FRAME_POOL_MAX_SIZE ȉ)
+ * @return	t[obt@(QƐ1, nLength=0), NULL:s
+ * @remarks	svɂȂ Release ĂB
+ */
+FRAME_BUF* CFramePool::Alloc(int nSize)
+{
+	int nClass = SizeToClass(nSize);
+	if (nClass < 0) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return NULL;
+	}
+
+	FRAME_BUF* pstBuf = NULL;
+	FRAME_POOL_CACHE* pstCache = getCache();
+	if (pstCache != NULL && 0 < pstCache->anCount[nClass]) {
+		pstBuf = pstCache->apBuf[nClass][--pstCache->anCount[nClass]];
+	}
+	else {
+		pstBuf = refill(pstCache, nClass);
+	}
+	if (pstBuf == NULL) {
+		return NULL;
+	}
+
+	pstBuf->lRef = 1;
+	pstBuf->nLength = 0;
+	pstBuf->llStamp = 0;
+#ifdef _DEBUG
+	pstBuf->dwOwner = GetCurrentThreadId();
+	pstBuf->szOwner = NULL;
+	InterlockedIncrement(&m_lOutstanding);
+#endif
+	return pstBuf;
+}
+
+
+/**
+ * @fn		AddRef
+ * @brief	t[obt@̎QƐ𑝂₷(ʂ̎󂯎葤ɂnꍇ)
+ * @param[in]	FRAME_BUF* pstBuf	: t[obt@
+ */
+void CFramePool::AddRef(FRAME_BUF* pstBuf)
+{
+	if (pstBuf == NULL) {
+		return;
+	}
+#ifdef _DEBUG
+	assert(0 < pstBuf->lRef);		// ς݂̃obt@
+#endif
+	InterlockedIncrement(&pstBuf->lRef);
+}
+
+
+/**
+ * @fn		Release
+ * @brief	t[obt@̎QƐ炵A0 ɂȂv[ɖ߂
+ * @param[in]	FRAME_BUF* pstBuf	: t[obt@
+ */
+void CFramePool::Release(FRAME_BUF* pstBuf)
+{
+	if (pstBuf == NULL) {
+		return;
+	}
+	LONG lRef = InterlockedDecrement(&pstBuf->lRef);
+	if (lRef == 0) {
+		pstBuf->pcPool->recycle(pstBuf);
+	}
+#ifdef _DEBUG
+	else if (lRef < 0) {
+		assert(FALSE);		// d
+	}
+#endif
+}
+
+
+/**
+ * @fn		SetOwner
+ * @brief	t[obt@̏L҂L^(_DEBUG ̂݁A󂯓nŌĂ)
+ * @param[in]	FRAME_BUF* pstBuf		: t[obt@
+ * @param[in]	const char* szOwner		: LҖ(ÓIȕ)
+ */
+void CFramePool::SetOwner(FRAME_BUF* pstBuf, const char* szOwner)
+{
+#ifdef _DEBUG
+	if (pstBuf != NULL) {
+		pstBuf->dwOwner = GetCurrentThreadId();
+		pstBuf->szOwner = szOwner;
+	}
+#else
+	(void)pstBuf;
+	(void)szOwner;
+#endif
+}
+
+
+/**
+ * @fn		Reserve
+ * @brief	wTCỸobt@OɊmۂ(NɌĂсAMJñ`Nǉ)
+ * @param[in]	int nSize		: f[^̈̑傫
+ * @param[in]	int nCount		: mۂĂobt@
+ * @return	0`:TCYNX̃obt@, -1:s
+ */
+int CFramePool::Reserve(int nSize, int nCount)
+{
+	int nClass = SizeToClass(nSize);
+	if (nClass < 0) {
+		return -1;
+	}
+	while (m_alBlocks[nClass] < nCount) {
+		if (grow(nClass) < 0) {
+			return -1;
+		}
+	}
+	return (int)m_alBlocks[nClass];
+}
+
+
+/**
+ * @fn		FlushThreadCache
+ * @brief	ďoXbh̃LbṼobt@󂫃Xgɖ߂
+ * @remarks	v[ɏIXbh́AIOɌĂł(Ă΂ȂꍇA
+ *			LbṼobt@̓v[̔j܂ōėp܂)B
+ */
+void CFramePool::FlushThreadCache()
+{
+	if (m_dwTlsIndex == TLS_OUT_OF_INDEXES) {
+		return;
+	}
+	FRAME_POOL_CACHE* pstCache = (FRAME_POOL_CACHE*)TlsGetValue(m_dwTlsIndex);
+	if (pstCache == NULL) {
+		return;
+	}
+	for (int i = 0; i < FRAME_POOL_CLASS_NUM; i++) {
+		spill(pstCache, i, pstCache->anCount[i]);
+	}
+}
+
+
+/**
+ * @fn		GetBlockCount
+ * @brief	TCYNX̃obt@擾
+ * @param[in]	int nSize		: f[^̈̑傫
+ * @return	0`:obt@, -1:s
+ */
+int CFramePool::GetBlockCount(int nSize)
+{
+	int nClass = SizeToClass(nSize);
+	return (nClass < 0) ? (-1) : ((int)m_alBlocks[nClass]);
+}
+
+
+/**
+ * @fn		GetOutstanding
+ * @brief	̃obt@擾
+ * @return	0`:̃obt@(_DEBUG ̂), -1:[Xrhł͖v
+ */
+int CFramePool::GetOutstanding()
+{
+#ifdef _DEBUG
+	return (int)m_lOutstanding;
+#else
+	return -1;
+#endif
+}
+
+
+/**
+ * @fn		DumpOutstanding
+ * @brief	̃obt@ƏL҂o͂(_DEBUG ̂)
+ * @param[in]	FILE* fp	: o͐
+ * @remarks	̃Xbh Alloc/Release ̏ꍇAo͓e͖ڈłB
+ */
+void CFramePool::DumpOutstanding(FILE* fp)
+{
+#ifdef _DEBUG
+	if (fp == NULL) {
+		return;
+	}
+	AcquireSRWLockShared(&m_srwGrow);
+	for (FRAME_POOL_CHUNK* pstChunk = m_pstChunks; pstChunk != NULL; pstChunk = pstChunk->pstNext) {
+		unsigned char* pbyBlock = (unsigned char*)(pstChunk + 1);
+		for (int i = 0; i < pstChunk->nBlocks; i++, pbyBlock += pstChunk->nStride) {
+			FRAME_BUF* pstBuf = (FRAME_BUF*)pbyBlock;
+			if (0 < pstBuf->lRef) {
+				fprintf(fp, "FramePool: %p size=%d len=%d ref=%ld thread=%lu owner=%s\r\n"
+					, (void*)pstBuf, pstBuf->nCapacity, pstBuf->nLength, (long)pstBuf->lRef
+					, (unsigned long)pstBuf->dwOwner, (pstBuf->szOwner != NULL) ? (pstBuf->szOwner) : ("-"));
+			}
+		}
+	}
+	ReleaseSRWLockShared(&m_srwGrow);
+#else
+	(void)fp;
+#endif
+}
+
+
+/**
+ * @fn		SizeToClass
+ * @brief	f[^̈̑傫TCYNX߂
+ * @param[in]	int nSize		: f[^̈̑傫
+ * @return	0`:TCYNX, -1:͈͊O
+ */
+int CFramePool::SizeToClass(int nSize)
+{
+	if (nSize < 0 || FRAME_POOL_MAX_SIZE < nSize) {
+		return -1;
+	}
+	if (nSize <= (1 << FRAME_POOL_MIN_SHIFT)) {
+		return 0;
+	}
+	unsigned long ulBit;
+	_BitScanReverse(&ulBit, (unsigned long)(nSize - 1));
+	return (int)ulBit + 1 - FRAME_POOL_MIN_SHIFT;
+}
+
+
+/**
+ * @fn		recycle
+ * @brief	QƐ 0 ɂȂobt@ďoXbh̃LbV(܂͋󂫃Xg)ɖ߂
+ * @param[in]	FRAME_BUF* pstBuf	: t[obt@
+ */
+void CFramePool::recycle(FRAME_BUF* pstBuf)
+{
+	int nClass = pstBuf->nClass;
+#ifdef _DEBUG
+	memset(pstBuf->Data(), 0xDD, pstBuf->nCapacity);		// ̎QƂo₷
+	pstBuf->szOwner = NULL;
+	InterlockedDecrement(&m_lOutstanding);
+#endif
+
+	FRAME_POOL_CACHE* pstCache = getCache();
+	if (pstCache == NULL) {
+		InterlockedPushEntrySList(&m_astFree[nClass], &pstBuf->stEntry);
+		return;
+	}
+	if (FRAME_POOL_CACHE_SIZE <= pstCache->anCount[nClass]) {
+		spill(pstCache, nClass, FRAME_POOL_BATCH);		// ̃Xbhɗ܂mۑ։
+	}
+	pstCache->apBuf[nClass][pstCache->anCount[nClass]++] = pstBuf;
+}
+
+
+/**
+ * @fn		getCache
+ * @brief	ďoXbh̃LbV擾(͍쐬)
+ * @return	LbV, NULL:LbV
+ */
+FRAME_POOL_CACHE* CFramePool::getCache()
+{
+	if (m_dwTlsIndex == TLS_OUT_OF_INDEXES) {
+		return NULL;
+	}
+	FRAME_POOL_CACHE* pstCache = (FRAME_POOL_CACHE*)TlsGetValue(m_dwTlsIndex);
+	if (pstCache != NULL) {
+		return pstCache;
+	}
+
+	// Xbh1̂
+	pstCache = new FRAME_POOL_CACHE;
+	memset(pstCache, 0, sizeof(FRAME_POOL_CACHE));
+	pstCache->dwThreadId = GetCurrentThreadId();
+	FRAME_POOL_CACHE* pstHead;
+	do {
+		pstHead = m_pstCaches;
+		pstCache->pstNext = pstHead;
+	} while (InterlockedCompareExchangePointer((PVOID volatile*)&m_pstCaches, pstCache, pstHead) != pstHead);
+	TlsSetValue(m_dwTlsIndex, pstCache);
+
+	return pstCache;
+}
+
+
+/**
+ * @fn		refill
+ * @brief	󂫃XgLbVւ܂Ƃ߂ĈڂA1Ԃ(󂫃Xg̏ꍇ̓`Nǉ)
+ * @param[in]	FRAME_POOL_CACHE* pstCache	: LbV(NULL:LbV)
+ * @param[in]	int nClass					: TCYNX
+ * @return	t[obt@, NULL:s
+ */
+FRAME_BUF* CFramePool::refill(FRAME_POOL_CACHE* pstCache, int nClass)
+{
+	for (;;) {
+		FRAME_BUF* pstBuf = (FRAME_BUF*)InterlockedPopEntrySList(&m_astFree[nClass]);
+		if (pstBuf != NULL) {
+			if (pstCache != NULL) {
+				for (int i = 1; i < FRAME_POOL_BATCH; i++) {
+					FRAME_BUF* pstMore = (FRAME_BUF*)InterlockedPopEntrySList(&m_astFree[nClass]);
+					if (pstMore == NULL) {
+						break;
+					}
+					pstCache->apBuf[nClass][pstCache->anCount[nClass]++] = pstMore;
+				}
+			}
+			return pstBuf;
+		}
+		if (grow(nClass) < 0) {
+			return NULL;
+		}
+	}
+}
+
+
+/**
+ * @fn		spill
+ * @brief	LbṼobt@󂫃Xgɖ߂
+ * @param[in]	FRAME_POOL_CACHE* pstCache	: LbV
+ * @param[in]	int nClass					: TCYNX
+ * @param[in]	int nCount					: ߂
+ */
+void CFramePool::spill(FRAME_POOL_CACHE* pstCache, int nClass, int nCount)
+{
+	while (0 < nCount-- && 0 < pstCache->anCount[nClass]) {
+		FRAME_BUF* pstBuf = pstCache->apBuf[nClass][--pstCache->anCount[nClass]];
+		InterlockedPushEntrySList(&m_astFree[nClass], &pstBuf->stEntry);
+	}
+}
+
+
+/**
+ * @fn		grow
+ * @brief	`N1mۂAobt@󂫃Xgɒǉ
+ * @param[in]	int nClass		: TCYNX
+ * @return	0:, -1:s
+ */
+int CFramePool::grow(int nClass)
+{
+	int nStride = (int)sizeof(FRAME_BUF) + ClassToSize(nClass);
+	int nBlocks = (int)(FRAME_POOL_CHUNK_SIZE - sizeof(FRAME_POOL_CHUNK)) / nStride;
+	if (nBlocks < 4) {
+		nBlocks = 4;		// 傫TCYNX`NɍŒ4
+	}
+	size_t nSize = sizeof(FRAME_POOL_CHUNK) + (size_t)nBlocks * nStride;
+
+	FRAME_POOL_CHUNK* pstChunk = (FRAME_POOL_CHUNK*)_aligned_malloc(nSize, CACHE_LINE_SIZE);
+	if (pstChunk == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	pstChunk->nClass = nClass;
+	pstChunk->nBlocks = nBlocks;
+	pstChunk->nStride = nStride;
+
+	unsigned char* pbyBlock = (unsigned char*)(pstChunk + 1);
+	for (int i = 0; i < nBlocks; i++, pbyBlock += nStride) {
+		FRAME_BUF* pstBuf = (FRAME_BUF*)pbyBlock;
+		memset(pstBuf, 0, sizeof(FRAME_BUF));
+		pstBuf->pcPool = this;
+		pstBuf->nClass = nClass;
+		pstBuf->nCapacity = ClassToSize(nClass);
+	}
+
+	// `N̈ꗗ(jEDumpOutstanding p)ɒǉĂ󂫃XgɌJ
+	AcquireSRWLockExclusive(&m_srwGrow);
+	pstChunk->pstNext = m_pstChunks;
+	m_pstChunks = pstChunk;
+	ReleaseSRWLockExclusive(&m_srwGrow);
+
+	pbyBlock = (unsigned char*)(pstChunk + 1);
+	for (int i = 0; i < nBlocks; i++, pbyBlock += nStride) {
+		InterlockedPushEntrySList(&m_astFree[nClass], &((FRAME_BUF*)pbyBlock)->stEntry);
+	}
+	InterlockedIncrement(&m_lChunks);
+	InterlockedExchangeAdd(&m_alBlocks[nClass], nBlocks);
+
+	return 0;
+}
@@ -14,6 +14,9 @@
 #pragma comment(lib, "shlwapi.lib")
 
 #define		INI_KEY_BUFF_SIZE		(64)
+#define		INI_CACHE_MAX_SIZE		(16 * 1024 * 1024)		// LbVΏۂƂINIt@C̍őTCY[byte]
+#define		INI_CACHE_HASH_MIN		(64)					// LbṼnbVoPbg̍ŏl
+#define		INI_UPDATE_POOL_SIZE	(16 * 1024)				// ꊇXV̈̃̕ubNTCY[byte]
 
 /**
  * @class	CPathInfo
@@ -78,6 +81,53 @@ public:
 };
 
 
+/**
+ * @struct	INI_CACHE_ENTRY
+ * @brief	INILbV̗vf(L[A܂lpszKey=NULL̃ZNV)
+ */
+typedef struct {
+	LPCTSTR	lpszSection;		//!< ZNV(ZNṼL[͓|C^L)
+	LPCTSTR	lpszKey;			//!< L[(NULL:ZNVvf)
+	LPCTSTR	lpszValue;			//!< l
+	DWORD	dwHash;				//!< ZNV+L[̃nbVl
+	INT		nNext;				//!< oPbg̗̎vf(-1:I[)
+} INI_CACHE_ENTRY;
+
+
+/**
+ * @class	CIniUpdate
+ * @brief	INIt@CꊇXV̕ύXeێNX
+ * @remarks	ZNV+L[̃nbV\ŕύXێB
+ *			̓ubNPʂŊmۂ̈֕AClear()ł܂Ƃ߂ĉB
+ */
+class CIniUpdate
+{
+private:
+	INI_CACHE_ENTRY*	m_pEntry;			//! ύXvf\
+	INT		m_nEntry;						//! ύXvf
+	INT		m_nMax;							//! ύXvf\̊mې
+	INT*	m_pnBucket;						//! nbVoPbg
+	DWORD	m_dwBucketMask;					//! nbVoPbg-1
+	LPBYTE	m_pPool;						//! ̈(擪ubNAubN擪ɎubNւ̃|C^)
+	SIZE_T	m_nPoolUsed;					//! 擪ubN̎gpTCY[byte]
+	SIZE_T	m_nPoolSize;					//! 擪ubÑTCY[byte]
+
+public:
+	CIniUpdate();
+	~CIniUpdate();
+
+	BOOL	Set(LPCTSTR lpszSection, LPCTSTR lpszKey, LPCTSTR lpszValue);
+	INT		Find(LPCTSTR lpszSection, LPCTSTR lpszKey);
+	const INI_CACHE_ENTRY*	GetAt(INT nIndex);
+	INT		GetCount();
+	void	Clear();
+
+private:
+	LPCTSTR	copyString(LPCTSTR lpszStr);
+	void	grow();
+};
+
+
 /**
  * @class	CIniFile
  * @brief	INIt@CANZXNX
@@ -88,6 +138,23 @@ private:
 	TCHAR	m_szFile[MAX_PATH + 1];			//! INIt@CpX
 	BOOL	m_bInit;						//! ς݃tO
 
+	BOOL	m_bCache;						//! LbVgptO
+	BOOL	m_bCacheValid;					//! LbVeLtO
+	DWORD	m_dwCheckInterval;				//! t@CXVmFԊu[ms](0:ǂݍݖɊmF)
+	ULONGLONG	m_ullLastCheck;				//! ŏIXVmF[ms]
+	FILETIME	m_ftCacheWrite;				//! LbVt@C̍ŏIXV
+	ULONGLONG	m_ullCacheSize;				//! LbVt@C̃TCY
+	LPBYTE	m_pArena;						//! LbV̈(vf\AoPbgAꊇm)
+	INI_CACHE_ENTRY*	m_pEntry;			//! LbVvf\
+	INT		m_nEntry;						//! LbVvf
+	INT*	m_pnBucket;						//! nbVoPbg(vf\̃CfbNX)
+	DWORD	m_dwBucketMask;					//! nbVoPbg-1
+
+	BOOL	m_bUpdate;						//! ꊇXVtO
+	CIniUpdate	m_cUpdate;					//! ꊇXV̕ύXe
+
+	friend class CIniUpdate;
+
 public:
 	CIniFile(LPCTSTR lpszPath, BOOL bCreate = TRUE);
 	~CIniFile();
@@ -104,6 +171,28 @@ public:
 	BOOL	WriteInt(LPCTSTR lpszSection, LPCTSTR lpszKey, LONG nVal);
 	BOOL	WriteHex(LPCTSTR lpszSection, LPCTSTR lpszKey, UINT uiVal);
 	BOOL	WriteDouble(LPCTSTR lpszSection, LPCTSTR lpszKey, DOUBLE dVal);
+
+	BOOL	EnableCache(BOOL bEnable, DWORD dwCheckInterval = 0);
+	void	InvalidateCache();
+
+	BOOL	BeginUpdate();
+	BOOL	Commit();
+	void	Rollback();
+	BOOL	IsUpdating();
+
+private:
+	BOOL	checkCache();
+	BOOL	loadCache();
+	BOOL	readFile(WIN32_FILE_ATTRIBUTE_DATA* pstAttr, LPBYTE* ppRaw, DWORD* pdwRaw);
+	static INT	convertText(const BYTE* pRaw, DWORD dwRaw, LPTSTR lpszText, INT nChars, BOOL* pbWide);
+	void	freeCache();
+	const INI_CACHE_ENTRY*	findCache(LPCTSTR lpszSection, LPCTSTR lpszKey);
+	static DWORD	hashString(LPCTSTR lpszStr, DWORD dwHash);
+	static BOOL		equalString(LPCTSTR lpszStr1, LPCTSTR lpszStr2);
+	static LPTSTR	trimString(LPTSTR lpszStr);
+	static INT		appendString(LPTSTR lpszDst, INT nPos, LPCTSTR lpszSrc, INT nLen);
+	INT		appendSection(LPTSTR lpszDst, INT nPos, LPCTSTR lpszSection, LPBYTE pbDone);
+	BOOL	writeFile(LPCTSTR lpszText, INT nChars, BOOL bWide, BOOL bExist);
 };
 
 
@@ -114,7 +203,20 @@ public:
  */
 CIniFile::CIniFile(LPCTSTR lpszPath, BOOL bCreate/*=TRUE*/) :
 	m_bInit(FALSE)
+	, m_bCache(FALSE)
+	, m_bCacheValid(FALSE)
+	, m_dwCheckInterval(0)
+	, m_ullLastCheck(0)
+	, m_ullCacheSize(0)
+	, m_pArena(NULL)
+	, m_pEntry(NULL)
+	, m_nEntry(0)
+	, m_pnBucket(NULL)
+	, m_dwBucketMask(0)
+	, m_bUpdate(FALSE)
 {
+	memset(&m_ftCacheWrite, 0, sizeof(m_ftCacheWrite));
+
 	// pXw ȉ̌`l
 	// ΁@CIniFile cIni0(_T("C:\\My Documents\\Program\\Config\\IniFile.ini"));
 	// ΁@CIniFile cIni1(_T("Config\\IniFile.ini"));
@@ -130,6 +232,8 @@ CIniFile::CIniFile(LPCTSTR lpszPath, BOOL bCreate/*=TRUE*/) :
  */
 CIniFile::~CIniFile()
 {
+	// Commit()ĂȂꊇXV͔j
+	freeCache();
 }
 
 
@@ -186,6 +290,8 @@ BOOL CIniFile::SetPath(LPCTSTR lpszPath, BOOL bCreate/*=TRUE*/)
 	memset(m_szFile, 0, sizeof(m_szFile));
 	_tcsncpy(m_szFile, lpszWork, MAX_PATH);
 	m_bInit = TRUE;
+	freeCache();
+	Rollback();
 
 	return TRUE;
 }
@@ -231,6 +337,40 @@ DWORD CIniFile::ReadString(LPCTSTR lpszSection, LPCTSTR lpszKey, LPCTSTR lpszDef
 		return 0;
 	}
 
+	if (m_bUpdate) {
+		// ꊇXV͖f̕ύXD悷
+		INT nIndex = m_cUpdate.Find(lpszSection, lpszKey);
+		if (nIndex >= 0) {
+			LPCTSTR lpszSrc = m_cUpdate.GetAt(nIndex)->lpszValue;
+			if (dwSize == 0) {
+				return 0;
+			}
+			DWORD dwCount = 0;
+			while (lpszSrc[dwCount] != '\0' && dwCount < dwSize - 1) {
+				lpszStr[dwCount] = lpszSrc[dwCount];
+				dwCount++;
+			}
+			lpszStr[dwCount] = '\0';
+			return dwCount;
+		}
+	}
+
+	if (m_bCache && checkCache()) {
+		// LbVǂݍ(GetPrivateProfileString Ɠlɐ؂l߂ďI[)
+		if (dwSize == 0) {
+			return 0;
+		}
+		const INI_CACHE_ENTRY* pEntry = findCache(lpszSection, lpszKey);
+		LPCTSTR lpszSrc = (pEntry != NULL) ? pEntry->lpszValue : lpszDefault;
+		DWORD dwCount = 0;
+		while (lpszSrc[dwCount] != '\0' && dwCount < dwSize - 1) {
+			lpszStr[dwCount] = lpszSrc[dwCount];
+			dwCount++;
+		}
+		lpszStr[dwCount] = '\0';
+		return dwCount;
+	}
+
 	DWORD dwCount = ::GetPrivateProfileString(lpszSection, lpszKey, lpszDefault, lpszStr, dwSize, m_szFile);
 
 	return dwCount;
@@ -371,6 +511,11 @@ BOOL CIniFile::WriteString(LPCTSTR lpszSection, LPCTSTR lpszKey, LPCTSTR lpszStr
 		return FALSE;
 	}
 
+	if (m_bUpdate) {
+		return m_cUpdate.Set(lpszSection, lpszKey, lpszStr);		// Commit()ł܂Ƃ߂ď
+	}
+
+	m_bCacheValid = FALSE;		// ݌͎̓ǂݍ݂ōĉ͂
 	if (::WritePrivateProfileString(lpszSection, lpszKey, lpszStr, m_szFile) == 0) {
 		return FALSE;
 	}
@@ -443,6 +588,973 @@ BOOL CIniFile::WriteDouble(LPCTSTR lpszSection, LPCTSTR lpszKey, DOUBLE dVal)
 	return WriteString(lpszSection, lpszKey, szBuff);
 }
 
+
+/**
+ * @fn		EnableCache
+ * @brief	ǂݍ݃LbV̎gpݒ肷
+ * @param	[in]	BOOL bEnable			: TRUE:gp, FALSE:gpȂ
+ * @param	[in]	DWORD dwCheckInterval	: t@CXVmFԊu[ms](0:ǂݍݖɊmF)
+ * @return	TRUE:, FALSE:s
+ * @remarks	Lɂƃt@Cx͂ăZNV/L[̃nbV\쐬A
+ *			Readn֐̓̕\lԂB
+ *			t@C̍ŏIXVƃTCYmFAωĂ΍ĉ͂B
+ *			L[̑啶̓ꎋASCII͈͂̂݁B
+ */
+BOOL CIniFile::EnableCache(BOOL bEnable, DWORD dwCheckInterval/*=0*/)
+{
+	if (!m_bInit) {
+		return FALSE;
+	}
+
+	freeCache();
+	m_bCache = bEnable;
+	m_dwCheckInterval = dwCheckInterval;
+
+	return TRUE;
+}
+
+
+/**
+ * @fn		InvalidateCache
+ * @brief	LbV𖳌A̓ǂݍ݂ōĉ͂
+ */
+void CIniFile::InvalidateCache()
+{
+	m_bCacheValid = FALSE;
+}
+
+
+/**
+ * @fn		checkCache
+ * @brief	LbVgp\mFAKvł΍ĉ͂
+ * @return	TRUE:LbVgp, FALSE:gps(APIœǂݍ)
+ */
+BOOL CIniFile::checkCache()
+{
+	ULONGLONG ullNow = ::GetTickCount64();
+
+	if (m_bCacheValid && m_dwCheckInterval > 0 && ullNow - m_ullLastCheck < m_dwCheckInterval) {
+		return TRUE;		// mFԊu
+	}
+	m_ullLastCheck = ullNow;
+
+	if (m_bCacheValid) {
+		WIN32_FILE_ATTRIBUTE_DATA stAttr;
+		if (!::GetFileAttributesEx(m_szFile, GetFileExInfoStandard, &stAttr)) {
+			m_bCacheValid = FALSE;		// t@C폜
+			return FALSE;
+		}
+		ULONGLONG ullSize = ((ULONGLONG)stAttr.nFileSizeHigh << 32) | stAttr.nFileSizeLow;
+		if (ullSize == m_ullCacheSize
+			&& stAttr.ftLastWriteTime.dwLowDateTime == m_ftCacheWrite.dwLowDateTime
+			&& stAttr.ftLastWriteTime.dwHighDateTime == m_ftCacheWrite.dwHighDateTime) {
+			return TRUE;
+		}
+	}
+
+	return loadCache();
+}
+
+
+/**
+ * @fn		loadCache
+ * @brief	INIt@Cǂݍ݁ALbV쐬
+ * @return	TRUE:, FALSE:s
+ * @remarks	vf\AnbVoPbgA1̊mۂœ̈ɔzuB
+ *			͓ǂݍ񂾃eLXg̏ŏI[ĎQƂB
+ */
+BOOL CIniFile::loadCache()
+{
+	freeCache();
+
+	// ǂݍݑO̍XVL^(ǂݍݒɍXVꂽꍇ͎̊mFŌo)
+	WIN32_FILE_ATTRIBUTE_DATA stAttr;
+	LPBYTE pRaw = NULL;
+	DWORD dwRaw = 0;
+	if (!readFile(&stAttr, &pRaw, &dwRaw)) {
+		return FALSE;
+	}
+	ULONGLONG ullSize = ((ULONGLONG)stAttr.nFileSizeHigh << 32) | stAttr.nFileSizeLow;
+
+	BOOL bWide = FALSE;
+	INT nChars = convertText(pRaw, dwRaw, NULL, 0, &bWide);
+	INT nLines = 1;
+	if (bWide) {
+		LPCWSTR lpszRawW = (LPCWSTR)(pRaw + 2);
+		for (DWORD i = 0; i < (dwRaw - 2) / sizeof(WCHAR); i++) {
+			if (lpszRawW[i] == L'\n' || lpszRawW[i] == L'\r') {
+				nLines++;
+			}
+		}
+	}
+	else {
+		for (DWORD i = 0; i < dwRaw; i++) {
+			if (pRaw[i] == '\n' || pRaw[i] == '\r') {
+				nLines++;
+			}
+		}
+	}
+
+	// 1sɂő1vf(L[܂̓ZNV)
+	DWORD dwBuckets = INI_CACHE_HASH_MIN;
+	while (dwBuckets < (DWORD)nLines) {
+		dwBuckets <<= 1;
+	}
+	SIZE_T nEntryBytes = sizeof(INI_CACHE_ENTRY) * nLines;
+	SIZE_T nBucketBytes = sizeof(INT) * dwBuckets;
+	SIZE_T nTextBytes = sizeof(TCHAR) * (nChars + 1);
+	m_pArena = new BYTE[nEntryBytes + nBucketBytes + nTextBytes];
+	m_pEntry = (INI_CACHE_ENTRY*)m_pArena;
+	m_pnBucket = (INT*)(m_pArena + nEntryBytes);
+	LPTSTR lpszText = (LPTSTR)(m_pArena + nEntryBytes + nBucketBytes);
+	m_dwBucketMask = dwBuckets - 1;
+	m_nEntry = 0;
+	memset(m_pnBucket, 0xFF, nBucketBytes);		// -1ŏ
+
+	convertText(pRaw, dwRaw, lpszText, nChars, &bWide);
+	lpszText[nChars] = '\0';
+	delete[] pRaw;
+
+	// sPʂŉ͂
+	LPTSTR p = lpszText;
+	LPCTSTR lpszSection = NULL;
+	DWORD dwSectHash = 0;
+	while (*p != '\0') {
+		LPTSTR lpszLine = p;
+		while (*p != '\0' && *p != '\n' && *p != '\r') {
+			p++;
+		}
+		if (*p != '\0') {
+			*p++ = '\0';
+		}
+
+		lpszLine = trimString(lpszLine);
+		if (*lpszLine == '\0' || *lpszLine == ';') {
+			continue;		// sARg
+		}
+
+		if (*lpszLine == '[') {
+			LPTSTR lpszName = lpszLine + 1;
+			LPTSTR lpszEnd = _tcschr(lpszName, ']');
+			if (lpszEnd != NULL) {
+				*lpszEnd = '\0';
+			}
+			lpszName = trimString(lpszName);
+			dwSectHash = hashString(lpszName, 2166136261UL);
+			if (findCache(lpszName, NULL) != NULL) {
+				lpszSection = NULL;		// dZNVFAPIƓlɍŏ̃ZNV̂ݎQƂ
+				continue;
+			}
+			lpszSection = lpszName;
+			INI_CACHE_ENTRY* pEntry = &m_pEntry[m_nEntry];
+			pEntry->lpszSection = lpszSection;
+			pEntry->lpszKey = NULL;
+			pEntry->lpszValue = NULL;
+			pEntry->dwHash = dwSectHash;
+			pEntry->nNext = m_pnBucket[dwSectHash & m_dwBucketMask];
+			m_pnBucket[dwSectHash & m_dwBucketMask] = m_nEntry++;
+			continue;
+		}
+
+		if (lpszSection == NULL) {
+			continue;		// ZNVO̍s
+		}
+		LPTSTR lpszEq = _tcschr(lpszLine, '=');
+		if (lpszEq == NULL) {
+			continue;
+		}
+		*lpszEq = '\0';
+		LPTSTR lpszKey = trimString(lpszLine);
+		LPTSTR lpszValue = trimString(lpszEq + 1);
+		size_t nLen = _tcslen(lpszValue);
+		if (nLen >= 2 && (lpszValue[0] == '"' || lpszValue[0] == '\'') && lpszValue[nLen - 1] == lpszValue[0]) {
+			lpszValue[nLen - 1] = '\0';		// ݈͂p
+			lpszValue++;
+		}
+		if (findCache(lpszSection, lpszKey) != NULL) {
+			continue;		// dL[Fŏ̒lD悷
+		}
+
+		INI_CACHE_ENTRY* pEntry = &m_pEntry[m_nEntry];
+		pEntry->lpszSection = lpszSection;
+		pEntry->lpszKey = lpszKey;
+		pEntry->lpszValue = lpszValue;
+		pEntry->dwHash = hashString(lpszKey, dwSectHash ^ '[');
+		pEntry->nNext = m_pnBucket[pEntry->dwHash & m_dwBucketMask];
+		m_pnBucket[pEntry->dwHash & m_dwBucketMask] = m_nEntry++;
+	}
+
+	m_ftCacheWrite = stAttr.ftLastWriteTime;
+	m_ullCacheSize = ullSize;
+	m_bCacheValid = TRUE;
+
+	return TRUE;
+}
+
+
+/**
+ * @fn		readFile
+ * @brief	INIt@CŜǂݍ
+ * @param	[out]	WIN32_FILE_ATTRIBUTE_DATA* pstAttr	: ǂݍݑÕt@C
+ * @param	[out]	LPBYTE* ppRaw		: ǂݍ񂾃f[^(Ăяo delete[] )
+ * @param	[out]	DWORD* pdwRaw		: ǂݍ񂾃TCY[byte]
+ * @return	TRUE:, FALSE:s(t@CȂATCY߁Aǂݍݓr̃G[Et@CkȂ)
+ * @remarks	t@C̃TCYSēǂݍ߂Ȃꍇ́Ar܂ł̃f[^ԂɎsƂB
+ */
+BOOL CIniFile::readFile(WIN32_FILE_ATTRIBUTE_DATA* pstAttr, LPBYTE* ppRaw, DWORD* pdwRaw)
+{
+	if (!::GetFileAttributesEx(m_szFile, GetFileExInfoStandard, pstAttr)) {
+		return FALSE;
+	}
+	if (pstAttr->nFileSizeHigh != 0 || pstAttr->nFileSizeLow > INI_CACHE_MAX_SIZE) {
+		return FALSE;
+	}
+
+	HANDLE hFile = ::CreateFile(m_szFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	DWORD dwRaw = pstAttr->nFileSizeLow;
+	LPBYTE pRaw = new BYTE[dwRaw + sizeof(WCHAR)];
+	DWORD dwRead = 0;
+	while (dwRead < dwRaw) {
+		DWORD dwDone = 0;
+		if (!::ReadFile(hFile, pRaw + dwRead, dwRaw - dwRead, &dwDone, NULL) || dwDone == 0) {
+			break;
+		}
+		dwRead += dwDone;
+	}
+	::CloseHandle(hFile);
+	if (dwRead != dwRaw) {
+		delete[] pRaw;
+		return FALSE;
+	}
+
+	*ppRaw = pRaw;
+	*pdwRaw = dwRead;
+
+	return TRUE;
+}
+
+
+/**
+ * @fn		convertText
+ * @brief	t@Cf[^TCHAR֕ϊ
+ * @param	[in]	const BYTE* pRaw	: t@Cf[^
+ * @param	[in]	DWORD dwRaw			: t@Cf[^TCY[byte]
+ * @param	[out]	LPTSTR lpszText		: ϊ(NULL:Kvȕ̂݋߂)
+ * @param	[in]	INT nChars			: ϊ̕
+ * @param	[out]	BOOL* pbWide		: TRUE:UTF-16LE(BOMt), FALSE:ANSI
+ * @return	ϊ̕(I[܂܂Ȃ)
+ */
+INT CIniFile::convertText(const BYTE* pRaw, DWORD dwRaw, LPTSTR lpszText, INT nChars, BOOL* pbWide)
+{
+	BOOL bWide = (dwRaw >= 2 && pRaw[0] == 0xFF && pRaw[1] == 0xFE);
+	*pbWide = bWide;
+
+	if (bWide) {
+		LPCWSTR lpszRawW = (LPCWSTR)(pRaw + 2);
+		INT nRawW = (INT)((dwRaw - 2) / sizeof(WCHAR));
+#ifdef UNICODE
+		if (lpszText != NULL) {
+			memcpy(lpszText, lpszRawW, sizeof(WCHAR) * nChars);
+		}
+		return nRawW;
+#else
+		if (nRawW <= 0) {
+			return 0;
+		}
+		return ::WideCharToMultiByte(CP_ACP, 0, lpszRawW, nRawW, lpszText, (lpszText != NULL) ? nChars : 0, NULL, NULL);
+#endif
+	}
+
+#ifdef UNICODE
+	if (dwRaw == 0) {
+		return 0;
+	}
+	return ::MultiByteToWideChar(CP_ACP, 0, (LPCSTR)pRaw, (INT)dwRaw, lpszText, (lpszText != NULL) ? nChars : 0);
+#else
+	if (lpszText != NULL) {
+		memcpy(lpszText, pRaw, nChars);
+	}
+	return (INT)dwRaw;
+#endif
+}
+
+
+/**
+ * @fn		freeCache
+ * @brief	LbV̈
+ */
+void CIniFile::freeCache()
+{
+	if (m_pArena != NULL) {
+		delete[] m_pArena;
+	}
+	m_pArena = NULL;
+	m_pEntry = NULL;
+	m_pnBucket = NULL;
+	m_nEntry = 0;
+	m_dwBucketMask = 0;
+	m_bCacheValid = FALSE;
+}
+
+
+/**
+ * @fn		findCache
+ * @brief	LbVL[(܂̓ZNV)
+ * @param	[in]	LPCTSTR lpszSection		: ZNV
+ * @param	[in]	LPCTSTR lpszKey			: L[(NULL:ZNV)
+ * @return	vfւ̃|C^(NULL:YȂ)
+ */
+const INI_CACHE_ENTRY* CIniFile::findCache(LPCTSTR lpszSection, LPCTSTR lpszKey)
+{
+	if (m_pnBucket == NULL) {
+		return NULL;
+	}
+
+	DWORD dwHash = hashString(lpszSection, 2166136261UL);
+	if (lpszKey != NULL) {
+		dwHash = hashString(lpszKey, dwHash ^ '[');
+	}
+
+	for (INT i = m_pnBucket[dwHash & m_dwBucketMask]; i >= 0; i = m_pEntry[i].nNext) {
+		const INI_CACHE_ENTRY* pEntry = &m_pEntry[i];
+		if (pEntry->dwHash != dwHash) {
+			continue;
+		}
+		if (lpszKey == NULL) {
+			if (pEntry->lpszKey == NULL && equalString(pEntry->lpszSection, lpszSection)) {
+				return pEntry;
+			}
+		}
+		else if (pEntry->lpszKey != NULL && equalString(pEntry->lpszKey, lpszKey) && equalString(pEntry->lpszSection, lpszSection)) {
+			return pEntry;
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @fn		hashString
+ * @brief	̃nbVl߂(FNV-1aAASCII啶𓯈ꎋ)
+ * @param	[in]	LPCTSTR lpszStr		: 
+ * @param	[in]	DWORD dwHash		: l
+ * @return	nbVl
+ */
+DWORD CIniFile::hashString(LPCTSTR lpszStr, DWORD dwHash)
+{
+	for (; *lpszStr != '\0'; lpszStr++) {
+		DWORD dwChar = (DWORD)(_TUCHAR)*lpszStr;
+		if (dwChar >= 'A' && dwChar <= 'Z') {
+			dwChar += 'a' - 'A';
+		}
+		dwHash = (dwHash ^ dwChar) * 16777619UL;
+	}
+	return dwHash;
+}
+
+
+/**
+ * @fn		equalString
+ * @brief	r(ASCII啶𓯈ꎋ)
+ * @param	[in]	LPCTSTR lpszStr1	: 1
+ * @param	[in]	LPCTSTR lpszStr2	: 2
+ * @return	TRUE:v, FALSE:sv
+ */
+BOOL CIniFile::equalString(LPCTSTR lpszStr1, LPCTSTR lpszStr2)
+{
+	for (;; lpszStr1++, lpszStr2++) {
+		DWORD dwChar1 = (DWORD)(_TUCHAR)*lpszStr1;
+		DWORD dwChar2 = (DWORD)(_TUCHAR)*lpszStr2;
+		if (dwChar1 >= 'A' && dwChar1 <= 'Z') {
+			dwChar1 += 'a' - 'A';
+		}
+		if (dwChar2 >= 'A' && dwChar2 <= 'Z') {
+			dwChar2 += 'a' - 'A';
+		}
+		if (dwChar1 != dwChar2) {
+			return FALSE;
+		}
+		if (dwChar1 == '\0') {
+			return TRUE;
+		}
+	}
+}
+
+
+/**
+ * @fn		trimString
+ * @brief	Ő󔒂(͂̏ŏI[)
+ * @param	[in]	LPTSTR lpszStr		: 
+ * @return	擪̋󔒂
+ */
+LPTSTR CIniFile::trimString(LPTSTR lpszStr)
+{
+	while (*lpszStr == ' ' || *lpszStr == '\t') {
+		lpszStr++;
+	}
+	size_t nLen = _tcslen(lpszStr);
+	while (nLen > 0 && (lpszStr[nLen - 1] == ' ' || lpszStr[nLen - 1] == '\t')) {
+		lpszStr[--nLen] = '\0';
+	}
+	return lpszStr;
+}
+
+
+/**
+ * @fn		BeginUpdate
+ * @brief	ꊇXVJn
+ * @return	TRUE:, FALSE:s(AꊇXV)
+ * @remarks	Commit()܂ł Writen֐̓e̓ɕێAt@Cւ͏܂ȂB
+ *			ꊇXV Readn֐͕ێĂύXeD悵ĕԂB
+ */
+BOOL CIniFile::BeginUpdate()
+{
+	if (!m_bInit || m_bUpdate) {
+		return FALSE;
+	}
+
+	m_cUpdate.Clear();
+	m_bUpdate = TRUE;
+
+	return TRUE;
+}
+
+
+/**
+ * @fn		Commit
+ * @brief	ꊇXV̓eINIt@C֏݁AꊇXVI
+ * @return	TRUE:, FALSE:s(݂̎sł͈ꊇXV͌pAēxCommit()܂Rollback()\B
+ *			̃t@Cǂݍ߂Ȃꍇ́AύX𔽉fłȂ߈ꊇXVj(Rollback))
+ * @remarks	݂̃t@Ce֕ύX𔽉feLXgꎞt@C֏݁A
+ *			ReplaceFile ŒuBݒɒfẴt@C͉ȂB
+ *			L[͂̍suAVKL[̓ZNV̍Ō̃L[̌ցA
+ *			VKZNV̓t@C֒ǉB
+ */
+BOOL CIniFile::Commit()
+{
+	if (!m_bInit || !m_bUpdate) {
+		return FALSE;
+	}
+	INT nUpdate = m_cUpdate.GetCount();
+	if (nUpdate == 0) {
+		m_bUpdate = FALSE;
+		return TRUE;
+	}
+
+	// ݂̃t@Ceǂݍ(t@CȂ͐VK쐬)
+	WIN32_FILE_ATTRIBUTE_DATA stAttr;
+	LPBYTE pRaw = NULL;
+	DWORD dwRaw = 0;
+	BOOL bExist = readFile(&stAttr, &pRaw, &dwRaw);
+	if (!bExist && ::PathFileExists(m_szFile)) {
+		// ǂݍݕs(r܂ł̓eɕύX𔽉fƎc肪邽߁AꊇXVj)
+		Rollback();
+		return FALSE;
+	}
+	BOOL bWide = FALSE;
+	INT nChars = bExist ? convertText(pRaw, dwRaw, NULL, 0, &bWide) : 0;
+	LPTSTR lpszText = new TCHAR[nChars + 1];
+	if (bExist) {
+		convertText(pRaw, dwRaw, lpszText, nChars, &bWide);
+		delete[] pRaw;
+	}
+	lpszText[nChars] = '\0';
+
+	// o̓TCY̏F̃eLXg{SύX "[ZNV]\r\nL[=l\r\n" Œǉꍇ
+	INT nMax = nChars + 4;
+	for (INT i = 0; i < nUpdate; i++) {
+		const INI_CACHE_ENTRY* pEntry = m_cUpdate.GetAt(i);
+		nMax += (INT)(_tcslen(pEntry->lpszSection) + _tcslen(pEntry->lpszKey) + _tcslen(pEntry->lpszValue)) + 9;
+	}
+	LPTSTR lpszOut = new TCHAR[nMax];
+	LPBYTE pbDone = new BYTE[nUpdate];
+	memset(pbDone, 0, nUpdate);
+	INT nOut = 0;
+
+	// ͕͂eLXgōsPʂɏI[čsAo͂͌̃eLXgs
+	LPTSTR lpszWorkText = new TCHAR[nChars + 1];
+	memcpy(lpszWorkText, lpszText, sizeof(TCHAR) * (nChars + 1));
+	LPCTSTR p = lpszText;
+	LPCTSTR lpszHold = NULL;		// ZNVŕۗ̋s/Rgs̐擪
+	LPCTSTR lpszSection = NULL;		// ݂̃ZNV(NULL:ZNVO)
+
+	while (*p != '\0') {
+		// 1s(s܂)؂o
+		LPCTSTR lpszLine = p;
+		while (*p != '\0' && *p != '\n' && *p != '\r') {
+			p++;
+		}
+		INT nBody = (INT)(p - lpszLine);
+		if (*p == '\r' && *(p + 1) == '\n') {
+			p += 2;
+		}
+		else if (*p != '\0') {
+			p++;
+		}
+		INT nLine = (INT)(p - lpszLine);
+
+		LPTSTR lpszWork = lpszWorkText + (lpszLine - lpszText);
+		lpszWork[nBody] = '\0';
+		lpszWork = trimString(lpszWork);
+
+		if (*lpszWork == '[') {
+			// ZNVIFf̃L[ǉĂۗsƃZNVso͂
+			if (lpszSection != NULL) {
+				nOut = appendSection(lpszOut, nOut, lpszSection, pbDone);
+			}
+			if (lpszHold != NULL) {
+				nOut = appendString(lpszOut, nOut, lpszHold, (INT)(lpszLine - lpszHold));
+				lpszHold = NULL;
+			}
+			nOut = appendString(lpszOut, nOut, lpszLine, nLine);
+
+			LPTSTR lpszEnd = _tcschr(lpszWork + 1, ']');
+			if (lpszEnd != NULL) {
+				*lpszEnd = '\0';
+			}
+			lpszSection = trimString(lpszWork + 1);
+			continue;
+		}
+
+		LPTSTR lpszEq = (*lpszWork != ';') ? _tcschr(lpszWork, '=') : NULL;
+		if (lpszSection == NULL || lpszEq == NULL) {
+			// s/RgsȂǁFZNVȂ疖̃L[ǉʒu߂邽ߕۗ
+			if (lpszSection != NULL) {
+				if (lpszHold == NULL) {
+					lpszHold = lpszLine;
+				}
+			}
+			else {
+				nOut = appendString(lpszOut, nOut, lpszLine, nLine);
+			}
+			continue;
+		}
+
+		// L[s
+		if (lpszHold != NULL) {
+			nOut = appendString(lpszOut, nOut, lpszHold, (INT)(lpszLine - lpszHold));
+			lpszHold = NULL;
+		}
+		*lpszEq = '\0';
+		LPTSTR lpszKey = trimString(lpszWork);
+		INT nIndex = m_cUpdate.Find(lpszSection, lpszKey);
+		if (nIndex < 0 || pbDone[nIndex]) {
+			nOut = appendString(lpszOut, nOut, lpszLine, nLine);
+			continue;
+		}
+		// L[̒lu(̉sR[hێ)
+		nOut = appendString(lpszOut, nOut, lpszKey, (INT)_tcslen(lpszKey));
+		nOut = appendString(lpszOut, nOut, _T("="), 1);
+		nOut = appendString(lpszOut, nOut, m_cUpdate.GetAt(nIndex)->lpszValue, -1);
+		nOut = appendString(lpszOut, nOut, lpszLine + nBody, nLine - nBody);
+		pbDone[nIndex] = TRUE;
+	}
+
+	if (nOut > 0 && lpszOut[nOut - 1] != '\n' && lpszOut[nOut - 1] != '\r') {
+		nOut = appendString(lpszOut, nOut, _T("\r\n"), 2);		// ŏIsɉsȂ
+	}
+	if (lpszSection != NULL) {
+		nOut = appendSection(lpszOut, nOut, lpszSection, pbDone);
+	}
+	if (lpszHold != NULL) {
+		nOut = appendString(lpszOut, nOut, lpszHold, (INT)_tcslen(lpszHold));
+		if (nOut > 0 && lpszOut[nOut - 1] != '\n' && lpszOut[nOut - 1] != '\r') {
+			nOut = appendString(lpszOut, nOut, _T("\r\n"), 2);
+		}
+	}
+
+	// VKZNV𖖔ɒǉ
+	for (INT i = 0; i < nUpdate; i++) {
+		if (pbDone[i]) {
+			continue;
+		}
+		LPCTSTR lpszNew = m_cUpdate.GetAt(i)->lpszSection;
+		nOut = appendString(lpszOut, nOut, _T("["), 1);
+		nOut = appendString(lpszOut, nOut, lpszNew, -1);
+		nOut = appendString(lpszOut, nOut, _T("]\r\n"), 3);
+		nOut = appendSection(lpszOut, nOut, lpszNew, pbDone);
+	}
+	lpszOut[nOut] = '\0';
+
+	BOOL bRet = writeFile(lpszOut, nOut, bWide, bExist);
+
+	delete[] pbDone;
+	delete[] lpszOut;
+	delete[] lpszWorkText;
+	delete[] lpszText;
+
+	if (!bRet) {
+		return FALSE;
+	}
+
+	m_cUpdate.Clear();
+	m_bUpdate = FALSE;
+	m_bCacheValid = FALSE;
+
+	return TRUE;
+}
+
+
+/**
+ * @fn		Rollback
+ * @brief	ꊇXV̓ejAꊇXVI
+ */
+void CIniFile::Rollback()
+{
+	m_cUpdate.Clear();
+	m_bUpdate = FALSE;
+}
+
+
+/**
+ * @fn		IsUpdating
+ * @brief	ꊇXVmF
+ * @return	TRUE:ꊇXV, FALSE:ꊇXVł͂Ȃ
+ */
+BOOL CIniFile::IsUpdating()
+{
+	return m_bUpdate;
+}
+
+
+/**
+ * @fn		appendString
+ * @brief	o̓obt@֕ǉ
+ * @param	[out]	LPTSTR lpszDst		: o̓obt@
+ * @param	[in]	INT nPos			: ǉʒu
+ * @param	[in]	LPCTSTR lpszSrc		: ǉ镶
+ * @param	[in]	INT nLen			: ǉ镶(-1:I[܂)
+ * @return	ǉ̈ʒu
+ */
+INT CIniFile::appendString(LPTSTR lpszDst, INT nPos, LPCTSTR lpszSrc, INT nLen)
+{
+	if (nLen < 0) {
+		nLen = (INT)_tcslen(lpszSrc);
+	}
+	memcpy(lpszDst + nPos, lpszSrc, sizeof(TCHAR) * nLen);
+	return nPos + nLen;
+}
+
+
+/**
+ * @fn		appendSection
+ * @brief	ΏۃZNV̖f̃L[ "L[=l" ̍sƂďo̓obt@֒ǉ
+ * @param	[out]	LPTSTR lpszDst		: o̓obt@
+ * @param	[in]	INT nPos			: ǉʒu
+ * @param	[in]	LPCTSTR lpszSection	: ZNV
+ * @param	[in,out]	LPBYTE pbDone	: fς݃tO(ǉL[TRUEɂ)
+ * @return	ǉ̈ʒu
+ */
+INT CIniFile::appendSection(LPTSTR lpszDst, INT nPos, LPCTSTR lpszSection, LPBYTE pbDone)
+{
+	INT nUpdate = m_cUpdate.GetCount();
+	for (INT i = 0; i < nUpdate; i++) {
+		const INI_CACHE_ENTRY* pEntry = m_cUpdate.GetAt(i);
+		if (pbDone[i] || !equalString(pEntry->lpszSection, lpszSection)) {
+			continue;
+		}
+		nPos = appendString(lpszDst, nPos, pEntry->lpszKey, -1);
+		nPos = appendString(lpszDst, nPos, _T("="), 1);
+		nPos = appendString(lpszDst, nPos, pEntry->lpszValue, -1);
+		nPos = appendString(lpszDst, nPos, _T("\r\n"), 2);
+		pbDone[i] = TRUE;
+	}
+	return nPos;
+}
+
+
+/**
+ * @fn		writeFile
+ * @brief	eLXgꎞt@C֏݁AINIt@Cƒu
+ * @param	[in]	LPCTSTR lpszText	: eLXg
+ * @param	[in]	INT nChars			: eLXg̕
+ * @param	[in]	BOOL bWide			: TRUE:UTF-16LE(BOMt)ŕۑ, FALSE:ANSIŕۑ
+ * @param	[in]	BOOL bExist			: TRUE:t@Cu, FALSE:VK쐬
+ * @return	TRUE:, FALSE:s(̃t@C͕ύXȂ)
+ */
+BOOL CIniFile::writeFile(LPCTSTR lpszText, INT nChars, BOOL bWide, BOOL bExist)
+{
+	// t@Cf[^֕ϊ
+	LPBYTE pData = NULL;
+	DWORD dwData = 0;
+#ifdef UNICODE
+	if (bWide) {
+		dwData = 2 + sizeof(WCHAR) * nChars;
+		pData = new BYTE[dwData];
+		pData[0] = 0xFF;
+		pData[1] = 0xFE;
+		memcpy(pData + 2, lpszText, sizeof(WCHAR) * nChars);
+	}
+	else {
+		INT nBytes = (nChars > 0) ? ::WideCharToMultiByte(CP_ACP, 0, lpszText, nChars, NULL, 0, NULL, NULL) : 0;
+		dwData = (DWORD)nBytes;
+		pData = new BYTE[dwData + 1];
+		if (nBytes > 0) {
+			::WideCharToMultiByte(CP_ACP, 0, lpszText, nChars, (LPSTR)pData, nBytes, NULL, NULL);
+		}
+	}
+#else
+	if (bWide) {
+		INT nWide = (nChars > 0) ? ::MultiByteToWideChar(CP_ACP, 0, lpszText, nChars, NULL, 0) : 0;
+		dwData = 2 + sizeof(WCHAR) * nWide;
+		pData = new BYTE[dwData];
+		pData[0] = 0xFF;
+		pData[1] = 0xFE;
+		if (nWide > 0) {
+			::MultiByteToWideChar(CP_ACP, 0, lpszText, nChars, (LPWSTR)(pData + 2), nWide);
+		}
+	}
+	else {
+		dwData = (DWORD)nChars;
+		pData = new BYTE[dwData + 1];
+		memcpy(pData, lpszText, nChars);
+	}
+#endif
+
+	// tH_̈ꎞt@C֏݁AfBXN֔f
+	TCHAR szTemp[MAX_PATH + 1];
+	memset(szTemp, 0, sizeof(szTemp));
+	if (_tcslen(m_szFile) + 4 > MAX_PATH) {
+		delete[] pData;
+		return FALSE;
+	}
+	_sntprintf(szTemp, MAX_PATH, _T("%s.tmp"), m_szFile);
+
+	HANDLE hFile = ::CreateFile(szTemp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		delete[] pData;
+		return FALSE;
+	}
+	DWORD dwWritten = 0;
+	BOOL bRet = (::WriteFile(hFile, pData, dwData, &dwWritten, NULL) && dwWritten == dwData);
+	if (bRet) {
+		bRet = ::FlushFileBuffers(hFile);
+	}
+	::CloseHandle(hFile);
+	delete[] pData;
+
+	if (bRet) {
+		if (bExist) {
+			bRet = ::ReplaceFile(m_szFile, szTemp, NULL, REPLACEFILE_IGNORE_MERGE_ERRORS, NULL, NULL);
+		}
+		else {
+			bRet = ::MoveFileEx(szTemp, m_szFile, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+		}
+	}
+	if (!bRet) {
+		::DeleteFile(szTemp);
+	}
+
+	return bRet;
+}
+
+
+/**
+ * @brief	RXgN^
+ */
+CIniUpdate::CIniUpdate() :
+	m_pEntry(NULL)
+	, m_nEntry(0)
+	, m_nMax(0)
+	, m_pnBucket(NULL)
+	, m_dwBucketMask(0)
+	, m_pPool(NULL)
+	, m_nPoolUsed(0)
+	, m_nPoolSize(0)
+{
+}
+
+
+/**
+ * @brief	fXgN^
+ */
+CIniUpdate::~CIniUpdate()
+{
+	Clear();
+	if (m_pEntry != NULL) {
+		delete[] m_pEntry;
+	}
+	if (m_pnBucket != NULL) {
+		delete[] m_pnBucket;
+	}
+}
+
+
+/**
+ * @fn		Set
+ * @brief	ύXeݒ肷(L[͌̒lŏ㏑)
+ * @param	[in]	LPCTSTR lpszSection		: ZNV
+ * @param	[in]	LPCTSTR lpszKey			: L[
+ * @param	[in]	LPCTSTR lpszValue		: l
+ * @return	TRUE:, FALSE:s
+ */
+BOOL CIniUpdate::Set(LPCTSTR lpszSection, LPCTSTR lpszKey, LPCTSTR lpszValue)
+{
+	if (lpszSection == NULL || lpszKey == NULL || lpszValue == NULL) {
+		return FALSE;
+	}
+
+	INT nIndex = Find(lpszSection, lpszKey);
+	if (nIndex >= 0) {
+		m_pEntry[nIndex].lpszValue = copyString(lpszValue);
+		return TRUE;
+	}
+
+	if (m_nEntry >= m_nMax) {
+		grow();
+	}
+	INI_CACHE_ENTRY* pEntry = &m_pEntry[m_nEntry];
+	pEntry->lpszSection = copyString(lpszSection);
+	pEntry->lpszKey = copyString(lpszKey);
+	pEntry->lpszValue = copyString(lpszValue);
+	pEntry->dwHash = CIniFile::hashString(lpszKey, CIniFile::hashString(lpszSection, 2166136261UL) ^ '[');
+	pEntry->nNext = m_pnBucket[pEntry->dwHash & m_dwBucketMask];
+	m_pnBucket[pEntry->dwHash & m_dwBucketMask] = m_nEntry++;
+
+	return TRUE;
+}
+
+
+/**
+ * @fn		Find
+ * @brief	ύXe
+ * @param	[in]	LPCTSTR lpszSection		: ZNV
+ * @param	[in]	LPCTSTR lpszKey			: L[
+ * @return	0`:vf̃CfbNX, -1:YȂ
+ */
+INT CIniUpdate::Find(LPCTSTR lpszSection, LPCTSTR lpszKey)
+{
+	if (m_nEntry == 0) {
+		return -1;
+	}
+
+	DWORD dwHash = CIniFile::hashString(lpszKey, CIniFile::hashString(lpszSection, 2166136261UL) ^ '[');
+	for (INT i = m_pnBucket[dwHash & m_dwBucketMask]; i >= 0; i = m_pEntry[i].nNext) {
+		if (m_pEntry[i].dwHash == dwHash
+			&& CIniFile::equalString(m_pEntry[i].lpszKey, lpszKey)
+			&& CIniFile::equalString(m_pEntry[i].lpszSection, lpszSection)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+ * @fn		GetAt
+ * @brief	ύXe擾
+ * @param	[in]	INT nIndex		: vf̃CfbNX
+ * @return	vfւ̃|C^(NULL:͈͊O)
+ */
+const INI_CACHE_ENTRY* CIniUpdate::GetAt(INT nIndex)
+{
+	if (nIndex < 0 || nIndex >= m_nEntry) {
+		return NULL;
+	}
+	return &m_pEntry[nIndex];
+}
+
+
+/**
+ * @fn		GetCount
+ * @brief	ύXe̐擾
+ * @return	ύXe̐
+ */
+INT CIniUpdate::GetCount()
+{
+	return m_nEntry;
+}
+
+
+/**
+ * @fn		Clear
+ * @brief	ύXeSĔj(vf\̗͍̈ėp)
+ */
+void CIniUpdate::Clear()
+{
+	while (m_pPool != NULL) {
+		LPBYTE pNext = *(LPBYTE*)m_pPool;
+		delete[] m_pPool;
+		m_pPool = pNext;
+	}
+	m_nPoolUsed = 0;
+	m_nPoolSize = 0;
+	m_nEntry = 0;
+	if (m_pnBucket != NULL) {
+		memset(m_pnBucket, 0xFF, sizeof(INT) * (m_dwBucketMask + 1));
+	}
+}
+
+
+/**
+ * @fn		copyString
+ * @brief	𕶎̈֕
+ * @param	[in]	LPCTSTR lpszStr		: 
+ * @return	
+ */
+LPCTSTR CIniUpdate::copyString(LPCTSTR lpszStr)
+{
+	SIZE_T nBytes = sizeof(TCHAR) * (_tcslen(lpszStr) + 1);
+
+	if (m_pPool == NULL || m_nPoolUsed + nBytes > m_nPoolSize) {
+		// VubN擪ɘA
+		SIZE_T nSize = sizeof(LPBYTE) + nBytes;
+		if (nSize < INI_UPDATE_POOL_SIZE) {
+			nSize = INI_UPDATE_POOL_SIZE;
+		}
+		LPBYTE pBlock = new BYTE[nSize];
+		*(LPBYTE*)pBlock = m_pPool;
+		m_pPool = pBlock;
+		m_nPoolUsed = sizeof(LPBYTE);
+		m_nPoolSize = nSize;
+	}
+
+	LPTSTR lpszCopy = (LPTSTR)(m_pPool + m_nPoolUsed);
+	memcpy(lpszCopy, lpszStr, nBytes);
+	m_nPoolUsed += (nBytes + sizeof(LPBYTE) - 1) & ~(sizeof(LPBYTE) - 1);
+	if (m_nPoolUsed > m_nPoolSize) {
+		m_nPoolUsed = m_nPoolSize;
+	}
+
+	return lpszCopy;
+}
+
+
+/**
+ * @fn		grow
+ * @brief	vf\ƃnbVoPbgg
+ */
+void CIniUpdate::grow()
+{
+	INT nMax = (m_nMax > 0) ? m_nMax * 2 : INI_CACHE_HASH_MIN;
+	INI_CACHE_ENTRY* pEntry = new INI_CACHE_ENTRY[nMax];
+	if (m_pEntry != NULL) {
+		memcpy(pEntry, m_pEntry, sizeof(INI_CACHE_ENTRY) * m_nEntry);
+		delete[] m_pEntry;
+	}
+	m_pEntry = pEntry;
+	m_nMax = nMax;
+
+	// oPbg͗vfƓ(2ׂ̂)ɂčĘA
+	if (m_pnBucket != NULL) {
+		delete[] m_pnBucket;
+	}
+	m_pnBucket = new INT[nMax];
+	m_dwBucketMask = (DWORD)nMax - 1;
+	memset(m_pnBucket, 0xFF, sizeof(INT) * nMax);
+	for (INT i = 0; i < m_nEntry; i++) {
+		m_pEntry[i].nNext = m_pnBucket[m_pEntry[i].dwHash & m_dwBucketMask];
+		m_pnBucket[m_pEntry[i].dwHash & m_dwBucketMask] = i;
+	}
+}
+
 //void CMFDlgApp7Dlg::TestFunc03()
 //{
 //	CIniFile cIni(_T("TestIni.ini"));
@@ -3,6 +3,17 @@
  * @brief	rbN
  * @author	?
  * @date	?
+ * @remarks
+ *		L[EÕev[g(bN|V[)ƂĎgprbNNXłB
+ *		- CLockSRW		: SRWLOCK(L/rAċAbNs)
+ *		- CLockCS<S>	: XsJEg S ̃NeBJZNV(ċAbN)
+ *		- CLockNone		: Ȃ(VOXbhŎgpꍇ)
+ *		ǂ̃|V[ Lock/Unlock(r)ALockShared/UnlockShared(L)ATryLock ܂B
+ *		LbNʂȂ|V[ł LockShared ͔rbNƓłB
+ *		bN̎擾E CLockGuard/CSharedLockGuard ŃXR[vɑΉĂ
+ *		(r return ŉRꂪNȂ悤ɂ邽)B
+ *		Init/Exit ͐EjɎŌĂ΂܂B\̂̃oƂĎgpAJn/I֐
+ *		ꍇ(simple_log.h  LOG_INFO )͖IɌĂł(d Init/Exit ͖)B
  */
 #pragma once
 
@@ -12,93 +23,155 @@
 #define LOCK(obj)			obj.Lock()
 #define UNLOCK(obj)			obj.Unlock()
 
+#define LOCK_CS_SPIN_COUNT	(4000)		//!< CLockCS ̊̃XsJEg(ҋ@OɃXs)
+
 
 /**
- * @class CLock
- * @brief
+ * @class	CLockSRW
+ * @brief	SRWLOCK ɂ鋤L/rbN
+ * @remarks	XbhċAIɃbNȂł(fbhbN܂)B
  */
-class CLock
+class CLockSRW
 {
 private:
-	CRITICAL_SECTION	m_stCS;
-	BOOL				m_bInit;
+	SRWLOCK				m_stSRW;
 
 public:
-	CLock();
-	~CLock();
+	CLockSRW() { Init(); }
+	~CLockSRW() { Exit(); }
 
-	void	Init();
-	void	Exit();
-	int		Loock();
-	int		Unlock();
+	void				Init() { ::InitializeSRWLock(&m_stSRW); }
+	void				Exit() {}
+	void				Lock() { ::AcquireSRWLockExclusive(&m_stSRW); }
+	void				Unlock() { ::ReleaseSRWLockExclusive(&m_stSRW); }
+	BOOL				TryLock() { return (::TryAcquireSRWLockExclusive(&m_stSRW)) ? (TRUE) : (FALSE); }
+	void				LockShared() { ::AcquireSRWLockShared(&m_stSRW); }
+	void				UnlockShared() { ::ReleaseSRWLockShared(&m_stSRW); }
+
+private:
+	CLockSRW(const CLockSRW&);
+	CLockSRW& operator=(const CLockSRW&);
 };
 
 
 /**
- * RXgN^
+ * @class	CLockCS
+ * @brief	XsJEgtNeBJZNV
+ * @tparam	S	: XsJEg(0:XsȂAVOvZbTł͖)
+ * @remarks	ێԂZbNł́Aҋ@(J[lJ)̑OɃXs邱Ƃŋ̃RXg}܂B
  */
-CLock::CLock()
-	: m_bInit(FALSE)
+template <DWORD S = LOCK_CS_SPIN_COUNT>
+class CLockCS
 {
-	Init();
-}
+private:
+	CRITICAL_SECTION	m_stCS;
+	BOOL				m_bInit;
+
+public:
+	CLockCS() : m_bInit(FALSE) { Init(); }
+	~CLockCS() { Exit(); }
+
+	void				Init();
+	void				Exit();
+	void				Lock() { ::EnterCriticalSection(&m_stCS); }
+	void				Unlock() { ::LeaveCriticalSection(&m_stCS); }
+	BOOL				TryLock() { return (::TryEnterCriticalSection(&m_stCS)) ? (TRUE) : (FALSE); }
+	void				LockShared() { Lock(); }
+	void				UnlockShared() { Unlock(); }
+
+private:
+	CLockCS(const CLockCS&);
+	CLockCS& operator=(const CLockCS&);
+};
+
 
 /**
- * fXgN^
+ * @class	CLockNone
+ * @brief	rȂbN(VOXbhp)
  */
-CLock::~CLock()
+class CLockNone
 {
-	Exit();
-}
+public:
+	void				Init() {}
+	void				Exit() {}
+	void				Lock() {}
+	void				Unlock() {}
+	BOOL				TryLock() { return TRUE; }
+	void				LockShared() {}
+	void				UnlockShared() {}
+};
+
+
+//! ] CLock(̃XsJEg̃NeBJZNV)
+typedef CLockCS<>	CLock;
+
 
 /**
- * @fn		Init
- * @brief
- * @return
+ * @class	CLockGuard
+ * @brief	XR[vŔrbNێ
+ * @tparam	L	: bN|V[
  */
-void CLock::Init()
+template <typename L>
+class CLockGuard
 {
-	if (!m_bInit) {
-		InitializeCriticalSection(&m_stCS);
-		m_bInit = TRUE;
-	}
-}
+private:
+	L&					m_cLock;
+
+public:
+	explicit CLockGuard(L& cLock) : m_cLock(cLock) { m_cLock.Lock(); }
+	//! 擾ς݂̃bNp(bLocked=TRUEAbN擾ĕԂ֐Ƒgݍ킹)
+	CLockGuard(L& cLock, BOOL bLocked) : m_cLock(cLock) { if (!bLocked) { m_cLock.Lock(); } }
+	~CLockGuard() { m_cLock.Unlock(); }
+
+private:
+	CLockGuard(const CLockGuard&);
+	CLockGuard& operator=(const CLockGuard&);
+};
+
 
 /**
- * @fn		Exit
- * @brief
- * @return
+ * @class	CSharedLockGuard
+ * @brief	XR[vŋLbNێ
+ * @tparam	L	: bN|V[
  */
-void CLock::Exit()
+template <typename L>
+class CSharedLockGuard
 {
-	DeleteCriticalSection(&m_stCS);
-	m_bInit = FALSE;
-}
+private:
+	L&					m_cLock;
+
+public:
+	explicit CSharedLockGuard(L& cLock) : m_cLock(cLock) { m_cLock.LockShared(); }
+	~CSharedLockGuard() { m_cLock.UnlockShared(); }
+
+private:
+	CSharedLockGuard(const CSharedLockGuard&);
+	CSharedLockGuard& operator=(const CSharedLockGuard&);
+};
+
 
 /**
- * @fn		Loock
- * @brief
- * @return
+ * @fn		Init
+ * @brief	NeBJZNV(ς݂̏ꍇ͉Ȃ)
  */
-int CLock::Loock()
+template <DWORD S>
+void CLockCS<S>::Init()
 {
 	if (!m_bInit) {
-		return -1;
+		::InitializeCriticalSectionAndSpinCount(&m_stCS, S);
+		m_bInit = TRUE;
 	}
-	EnterCriticalSection(&m_stCS);
-	return 0;
 }
 
 /**
- * @fn		Unlock
- * @brief
- * @return
+ * @fn		Exit
+ * @brief	NeBJZNV폜(̏ꍇ͉Ȃ)
  */
-int CLock::Unlock()
+template <DWORD S>
+void CLockCS<S>::Exit()
 {
-	if (!m_bInit) {
-		return -1;
+	if (m_bInit) {
+		::DeleteCriticalSection(&m_stCS);
+		m_bInit = FALSE;
 	}
-	LeaveCriticalSection(&m_stCS);
-	return 0;
 }
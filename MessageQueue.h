@@ -0,0 +1,265 @@
+/**
+ * @file	MessageQueue.h
+ * @brief	^tbZ[WL[
+ * @author	?
+ * @date	?
+ * @remarks
+ *		CQueue(SimpleQueue.h)oCĝɑ΂At[\̂1vfPʂŎ󂯓n܂B
+ *		vf̈͌Œ蒷̃XbgzƂăIuWFNgɎ߁AɃmۂ͍s܂B
+ *		Xbg̓LbVCEɔzuAאڃXbgރXbhm̋ULh܂B
+ *		̂߃NXŜLbVCEvAnew ł̓NX operator new ŋEɊmۂ܂B
+ */
+#pragma once
+
+#include <windows.h>
+#include <malloc.h>
+#include <new>
+#include <utility>
+#include "ring_core.h"
+#include "Lock.h"
+
+
+/**
+ * @class	CMessageQueue
+ * @brief	^tbZ[WL[NX
+ * @tparam	T	: vf̌^
+ * @tparam	N	: ővf(2ׂ̂)
+ * @tparam	L	: bN|V[(Lock.hA̓XsJEgtNeBJZNV)
+ * @remarks
+ *		Emplace ŋ󂫃Xbgɒڗvf\zADequeue Ń[uĎo܂B
+ *		1̃Xbĥ݂Ŏgpꍇ L  CLockNone w肵ĂB
+ */
+template <typename T, int N, typename L = CLockCS<> >
+class CMessageQueue
+{
+	static_assert(0 < N && (N & (N - 1)) == 0, "CMessageQueue size must be power of 2");
+
+private:
+	/**
+	 * @struct	SLOT
+	 * @brief	vfi[̈(LbVCPʂɔzu)
+	 */
+	struct alignas(CACHE_LINE_SIZE) SLOT {
+		alignas(T) unsigned char	abyData[sizeof(T)];		//!< vf̊i[̈(placement new ō\z)
+	};
+
+private:
+	L					m_cLock;
+	int					m_nHead;
+	int					m_nLength;
+	SLOT				m_astSlot[N];
+
+public:
+	CMessageQueue();
+	~CMessageQueue();
+
+	static void*		operator new(size_t nSize);
+	static void			operator delete(void* p);
+
+	int					Clear();
+	template <class... Args>
+	int					Emplace(Args&&... args);
+	int					Enqueue(const T& stData);
+	int					Enqueue(T&& stData);
+	int					Dequeue(T* pstData);
+	BOOL				IsEmpty();
+	BOOL				IsFull();
+	int					GetLength();
+	int					GetCapacity();
+
+private:
+	inline T*			slot(int nIndex);
+};
+
+
+/**
+ * RXgN^
+ */
+template <typename T, int N, typename L>
+CMessageQueue<T, N, L>::CMessageQueue()
+{
+	m_nHead = 0;
+	m_nLength = 0;
+}
+
+/**
+ * fXgN^
+ */
+template <typename T, int N, typename L>
+CMessageQueue<T, N, L>::~CMessageQueue()
+{
+	Clear();
+}
+
+/**
+ * @fn		operator new
+ * @brief	L[LbVCEɊmۂ
+ * @param	[in]	size_t nSize	: mۂTCY
+ * @return	mۂ̈(s std::bad_alloc)
+ * @remarks	C++17 O new  alignas ̋Eۏ؂Ȃ߁A_aligned_malloc Ŋmۂ܂B
+ */
+template <typename T, int N, typename L>
+void* CMessageQueue<T, N, L>::operator new(size_t nSize)
+{
+	void* p = _aligned_malloc(nSize, alignof(CMessageQueue));
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+/**
+ * @fn		operator delete
+ * @brief	operator new Ŋmۂ̈
+ * @param	[in]	void* p			: ̈
+ */
+template <typename T, int N, typename L>
+void CMessageQueue<T, N, L>::operator delete(void* p)
+{
+	_aligned_free(p);
+}
+
+/**
+ * @fn		Clear
+ * @brief	L[̑Svfj
+ * @return	0:
+ */
+template <typename T, int N, typename L>
+int CMessageQueue<T, N, L>::Clear()
+{
+	CLockGuard<L> cGuard(m_cLock);
+	for (int i = 0; i < m_nLength; i++) {
+		slot(m_nHead + i)->~T();
+	}
+	m_nHead = 0;
+	m_nLength = 0;
+
+	return 0;
+}
+
+/**
+ * @fn		Emplace
+ * @brief	L[̖ɗvf𒼐ڍ\z
+ * @param	[IN]	args	: vf̃RXgN^
+ * @return	0:, -1:L[t
+ * @remarks	vf̃RXgN^̓bN擾Ɏs܂B
+ */
+template <typename T, int N, typename L>
+template <class... Args>
+int CMessageQueue<T, N, L>::Emplace(Args&&... args)
+{
+	CLockGuard<L> cGuard(m_cLock);
+	if (N <= m_nLength) {
+		return -1;
+	}
+	new (m_astSlot[(m_nHead + m_nLength) & (N - 1)].abyData) T(std::forward<Args>(args)...);
+	m_nLength++;
+
+	return 0;
+}
+
+/**
+ * @fn		Enqueue
+ * @brief	L[̖ɗvfRs[
+ * @param	[IN]	stData	: ǉvf
+ * @return	0:, -1:L[t
+ */
+template <typename T, int N, typename L>
+int CMessageQueue<T, N, L>::Enqueue(const T& stData)
+{
+	return Emplace(stData);
+}
+
+/**
+ * @fn		Enqueue
+ * @brief	L[̖ɗvf[u
+ * @param	[IN]	stData	: ǉvf
+ * @return	0:, -1:L[t
+ */
+template <typename T, int N, typename L>
+int CMessageQueue<T, N, L>::Enqueue(T&& stData)
+{
+	return Emplace(std::move(stData));
+}
+
+/**
+ * @fn		Dequeue
+ * @brief	L[̐擪̗vfo
+ * @param	[OUT]	pstData	: ovf̊i[([u)
+ * @return	0:, -1:L[ or G[
+ */
+template <typename T, int N, typename L>
+int CMessageQueue<T, N, L>::Dequeue(T* pstData)
+{
+	if (pstData == NULL) {
+		return -1;
+	}
+
+	CLockGuard<L> cGuard(m_cLock);
+	if (m_nLength <= 0) {
+		return -1;
+	}
+	T* pHead = slot(m_nHead);
+	*pstData = std::move(*pHead);
+	pHead->~T();
+	m_nHead = ((m_nHead + 1) & (N - 1));
+	m_nLength--;
+
+	return 0;
+}
+
+/**
+ * @fn		IsEmpty
+ * @brief	L[󂩔肷
+ * @return	TRUE:, FALSE:vf
+ */
+template <typename T, int N, typename L>
+BOOL CMessageQueue<T, N, L>::IsEmpty()
+{
+	return ((m_nLength == 0) ? (TRUE) : (FALSE));
+}
+
+/**
+ * @fn		IsFull
+ * @brief	L[t肷
+ * @return	TRUE:t, FALSE:󂫂
+ */
+template <typename T, int N, typename L>
+BOOL CMessageQueue<T, N, L>::IsFull()
+{
+	return ((N <= m_nLength) ? (TRUE) : (FALSE));
+}
+
+/**
+ * @fn		GetLength
+ * @brief	L[̗vf擾
+ * @return	vf
+ */
+template <typename T, int N, typename L>
+int CMessageQueue<T, N, L>::GetLength()
+{
+	return m_nLength;
+}
+
+/**
+ * @fn		GetCapacity
+ * @brief	L[̍ővf擾
+ * @return	ővf
+ */
+template <typename T, int N, typename L>
+int CMessageQueue<T, N, L>::GetCapacity()
+{
+	return N;
+}
+
+/**
+ * @fn		slot
+ * @brief	wʒũXbg̗vf擾
+ * @param	[IN]	nIndex	: ʒu(N ȏ͐܂Ԃ)
+ * @return	vfւ̃|C^
+ */
+template <typename T, int N, typename L>
+inline T* CMessageQueue<T, N, L>::slot(int nIndex)
+{
+	return reinterpret_cast<T*>(m_astSlot[nIndex & (N - 1)].abyData);
+}
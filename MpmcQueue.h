@@ -0,0 +1,298 @@
+/**
+ * @file	MpmcQueue.h
+ * @brief	vf[T/RV[}Ή̗LEL[
+ * @author	?
+ * @date	?
+ * @remarks
+ *		D.Vyukov  bounded MPMC queue ̕ŁAXbg̃V[PXԍɂ
+ *		bNg킸ɕXbh̒ǉ/os܂B
+ *		queue.h ƈقȂO[oϐȂ߁ACӂ̐̃CX^X𐶐ł܂B
+ */
+#pragma once
+
+#include <windows.h>
+#include <malloc.h>
+#include <atomic>
+#include <new>
+#include <utility>
+#include "ring_core.h"
+
+
+/**
+ * @class	CMpmcQueue
+ * @brief	MPMC LEL[NX
+ * @tparam	T	: vf̌^
+ * @remarks
+ *		ǉʒuEoʒu͂ꂼ CAS Ői߁AXbg̃V[PXԍ
+ *		u݉\vuǏo\v𔻒肵܂BL[t/̏ꍇ͑҂ɎsԂ܂B
+ *		eXbgƒǉ/oʒu̓LbVCPʂɔzu܂B
+ */
+template <typename T>
+class CMpmcQueue
+{
+private:
+	/**
+	 * @struct	CELL
+	 * @brief	vfi[Xbg
+	 */
+	struct alignas(CACHE_LINE_SIZE) CELL {
+		std::atomic<unsigned int>	uiSeq;						//!< V[PXԍ(pos:݉, pos+1:Ǐo)
+		alignas(T) unsigned char	abyData[sizeof(T)];			//!< vf̊i[̈(placement new ō\z)
+	};
+
+private:
+	CELL*						m_pstCell;
+	unsigned int				m_uiMask;
+	unsigned char				m_abyPad0[CACHE_LINE_SIZE];
+	std::atomic<unsigned int>	m_uiEnqueuePos;
+	unsigned char				m_abyPad1[CACHE_LINE_SIZE - sizeof(std::atomic<unsigned int>)];
+	std::atomic<unsigned int>	m_uiDequeuePos;
+	unsigned char				m_abyPad2[CACHE_LINE_SIZE - sizeof(std::atomic<unsigned int>)];
+
+public:
+	CMpmcQueue(int nSize = 1024);
+	~CMpmcQueue();
+
+	template <class... Args>
+	int					Emplace(Args&&... args);
+	int					Enqueue(const T& stData);
+	int					Enqueue(T&& stData);
+	int					Dequeue(T* pstData);
+	int					GetLength();
+	int					GetCapacity();
+
+private:
+	inline CELL*		reserveEnqueue();
+	inline CELL*		reserveDequeue(unsigned int* puiPos);
+	int					getPow2Size(int nSize);
+};
+
+
+/**
+ * RXgN^
+ * @param	[IN]	nSize	: ővf(2ׂ̂ɐ؂グAŏ2)
+ */
+template <typename T>
+CMpmcQueue<T>::CMpmcQueue(int nSize/*=1024*/)
+{
+	int size = getPow2Size(nSize);
+
+	m_pstCell = (CELL*)_aligned_malloc(sizeof(CELL) * size, alignof(CELL));
+	m_uiMask = (m_pstCell != NULL) ? ((unsigned int)size - 1) : (0);
+	for (unsigned int i = 0; m_pstCell != NULL && i <= m_uiMask; i++) {
+		new (&m_pstCell[i]) CELL;
+		m_pstCell[i].uiSeq.store(i, std::memory_order_relaxed);
+	}
+	m_uiEnqueuePos.store(0, std::memory_order_relaxed);
+	m_uiDequeuePos.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * fXgN^
+ * @remarks	XbhgpĂȂԂŔjĂBcĂvf͔j܂B
+ */
+template <typename T>
+CMpmcQueue<T>::~CMpmcQueue()
+{
+	if (m_pstCell == NULL) {
+		return;
+	}
+
+	unsigned int tail = m_uiEnqueuePos.load(std::memory_order_relaxed);
+	for (unsigned int pos = m_uiDequeuePos.load(std::memory_order_relaxed); pos != tail; pos++) {
+		CELL* pstCell = &m_pstCell[pos & m_uiMask];
+		if (pstCell->uiSeq.load(std::memory_order_acquire) == pos + 1) {
+			reinterpret_cast<T*>(pstCell->abyData)->~T();
+		}
+	}
+	_aligned_free(m_pstCell);
+}
+
+/**
+ * @fn		Emplace
+ * @brief	L[̖ɗvf𒼐ڍ\z
+ * @param	[IN]	args	: vf̃RXgN^
+ * @return	0:, -1:L[t
+ */
+template <typename T>
+template <class... Args>
+int CMpmcQueue<T>::Emplace(Args&&... args)
+{
+	CELL* pstCell = reserveEnqueue();
+	if (pstCell == NULL) {
+		return -1;
+	}
+
+	unsigned int pos = pstCell->uiSeq.load(std::memory_order_relaxed);
+	new (pstCell->abyData) T(std::forward<Args>(args)...);
+	// vf̍\zɓǏo\Ƃ
+	pstCell->uiSeq.store(pos + 1, std::memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @fn		Enqueue
+ * @brief	L[̖ɗvfRs[
+ * @param	[IN]	stData	: ǉvf
+ * @return	0:, -1:L[t
+ */
+template <typename T>
+int CMpmcQueue<T>::Enqueue(const T& stData)
+{
+	return Emplace(stData);
+}
+
+/**
+ * @fn		Enqueue
+ * @brief	L[̖ɗvf[u
+ * @param	[IN]	stData	: ǉvf
+ * @return	0:, -1:L[t
+ */
+template <typename T>
+int CMpmcQueue<T>::Enqueue(T&& stData)
+{
+	return Emplace(std::move(stData));
+}
+
+/**
+ * @fn		Dequeue
+ * @brief	L[̐擪̗vfo
+ * @param	[OUT]	pstData	: ovf̊i[([u)
+ * @return	0:, -1:L[ or G[
+ */
+template <typename T>
+int CMpmcQueue<T>::Dequeue(T* pstData)
+{
+	if (pstData == NULL) {
+		return -1;
+	}
+
+	unsigned int pos = 0;
+	CELL* pstCell = reserveDequeue(&pos);
+	if (pstCell == NULL) {
+		return -1;
+	}
+
+	T* pItem = reinterpret_cast<T*>(pstCell->abyData);
+	*pstData = std::move(*pItem);
+	pItem->~T();
+	// 1̏ݗpɉ
+	pstCell->uiSeq.store(pos + m_uiMask + 1, std::memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @fn		GetLength
+ * @brief	L[̗vf擾
+ * @return	vf(Xbh쒆̏ꍇ͊TZl)
+ */
+template <typename T>
+int CMpmcQueue<T>::GetLength()
+{
+	unsigned int head = m_uiDequeuePos.load(std::memory_order_acquire);
+	unsigned int tail = m_uiEnqueuePos.load(std::memory_order_acquire);
+	int length = (int)(tail - head);
+	if (length < 0) {
+		return 0;
+	}
+	return (GetCapacity() < length) ? (GetCapacity()) : (length);
+}
+
+/**
+ * @fn		GetCapacity
+ * @brief	L[̍ővf擾
+ * @return	ővf
+ */
+template <typename T>
+int CMpmcQueue<T>::GetCapacity()
+{
+	return (m_pstCell != NULL) ? ((int)m_uiMask + 1) : (0);
+}
+
+/**
+ * @fn		reserveEnqueue
+ * @brief	݃Xbgmۂ
+ * @return	mۂXbg(V[PXԍ݈ʒu), NULL:L[t
+ */
+template <typename T>
+inline typename CMpmcQueue<T>::CELL* CMpmcQueue<T>::reserveEnqueue()
+{
+	if (m_pstCell == NULL) {
+		return NULL;
+	}
+
+	unsigned int pos = m_uiEnqueuePos.load(std::memory_order_relaxed);
+	while (TRUE) {
+		CELL* pstCell = &m_pstCell[pos & m_uiMask];
+		unsigned int seq = pstCell->uiSeq.load(std::memory_order_acquire);
+		int diff = (int)(seq - pos);
+		if (diff == 0) {
+			// ݉\ȃXbgBʒui߂ꂽXbhmۂ
+			if (m_uiEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				return pstCell;
+			}
+		}
+		else if (diff < 0) {
+			// 1O̗vfo
+			return NULL;
+		}
+		else {
+			// XbhɊmۂ
+			pos = m_uiEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @fn		reserveDequeue
+ * @brief	ǏoXbgmۂ
+ * @param	[OUT]	puiPos	: mۂǏoʒu
+ * @return	mۂXbg, NULL:L[
+ */
+template <typename T>
+inline typename CMpmcQueue<T>::CELL* CMpmcQueue<T>::reserveDequeue(unsigned int* puiPos)
+{
+	if (m_pstCell == NULL) {
+		return NULL;
+	}
+
+	unsigned int pos = m_uiDequeuePos.load(std::memory_order_relaxed);
+	while (TRUE) {
+		CELL* pstCell = &m_pstCell[pos & m_uiMask];
+		unsigned int seq = pstCell->uiSeq.load(std::memory_order_acquire);
+		int diff = (int)(seq - (pos + 1));
+		if (diff == 0) {
+			// Ǐo\ȃXbgBʒui߂ꂽXbhmۂ
+			if (m_uiDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				*puiPos = pos;
+				return pstCell;
+			}
+		}
+		else if (diff < 0) {
+			// vf
+			return NULL;
+		}
+		else {
+			// XbhɊmۂ
+			pos = m_uiDequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @fn		getPow2Size
+ * @brief	wTCYȏ2ׂ̂̃TCYԂ
+ * @param	[IN]	nSize	: vf
+ * @return	vf(2ׂ̂Aŏ2)
+ */
+template <typename T>
+int CMpmcQueue<T>::getPow2Size(int nSize)
+{
+	int exp_size = 2;
+	while (exp_size < nSize) {
+		exp_size <<= 1;
+	}
+	return exp_size;
+}
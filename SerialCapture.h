@@ -0,0 +1,567 @@
+/**
+ * @file	SerialCapture.h
+ * @brief	Mf[^̃Lv`(}bvht@C)ƍĐ
+ * @author	?
+ * @date	?
+ * @remarks
+ *		CSerialCapture ͎Mf[^̂܂܃^CX^v(QPC)t̃R[hƂāA
+ *		}bvt@C̖֒ǋL܂(ǋL̂݁At@CI/OEmalloc ̓}bv̊ĝ)B
+ *		CSerialReplay ̓Lv`t@COobt@֏݁AMƓoH
+ *		(Oobt@  t[  c)@œ삳܂B
+ *		Đx͋L^̊Ԋu(SERIAL_REPLAY_ORIGINAL)A̔{(SERIAL_REPLAY_SCALED)A
+ *		ҋ@(SERIAL_REPLAY_FAST)IAFAST ł͏Ŝ̃X[vbgvł܂B
+ *
+ *		t@C̓wb_(SERIAL_CAPTURE_HEADER)ƃR[h̕тł(gGfBA)B
+ *		R[h SERIAL_CAPTURE_RECORD + f[^ŁÃR[h SERIAL_CAPTURE_ALIGN En܂܂B
+ *		wb_ llDataEnd ̓R[hIĂXV邽߁AُIꍇ
+ *		llDataEnd ܂ł̃R[h͓ǂݏo܂B
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <windows.h>
+#include "CByteRingBuffer.h"
+
+
+#define SERIAL_CAPTURE_MAGIC		(0x50414353)		//!< wb_̎ʎq("SCAP")
+#define SERIAL_CAPTURE_VERSION		(1)					//!< t@C`o[W
+#define SERIAL_CAPTURE_ALIGN		(8)					//!< R[h̋E
+#define SERIAL_CAPTURE_GROW			(16 * 1024 * 1024)	//!< }bv̊gP(t@CTCY̑)
+#define SERIAL_CAPTURE_MAX_RECORD	(64 * 1024)			//!< R[h1̃f[^̍őoCg
+
+#define SERIAL_REPLAY_SPIN_US		(2000)				//!< Đ̑ҋ@ Sleep Xsc莞(us)
+
+
+#pragma pack(push, 8)
+/**
+ * @struct	SERIAL_CAPTURE_HEADER
+ * @brief	Lv`t@C̃wb_
+ */
+struct SERIAL_CAPTURE_HEADER {
+	DWORD				dwMagic;						//!< SERIAL_CAPTURE_MAGIC
+	DWORD				dwVersion;						//!< SERIAL_CAPTURE_VERSION
+	LONGLONG			llFrequency;					//!< QPCg
+	LONGLONG			llBaseQpc;						//!< Jn QPC l
+	FILETIME			ftBase;							//!< Jn̓(UTC)
+	volatile LONGLONG	llDataEnd;						//!< ݍς݂̃R[h̏I[(t@C擪̃oCg)
+	LONGLONG			llRecords;						//!< R[h
+};
+
+/**
+ * @struct	SERIAL_CAPTURE_RECORD
+ * @brief	R[h̃wb_( dwLength oCg̃f[^)
+ */
+struct SERIAL_CAPTURE_RECORD {
+	LONGLONG			llQpc;							//!< M QPC l
+	DWORD				dwLength;						//!< f[^̃oCg
+	DWORD				dwReserved;
+};
+#pragma pack(pop)
+
+/**
+ * @enum	SERIAL_REPLAY_MODE
+ * @brief	Đx
+ */
+enum SERIAL_REPLAY_MODE {
+	SERIAL_REPLAY_ORIGINAL = 0,					//!< L^̊ԊuōĐ
+	SERIAL_REPLAY_SCALED,						//!< L^̊Ԋu{ŊԊuōĐ(2.0:2{)
+	SERIAL_REPLAY_FAST,							//!< ҋ@ɍĐ(Oobt@̋󂫑҂̂)
+};
+
+/**
+ * @struct	SERIAL_REPLAY_RESULT
+ * @brief	Đ
+ */
+struct SERIAL_REPLAY_RESULT {
+	LONGLONG			llRecords;						//!< ĐR[h
+	LONGLONG			llBytes;						//!< Oobt@֏񂾃oCg
+	LONGLONG			llElapsedUs;					//!< Đɗv(us)
+	LONGLONG			llLateUs;						//!< \莞ɑ΂x̍ől(us, FAST ł 0)
+	LONGLONG			llFullWaits;					//!< Oobt@̋󂫑҂̉
+};
+
+//! ĐɃf[^Oobt@֏ޖɌĂԊ֐(M Commit ̏ɑ)
+typedef void (*SERIAL_REPLAY_CALLBACK)(PVOID pParam, int nLen);
+
+
+/**
+ * @class	CSerialCapture
+ * @brief	Mf[^̃Lv`
+ * @remarks
+ *		Write ͎MXbh1Ăł(r܂)B
+ *		}bv̊g(SERIAL_CAPTURE_GROW )̍ۂ̓}bv蒼߁Ả̂ݎԂ܂B
+ */
+class CSerialCapture
+{
+private:
+	HANDLE					m_hFile;					//!< Lv`t@C
+	HANDLE					m_hMapping;					//!< t@C}bsO
+	unsigned char*			m_pbyView;					//!< }bvr[(t@C擪)
+	LONGLONG				m_llMapSize;				//!< }bvTCY
+	LONGLONG				m_llWritePos;				//!< ̃R[h݈̏ʒu
+
+public:
+	CSerialCapture();
+	~CSerialCapture();
+
+	int					Open(const char* szPath);
+	int					Close();
+	int					Write(const unsigned char* pbyData, int nLen);
+	int					Flush();
+	BOOL				IsOpen() { return (m_pbyView != NULL); }
+	LONGLONG			GetRecordCount() { return (m_pbyView != NULL) ? (header()->llRecords) : (0); }
+	LONGLONG			GetSize() { return m_llWritePos; }
+
+private:
+	SERIAL_CAPTURE_HEADER*	header() { return (SERIAL_CAPTURE_HEADER*)m_pbyView; }
+	int					remap(LONGLONG llSize);
+	void				unmap();
+};
+
+
+/**
+ * @class	CSerialReplay
+ * @brief	Lv`t@C̍Đ
+ * @remarks
+ *		Run Ă񂾃XbhMXbh̑ɃOobt@̏ݑƂȂ܂B
+ *		Stop ͕ʂ̃XbhĂׂ܂B
+ */
+class CSerialReplay
+{
+private:
+	HANDLE					m_hFile;					//!< Lv`t@C
+	HANDLE					m_hMapping;					//!< t@C}bsO
+	const unsigned char*	m_pbyView;					//!< }bvr[(t@C擪)
+	LONGLONG				m_llDataEnd;				//!< R[h̏I[
+	volatile BOOL			m_bStop;					//!< ~v
+
+public:
+	CSerialReplay();
+	~CSerialReplay();
+
+	int					Open(const char* szPath);
+	void				Close();
+	int					Run(CByteRingBuffer* pcRing, SERIAL_REPLAY_MODE enMode, double dScale
+							, SERIAL_REPLAY_CALLBACK pfnCallback, PVOID pParam, SERIAL_REPLAY_RESULT* pstResult);
+	void				Stop() { m_bStop = TRUE; }
+	LONGLONG			GetRecordCount() { return (m_pbyView != NULL) ? (header()->llRecords) : (0); }
+
+private:
+	const SERIAL_CAPTURE_HEADER*	header() { return (const SERIAL_CAPTURE_HEADER*)m_pbyView; }
+	BOOL				waitUntil(LONGLONG llTarget, LONGLONG llFrequency);
+};
+
+
+/**
+ * @brief	RXgN^
+ */
+CSerialCapture::CSerialCapture() :
+	m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(NULL)
+	, m_pbyView(NULL)
+	, m_llMapSize(0)
+	, m_llWritePos(0)
+{
+}
+
+/**
+ * @brief	fXgN^
+ */
+CSerialCapture::~CSerialCapture()
+{
+	Close();
+}
+
+/**
+ * @fn		Open
+ * @brief	Lv`t@C쐬(̃t@C͏㏑)
+ * @param[in]	const char* szPath	: t@CpX
+ * @return	0:, -1:s
+ */
+int CSerialCapture::Open(const char* szPath)
+{
+	if (szPath == NULL || m_hFile != INVALID_HANDLE_VALUE) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	m_hFile = CreateFile(szPath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL
+		, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE) {
+		return -1;
+	}
+	if (remap(SERIAL_CAPTURE_GROW) != 0) {
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+		return -1;
+	}
+
+	LARGE_INTEGER liFreq, liNow;
+	QueryPerformanceFrequency(&liFreq);
+	QueryPerformanceCounter(&liNow);
+	SERIAL_CAPTURE_HEADER* h = header();
+	h->dwMagic = SERIAL_CAPTURE_MAGIC;
+	h->dwVersion = SERIAL_CAPTURE_VERSION;
+	h->llFrequency = liFreq.QuadPart;
+	h->llBaseQpc = liNow.QuadPart;
+	GetSystemTimeAsFileTime(&h->ftBase);
+	h->llRecords = 0;
+	m_llWritePos = sizeof(SERIAL_CAPTURE_HEADER);
+	h->llDataEnd = m_llWritePos;
+	return 0;
+}
+
+/**
+ * @fn		Close
+ * @brief	Lv`t@C(gp̊g؂l߂)
+ * @return	0:, -1:s
+ */
+int CSerialCapture::Close()
+{
+	if (m_hFile == INVALID_HANDLE_VALUE) {
+		return 0;
+	}
+
+	int ret = Flush();
+	unmap();
+	LARGE_INTEGER liEnd;
+	liEnd.QuadPart = m_llWritePos;
+	if (!SetFilePointerEx(m_hFile, liEnd, NULL, FILE_BEGIN) || !SetEndOfFile(m_hFile)) {
+		ret = -1;
+	}
+	CloseHandle(m_hFile);
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_llMapSize = 0;
+	m_llWritePos = 0;
+	return ret;
+}
+
+/**
+ * @fn		Write
+ * @brief	Mf[^R[hƂĒǋL
+ * @param[in]	const unsigned char* pbyData	: Mf[^
+ * @param[in]	int nLen						: Mf[^̃oCg(SERIAL_CAPTURE_MAX_RECORD ȉ)
+ * @return	0:, -1:s
+ * @remarks	M͌ďo QPC lƂ܂BOobt@ւ Commit ̒OɌĂłB
+ */
+int CSerialCapture::Write(const unsigned char* pbyData, int nLen)
+{
+	if (m_pbyView == NULL || pbyData == NULL || nLen < 0 || SERIAL_CAPTURE_MAX_RECORD < nLen) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	LARGE_INTEGER liNow;
+	QueryPerformanceCounter(&liNow);
+
+	LONGLONG size = (sizeof(SERIAL_CAPTURE_RECORD) + nLen + (SERIAL_CAPTURE_ALIGN - 1)) & ~(LONGLONG)(SERIAL_CAPTURE_ALIGN - 1);
+	if (m_llMapSize < m_llWritePos + size) {
+		if (remap(m_llMapSize + SERIAL_CAPTURE_GROW) != 0) {
+			return -1;
+		}
+	}
+
+	SERIAL_CAPTURE_RECORD* rec = (SERIAL_CAPTURE_RECORD*)(m_pbyView + m_llWritePos);
+	rec->llQpc = liNow.QuadPart;
+	rec->dwLength = (DWORD)nLen;
+	rec->dwReserved = 0;
+	if (0 < nLen) {
+		memcpy(rec + 1, pbyData, nLen);
+	}
+	m_llWritePos += size;
+
+	// R[hIĂI[XV(Ǐo llDataEnd ܂łLƂ)
+	SERIAL_CAPTURE_HEADER* h = header();
+	h->llRecords++;
+	MemoryBarrier();
+	h->llDataEnd = m_llWritePos;
+	return 0;
+}
+
+/**
+ * @fn		Flush
+ * @brief	ݍς݂̃R[ht@C֏o
+ * @return	0:, -1:s
+ * @remarks	r[̓e OS o߁Aʏ͌ĂԕKv͂܂(dfւ̔)B
+ */
+int CSerialCapture::Flush()
+{
+	if (m_pbyView == NULL) {
+		return -1;
+	}
+	if (!FlushViewOfFile(m_pbyView, (SIZE_T)m_llWritePos)) {
+		return -1;
+	}
+	return (FlushFileBuffers(m_hFile)) ? (0) : (-1);
+}
+
+/**
+ * @fn		remap
+ * @brief	t@CwTCYɊgă}bv
+ * @param[in]	LONGLONG llSize	: }bvTCY
+ * @return	0:, -1:s(̃}bv)
+ */
+int CSerialCapture::remap(LONGLONG llSize)
+{
+	unmap();
+	m_hMapping = CreateFileMapping(m_hFile, NULL, PAGE_READWRITE, (DWORD)(llSize >> 32), (DWORD)llSize, NULL);
+	if (m_hMapping == NULL) {
+		return -1;
+	}
+	m_pbyView = (unsigned char*)MapViewOfFile(m_hMapping, FILE_MAP_WRITE, 0, 0, (SIZE_T)llSize);
+	if (m_pbyView == NULL) {
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+		return -1;
+	}
+	m_llMapSize = llSize;
+	return 0;
+}
+
+/**
+ * @fn		unmap
+ * @brief	}bv
+ */
+void CSerialCapture::unmap()
+{
+	if (m_pbyView != NULL) {
+		UnmapViewOfFile(m_pbyView);
+		m_pbyView = NULL;
+	}
+	if (m_hMapping != NULL) {
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+}
+
+
+/**
+ * @brief	RXgN^
+ */
+CSerialReplay::CSerialReplay() :
+	m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(NULL)
+	, m_pbyView(NULL)
+	, m_llDataEnd(0)
+	, m_bStop(FALSE)
+{
+}
+
+/**
+ * @brief	fXgN^
+ */
+CSerialReplay::~CSerialReplay()
+{
+	Close();
+}
+
+/**
+ * @fn		Open
+ * @brief	Lv`t@CJ
+ * @param[in]	const char* szPath	: t@CpX
+ * @return	0:, -1:s(t@C`قȂꍇ܂)
+ * @remarks	Lv`̃t@CJ܂(Open _ llDataEnd ܂łĐ܂)B
+ */
+int CSerialReplay::Open(const char* szPath)
+{
+	if (szPath == NULL || m_hFile != INVALID_HANDLE_VALUE) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	m_hFile = CreateFile(szPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL
+		, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE) {
+		return -1;
+	}
+	LARGE_INTEGER liSize;
+	if (!GetFileSizeEx(m_hFile, &liSize) || liSize.QuadPart < (LONGLONG)sizeof(SERIAL_CAPTURE_HEADER)) {
+		Close();
+		return -1;
+	}
+	m_hMapping = CreateFileMapping(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping != NULL) {
+		m_pbyView = (const unsigned char*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, (SIZE_T)liSize.QuadPart);
+	}
+	if (m_pbyView == NULL) {
+		Close();
+		return -1;
+	}
+
+	const SERIAL_CAPTURE_HEADER* h = header();
+	m_llDataEnd = h->llDataEnd;
+	if (h->dwMagic != SERIAL_CAPTURE_MAGIC || h->dwVersion != SERIAL_CAPTURE_VERSION || h->llFrequency <= 0
+		|| m_llDataEnd < (LONGLONG)sizeof(SERIAL_CAPTURE_HEADER) || liSize.QuadPart < m_llDataEnd) {
+		Close();
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @fn		Close
+ * @brief	Lv`t@C
+ */
+void CSerialReplay::Close()
+{
+	if (m_pbyView != NULL) {
+		UnmapViewOfFile(m_pbyView);
+		m_pbyView = NULL;
+	}
+	if (m_hMapping != NULL) {
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+	if (m_hFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+	m_llDataEnd = 0;
+}
+
+/**
+ * @fn		Run
+ * @brief	Lv`t@C̑SR[hOobt@֏
+ * @param[in]	CByteRingBuffer* pcRing					: ݐ̃Oobt@
+ * @param[in]	SERIAL_REPLAY_MODE enMode				: Đx
+ * @param[in]	double dScale							: Đx̔{(SERIAL_REPLAY_SCALED, 0)
+ * @param[in]	SERIAL_REPLAY_CALLBACK pfnCallback		: ޖɌĂԊ֐(NULL:Ă΂Ȃ)
+ * @param[in]	PVOID pParam							: pfnCallback ɓn
+ * @param[out]	SERIAL_REPLAY_RESULT* pstResult			: Đ(NULL:sv)
+ * @return	0:(Ō܂ōĐ), 1:Stop Œf, -1:s
+ * @remarks
+ *		R[h̎MƐ擪̃R[hƂ̍ĐJn̗\莞ƂA\莞܂ő҂Ă珑݂܂B
+ *		Oobt@ɋ󂫂ꍇ͋󂭂܂ő҂(Ǐô pfnCallback ͏񂾕̂݌Ăт܂)A
+ *		̒x͈ȍ~̃R[h̗\莞Ɏz܂(\莞͏ɍĐJn)B
+ */
+int CSerialReplay::Run(CByteRingBuffer* pcRing, SERIAL_REPLAY_MODE enMode, double dScale
+	, SERIAL_REPLAY_CALLBACK pfnCallback, PVOID pParam, SERIAL_REPLAY_RESULT* pstResult)
+{
+	if (m_pbyView == NULL || pcRing == NULL || (enMode == SERIAL_REPLAY_SCALED && dScale <= 0.0)) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	SERIAL_REPLAY_RESULT stResult;
+	memset(&stResult, 0, sizeof(stResult));
+	m_bStop = FALSE;
+
+	const SERIAL_CAPTURE_HEADER* h = header();
+	LARGE_INTEGER liFreq, liStart, liNow;
+	QueryPerformanceFrequency(&liFreq);
+	// L^ QPC Đ QPC ɕϊW
+	double ratio = (double)liFreq.QuadPart / (double)h->llFrequency;
+	if (enMode == SERIAL_REPLAY_SCALED) {
+		ratio /= dScale;
+	}
+
+	int ret = 0;
+	LONGLONG pos = sizeof(SERIAL_CAPTURE_HEADER);
+	LONGLONG first = 0;
+	QueryPerformanceCounter(&liStart);
+	while (pos + (LONGLONG)sizeof(SERIAL_CAPTURE_RECORD) <= m_llDataEnd) {
+		const SERIAL_CAPTURE_RECORD* rec = (const SERIAL_CAPTURE_RECORD*)(m_pbyView + pos);
+		LONGLONG next = pos + ((sizeof(SERIAL_CAPTURE_RECORD) + rec->dwLength + (SERIAL_CAPTURE_ALIGN - 1)) & ~(LONGLONG)(SERIAL_CAPTURE_ALIGN - 1));
+		if (SERIAL_CAPTURE_MAX_RECORD < rec->dwLength || m_llDataEnd < next) {
+			// jR[h
+			ret = -1;
+			break;
+		}
+		if (stResult.llRecords == 0) {
+			first = rec->llQpc;
+		}
+
+		if (enMode != SERIAL_REPLAY_FAST) {
+			LONGLONG target = liStart.QuadPart + (LONGLONG)((double)(rec->llQpc - first) * ratio);
+			if (!waitUntil(target, liFreq.QuadPart)) {
+				ret = 1;
+				break;
+			}
+			QueryPerformanceCounter(&liNow);
+			LONGLONG late = (liNow.QuadPart - target) * 1000000 / liFreq.QuadPart;
+			if (stResult.llLateUs < late) {
+				stResult.llLateUs = late;
+			}
+		}
+
+		const unsigned char* data = (const unsigned char*)(rec + 1);
+		int remain = (int)rec->dwLength;
+		while (0 < remain && !m_bStop) {
+			int n = pcRing->Push(data, remain);
+			if (n < 0) {
+				ret = -1;
+				break;
+			}
+			if (0 < n) {
+				data += n;
+				remain -= n;
+				stResult.llBytes += n;
+				if (pfnCallback != NULL) {
+					pfnCallback(pParam, n);
+				}
+			}
+			if (0 < remain) {
+				stResult.llFullWaits++;
+				pcRing->WaitSpace(1, 100);
+			}
+		}
+		if (ret != 0) {
+			break;
+		}
+		if (m_bStop) {
+			ret = 1;
+			break;
+		}
+		stResult.llRecords++;
+		pos = next;
+	}
+	QueryPerformanceCounter(&liNow);
+	stResult.llElapsedUs = (liNow.QuadPart - liStart.QuadPart) * 1000000 / liFreq.QuadPart;
+
+	if (pstResult != NULL) {
+		*pstResult = stResult;
+	}
+	return ret;
+}
+
+/**
+ * @fn		waitUntil
+ * @brief	w肵 QPC lɂȂ܂őҋ@
+ * @param[in]	LONGLONG llTarget		: ҋ@I QPC l
+ * @param[in]	LONGLONG llFrequency	: QPCg
+ * @return	TRUE:w莞ɂȂ, FALSE:Stop Œf
+ * @remarks	Sleep ̗x(1msO)Zc莞Ԃ̓Xsđ҂܂B
+ */
+BOOL CSerialReplay::waitUntil(LONGLONG llTarget, LONGLONG llFrequency)
+{
+	LONGLONG spin = llFrequency * SERIAL_REPLAY_SPIN_US / 1000000;
+	LARGE_INTEGER liNow;
+	for (;;) {
+		QueryPerformanceCounter(&liNow);
+		LONGLONG remain = llTarget - liNow.QuadPart;
+		if (remain <= 0) {
+			return TRUE;
+		}
+		if (m_bStop) {
+			return FALSE;
+		}
+		if (spin < remain) {
+			// L^̖ʐMԂł Stop ɉł悤A1 Sleep  100ms ܂łƂ
+			LONGLONG ms = (remain - spin) * 1000 / llFrequency + 1;
+			Sleep((100 < ms) ? (100) : ((DWORD)ms));
+		}
+		else {
+			YieldProcessor();
+		}
+	}
+}
@@ -0,0 +1,1285 @@
+/**
+ * @file	SerialIocp.h
+ * @brief	I/O|[gɂ镡COM|[g̔񓯊M
+ * @author	?
+ * @date	?
+ * @remarks
+ *		open_serial_ex(FILE_FLAG_OVERLAPPED)ŊJ|[g1I/O|[g(IOCP)Ɋ֘AtÃ[J[Xbh
+ *		S|[g̎M܂(|[gĂXbh͑܂)B
+ *		|[g IOCP_READS_PER_PORT  ReadFile ɔsĂAf[^
+ *		sɃ|[g̃Oobt@(CByteRingBuffer)֏݂܂B
+ *		Mf[^̓Ǐo GetRecvBuffer Ŏ擾Oobt@sĂ
+ *		(WaitData/PeekSpan/Consume ܂ CFrameParser::ParseRing)B
+ *		M̒ʒm(Oobt@ւ̏݁EM~) SetRecvNotify Őݒ肵R[obN/CxgŎ󂯎܂B
+ *		M Send Ń|[g̑ML[ɐςނŖ߂AL[ɗ܂̃t[
+ *		1̔񓯊 WriteFile ɂ܂Ƃ߂đM܂(M̓R[obN/Cxg/WaitSent ŊmF)B
+ *		|[g̓v(oCgEs/EG[EMx) GetStats Ŏ擾 CSerialStats 擾ł܂
+ *		(Ǐo͎o CSerialStats::Consumed ĂԂƁAMǏo̒xL^܂)B
+ */
+#pragma once
+
+#include <assert.h>
+#include <windows.h>
+#include <process.h>
+#include "serial_comm.h"
+#include "CByteRingBuffer.h"
+#include "SerialStats.h"
+#include "SimpleThread.h"
+#include "Lock.h"
+
+
+#define IOCP_MAX_PORTS			(64)		//!< o^ł|[g
+#define IOCP_MAX_WORKERS		(16)		//!< [J[Xbh̏
+#define IOCP_DEFAULT_WORKERS	(4)			//!< [J[Xbh̊l̏(CPUƏ)
+#define IOCP_READS_PER_PORT		(4)			//!< |[gɔsĂ ReadFile ̐
+#define IOCP_READ_SIZE			(256)		//!< ReadFile 1񂠂̎MTCY̏
+#define IOCP_RING_SIZE			(4096)		//!< |[g̎MOobt@TCY
+#define IOCP_READ_TIMEOUT		(1000)		//!< M ReadFile 0oCgŊ܂ł̎(ms)
+#define IOCP_MAX_ERRORS			(16)		//!< AĎsꍇɎM~(ReadFile ̑̎s܂)
+#define IOCP_CLOSE_TIMEOUT		(3000)		//!< |[g폜ɔs̎M̊҂(ms)
+#define IOCP_WRITE_SIZE			(1024)		//!< WriteFile 1񂠂̍ő呗MTCY(܂Ƃ߂đ)
+#define IOCP_SEND_HIGH_WATER	(4096)		//!< M҂̃oCg𒴂 Send ͎󂯕tȂ(2ׂ̂)
+#define IOCP_SEND_LOW_WATER		(1024)		//!< t~AM҂̃oCgȉɂȂƎtĊJ
+#define IOCP_SEND_MAX_FRAMES	(256)		//!< M҂̃t[̏
+
+
+/**
+ * @enum	IOCP_OP
+ * @brief	񓯊I/O̎
+ */
+enum IOCP_OP {
+	IOCP_OP_READ = 0,						//!< ReadFile
+	IOCP_OP_WRITE,							//!< WriteFile
+};
+
+/**
+ * @brief		M̒ʒm
+ * @param[in]	int nId			: |[gID
+ * @param[in]	DWORD dwTicket	: MŌ̃t[̃`Pbg(Send Ŏ擾l)
+ * @param[in]	BOOL bOk		: FALSE:Ms(st[͔j)
+ * @param[in]	PVOID pParam	: SetSendNotify Ŏw肵l
+ * @remarks		[J[XbhĂ΂܂BR[obNŒԂ̏͂ȂłB
+ */
+typedef void (*IOCP_SEND_CALLBACK)(int nId, DWORD dwTicket, BOOL bOk, PVOID pParam);
+
+/**
+ * @brief		M̒ʒm
+ * @param[in]	int nId			: |[gID
+ * @param[in]	int nBytes		: Oobt@֏񂾃oCg(bOk=FALSE ̏ꍇ0)
+ * @param[in]	BOOL bOk		: FALSE:As(IOCP_MAX_ERRORS )ɂM~
+ *								  (Ȍ͎MȂ߁ARemovePort  AddPort ŊJ)
+ * @param[in]	PVOID pParam	: SetRecvNotify Ŏw肵l
+ * @remarks		[J[XbhĂ΂܂BR[obNŒԂ̏ERemovePort ͂ȂłB
+ */
+typedef void (*IOCP_RECV_CALLBACK)(int nId, int nBytes, BOOL bOk, PVOID pParam);
+
+
+struct IOCP_PORT;
+
+/**
+ * @struct	IOCP_IO
+ * @brief	񓯊I/Őʕ(pPbg OVERLAPPED ʂ𔻒肷)
+ */
+struct IOCP_IO {
+	OVERLAPPED			stOv;								//!< 񓯊I/O(擪ɒu)
+	IOCP_OP				enOp;								//!< 
+	IOCP_PORT*			pstPort;							//!< |[g
+};
+
+/**
+ * @struct	IOCP_READ
+ * @brief	s̎Mv(1񕪂 ReadFile)
+ */
+struct IOCP_READ : IOCP_IO {
+	DWORD				dwSeq;								//!< s̒ʂԍ
+	DWORD				dwBytes;							//!< MoCg
+	BOOL				bIssued;							//!< s(҂)
+	BOOL				bDone;								//!< ς(O̎M̔zM҂)
+	unsigned char		abyBuff[IOCP_READ_SIZE];			//!< Mobt@
+};
+
+/**
+ * @struct	IOCP_WRITE
+ * @brief	Mv(|[g1AML[ot[)
+ */
+struct IOCP_WRITE : IOCP_IO {
+	int					nLength;							//!< Mobt@̃oCg
+	int					nOffset;							//!< Mς݂̃oCg(^CAEgœr܂őMꍇ̑)
+	unsigned char		abyBuff[IOCP_WRITE_SIZE];			//!< Mobt@
+};
+
+/**
+ * @struct	IOCP_SEND_NOTIFY
+ * @brief	M̒ʒme(bNOŒʒm邽߂̎ʂ)
+ */
+struct IOCP_SEND_NOTIFY {
+	int					nId;								//!< |[gID
+	DWORD				dwTicket;							//!< MŌ̃t[̃`Pbg
+	IOCP_SEND_CALLBACK	pfnCallback;						//!< R[obN
+	PVOID				pParam;								//!< R[obN̈
+	HANDLE				hEvent;								//!< MŃVOiɂCxg
+	volatile DWORD*		pdwSendSeq;							//!< ҋ@̃XbhNAhX
+};
+
+/**
+ * @struct	IOCP_PORT
+ * @brief	|[g̎M(L[Ƃ IOCP ɓo^)
+ */
+struct IOCP_PORT {
+	int					nId;								//!< |[gID(AddPort ̖߂l)
+	HANDLE				hComm;								//!< COM|[gnh
+	int					nReadSize;							//!< ReadFile 1񂠂̎MTCY
+	CByteRingBuffer*	pcRecvBuff;							//!< MOobt@
+	CLockCS<>			cLock;								//!< M̔r
+	IOCP_READ			astRead[IOCP_READS_PER_PORT];		//!< Mv
+	DWORD				dwIssueSeq;							//!< ɔsM̒ʂԍ
+	DWORD				dwDeliverSeq;						//!< ɃOobt@֏ގM̒ʂԍ
+	int					nReading;							//!< s()̎M
+	int					nPending;							//!< s̎MEMƎs̒ʒm̐(0 ŉł)
+	int					nErrors;							//!< AĎs
+	BOOL				bRecvStopped;						//!< AsɂM~(ʒmς)
+	BOOL				bClosing;							//!< 폜(MĔsȂ)
+	IOCP_RECV_CALLBACK	pfnRecvCallback;					//!< M̃R[obN
+	PVOID				pRecvParam;							//!< R[obN̈
+	HANDLE				hRecvEvent;							//!< MEM~ŃVOiɂCxg
+	HANDLE				hIdleEvent;							//!< 폜ɔs̎MȂƃVOi
+	// M
+	IOCP_WRITE			stWrite;							//!< Mv
+	CByteRingBuffer*	pcSendBuff;							//!< ML[(cLock ł̂ݎgp)
+	BOOL				bWriting;							//!< WriteFile s
+	BOOL				bSendBlocked;						//!< ʂ𒴂ߎt~
+	LONGLONG			llQueuedBytes;						//!< Send Ŏ󂯕t݌voCg
+	LONGLONG			llDoneBytes;						//!< M(܂͎sŔj)݌voCg
+	LONGLONG			allFrameEnd[IOCP_SEND_MAX_FRAMES];	//!< M҂t[̏I[(llQueuedBytes ̒l)
+	int					nFrameHead;							//!< allFrameEnd ̐擪
+	int					nFrameCount;						//!< M҂̃t[
+	DWORD				dwTicket;							//!< ŌɎ󂯕tt[̃`Pbg
+	DWORD				dwTicketDone;						//!< MŌ̃t[̃`Pbg
+	volatile DWORD		dwSendSeq;							//!< MԂ̍XV(WaitOnAddress ŊĎ)
+	IOCP_SEND_CALLBACK	pfnSendCallback;					//!< M̃R[obN
+	PVOID				pSendParam;							//!< R[obN̈
+	HANDLE				hSendEvent;							//!< MŃVOiɂCxg
+	// v
+	CSerialStats*		pcStats;							//!< M̓v
+	LONGLONG			llSendRefused;						//!< L[ʂ̂ߎ󂯕tȂ Send ̉
+};
+
+
+/**
+ * @class	CSerialIocp
+ * @brief	I/O|[gɂ镡COM|[g̎MGW
+ * @remarks
+ *		Start  AddPort(|[g)  (M)  RemovePort/Stop ̏Ɏgp܂B
+ *		[J[Xbh͕łA|[g̊̓|[g̃NeBJZNV
+ *		񉻂AReadFile ̔sɃOobt@֏ނ߁AMf[^͓̏ւ܂B
+ *		Oobt@ RING_MODE_SPSC ō쐬܂(݂̓|[gɒ񉻂ꂽ[J[A
+ *		Ǐo1̃Xbĥ݂ƂĂ)B
+ *		M^CAEǵu1oCgłM瑦AMȂ IOCP_READ_TIMEOUT 0oCgv
+ *		Ƃ܂(vt@C̎MC^[o҂ɁAM珇ɃOobt@֓n)B
+ *		M̓|[g WriteFile 1sAs Send ꂽt[͑ML[ɗ߂
+ *		 WriteFile ł܂Ƃ߂đM܂BM҂ IOCP_SEND_HIGH_WATER 𒴂ꍇASend 
+ *		0ԂĎ󂯕t܂(IOCP_SEND_LOW_WATER ȉɌ܂ŁBWaitSendSpace őҋ@ł܂)B
+ */
+class CSerialIocp
+{
+private:
+	HANDLE				m_hIocp;							//!< I/O|[g
+	HANDLE				m_ahWorker[IOCP_MAX_WORKERS];		//!< [J[Xbh
+	int					m_nWorkers;							//!< [J[Xbh
+	DWORD_PTR			m_dwpAffinity;						//!< [J[̃AtBjeB}XN(0:ݒ肵Ȃ)
+	int					m_nPriority;						//!< [J[̗Dx(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+	char				m_szMmcssTask[THREAD_MMCSS_SIZE];	//!< [J[o^ MMCSS ̃^XN(:o^Ȃ)
+	IOCP_PORT*			m_apPort[IOCP_MAX_PORTS];			//!< o^̃|[g(NULL:)
+	CLockCS<>			m_cLock;							//!< m_apPort ̔r
+
+public:
+	CSerialIocp();
+	~CSerialIocp();
+
+	int					SetThreadAttributes(DWORD_PTR dwpAffinity, int nPriority = THREAD_PRIORITY_NONE, const char* szMmcssTask = NULL);
+	int					Start(int nWorkers = 0);
+	void				Stop();
+	int					AddPort(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName, int nRingSize = IOCP_RING_SIZE, SERIAL_PROFILE enProfile = SERIAL_PROFILE_BALANCED);
+	int					RemovePort(int nId);
+
+	int					Send(int nId, const unsigned char* pbyData, int nLen, DWORD* pdwTicket = NULL);
+	int					SetSendNotify(int nId, IOCP_SEND_CALLBACK pfnCallback, PVOID pParam, HANDLE hEvent);
+	int					SetRecvNotify(int nId, IOCP_RECV_CALLBACK pfnCallback, PVOID pParam, HANDLE hEvent);
+	int					WaitSent(int nId, DWORD dwTicket, DWORD dwTimeout);
+	int					WaitSendSpace(int nId, int nLen, DWORD dwTimeout);
+
+	CByteRingBuffer*	GetRecvBuffer(int nId);
+	CSerialStats*		GetStats(int nId);
+	HANDLE				GetHandle(int nId);
+	int					GetWorkerCount() { return m_nWorkers; }
+	LONGLONG			GetRecvCount(int nId);
+	LONGLONG			GetDropCount(int nId);
+	LONGLONG			GetErrorCount(int nId);
+	LONGLONG			GetSendPendingCount(int nId);
+	LONGLONG			GetSendErrorCount(int nId);
+	LONGLONG			GetSendRefusedCount(int nId);
+
+private:
+	/**
+	 * @enum	COUNTER
+	 * @brief	getCounter Ŏ擾铝vl
+	 */
+	enum COUNTER {
+		COUNTER_RECV = 0,					//!< MoCg
+		COUNTER_DROP,						//!< MOobt@tŔjoCg
+		COUNTER_READ_ERROR,					//!< Ms
+		COUNTER_SEND_PENDING,				//!< M҂̃oCg
+		COUNTER_SEND_ERROR,					//!< Ms
+		COUNTER_SEND_REFUSED,				//!< 󂯕tȂ Send ̉
+	};
+
+	static unsigned __stdcall	workerThread(PVOID pParam);
+	void				worker();
+	void				complete(IOCP_PORT* pstPort, IOCP_READ* pstRead, DWORD dwBytes, BOOL bOk);
+	BOOL				issueRead(IOCP_PORT* pstPort, IOCP_READ* pstRead);
+	void				issueIdleReads(IOCP_PORT* pstPort);
+	void				completeWrite(IOCP_PORT* pstPort, DWORD dwBytes, BOOL bOk);
+	BOOL				startWrite(IOCP_PORT* pstPort);
+	void				finishSend(IOCP_PORT* pstPort, int nBytes);
+	void				getNotify(IOCP_PORT* pstPort, IOCP_SEND_NOTIFY* pstNotify);
+	static void			notifySend(const IOCP_SEND_NOTIFY* pstNotify, BOOL bOk);
+	int					waitSend(int nId, BOOL bSpace, DWORD dwValue, DWORD dwTimeout);
+	int					closePort(IOCP_PORT* pstPort);
+	IOCP_PORT*			getPort(int nId);
+	IOCP_PORT*			lockPort(int nId);
+	LONGLONG			getCounter(int nId, COUNTER enKind);
+};
+
+
+/**
+ * @fn			RXgN^
+ */
+CSerialIocp::CSerialIocp()
+{
+	m_hIocp = NULL;
+	m_nWorkers = 0;
+	m_dwpAffinity = 0;
+	m_nPriority = THREAD_PRIORITY_NONE;
+	m_szMmcssTask[0] = '\0';
+	memset(m_ahWorker, 0, sizeof(m_ahWorker));
+	memset(m_apPort, 0, sizeof(m_apPort));
+}
+
+/**
+ * @fn			fXgN^
+ * @remarks		o^̃|[g͑Sĕ܂B
+ */
+CSerialIocp::~CSerialIocp()
+{
+	Stop();
+}
+
+/**
+ * @fn			SetThreadAttributes
+ * @brief		[J[Xbh̑ݒ肷(Start OɌĂԂ)
+ * @param[in]	DWORD_PTR dwpAffinity	: AtBjeB}XN(0:ݒ肵ȂBCThread::GetCacheMask/GetNumaMask Ŏ擾)
+ * @param[in]	int nPriority			: Dx(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+ * @param[in]	const char* szMmcssTask	: MMCSS ̃^XN("Pro Audio", "Capture" BNULL:o^Ȃ)
+ * @return		0:, -1:s(Jnς݁A܂̓^XN)
+ * @remarks
+ *		Mf[^ǂݏoXbhƓ L2 NX^(܂ NUMA m[h)ɐƁA
+ *		[J[񂾃Oobt@̃f[^ǏoLbVQƂł܂B
+ */
+int CSerialIocp::SetThreadAttributes(DWORD_PTR dwpAffinity, int nPriority/*=THREAD_PRIORITY_NONE*/, const char* szMmcssTask/*=NULL*/)
+{
+	if (m_hIocp != NULL || (szMmcssTask != NULL && THREAD_MMCSS_SIZE <= strlen(szMmcssTask))) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	m_dwpAffinity = dwpAffinity;
+	m_nPriority = nPriority;
+	m_szMmcssTask[0] = '\0';
+	if (szMmcssTask != NULL) {
+		strncpy(m_szMmcssTask, szMmcssTask, sizeof(m_szMmcssTask));
+	}
+	return 0;
+}
+
+/**
+ * @fn			Start
+ * @brief		I/O|[g쐬A[J[XbhJn
+ * @param[in]	int nWorkers	: [J[Xbh(0:CPU IOCP_DEFAULT_WORKERS ̏)
+ * @return		0:, -1:s
+ * @remarks		VAM͏y߁A|[gɊւ炸̃Xbhŏ\łB
+ */
+int CSerialIocp::Start(int nWorkers/*=0*/)
+{
+	if (m_hIocp != NULL) {
+		// Jnς
+		return -1;
+	}
+	if (nWorkers <= 0) {
+		SYSTEM_INFO stInfo;
+		GetSystemInfo(&stInfo);
+		nWorkers = (int)stInfo.dwNumberOfProcessors;
+		if (IOCP_DEFAULT_WORKERS < nWorkers) {
+			nWorkers = IOCP_DEFAULT_WORKERS;
+		}
+	}
+	if (IOCP_MAX_WORKERS < nWorkers) {
+		nWorkers = IOCP_MAX_WORKERS;
+	}
+
+	// s = [J[Xbh
+	m_hIocp = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, nWorkers);
+	if (m_hIocp == NULL) {
+		return -1;
+	}
+
+	for (m_nWorkers = 0; m_nWorkers < nWorkers; m_nWorkers++) {
+		// KpĂJn
+		HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, workerThread, this, CREATE_SUSPENDED, NULL);
+		if (hThread == NULL) {
+			Stop();
+			return -1;
+		}
+		CThread::ApplyAttributes(hThread, m_dwpAffinity, -1, m_nPriority, L"CSerialIocp worker");
+		ResumeThread(hThread);
+		m_ahWorker[m_nWorkers] = hThread;
+	}
+	return 0;
+}
+
+/**
+ * @fn			Stop
+ * @brief		S|[gA[J[XbhI
+ */
+void CSerialIocp::Stop()
+{
+	if (m_hIocp == NULL) {
+		return;
+	}
+
+	for (int i = 0; i < IOCP_MAX_PORTS; i++) {
+		if (m_apPort[i] != NULL) {
+			RemovePort(i);
+		}
+	}
+
+	// L[ 0 / OVERLAPPED IvƂ
+	for (int i = 0; i < m_nWorkers; i++) {
+		PostQueuedCompletionStatus(m_hIocp, 0, 0, NULL);
+	}
+	if (0 < m_nWorkers) {
+		WaitForMultipleObjects(m_nWorkers, m_ahWorker, TRUE, INFINITE);
+	}
+	for (int i = 0; i < m_nWorkers; i++) {
+		CloseHandle(m_ahWorker[i]);
+		m_ahWorker[i] = NULL;
+	}
+	m_nWorkers = 0;
+
+	CloseHandle(m_hIocp);
+	m_hIocp = NULL;
+}
+
+/**
+ * @fn			AddPort
+ * @brief		COM|[gJI/O|[gɊ֘AtAMJn
+ * @param[in]	const char* szPort	: |[g("COM4" )
+ * @param[in]	int nBaud			: {[[g
+ * @param[in]	int nDataBit		: f[^rbg
+ * @param[in]	int nParity			: peB
+ * @param[in]	int nStopBit		: Xgbvrbg
+ * @param[in]	const char* szLogName	: Ot@C(open_serial_ex ̎sOANULL:o͂Ȃ)
+ * @param[in]	int nRingSize		: MOobt@TCY(ReadFile 1̎MTCY̗eʂ猈߂)
+ * @param[in]	SERIAL_PROFILE enProfile	: hCõL[TCỸvt@C(M^CAEg͖{NXŐݒ)
+ * @return		0`:|[gID, -1:s
+ * @remarks		Start ̌ɌĂłB
+ */
+int CSerialIocp::AddPort(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName, int nRingSize/*=IOCP_RING_SIZE*/, SERIAL_PROFILE enProfile/*=SERIAL_PROFILE_BALANCED*/)
+{
+	if (m_hIocp == NULL || szPort == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	// hCõL[TCYEM^CAEg̓vt@Cɏ]AM^CAEĝݕύX
+	// 1oCgłM犮AMȂ IOCP_READ_TIMEOUT 0oCg
+	SERIAL_CONFIG stConfig;
+	serial_make_config(&stConfig, enProfile, nBaud, nRingSize);
+	stConfig.dwEventMask = 0;
+	stConfig.stTimeouts.ReadIntervalTimeout = MAXDWORD;
+	stConfig.stTimeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+	stConfig.stTimeouts.ReadTotalTimeoutConstant = IOCP_READ_TIMEOUT;
+
+	HANDLE hComm = open_serial_ex(szPort, nBaud, nDataBit, nParity, nStopBit, TRUE, &stConfig, szLogName);
+	if (hComm == NULL) {
+		return -1;
+	}
+
+	IOCP_PORT* pstPort = new IOCP_PORT();		// l(o0AcLock ̓RXgN^ŏ)
+	pstPort->hComm = hComm;
+	pstPort->pcRecvBuff = new CByteRingBuffer(nRingSize, CByteRingBuffer::RING_MODE_SPSC);
+	// s̎MSăOobt@Ɏ܂TCYœǂ
+	pstPort->nReadSize = pstPort->pcRecvBuff->GetBuffSize() / IOCP_READS_PER_PORT;
+	if (stConfig.nReadSize < pstPort->nReadSize) {
+		pstPort->nReadSize = stConfig.nReadSize;
+	}
+	if (IOCP_READ_SIZE < pstPort->nReadSize) {
+		pstPort->nReadSize = IOCP_READ_SIZE;
+	}
+	if (pstPort->nReadSize < 1) {
+		pstPort->nReadSize = 1;
+	}
+	pstPort->pcSendBuff = new CByteRingBuffer(IOCP_SEND_HIGH_WATER, CByteRingBuffer::RING_MODE_SPSC);
+#if _DEBUG
+	// Send ͑M҂ IOCP_SEND_HIGH_WATER ܂łɗ}邽߁AML[ɕK肫
+	assert(IOCP_SEND_HIGH_WATER <= pstPort->pcSendBuff->GetBuffSize());
+#endif
+	pstPort->pcStats = new CSerialStats(pstPort->pcRecvBuff);
+	pstPort->stWrite.enOp = IOCP_OP_WRITE;
+	pstPort->stWrite.pstPort = pstPort;
+	pstPort->hIdleEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	for (int i = 0; i < IOCP_READS_PER_PORT; i++) {
+		pstPort->astRead[i].enOp = IOCP_OP_READ;
+		pstPort->astRead[i].pstPort = pstPort;
+	}
+
+	// s closePort ͔s̎M̊҂߁Am_cLock ̊OŌĂ
+	int id = -1;
+	BOOL bStarted = FALSE;
+	{
+		CLockGuard<CLockCS<> > cGuard(m_cLock);
+		for (int i = 0; i < IOCP_MAX_PORTS; i++) {
+			if (m_apPort[i] == NULL) {
+				id = i;
+				break;
+			}
+		}
+		if (0 <= id && CreateIoCompletionPort(hComm, m_hIocp, (ULONG_PTR)pstPort, 0) != NULL) {
+			pstPort->nId = id;
+			m_apPort[id] = pstPort;
+
+			// Mv𔭍sĂ(ȍ~͊ɍĔs)
+			{
+				CLockGuard<CLockCS<> > cPortGuard(pstPort->cLock);
+				issueIdleReads(pstPort);
+				bStarted = (0 < pstPort->nReading);
+			}
+			if (!bStarted) {
+				// 1słȂ(ReadFile Ɏs)
+				m_apPort[id] = NULL;
+			}
+		}
+	}
+	if (!bStarted) {
+		closePort(pstPort);
+		return -1;
+	}
+
+	return id;
+}
+
+/**
+ * @fn			RemovePort
+ * @brief		M~COM|[g
+ * @param[in]	int nId		: |[gID
+ * @return		0:, -1:s
+ * @remarks
+ *		Oobt@폜邽߁AǏõXbh͐ɒ~ĂB
+ *		s̎M CancelIoEx ŎA߂܂ő҂܂B
+ */
+int CSerialIocp::RemovePort(int nId)
+{
+	IOCP_PORT* pstPort = NULL;
+	{
+		CLockGuard<CLockCS<> > cGuard(m_cLock);
+		pstPort = getPort(nId);
+		if (pstPort != NULL) {
+			m_apPort[nId] = NULL;
+		}
+	}
+
+	if (pstPort == NULL) {
+		return -1;
+	}
+	return closePort(pstPort);
+}
+
+/**
+ * @fn			GetRecvBuffer
+ * @brief		|[g̎MOobt@擾
+ * @param[in]	int nId		: |[gID
+ * @return		MOobt@(NULL:s)
+ */
+CByteRingBuffer* CSerialIocp::GetRecvBuffer(int nId)
+{
+	CLockGuard<CLockCS<> > cGuard(m_cLock);
+	IOCP_PORT* pstPort = getPort(nId);
+	return (pstPort != NULL) ? pstPort->pcRecvBuff : NULL;
+}
+
+/**
+ * @fn			GetStats
+ * @brief		|[g̓v擾
+ * @param[in]	int nId		: |[gID
+ * @return		v(NULL:sARemovePort ܂ŗL)
+ */
+CSerialStats* CSerialIocp::GetStats(int nId)
+{
+	CLockGuard<CLockCS<> > cGuard(m_cLock);
+	IOCP_PORT* pstPort = getPort(nId);
+	return (pstPort != NULL) ? pstPort->pcStats : NULL;
+}
+
+/**
+ * @fn			GetHandle
+ * @brief		|[gCOM|[gnh擾(MEClearCommError Ɏgp)
+ * @param[in]	int nId		: |[gID
+ * @return		COM|[gnh(NULL:s)
+ */
+HANDLE CSerialIocp::GetHandle(int nId)
+{
+	CLockGuard<CLockCS<> > cGuard(m_cLock);
+	IOCP_PORT* pstPort = getPort(nId);
+	return (pstPort != NULL) ? pstPort->hComm : NULL;
+}
+
+/**
+ * @fn			Send
+ * @brief		t[𑗐ML[ɐς(M̊͑҂Ȃ)
+ * @param[in]	int nId						: |[gID
+ * @param[in]	const unsigned char* pbyData	: Mf[^
+ * @param[in]	int nLen					: Mf[^̃oCg(1`IOCP_SEND_HIGH_WATER)
+ * @param[out]	DWORD* pdwTicket			: 󂯕tt[̃`Pbg(NULL:sv)
+ * @return		nLen:󂯕t, 0:M҂ʂ̂ߎ󂯕tȂ, -1:s
+ * @remarks
+ *		t[͕ɑSĎ󂯕t邩ASĎ󂯕tȂ̂ǂ炩łB
+ *		`Pbg̓|[g̒ʂԍŁAWaitSent ⑗M̒ʒmŊmFł܂B
+ */
+int CSerialIocp::Send(int nId, const unsigned char* pbyData, int nLen, DWORD* pdwTicket/*=NULL*/)
+{
+	if (pbyData == NULL || nLen <= 0 || IOCP_SEND_HIGH_WATER < nLen) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	IOCP_PORT* pstPort = lockPort(nId);
+	if (pstPort == NULL) {
+		return -1;
+	}
+
+	int ret = nLen;
+	BOOL bFailed = FALSE;
+	IOCP_SEND_NOTIFY stNotify;
+	{
+		CLockGuard<CLockCS<> > cGuard(pstPort->cLock, TRUE);
+		LONGLONG llPending = pstPort->llQueuedBytes - pstPort->llDoneBytes;
+
+		if (pstPort->bClosing) {
+			ret = -1;
+		}
+		else if (pstPort->bSendBlocked && IOCP_SEND_LOW_WATER < llPending) {
+			// t~(ᐅʂ܂Ō̂҂)
+			ret = 0;
+		}
+		else if (IOCP_SEND_HIGH_WATER < llPending + nLen || IOCP_SEND_MAX_FRAMES <= pstPort->nFrameCount) {
+			pstPort->bSendBlocked = TRUE;
+			ret = 0;
+		}
+		else if (pstPort->pcSendBuff->GetBuffSize() - pstPort->pcSendBuff->Count() < nLen) {
+			// ML[̗e(IOCP_SEND_HIGH_WATER ȏ)̑O񂪕Ă
+			// ꕔςނƑMς݃oCǧvZ邽߁Aς܂ɎsƂ
+#if _DEBUG
+			assert(FALSE);
+#endif
+			ret = -1;
+		}
+		else {
+			pstPort->bSendBlocked = FALSE;
+			pstPort->pcSendBuff->Push(pbyData, nLen);
+			pstPort->llQueuedBytes += nLen;
+			pstPort->allFrameEnd[(pstPort->nFrameHead + pstPort->nFrameCount) % IOCP_SEND_MAX_FRAMES] = pstPort->llQueuedBytes;
+			pstPort->nFrameCount++;
+			pstPort->dwTicket++;
+			if (pdwTicket != NULL) {
+				*pdwTicket = pstPort->dwTicket;
+			}
+			// WriteFile sȂÅɂ܂Ƃ߂đM
+			if (!pstPort->bWriting) {
+				bFailed = startWrite(pstPort);
+				getNotify(pstPort, &stNotify);
+			}
+		}
+		if (ret == 0) {
+			pstPort->llSendRefused++;
+		}
+	}
+
+	if (bFailed) {
+		notifySend(&stNotify, FALSE);
+	}
+	return ret;
+}
+
+/**
+ * @fn			SetSendNotify
+ * @brief		M̒ʒmݒ肷
+ * @param[in]	int nId							: |[gID
+ * @param[in]	IOCP_SEND_CALLBACK pfnCallback	: R[obN(NULL:Ă΂Ȃ)
+ * @param[in]	PVOID pParam					: R[obN̈
+ * @param[in]	HANDLE hEvent					: M SetEvent Cxg(NULL:gpȂ)
+ * @return		0:, -1:s
+ * @remarks		Cxg͕|[gŋpł܂(ǂ̃|[g GetSendPendingCount ŊmF)B
+ */
+int CSerialIocp::SetSendNotify(int nId, IOCP_SEND_CALLBACK pfnCallback, PVOID pParam, HANDLE hEvent)
+{
+	IOCP_PORT* pstPort = lockPort(nId);
+	if (pstPort == NULL) {
+		return -1;
+	}
+	CLockGuard<CLockCS<> > cGuard(pstPort->cLock, TRUE);
+	pstPort->pfnSendCallback = pfnCallback;
+	pstPort->pSendParam = pParam;
+	pstPort->hSendEvent = hEvent;
+	return 0;
+}
+
+/**
+ * @fn			SetRecvNotify
+ * @brief		M̒ʒmݒ肷
+ * @param[in]	int nId							: |[gID
+ * @param[in]	IOCP_RECV_CALLBACK pfnCallback	: R[obN(NULL:Ă΂Ȃ)
+ * @param[in]	PVOID pParam					: R[obN̈
+ * @param[in]	HANDLE hEvent					: Oobt@ւ̏݁EM~ SetEvent Cxg(NULL:gpȂ)
+ * @return		0:, -1:s
+ * @remarks
+ *		M~(bOk=FALSE)̓|[g1񂾂ʒm܂BݒOɒ~Ăꍇ͐ݒ莞ɂ͒ʒmȂ߁A
+ *		AddPort ̒ɐݒ肵ĂB
+ */
+int CSerialIocp::SetRecvNotify(int nId, IOCP_RECV_CALLBACK pfnCallback, PVOID pParam, HANDLE hEvent)
+{
+	IOCP_PORT* pstPort = lockPort(nId);
+	if (pstPort == NULL) {
+		return -1;
+	}
+	CLockGuard<CLockCS<> > cGuard(pstPort->cLock, TRUE);
+	pstPort->pfnRecvCallback = pfnCallback;
+	pstPort->pRecvParam = pParam;
+	pstPort->hRecvEvent = hEvent;
+	return 0;
+}
+
+/**
+ * @fn			WaitSent
+ * @brief		w肵`Pbg̃t[܂őM̂҂
+ * @param[in]	int nId				: |[gID
+ * @param[in]	DWORD dwTicket		: Send Ŏ擾`Pbg
+ * @param[in]	DWORD dwTimeout		: ^CAEg(ms, INFINITE:)
+ * @return		0:, -1:^CAEg܂͎s
+ * @remarks		ҋ@ RemovePort ȂłB
+ */
+int CSerialIocp::WaitSent(int nId, DWORD dwTicket, DWORD dwTimeout)
+{
+	return waitSend(nId, FALSE, dwTicket, dwTimeout);
+}
+
+/**
+ * @fn			WaitSendSpace
+ * @brief		w肵oCg Send 󂯕t܂ő҂
+ * @param[in]	int nId				: |[gID
+ * @param[in]	int nLen			: MoCg
+ * @param[in]	DWORD dwTimeout		: ^CAEg(ms, INFINITE:)
+ * @return		0:t\, -1:^CAEg܂͎s
+ * @remarks		ҋ@ RemovePort ȂłB
+ */
+int CSerialIocp::WaitSendSpace(int nId, int nLen, DWORD dwTimeout)
+{
+	if (nLen <= 0 || IOCP_SEND_HIGH_WATER < nLen) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	return waitSend(nId, TRUE, (DWORD)nLen, dwTimeout);
+}
+
+//! Oobt@ɏ񂾃oCg擾(-1:s)
+LONGLONG CSerialIocp::GetRecvCount(int nId)
+{
+	return getCounter(nId, COUNTER_RECV);
+}
+
+//! Oobt@tŔjoCg擾(-1:s)
+LONGLONG CSerialIocp::GetDropCount(int nId)
+{
+	return getCounter(nId, COUNTER_DROP);
+}
+
+//! sM̉񐔂擾(-1:s)
+LONGLONG CSerialIocp::GetErrorCount(int nId)
+{
+	return getCounter(nId, COUNTER_READ_ERROR);
+}
+
+//! M҂(M܂)̃oCg擾(-1:s)
+LONGLONG CSerialIocp::GetSendPendingCount(int nId)
+{
+	return getCounter(nId, COUNTER_SEND_PENDING);
+}
+
+//! sM̉񐔂擾(-1:s)
+LONGLONG CSerialIocp::GetSendErrorCount(int nId)
+{
+	return getCounter(nId, COUNTER_SEND_ERROR);
+}
+
+//! L[ʂ̂ߎ󂯕tȂ Send ̉񐔂擾(-1:s)
+LONGLONG CSerialIocp::GetSendRefusedCount(int nId)
+{
+	return getCounter(nId, COUNTER_SEND_REFUSED);
+}
+
+/**
+ * @fn			workerThread
+ * @brief		[J[Xbh̃Gg|Cg
+ * @param[in]	PVOID pParam	: CSerialIocp*
+ * @return		0
+ */
+unsigned __stdcall CSerialIocp::workerThread(PVOID pParam)
+{
+	CSerialIocp* pcIocp = (CSerialIocp*)pParam;
+	HANDLE hMmcss = CThread::EnterMmcss(pcIocp->m_szMmcssTask);
+	pcIocp->worker();
+	CThread::LeaveMmcss(hMmcss);
+	return 0;
+}
+
+/**
+ * @fn			worker
+ * @brief		I/OpPbgoAM
+ * @remarks		L[ 0 / OVERLAPPED ̃pPbg(Stop )ŏI܂B
+ */
+void CSerialIocp::worker()
+{
+	for (;;) {
+		DWORD dwBytes = 0;
+		ULONG_PTR ulKey = 0;
+		LPOVERLAPPED pOv = NULL;
+		BOOL bOk = GetQueuedCompletionStatus(m_hIocp, &dwBytes, &ulKey, &pOv, INFINITE);
+		if (pOv == NULL) {
+			if (!bOk || ulKey == 0) {
+				// IvA܂͊|[gꂽ
+				break;
+			}
+			continue;
+		}
+		if (((IOCP_IO*)pOv)->enOp == IOCP_OP_WRITE) {
+			completeWrite((IOCP_PORT*)ulKey, dwBytes, bOk);
+		}
+		else {
+			complete((IOCP_PORT*)ulKey, (IOCP_READ*)pOv, dwBytes, bOk);
+		}
+	}
+}
+
+/**
+ * @fn			complete
+ * @brief		M
+ * @param[in]	IOCP_PORT* pstPort		: M|[g
+ * @param[in]	IOCP_READ* pstRead		: Mv
+ * @param[in]	DWORD dwBytes			: MoCg
+ * @param[in]	BOOL bOk				: FALSE:Ms(܂)
+ * @remarks
+ *		|[g̎M͕ʂ̃[J[œɊoƂ邽߁AM
+ *		Uς݂ƂAs(dwDeliverSeq)ɑ̂烊Oobt@֏ōĔs܂B
+ *		sMł(dwBytes)͏݂܂B
+ *		M̒ʒm(SetRecvNotify)̓bNOōs܂BAsŔs̎MȂꍇ
+ *		M~(bOk=FALSE)ʒm܂B
+ */
+void CSerialIocp::complete(IOCP_PORT* pstPort, IOCP_READ* pstRead, DWORD dwBytes, BOOL bOk)
+{
+	// ʒm̓bNOōs߁AʒmɎgl̓bNŎoĂ
+	int nId = 0;
+	int nDelivered = 0;
+	BOOL bStopped = FALSE;
+	IOCP_RECV_CALLBACK pfnCallback = NULL;
+	PVOID pParam = NULL;
+	HANDLE hEvent = NULL;
+	BOOL bNotify = FALSE;
+	{
+		CLockGuard<CLockCS<> > cGuard(pstPort->cLock);
+
+		pstPort->nReading--;
+		pstPort->nPending--;
+		pstRead->dwBytes = dwBytes;
+		pstRead->bIssued = FALSE;
+		pstRead->bDone = TRUE;
+		pstPort->pcStats->Add(SERIAL_STAT_READ_COMPLETIONS);
+		if (bOk) {
+			pstPort->nErrors = 0;
+		}
+		else if (!pstPort->bClosing) {
+			// fAbortOnError  ClearCommError ܂ňȍ~̎Ms
+			DWORD dwErrorMask = 0;
+			COMSTAT stComStat;
+			ClearCommError(pstPort->hComm, &dwErrorMask, &stComStat);
+			pstPort->nErrors++;
+			pstPort->pcStats->Add(SERIAL_STAT_READ_ERRORS);
+			pstPort->pcStats->AddCommErrors(dwErrorMask);
+		}
+
+		for (;;) {
+			IOCP_READ* pstNext = NULL;
+			for (int i = 0; i < IOCP_READS_PER_PORT; i++) {
+				if (pstPort->astRead[i].bDone && pstPort->astRead[i].dwSeq == pstPort->dwDeliverSeq) {
+					pstNext = &pstPort->astRead[i];
+					break;
+				}
+			}
+			if (pstNext == NULL) {
+				break;
+			}
+
+			if (0 < pstNext->dwBytes) {
+				int n = pstPort->pcRecvBuff->Push(pstNext->abyBuff, (int)pstNext->dwBytes);
+				if (n < 0) {
+					n = 0;
+				}
+				pstPort->pcStats->Add(SERIAL_STAT_BYTES_IN, n);
+				pstPort->pcStats->Add(SERIAL_STAT_DROP_BYTES, (LONGLONG)pstNext->dwBytes - n);
+				if (0 < n) {
+					pstPort->pcStats->Produced();
+					nDelivered += n;
+				}
+			}
+			pstNext->bDone = FALSE;
+			pstPort->dwDeliverSeq++;
+		}
+
+		// zMς݂̎MvƁAO̔sɎsMvĔs
+		if (!pstPort->bClosing) {
+			issueIdleReads(pstPort);
+		}
+
+		// sĔs̎MȂꍇ͎M~ʒm(1̂)
+		if (!pstPort->bClosing && !pstPort->bRecvStopped && pstPort->nReading == 0 && IOCP_MAX_ERRORS <= pstPort->nErrors) {
+			pstPort->bRecvStopped = TRUE;
+			bStopped = TRUE;
+		}
+
+		nId = pstPort->nId;
+		pfnCallback = pstPort->pfnRecvCallback;
+		pParam = pstPort->pRecvParam;
+		hEvent = pstPort->hRecvEvent;
+		bNotify = (0 < nDelivered || bStopped) && (pfnCallback != NULL || hEvent != NULL);
+		if (bNotify) {
+			// ʒmI܂ closePort |[gȂ悤ɂ
+			pstPort->nPending++;
+		}
+		else if (pstPort->bClosing && pstPort->nPending == 0) {
+			SetEvent(pstPort->hIdleEvent);
+		}
+	}
+
+	if (!bNotify) {
+		return;
+	}
+	if (hEvent != NULL) {
+		SetEvent(hEvent);
+	}
+	if (pfnCallback != NULL) {
+		if (0 < nDelivered) {
+			pfnCallback(nId, nDelivered, TRUE, pParam);
+		}
+		if (bStopped) {
+			pfnCallback(nId, 0, FALSE, pParam);
+		}
+	}
+
+	CLockGuard<CLockCS<> > cGuard(pstPort->cLock);
+	pstPort->nPending--;
+	if (pstPort->bClosing && pstPort->nPending == 0) {
+		SetEvent(pstPort->hIdleEvent);
+	}
+}
+
+/**
+ * @fn			issueRead
+ * @brief		Mv𔭍s
+ * @param[in]	IOCP_PORT* pstPort		: |[g
+ * @param[in]	IOCP_READ* pstRead		: Mv
+ * @return		TRUE:s, FALSE:s(As IOCP_MAX_ERRORS ɒB)
+ * @remarks
+ *		|[g̃bN(cLock)ŌĂł(ʂԍ̍̔Ԃ ReadFile ̔sv邽)B
+ *		ɊꍇpPbg邽߁A̓[J[ōs܂B
+ *		Ɏsꍇ͊pPbgȂ߁As񐔂𐔂čĔs܂B
+ */
+BOOL CSerialIocp::issueRead(IOCP_PORT* pstPort, IOCP_READ* pstRead)
+{
+	while (pstPort->nErrors < IOCP_MAX_ERRORS) {
+		memset(&pstRead->stOv, 0, sizeof(OVERLAPPED));
+		pstRead->dwBytes = 0;
+		pstRead->dwSeq = pstPort->dwIssueSeq;
+
+		if (ReadFile(pstPort->hComm, pstRead->abyBuff, pstPort->nReadSize, NULL, &pstRead->stOv)
+			|| GetLastError() == ERROR_IO_PENDING) {
+			pstPort->pcStats->Add(SERIAL_STAT_READS_ISSUED);
+			pstPort->dwIssueSeq++;
+			pstPort->nReading++;
+			pstPort->nPending++;
+			pstRead->bIssued = TRUE;
+			return TRUE;
+		}
+
+		// Ɏs: pPbg͓Ȃ߁AG[čĔs
+		DWORD dwErrorMask = 0;
+		COMSTAT stComStat;
+		ClearCommError(pstPort->hComm, &dwErrorMask, &stComStat);
+		pstPort->nErrors++;
+		pstPort->pcStats->Add(SERIAL_STAT_READ_ERRORS);
+		pstPort->pcStats->AddCommErrors(dwErrorMask);
+	}
+	return FALSE;
+}
+
+/**
+ * @fn			issueIdleReads
+ * @brief		słzM҂łȂMvSĔs
+ * @param[in]	IOCP_PORT* pstPort		: |[g
+ * @remarks
+ *		|[g̃bN(cLock)ŌĂłB
+ *		sɎsMv͎̊ɍĔs܂(As IOCP_MAX_ERRORS ɒB܂)B
+ */
+void CSerialIocp::issueIdleReads(IOCP_PORT* pstPort)
+{
+	for (int i = 0; i < IOCP_READS_PER_PORT; i++) {
+		IOCP_READ* pstRead = &pstPort->astRead[i];
+		if (!pstRead->bIssued && !pstRead->bDone && !issueRead(pstPort, pstRead)) {
+			break;
+		}
+	}
+}
+
+/**
+ * @fn			completeWrite
+ * @brief		MAML[ɗ܂f[^𑱂đM
+ * @param[in]	IOCP_PORT* pstPort		: M|[g
+ * @param[in]	DWORD dwBytes			: MoCg
+ * @param[in]	BOOL bOk				: FALSE:Ms(܂)
+ * @remarks
+ *		^CAEgœr܂őMꍇ͎cđM܂BsꍇAMobt@̎c͔j܂B
+ *		ʒm̓bNOōsA WriteFile ͒ʒm̌Ŕs܂(ʒm̏`PbgɂȂ悤)B
+ */
+void CSerialIocp::completeWrite(IOCP_PORT* pstPort, DWORD dwBytes, BOOL bOk)
+{
+	IOCP_WRITE* pstWrite = &pstPort->stWrite;
+	IOCP_SEND_NOTIFY stNotify;
+
+	{
+		CLockGuard<CLockCS<> > cGuard(pstPort->cLock);
+		int remain = pstWrite->nLength - pstWrite->nOffset;
+		int done = ((DWORD)remain < dwBytes) ? (remain) : ((int)dwBytes);
+		pstPort->pcStats->Add(SERIAL_STAT_WRITE_COMPLETIONS);
+		pstPort->pcStats->Add(SERIAL_STAT_BYTES_OUT, done);
+		if (!bOk) {
+			if (!pstPort->bClosing) {
+				DWORD dwErrorMask = 0;
+				COMSTAT stComStat;
+				ClearCommError(pstPort->hComm, &dwErrorMask, &stComStat);
+				pstPort->pcStats->Add(SERIAL_STAT_WRITE_ERRORS);
+				pstPort->pcStats->AddCommErrors(dwErrorMask);
+			}
+			done = remain;
+		}
+		pstWrite->nOffset += done;
+		finishSend(pstPort, done);
+		getNotify(pstPort, &stNotify);
+	}
+
+	notifySend(&stNotify, bOk);
+
+	// ʒmI܂ nPending 炳Ȃ(closePort |[gȂ悤)
+	BOOL bFailed = FALSE;
+	{
+		CLockGuard<CLockCS<> > cGuard(pstPort->cLock);
+		pstPort->nPending--;
+		if (pstPort->bClosing) {
+			pstPort->bWriting = FALSE;
+		}
+		else {
+			bFailed = startWrite(pstPort);
+			getNotify(pstPort, &stNotify);
+		}
+		if (pstPort->bClosing && pstPort->nPending == 0) {
+			SetEvent(pstPort->hIdleEvent);
+		}
+	}
+
+	if (bFailed) {
+		notifySend(&stNotify, FALSE);
+	}
+}
+
+/**
+ * @fn			startWrite
+ * @brief		Mobt@̎cA܂͑ML[̃f[^܂Ƃ߂ WriteFile őM
+ * @param[in]	IOCP_PORT* pstPort		: |[g
+ * @return		TRUE:WriteFile Ɏst[(ďoŃbNOʒm邱), FALSE:
+ * @remarks		|[g̃bN(cLock)ŌĂłBMf[^ bWriting  FALSE ɂ܂B
+ */
+BOOL CSerialIocp::startWrite(IOCP_PORT* pstPort)
+{
+	IOCP_WRITE* pstWrite = &pstPort->stWrite;
+	BOOL bFailed = FALSE;
+
+	while (TRUE) {
+		if (pstWrite->nLength <= pstWrite->nOffset) {
+			// ML[ɗ܂Ă镡̃t[1 WriteFile ɂ܂Ƃ߂
+			int n = pstPort->pcSendBuff->Pop(pstWrite->abyBuff, IOCP_WRITE_SIZE);
+			pstWrite->nOffset = 0;
+			pstWrite->nLength = (0 < n) ? (n) : (0);
+			if (n <= 0) {
+				pstPort->bWriting = FALSE;
+				break;
+			}
+		}
+
+		memset(&pstWrite->stOv, 0, sizeof(OVERLAPPED));
+		if (WriteFile(pstPort->hComm, pstWrite->abyBuff + pstWrite->nOffset, pstWrite->nLength - pstWrite->nOffset, NULL, &pstWrite->stOv)
+			|| GetLastError() == ERROR_IO_PENDING) {
+			// ɊꍇpPbg
+			pstPort->bWriting = TRUE;
+			pstPort->nPending++;
+			pstPort->pcStats->Add(SERIAL_STAT_WRITES_ISSUED);
+			break;
+		}
+
+		// Ɏs: Mobt@̃f[^͔jĎ
+		pstPort->pcStats->Add(SERIAL_STAT_WRITE_ERRORS);
+		finishSend(pstPort, pstWrite->nLength - pstWrite->nOffset);
+		pstWrite->nOffset = pstWrite->nLength;
+		bFailed = TRUE;
+	}
+	return bFailed;
+}
+
+/**
+ * @fn			finishSend
+ * @brief		M(܂͔j)oCgi߁AI[܂őMt[ɂ
+ * @param[in]	IOCP_PORT* pstPort		: |[g
+ * @param[in]	int nBytes				: MoCg
+ * @remarks		|[g̃bN(cLock)ŌĂłB
+ */
+void CSerialIocp::finishSend(IOCP_PORT* pstPort, int nBytes)
+{
+	pstPort->llDoneBytes += nBytes;
+	while (0 < pstPort->nFrameCount && pstPort->allFrameEnd[pstPort->nFrameHead] <= pstPort->llDoneBytes) {
+		pstPort->nFrameHead = (pstPort->nFrameHead + 1) % IOCP_SEND_MAX_FRAMES;
+		pstPort->nFrameCount--;
+		pstPort->dwTicketDone++;
+	}
+	pstPort->dwSendSeq++;
+}
+
+/**
+ * @fn			getNotify
+ * @brief		M̒ʒmeʂ(|[g̃bN(cLock)ŌĂԂ)
+ * @param[in]	IOCP_PORT* pstPort			: |[g
+ * @param[out]	IOCP_SEND_NOTIFY* pstNotify	: ʒme
+ */
+void CSerialIocp::getNotify(IOCP_PORT* pstPort, IOCP_SEND_NOTIFY* pstNotify)
+{
+	pstNotify->nId = pstPort->nId;
+	pstNotify->dwTicket = pstPort->dwTicketDone;
+	pstNotify->pfnCallback = pstPort->pfnSendCallback;
+	pstNotify->pParam = pstPort->pSendParam;
+	pstNotify->hEvent = pstPort->hSendEvent;
+	pstNotify->pdwSendSeq = &pstPort->dwSendSeq;
+}
+
+/**
+ * @fn			notifySend
+ * @brief		Mʒm(ҋ@̃XbhACxgAR[obN)
+ * @param[in]	const IOCP_SEND_NOTIFY* pstNotify	: ʒme
+ * @param[in]	BOOL bOk							: FALSE:Ms
+ */
+void CSerialIocp::notifySend(const IOCP_SEND_NOTIFY* pstNotify, BOOL bOk)
+{
+	::WakeByAddressAll((PVOID)pstNotify->pdwSendSeq);
+	if (pstNotify->hEvent != NULL) {
+		SetEvent(pstNotify->hEvent);
+	}
+	if (pstNotify->pfnCallback != NULL) {
+		pstNotify->pfnCallback(pstNotify->nId, pstNotify->dwTicket, bOk, pstNotify->pParam);
+	}
+}
+
+/**
+ * @fn			waitSend
+ * @brief		M܂͑ML[̋󂫂҂
+ * @param[in]	int nId				: |[gID
+ * @param[in]	BOOL bSpace			: TRUE:dwValue oCg̋, FALSE:`Pbg dwValue ̑M
+ * @param[in]	DWORD dwValue		: ҂l
+ * @param[in]	DWORD dwTimeout		: ^CAEg(ms, INFINITE:)
+ * @return		0:, -1:^CAEg܂͎s
+ * @remarks		MԂXV閈ɑ dwSendSeq  WaitOnAddress ŊĎ܂B
+ */
+int CSerialIocp::waitSend(int nId, BOOL bSpace, DWORD dwValue, DWORD dwTimeout)
+{
+	ULONGLONG ullStart = ::GetTickCount64();
+
+	while (TRUE) {
+		IOCP_PORT* pstPort = lockPort(nId);
+		if (pstPort == NULL) {
+			return -1;
+		}
+
+		BOOL bReady;
+		BOOL bClosing;
+		DWORD observed;
+		volatile DWORD* pdwSendSeq;
+		{
+			CLockGuard<CLockCS<> > cGuard(pstPort->cLock, TRUE);
+			if (bSpace) {
+				LONGLONG llPending = pstPort->llQueuedBytes - pstPort->llDoneBytes;
+				bReady = (llPending + (LONGLONG)dwValue <= IOCP_SEND_HIGH_WATER) && (pstPort->nFrameCount < IOCP_SEND_MAX_FRAMES)
+					&& (!pstPort->bSendBlocked || llPending <= IOCP_SEND_LOW_WATER);
+			}
+			else {
+				// `Pbg̎lčŔr
+				bReady = (0 <= (LONG)(pstPort->dwTicketDone - dwValue));
+			}
+			bClosing = pstPort->bClosing;
+			observed = pstPort->dwSendSeq;
+			pdwSendSeq = &pstPort->dwSendSeq;
+		}
+
+		if (bReady) {
+			return 0;
+		}
+		if (bClosing) {
+			return -1;
+		}
+
+		DWORD wait = INFINITE;
+		if (dwTimeout != INFINITE) {
+			ULONGLONG elapsed = ::GetTickCount64() - ullStart;
+			if (dwTimeout <= elapsed) {
+				return -1;
+			}
+			wait = dwTimeout - (DWORD)elapsed;
+		}
+		::WaitOnAddress(pdwSendSeq, &observed, sizeof(observed), wait);
+	}
+}
+
+/**
+ * @fn			closePort
+ * @brief		s̑Mă|[gA|[g폜
+ * @param[in]	IOCP_PORT* pstPort		: |[g
+ * @return		0:, -1:s(M̊߂Ȃ߃|[głȂ)
+ * @remarks		ML[ɎcĂt[͑Mɔj܂(ʒm܂)B
+ */
+int CSerialIocp::closePort(IOCP_PORT* pstPort)
+{
+	BOOL bIdle = FALSE;
+	{
+		CLockGuard<CLockCS<> > cGuard(pstPort->cLock);
+		pstPort->bClosing = TRUE;
+		bIdle = (pstPort->nPending == 0);
+	}
+
+	if (!bIdle) {
+		CancelIoEx(pstPort->hComm, NULL);
+		if (WaitForSingleObject(pstPort->hIdleEvent, IOCP_CLOSE_TIMEOUT) != WAIT_OBJECT_0) {
+			// OVERLAPPED gp̂߉Ȃ
+			return -1;
+		}
+		// SetEvent [J[bN𔲂̂҂(|[g̉OɃbN)
+		{
+			CLockGuard<CLockCS<> > cGuard(pstPort->cLock);
+		}
+	}
+
+	close_serial(pstPort->hComm, NULL);
+	CloseHandle(pstPort->hIdleEvent);
+	delete pstPort->pcRecvBuff;
+	delete pstPort->pcSendBuff;
+	delete pstPort->pcStats;
+	delete pstPort;
+	return 0;
+}
+
+/**
+ * @fn			getPort
+ * @brief		|[gID|[g擾(m_cLock ŌĂԂ)
+ * @param[in]	int nId		: |[gID
+ * @return		|[g(NULL:o^)
+ */
+IOCP_PORT* CSerialIocp::getPort(int nId)
+{
+	if (nId < 0 || IOCP_MAX_PORTS <= nId) {
+		return NULL;
+	}
+	return m_apPort[nId];
+}
+
+/**
+ * @fn			lockPort
+ * @brief		|[gID|[g擾A|[g̃bN擾
+ * @param[in]	int nId		: |[gID
+ * @return		bNς݂̃|[g(NULL:o^)
+ * @remarks
+ *		m_cLock Ń|[g̃bN擾Ă m_cLock 邽߁ARemovePort Ă
+ *		bN܂ł̓|[g͉܂Bďo CLockGuard(cLock, TRUE) ŉĂB
+ */
+IOCP_PORT* CSerialIocp::lockPort(int nId)
+{
+	CLockGuard<CLockCS<> > cGuard(m_cLock);
+	IOCP_PORT* pstPort = getPort(nId);
+	if (pstPort != NULL) {
+		pstPort->cLock.Lock();
+	}
+	return pstPort;
+}
+
+/**
+ * @fn			getCounter
+ * @brief		|[g̓vl擾
+ * @param[in]	int nId		: |[gID
+ * @param[in]	COUNTER enKind	: vl̎
+ * @return		0`:vl, -1:s
+ */
+LONGLONG CSerialIocp::getCounter(int nId, COUNTER enKind)
+{
+	IOCP_PORT* pstPort = lockPort(nId);
+	if (pstPort == NULL) {
+		return -1;
+	}
+	CLockGuard<CLockCS<> > cGuard(pstPort->cLock, TRUE);
+	LONGLONG llValue = -1;
+	switch (enKind) {
+	case COUNTER_RECV:
+		llValue = pstPort->pcStats->Get(SERIAL_STAT_BYTES_IN);
+		break;
+	case COUNTER_DROP:
+		llValue = pstPort->pcStats->Get(SERIAL_STAT_DROP_BYTES);
+		break;
+	case COUNTER_READ_ERROR:
+		llValue = pstPort->pcStats->Get(SERIAL_STAT_READ_ERRORS);
+		break;
+	case COUNTER_SEND_PENDING:
+		llValue = pstPort->llQueuedBytes - pstPort->llDoneBytes;
+		break;
+	case COUNTER_SEND_ERROR:
+		llValue = pstPort->pcStats->Get(SERIAL_STAT_WRITE_ERRORS);
+		break;
+	case COUNTER_SEND_REFUSED:
+		llValue = pstPort->llSendRefused;
+		break;
+	}
+	return llValue;
+}
@@ -0,0 +1,511 @@
+/**
+ * @file	SerialStats.h
+ * @brief	VAʐM̓v(JE^ExqXgO)
+ * @author	?
+ * @date	?
+ * @remarks
+ *		|[g CSerialStats 1pӂAMEM̏ɃJE^Z܂B
+ *		JE^̓bNgpȂ(std::atomic)߁AĎXbh炢ł Snapshot Ŏ擾ł܂B
+ *		M(Oobt@ւ̏)Ǐof[^o܂ł̒x́A
+ *		QueryPerformanceCounter Ōv CLatencyHistogram(HDR`)ɋL^܂B
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <atomic>
+#include <intrin.h>
+#include <windows.h>
+#include "CByteRingBuffer.h"
+
+
+#define HIST_SUB_BITS			(5)			//!< l̗Lrbg(Ό덷 1/2^(HIST_SUB_BITS-1) = 6.25%)
+#define HIST_MAX_BITS			(36)		//!< L^łl̃rbg(𒴂l͍ő̃oPbgɓ)
+//! oPbg(0`2^HIST_SUB_BITS-1 1݁Aȍ~2ׂ̂斈 2^(HIST_SUB_BITS-1) )
+#define HIST_BUCKETS			((1 << HIST_SUB_BITS) + (HIST_MAX_BITS - HIST_SUB_BITS) * (1 << (HIST_SUB_BITS - 1)))
+
+#define SERIAL_STATS_STAMPS		(256)		//!< xvpɕێM̐(2ׂ̂)
+
+
+/**
+ * @class	CLatencyHistogram
+ * @brief	HDR(High Dynamic Range)`̃qXgO
+ * @remarks
+ *		l̑傫Ɋւ炸̑Ό덷ŋL^܂(ΐoPbg + `TuoPbg)B
+ *		Record ͕Xbh瓯ɌĂׂ܂(oPbg̃Ag~bNẐ)B
+ */
+class CLatencyHistogram
+{
+private:
+	std::atomic<long long>	m_allBucket[HIST_BUCKETS];		//!< oPbǧ
+	std::atomic<long long>	m_llCount;						//!< 
+	std::atomic<long long>	m_llSum;						//!< v
+	std::atomic<long long>	m_llMin;						//!< ŏl
+	std::atomic<long long>	m_llMax;						//!< ől
+
+public:
+	CLatencyHistogram();
+	~CLatencyHistogram();
+
+	void				Record(long long llValue);
+	void				Reset();
+	long long			GetCount() { return m_llCount.load(std::memory_order_relaxed); }
+	long long			GetMin();
+	long long			GetMax() { return m_llMax.load(std::memory_order_relaxed); }
+	long long			GetMean();
+	long long			GetPercentile(double dPercent);
+
+	static int			ValueToIndex(long long llValue);
+	static long long	IndexToValue(int nIndex);
+};
+
+
+/**
+ * @fn			RXgN^
+ */
+CLatencyHistogram::CLatencyHistogram()
+{
+	Reset();
+}
+
+/**
+ * @fn			fXgN^
+ */
+CLatencyHistogram::~CLatencyHistogram()
+{
+}
+
+/**
+ * @fn			Record
+ * @brief		lL^
+ * @param[in]	long long llValue	: l(̒l0Ƃ)
+ */
+void CLatencyHistogram::Record(long long llValue)
+{
+	if (llValue < 0) {
+		llValue = 0;
+	}
+	m_allBucket[ValueToIndex(llValue)].fetch_add(1, std::memory_order_relaxed);
+	m_llCount.fetch_add(1, std::memory_order_relaxed);
+	m_llSum.fetch_add(llValue, std::memory_order_relaxed);
+
+	long long cur = m_llMax.load(std::memory_order_relaxed);
+	while (cur < llValue && !m_llMax.compare_exchange_weak(cur, llValue, std::memory_order_relaxed)) {
+	}
+	cur = m_llMin.load(std::memory_order_relaxed);
+	while (llValue < cur && !m_llMin.compare_exchange_weak(cur, llValue, std::memory_order_relaxed)) {
+	}
+}
+
+/**
+ * @fn			Reset
+ * @brief		L^Sď
+ * @remarks		Record ƓɌĂ񂾏ꍇÅԂ̋L^͈ꕔc邱Ƃ܂(vp)B
+ */
+void CLatencyHistogram::Reset()
+{
+	for (int i = 0; i < HIST_BUCKETS; i++) {
+		m_allBucket[i].store(0, std::memory_order_relaxed);
+	}
+	m_llCount.store(0, std::memory_order_relaxed);
+	m_llSum.store(0, std::memory_order_relaxed);
+	m_llMin.store(LLONG_MAX, std::memory_order_relaxed);
+	m_llMax.store(0, std::memory_order_relaxed);
+}
+
+//! ŏl擾(L^ꍇ0)
+long long CLatencyHistogram::GetMin()
+{
+	long long min = m_llMin.load(std::memory_order_relaxed);
+	return (min == LLONG_MAX) ? (0) : (min);
+}
+
+//! ϒl擾(L^ꍇ0)
+long long CLatencyHistogram::GetMean()
+{
+	long long count = m_llCount.load(std::memory_order_relaxed);
+	return (count == 0) ? (0) : (m_llSum.load(std::memory_order_relaxed) / count);
+}
+
+/**
+ * @fn			GetPercentile
+ * @brief		p[Z^Cl擾
+ * @param[in]	double dPercent		: p[Zg(0`100)
+ * @return		l(L^lȏƂȂoPbg̏AL^ꍇ0)
+ */
+long long CLatencyHistogram::GetPercentile(double dPercent)
+{
+	long long total = 0;
+	for (int i = 0; i < HIST_BUCKETS; i++) {
+		total += m_allBucket[i].load(std::memory_order_relaxed);
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	long long target = (long long)((dPercent / 100.0) * (double)total + 0.5);
+	if (target < 1) {
+		target = 1;
+	}
+	long long count = 0;
+	for (int i = 0; i < HIST_BUCKETS; i++) {
+		count += m_allBucket[i].load(std::memory_order_relaxed);
+		if (target <= count) {
+			// oPbg̏(̃oPbg̉ - 1)Aől͒Ȃ
+			long long value = (i + 1 < HIST_BUCKETS) ? (IndexToValue(i + 1) - 1) : (IndexToValue(i));
+			long long max = m_llMax.load(std::memory_order_relaxed);
+			return (max < value) ? (max) : (value);
+		}
+	}
+	return m_llMax.load(std::memory_order_relaxed);
+}
+
+/**
+ * @fn			ValueToIndex
+ * @brief		loPbgԍɕϊ
+ * @param[in]	long long llValue	: l(0ȏ)
+ * @return		oPbgԍ
+ * @remarks
+ *		2^HIST_SUB_BITS ͂̂܂܁Aȍ~͍ŏʃrbg̈ʒu(w)ƁA HIST_SUB_BITS-1 rbg
+ *		()oPbg߂܂B
+ */
+int CLatencyHistogram::ValueToIndex(long long llValue)
+{
+	if (llValue < (1 << HIST_SUB_BITS)) {
+		return (int)llValue;
+	}
+	unsigned long msb = 0;
+#ifdef _WIN64
+	_BitScanReverse64(&msb, (unsigned long long)llValue);
+#else
+	// x86 ɂ _BitScanReverse64 ߁A32bitE32bit̏ɒׂ
+	if (_BitScanReverse(&msb, (unsigned long)((unsigned long long)llValue >> 32))) {
+		msb += 32;
+	}
+	else {
+		_BitScanReverse(&msb, (unsigned long)llValue);
+	}
+#endif
+	if (HIST_MAX_BITS <= (int)msb) {
+		return HIST_BUCKETS - 1;
+	}
+	int sub = (int)(llValue >> (msb - (HIST_SUB_BITS - 1))) & ((1 << (HIST_SUB_BITS - 1)) - 1);
+	return (1 << HIST_SUB_BITS) + ((int)msb - HIST_SUB_BITS) * (1 << (HIST_SUB_BITS - 1)) + sub;
+}
+
+/**
+ * @fn			IndexToValue
+ * @brief		oPbgԍoPbg̉lɕϊ
+ * @param[in]	int nIndex	: oPbgԍ
+ * @return		oPbg̉l
+ */
+long long CLatencyHistogram::IndexToValue(int nIndex)
+{
+	if (nIndex < (1 << HIST_SUB_BITS)) {
+		return nIndex;
+	}
+	int k = nIndex - (1 << HIST_SUB_BITS);
+	int msb = k / (1 << (HIST_SUB_BITS - 1)) + HIST_SUB_BITS;
+	int sub = k % (1 << (HIST_SUB_BITS - 1));
+	return (long long)((1 << (HIST_SUB_BITS - 1)) + sub) << (msb - (HIST_SUB_BITS - 1));
+}
+
+
+/**
+ * @enum	SERIAL_STAT
+ * @brief	CSerialStats ̃JE^
+ */
+enum SERIAL_STAT {
+	SERIAL_STAT_BYTES_IN = 0,				//!< MoCg(Oobt@ɏ񂾕)
+	SERIAL_STAT_BYTES_OUT,					//!< MoCg
+	SERIAL_STAT_READS_ISSUED,				//!< s ReadFile ̐
+	SERIAL_STAT_READ_COMPLETIONS,			//!<  ReadFile ̐(0oCg܂)
+	SERIAL_STAT_WRITES_ISSUED,				//!< s WriteFile ̐
+	SERIAL_STAT_WRITE_COMPLETIONS,			//!<  WriteFile ̐
+	SERIAL_STAT_DROP_BYTES,					//!< Oobt@tŔjMoCg
+	SERIAL_STAT_READ_ERRORS,				//!< sM̐
+	SERIAL_STAT_WRITE_ERRORS,				//!< sM̐
+	SERIAL_STAT_MAX
+};
+
+/**
+ * @enum	SERIAL_CE
+ * @brief	ClearCommError ̃G[(CE_*)̉
+ */
+enum SERIAL_CE {
+	SERIAL_CE_RXOVER = 0,					//!< CE_RXOVER	: ML[̃I[o[t[
+	SERIAL_CE_OVERRUN,						//!< CE_OVERRUN	: I[o[(hCo̎肱ڂ)
+	SERIAL_CE_RXPARITY,						//!< CE_RXPARITY: peBG[
+	SERIAL_CE_FRAME,						//!< CE_FRAME	: t[~OG[
+	SERIAL_CE_BREAK,						//!< CE_BREAK	: u[No
+	SERIAL_CE_MAX
+};
+
+/**
+ * @struct	SERIAL_STATS_SNAPSHOT
+ * @brief	CSerialStats::Snapshot Ŏ擾铝vl(x̒Pʂ s)
+ */
+struct SERIAL_STATS_SNAPSHOT {
+	long long			allStat[SERIAL_STAT_MAX];			//!< JE^(SERIAL_STAT)
+	DWORD				dwCommErrors;						//!< ClearCommError ̃G[rbg(_a)
+	long long			allCommError[SERIAL_CE_MAX];		//!< G[ʖ̉(SERIAL_CE)
+	int					nRingSize;							//!< MOobt@̃TCY
+	int					nRingHighWater;						//!< MOobt@̃f[^̍ől
+	long long			llRingDrop;							//!< MOobt@ŔjoCg
+	long long			llLatCount;							//!< x̌v
+	long long			llLatMin;							//!< x̍ŏl
+	long long			llLatMean;							//!< x̕ϒl
+	long long			llLatP50;							//!< x50p[Z^C
+	long long			llLatP90;							//!< x90p[Z^C
+	long long			llLatP99;							//!< x99p[Z^C
+	long long			llLatP999;							//!< x99.9p[Z^C
+	long long			llLatMax;							//!< x̍ől
+};
+
+
+/**
+ * @class	CSerialStats
+ * @brief	|[g̓v
+ * @remarks
+ *		Add/AddCommErrors ͂ǂ̃XbhĂׂ܂(Ag~bNZ)B
+ *		Produced ͎MOobt@̏ݑAConsumed ͓ǏoĂł
+ *		(M̓Oobt@݈̏ʒuƑgɂĕێAǏoʒu_ŒxL^܂)B
+ *		M̕ێ(SERIAL_STATS_STAMPS)𒴂͌v܂(JE^ɂ͉e܂)B
+ */
+class CSerialStats
+{
+private:
+	/**
+	 * @struct	STAMP
+	 * @brief	M
+	 */
+	struct STAMP {
+		unsigned int		uiPos;							//!< M̃Oobt@݈̏ʒu
+		long long			llQpc;							//!< M(QueryPerformanceCounter)
+	};
+
+	std::atomic<long long>		m_allStat[SERIAL_STAT_MAX];		//!< JE^
+	std::atomic<DWORD>			m_dwCommErrors;					//!< ClearCommError ̃G[rbg(_a)
+	std::atomic<long long>		m_allCommError[SERIAL_CE_MAX];	//!< G[ʖ̉
+	CByteRingBuffer*			m_pcRing;						//!< MOobt@
+	CLatencyHistogram			m_cLatency;						//!< MǏo̒x(s)
+	long long					m_llQpcFreq;					//!< QueryPerformanceCounter ̎g
+	STAMP						m_astStamp[SERIAL_STATS_STAMPS];	//!< M
+	std::atomic<unsigned int>	m_uiStampHead;					//!< M݈̏ʒu(Produced ̂ݍXV)
+	std::atomic<unsigned int>	m_uiStampTail;					//!< M̓Ǐoʒu(Consumed ̂ݍXV)
+
+public:
+	CSerialStats(CByteRingBuffer* pcRing = NULL);
+	~CSerialStats();
+
+	void				SetRing(CByteRingBuffer* pcRing) { m_pcRing = pcRing; }
+	//! JE^Z
+	void				Add(SERIAL_STAT enStat, long long llValue = 1) { m_allStat[enStat].fetch_add(llValue, std::memory_order_relaxed); }
+	void				AddCommErrors(DWORD dwErrorMask);
+	void				Produced();
+	void				Consumed();
+	long long			Get(SERIAL_STAT enStat) { return m_allStat[enStat].load(std::memory_order_relaxed); }
+	CLatencyHistogram*	GetLatency() { return &m_cLatency; }
+
+	void				Snapshot(SERIAL_STATS_SNAPSHOT* pstSnap, BOOL bReset = FALSE);
+	static int			Format(const SERIAL_STATS_SNAPSHOT* pstSnap, char* pszBuff, int nBuffSize);
+};
+
+
+/**
+ * @fn			RXgN^
+ * @param[in]	CByteRingBuffer* pcRing	: MOobt@(NULL:xvȂBSetRing Ōォݒ)
+ */
+CSerialStats::CSerialStats(CByteRingBuffer* pcRing/*=NULL*/)
+{
+	for (int i = 0; i < SERIAL_STAT_MAX; i++) {
+		m_allStat[i].store(0, std::memory_order_relaxed);
+	}
+	for (int i = 0; i < SERIAL_CE_MAX; i++) {
+		m_allCommError[i].store(0, std::memory_order_relaxed);
+	}
+	m_dwCommErrors.store(0, std::memory_order_relaxed);
+	m_uiStampHead.store(0, std::memory_order_relaxed);
+	m_uiStampTail.store(0, std::memory_order_relaxed);
+	m_pcRing = pcRing;
+
+	LARGE_INTEGER liFreq;
+	::QueryPerformanceFrequency(&liFreq);
+	m_llQpcFreq = (liFreq.QuadPart != 0) ? (liFreq.QuadPart) : (1);
+}
+
+/**
+ * @fn			fXgN^
+ */
+CSerialStats::~CSerialStats()
+{
+}
+
+/**
+ * @fn			AddCommErrors
+ * @brief		ClearCommError Ŏ擾G[rbgL^
+ * @param[in]	DWORD dwErrorMask	: ClearCommError  lpErrors
+ */
+void CSerialStats::AddCommErrors(DWORD dwErrorMask)
+{
+	if (dwErrorMask == 0) {
+		return;
+	}
+	static const DWORD adwBit[SERIAL_CE_MAX] = { CE_RXOVER, CE_OVERRUN, CE_RXPARITY, CE_FRAME, CE_BREAK };
+
+	m_dwCommErrors.fetch_or(dwErrorMask, std::memory_order_relaxed);
+	for (int i = 0; i < SERIAL_CE_MAX; i++) {
+		if (dwErrorMask & adwBit[i]) {
+			m_allCommError[i].fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @fn			Produced
+ * @brief		Mf[^Oobt@ɏ񂾎L^(ݑ)
+ * @remarks		Push/Commit ̒ɌĂłB
+ */
+void CSerialStats::Produced()
+{
+	if (m_pcRing == NULL) {
+		return;
+	}
+	unsigned int head = m_uiStampHead.load(std::memory_order_relaxed);
+	if (SERIAL_STATS_STAMPS <= head - m_uiStampTail.load(std::memory_order_acquire)) {
+		// Ǐo Consumed ĂłȂ(ێ𒴂͌vȂ)
+		return;
+	}
+	LARGE_INTEGER liQpc;
+	::QueryPerformanceCounter(&liQpc);
+	STAMP* pstStamp = &m_astStamp[head & (SERIAL_STATS_STAMPS - 1)];
+	pstStamp->uiPos = m_pcRing->GetWritePos();
+	pstStamp->llQpc = liQpc.QuadPart;
+	m_uiStampHead.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @fn			Consumed
+ * @brief		Ǐoof[^̒xL^(Ǐo)
+ * @remarks
+ *		Pop/Consume ̒ɌĂłBǏoʒuM݈̏ʒuȏɂȂMɂāA
+ *		ݎƂ̍L^܂(Mf[^̍Ō̃oCgo܂ł̎)B
+ */
+void CSerialStats::Consumed()
+{
+	if (m_pcRing == NULL) {
+		return;
+	}
+	unsigned int tail = m_uiStampTail.load(std::memory_order_relaxed);
+	unsigned int head = m_uiStampHead.load(std::memory_order_acquire);
+	if (tail == head) {
+		return;
+	}
+
+	unsigned int rpos = m_pcRing->GetReadPos();
+	LARGE_INTEGER liQpc;
+	::QueryPerformanceCounter(&liQpc);
+
+	while (tail != head) {
+		const STAMP* pstStamp = &m_astStamp[tail & (SERIAL_STATS_STAMPS - 1)];
+		int ahead = (int)(pstStamp->uiPos - rpos);
+		if (0 < ahead && ahead <= m_pcRing->GetBuffSize()) {
+			// ܂oĂȂ
+			break;
+		}
+		// Clear ňʒu߂ꍇ(ahead obt@TCY)͌vɎ̂Ă
+		if (ahead <= 0) {
+			m_cLatency.Record((liQpc.QuadPart - pstStamp->llQpc) * 1000000 / m_llQpcFreq);
+		}
+		tail++;
+	}
+	m_uiStampTail.store(tail, std::memory_order_release);
+}
+
+/**
+ * @fn			Snapshot
+ * @brief		vl擾
+ * @param[out]	SERIAL_STATS_SNAPSHOT* pstSnap	: vl
+ * @param[in]	BOOL bReset						: TRUE:擾ɃJE^EqXgO0ɖ߂(̒lƂ)
+ * @remarks		el͌ʂɓǂݏo߁A擾ɍXVꂽl͈ꕔ̂ݔf邱Ƃ܂B
+ */
+void CSerialStats::Snapshot(SERIAL_STATS_SNAPSHOT* pstSnap, BOOL bReset/*=FALSE*/)
+{
+	if (pstSnap == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return;
+	}
+	memset(pstSnap, 0, sizeof(SERIAL_STATS_SNAPSHOT));
+
+	for (int i = 0; i < SERIAL_STAT_MAX; i++) {
+		pstSnap->allStat[i] = (bReset) ? (m_allStat[i].exchange(0, std::memory_order_relaxed)) : (m_allStat[i].load(std::memory_order_relaxed));
+	}
+	for (int i = 0; i < SERIAL_CE_MAX; i++) {
+		pstSnap->allCommError[i] = (bReset) ? (m_allCommError[i].exchange(0, std::memory_order_relaxed)) : (m_allCommError[i].load(std::memory_order_relaxed));
+	}
+	pstSnap->dwCommErrors = (bReset) ? (m_dwCommErrors.exchange(0, std::memory_order_relaxed)) : (m_dwCommErrors.load(std::memory_order_relaxed));
+
+	if (m_pcRing != NULL) {
+		pstSnap->nRingSize = m_pcRing->GetBuffSize();
+		pstSnap->nRingHighWater = m_pcRing->GetHighWater();
+		pstSnap->llRingDrop = m_pcRing->GetDropCount();
+		if (bReset) {
+			m_pcRing->ResetStats();
+		}
+	}
+
+	pstSnap->llLatCount = m_cLatency.GetCount();
+	pstSnap->llLatMin = m_cLatency.GetMin();
+	pstSnap->llLatMean = m_cLatency.GetMean();
+	pstSnap->llLatP50 = m_cLatency.GetPercentile(50.0);
+	pstSnap->llLatP90 = m_cLatency.GetPercentile(90.0);
+	pstSnap->llLatP99 = m_cLatency.GetPercentile(99.0);
+	pstSnap->llLatP999 = m_cLatency.GetPercentile(99.9);
+	pstSnap->llLatMax = m_cLatency.GetMax();
+	if (bReset) {
+		m_cLatency.Reset();
+	}
+}
+
+/**
+ * @fn			Format
+ * @brief		vl1s̕ɂ(Oo͗p)
+ * @param[in]	const SERIAL_STATS_SNAPSHOT* pstSnap	: vl
+ * @param[out]	char* pszBuff							: o͐
+ * @param[in]	int nBuffSize							: o͐̃TCY
+ * @return		0`:, -1:s
+ */
+int CSerialStats::Format(const SERIAL_STATS_SNAPSHOT* pstSnap, char* pszBuff, int nBuffSize)
+{
+	if (pstSnap == NULL || pszBuff == NULL || nBuffSize <= 0) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	int len = _snprintf(pszBuff, nBuffSize
+		, "in=%lld out=%lld rd=%lld/%lld wr=%lld/%lld drop=%lld err=%lld/%lld"
+		  " ce=0x%02lX(ovr=%lld rxo=%lld par=%lld frm=%lld brk=%lld) ring=%d/%d(drop=%lld)"
+		  " lat[us] n=%lld min=%lld avg=%lld p50=%lld p90=%lld p99=%lld p99.9=%lld max=%lld"
+		, pstSnap->allStat[SERIAL_STAT_BYTES_IN], pstSnap->allStat[SERIAL_STAT_BYTES_OUT]
+		, pstSnap->allStat[SERIAL_STAT_READ_COMPLETIONS], pstSnap->allStat[SERIAL_STAT_READS_ISSUED]
+		, pstSnap->allStat[SERIAL_STAT_WRITE_COMPLETIONS], pstSnap->allStat[SERIAL_STAT_WRITES_ISSUED]
+		, pstSnap->allStat[SERIAL_STAT_DROP_BYTES]
+		, pstSnap->allStat[SERIAL_STAT_READ_ERRORS], pstSnap->allStat[SERIAL_STAT_WRITE_ERRORS]
+		, (unsigned long)pstSnap->dwCommErrors
+		, pstSnap->allCommError[SERIAL_CE_OVERRUN], pstSnap->allCommError[SERIAL_CE_RXOVER]
+		, pstSnap->allCommError[SERIAL_CE_RXPARITY], pstSnap->allCommError[SERIAL_CE_FRAME], pstSnap->allCommError[SERIAL_CE_BREAK]
+		, pstSnap->nRingHighWater, pstSnap->nRingSize, pstSnap->llRingDrop
+		, pstSnap->llLatCount, pstSnap->llLatMin, pstSnap->llLatMean
+		, pstSnap->llLatP50, pstSnap->llLatP90, pstSnap->llLatP99, pstSnap->llLatP999, pstSnap->llLatMax);
+	// ؂l߂ꍇ _snprintf ͏I[Ȃ
+	if (len < 0 || nBuffSize <= len) {
+		pszBuff[nBuffSize - 1] = '\0';
+		len = nBuffSize - 1;
+	}
+	return len;
+}
@@ -14,16 +14,43 @@
 #include <io.h>
 #include <windows.h>
 #include <Shlwapi.h>
+#include "time_cache.h"
+#include "log_binary.h"
+#include "Lock.h"
 
 #define MAX_LOG_ID								(5)
 #define MAX_LOG_TEXT						(256)
 #define MAX_FILE_SIZE						(1024)		// 1kByteP
 #define MAX_LOG_BACKUP						(3)
+#define LOG_BUFF_SIZE						(8 * 1024)	// t@CJ܂܂̏ꍇ̏݃obt@TCY
+#define LOG_FLUSH_TIME						(1000)		// LOG_FLUSH_INTERVAL ̃tbV(ms)
+
+// o͂郍Ox̏(1:ERR ` 4:DBG, 0:Sďo͂Ȃ)
+// ڍׂȃx̃Oo̓}N͒萔ƂȂA̕]܂߂ăRpCɏ
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL					(4)
+#endif
+
+// OIDƂ̔rbN|V[(Lock.hAVOXbhŎgpꍇ CLockNone `)
+#ifndef LOG_LOCK_POLICY
+#define LOG_LOCK_POLICY						CLockCS<>
+#endif
 
 #define LOG_START(id, path)					CLog::Start(id, path)
 #define LOG_END(id)							CLog::End(id)		// LOG_END()ł
-#define LOG_WRITE(id, level, fmt, ...)		CLog::Write(id, level, fmt, __VA_ARGS__)
-#define LOG_DEBUG(id, level, fmt, ...)		CLog::Debug(id, level, __FILE__, __LINE__, __FUNCTION__, fmt, __VA_ARGS__)
+#define LOG_SET_FLUSH(id, mode, ms, size)	CLog::SetFlush(id, mode, ms, size)
+#define LOG_FLUSH(id)						CLog::Flush(id)
+#define LOG_SET_LEVEL(id, level)			CLog::SetLevel(id, level)
+// Ox̔(RpC̏As̃x̏)
+// ͈͊ÕOID͏o͊֐̃`FbNŃG[(-1)Ƃ邽߁Ao͂鑤ɔ肷
+#define LOG_ENABLED(id, level)				((level) <= LOG_ACTIVE_LEVEL && ((id) < 0 || MAX_LOG_ID <= (id) || CLog::IsEnabled(id, level)))
+// o͂Ȃx̏ꍇ͈(mem_dump )]Ȃ
+#define LOG_WRITE(id, level, fmt, ...)		(LOG_ENABLED(id, level) ? CLog::Write(id, level, fmt, __VA_ARGS__) : 0)
+#define LOG_DEBUG(id, level, fmt, ...)		(LOG_ENABLED(id, level) ? CLog::Debug(id, level, __FILE__, __LINE__, __FUNCTION__, fmt, __VA_ARGS__) : 0)
+// oCi`O(ID͌ďoӏɏ̂ݓo^)
+#define LOG_START_BINARY(id, path)			CLog::StartBinary(id, path)
+#define LOG_BINARY(id, level, dump, data, len, fmt, ...) \
+	do { if (LOG_ENABLED(id, level)) { static volatile LONG s_lFmtId = 0; CLog::Binary(id, level, &s_lFmtId, dump, data, len, fmt, __VA_ARGS__); } } while (0)
 
 
  /**
@@ -38,6 +65,19 @@ typedef enum _LOG_LEVEL {
 } LOG_LEVEL;
 
 
+/**
+ * @enum	_LOG_FLUSH_MODE
+ * @brief	Ot@C̏(tbV)@
+ * @remarks	LOG_FLUSH_CLOSE ȊO̓t@CJ܂܂ƂAERR x̃O͏ɑtbV܂
+ */
+typedef enum _LOG_FLUSH_MODE {
+	LOG_FLUSH_CLOSE = 0,		//! 1sɃt@CJ(])
+	LOG_FLUSH_LINE,				//! 1sɃtbV
+	LOG_FLUSH_INTERVAL,			//! ÕtbVw莞Ԍoߌ̏ݎɃtbV
+	LOG_FLUSH_ERROR				//! ERR x̏ݎ(܂̓obt@t)̂݃tbV
+} LOG_FLUSH_MODE;
+
+
 /**
  * @class	CLog
  * @brief	Oo̓NX
@@ -46,15 +86,26 @@ class CLog
 {
 private:
 	// X^eBbNoϐi錾̂݁Â̊mۂcppōsj
-	static CRITICAL_SECTION	m_stCS[MAX_LOG_ID];						//! OIDƂ̔rIuWFNg
+	static LOG_LOCK_POLICY	m_cLock[MAX_LOG_ID];					//! OIDƂ̔rIuWFNg
 	static char				m_szLogPath[MAX_LOG_ID][MAX_PATH + 1];	//! Ot@CpX
 	static BOOL				m_bUsed[MAX_LOG_ID];					//! OIDgp
+	static int				m_nActiveLevel[MAX_LOG_ID];				//! o͂郍Ox̏
 	// Ot@C
 	static char				m_szDir[MAX_LOG_ID][MAX_PATH + 1];		//! hCuAfBNg
 	static char				m_szFname[MAX_LOG_ID][MAX_PATH + 1];	//! t@Cigqj
 	static char				m_szFext[MAX_LOG_ID][MAX_PATH + 1];		//! gq
 	static int				m_nFileSize[MAX_LOG_ID];				//! Ot@CTCY
 	static int				m_nLogBackup[MAX_LOG_ID];				//! t@CobNAbv
+	// t@Cݏ
+	static FILE*			m_fpLog[MAX_LOG_ID];					//! J܂܂̃Ot@C
+	static LONGLONG			m_llWritten[MAX_LOG_ID];				//! J܂܂̃Ot@C̃TCY(݃oCg)
+	static int				m_nFlushMode[MAX_LOG_ID];				//! tbV@(LOG_FLUSH_MODE)
+	static DWORD			m_dwFlushTime[MAX_LOG_ID];				//! tbV(ms)
+	static DWORD			m_dwLastFlush[MAX_LOG_ID];				//! OtbV(ms)
+	static int				m_nBuffSize[MAX_LOG_ID];				//! ݃obt@TCY
+	// oCi`o͏
+	static BOOL				m_bBinary[MAX_LOG_ID];					//! oCi`o̓[h
+	static LOG_BINARY		m_stBinary[MAX_LOG_ID];					//! oCiOt@C
 
 public:
 	CLog();
@@ -65,6 +116,12 @@ public:
 	static int				End();
 	static int				Write(int nID, int nLevel, const char* szFmt, ...);
 	static int				Debug(int nID, int nLevel, const char* szFile, int nLine, const char* szFunc, const char* szFmt, ...);
+	static int				SetFlush(int nID, int nMode, DWORD dwFlushTime = LOG_FLUSH_TIME, int nBuffSize = LOG_BUFF_SIZE);
+	static int				Flush(int nID);
+	static int				SetLevel(int nID, int nLevel);
+	static BOOL				IsEnabled(int nID, int nLevel);
+	static int				StartBinary(int nID, const char* szPath);
+	static int				Binary(int nID, int nLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, ...);
 
 private:
 	// ȉ̃I[o[[h̓}NĂяoۂɎʂłȂ
@@ -75,14 +132,17 @@ private:
 private:
 	static int				write(int nID, int nLevel, const char* szFmt, va_list arg);
 	static int				debug(int nID, int nLevel, const char* szFile, int nLine, const char* szFunc, const char* szFmt, va_list arg);
+	static int				output(int nID, int nLevel, const char* szLine);
+	static int				binary(int nID, int nLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, va_list arg);
+	static int				binaryText(int nID, int nLevel, volatile LONG* plFmtId, const char* szFmt, ...);
+	static int				openFile(int nID);
+	static void				closeFile(int nID);
 	static const char*		logLevel(int nLevel);
 	static int				getId(int nID);
 	static const char*		getFnameFromPath(const char* szPath, char* szBuff, int nSize);
 
 	static void				lockInit(int nID);
 	static void				lockDelete(int nID);
-	static void				lock(int nID);
-	static void				unlock(int nID);
 
 	static int				copyFilePath(int nID, const char* szPath);
 	static int				getBackupName(int nID, int nBkNo, char* szBuff, int nSize);
@@ -93,13 +153,17 @@ private:
 
 //! X^eBbNoϐ̎̂̊mہA
 //! OIDƂ̔rIuWFNg
-CRITICAL_SECTION CLog::m_stCS[MAX_LOG_ID];
+LOG_LOCK_POLICY CLog::m_cLock[MAX_LOG_ID];
 //! Ot@CpX
 char CLog::m_szLogPath[MAX_LOG_ID][MAX_PATH + 1];
 //! OIDgp
 int CLog::m_bUsed[MAX_LOG_ID] = {
 	FALSE, FALSE, FALSE, FALSE, FALSE
 };
+//! o͂郍Ox̏
+int CLog::m_nActiveLevel[MAX_LOG_ID] = {
+	LOG_ACTIVE_LEVEL, LOG_ACTIVE_LEVEL, LOG_ACTIVE_LEVEL, LOG_ACTIVE_LEVEL, LOG_ACTIVE_LEVEL
+};
 
 //! hCuAfBNg
 char CLog::m_szDir[MAX_LOG_ID][MAX_PATH + 1];
@@ -115,6 +179,32 @@ int CLog::m_nFileSize[MAX_LOG_ID] = {
 int CLog::m_nLogBackup[MAX_LOG_ID] = {
 	MAX_LOG_BACKUP, MAX_LOG_BACKUP, MAX_LOG_BACKUP, MAX_LOG_BACKUP, MAX_LOG_BACKUP
 };
+//! J܂܂̃Ot@C
+FILE* CLog::m_fpLog[MAX_LOG_ID] = {
+	NULL, NULL, NULL, NULL, NULL
+};
+//! J܂܂̃Ot@C̃TCY
+LONGLONG CLog::m_llWritten[MAX_LOG_ID];
+//! tbV@
+int CLog::m_nFlushMode[MAX_LOG_ID] = {
+	LOG_FLUSH_CLOSE, LOG_FLUSH_CLOSE, LOG_FLUSH_CLOSE, LOG_FLUSH_CLOSE, LOG_FLUSH_CLOSE
+};
+//! tbV
+DWORD CLog::m_dwFlushTime[MAX_LOG_ID] = {
+	LOG_FLUSH_TIME, LOG_FLUSH_TIME, LOG_FLUSH_TIME, LOG_FLUSH_TIME, LOG_FLUSH_TIME
+};
+//! OtbV
+DWORD CLog::m_dwLastFlush[MAX_LOG_ID];
+//! ݃obt@TCY
+int CLog::m_nBuffSize[MAX_LOG_ID] = {
+	LOG_BUFF_SIZE, LOG_BUFF_SIZE, LOG_BUFF_SIZE, LOG_BUFF_SIZE, LOG_BUFF_SIZE
+};
+//! oCi`o̓[h
+BOOL CLog::m_bBinary[MAX_LOG_ID] = {
+	FALSE, FALSE, FALSE, FALSE, FALSE
+};
+//! oCiOt@C
+LOG_BINARY CLog::m_stBinary[MAX_LOG_ID];
 
 
 /**
@@ -155,7 +245,6 @@ int CLog::Start(int nID, const char* szPath)
 	//memset(m_szLogPath[id], 0, sizeof(m_szLogPath[id]));
 	//strncpy(m_szLogPath[id], szPath, sizeof(m_szLogPath[id]));
 
-	//::InitializeCriticalSection(&(m_stCS[id]));
 	lockInit(id);
 
 	m_bUsed[id] = TRUE;
@@ -191,8 +280,12 @@ int CLog::End(int nID)
 
 	// wID̂݊J
 	if (m_bUsed[nID] == TRUE) {
-		//::DeleteCriticalSection(&(m_stCS[nID]));
+		{
+			CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[nID]);
+			closeFile(nID);
+		}
 		lockDelete(nID);
+		m_bBinary[nID] = FALSE;
 		m_bUsed[nID] = FALSE;
 	}
 	return 0;
@@ -209,14 +302,158 @@ int CLog::End()
 	// SIDJ
 	for (int i = 0; i < MAX_LOG_ID; i++) {
 		if (m_bUsed[i] == TRUE) {
-			//::DeleteCriticalSection(&(m_stCS[i]));
+			{
+				CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[i]);
+				closeFile(i);
+			}
 			lockDelete(i);
+			m_bBinary[i] = FALSE;
 			m_bUsed[i] = FALSE;
 		}
 	}
 	return 0;
 }
 
+/**
+ * @fn		SetFlush
+ * @brief	Ot@C̏(tbV)@ݒ肷
+ * @param	[in]	int nID				: OID
+ * @param	[in]	int nMode			: tbV@(LOG_FLUSH_MODE)
+ * @param	[in]	DWORD dwFlushTime	: LOG_FLUSH_INTERVAL ̃tbV(ms)
+ * @param	[in]	int nBuffSize		: t@CJ܂܂̏ꍇ̏݃obt@TCY
+ * @return	0:, -1:s
+ * @remarks
+ *		LOG_FLUSH_CLOSE ȊO̓Ot@CJ܂܂ƂA݂̓obt@ɗ߂Ă܂Ƃ߂čs܂B
+ *		LOG_FLUSH_INTERVAL ̎͏ݎɔ肷邽߁A݂Ԃ̓tbV܂B
+ *		Oo͂r₦ꍇ͒I Flush() ĂłB
+ */
+int CLog::SetFlush(int nID, int nMode, DWORD dwFlushTime, int nBuffSize)
+{
+	if (nID < 0 || MAX_LOG_ID <= nID || m_bUsed[nID] == FALSE
+		|| nMode < LOG_FLUSH_CLOSE || LOG_FLUSH_ERROR < nMode || nBuffSize <= 0) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[nID]);
+	// JĂt@C͏ŕA񏑍ݎɐVݒŊJ
+	closeFile(nID);
+	m_nFlushMode[nID] = nMode;
+	m_dwFlushTime[nID] = dwFlushTime;
+	m_nBuffSize[nID] = nBuffSize;
+	return 0;
+}
+
+/**
+ * @fn		Flush
+ * @brief	݃obt@̃Ot@Cɏ
+ * @param	[in]	int nID				: OID
+ * @return	0:, -1:s
+ */
+int CLog::Flush(int nID)
+{
+	if (nID < 0 || MAX_LOG_ID <= nID || m_bUsed[nID] == FALSE) {
+		return -1;
+	}
+
+	int ret = 0;
+	CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[nID]);
+	if (m_fpLog[nID] != NULL) {
+		ret = (fflush(m_fpLog[nID]) == 0) ? (0) : (-1);
+		m_dwLastFlush[nID] = ::GetTickCount();
+	}
+	if (m_stBinary[nID].fp != NULL) {
+		ret = log_bin_flush(&m_stBinary[nID]);
+	}
+	return ret;
+}
+
+/**
+ * @fn		SetLevel
+ * @brief	o͂郍Ox̏ݒ肷
+ * @param	[in]	int nID		: OID
+ * @param	[in]	int nLevel	: Ox(ڍׂȃx̃O͏o͂Ȃ)
+ * @return	0:, -1:s
+ * @remarks
+ *		LOG_ACTIVE_LEVEL(RpC̏)ڍׂȃx͐ݒ肵Ăo͂܂B
+ *		x̎QƂ͔rȂ߁Ao͒̑Xbhɂ͎̃Oo͂甽f܂B
+ */
+int CLog::SetLevel(int nID, int nLevel)
+{
+	if (nID < 0 || MAX_LOG_ID <= nID) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	m_nActiveLevel[nID] = nLevel;
+	return 0;
+}
+
+/**
+ * @fn		IsEnabled
+ * @brief	w胍Ox̃Oo͂邩肷
+ * @param	[in]	int nID		: OID
+ * @param	[in]	int nLevel	: Ox
+ * @return	TRUE:o͂, FALSE:o͂Ȃ
+ */
+BOOL CLog::IsEnabled(int nID, int nLevel)
+{
+	if (nID < 0 || MAX_LOG_ID <= nID) {
+		return FALSE;
+	}
+	return (nLevel <= LOG_ACTIVE_LEVEL && nLevel <= m_nActiveLevel[nID]) ? (TRUE) : (FALSE);
+}
+
+/**
+ * @fn		StartBinary
+ * @brief	w胍Ot@Cւ̃oCi`Oo͂Jn
+ * @param	[in]	int nID				: Oo͎̎w胍OID((0)`(MAX_ID-1), -1IDw)
+ * @param	[in]	const char* szPath	: Oo͐t@CpX
+ * @return	(0)`(MAX_ID-1):(Ȍ̃Oo͎͂擾IDgp), -1:s
+ * @remarks
+ *		Binary() ŏIDE̐f[^EQPClEyC[hL^܂(log_binary.h)B
+ *		Write()/Debug() eLXg𕶎Ƃēt@CɋL^܂B
+ *		eLXgւ̕ϊ log_decode c[ōs܂B
+ */
+int CLog::StartBinary(int nID, const char* szPath)
+{
+	int id = Start(nID, szPath);
+	if (id < 0) {
+		return -1;
+	}
+	if (log_bin_open(&m_stBinary[id], m_szLogPath[id]) != 0) {
+		End(id);
+		return -1;
+	}
+	m_bBinary[id] = TRUE;
+	return id;
+}
+
+/**
+ * @fn		Binary
+ * @brief	oCi`Oo(LOG_BINARY }NĂ)
+ * @param	[in]		int nID					: OID(StartBinary ŊJn)
+ * @param	[in]		int nLevel				: Ox(LOG_LEVEL)
+ * @param	[in,out]	volatile LONG* plFmtId	: ďoӏ̏IDێϐ(l0)
+ * @param	[in]		int nDump				: yC[h̃eLXgϊ@(LOG_BIN_DUMP_HEX/LOG_BIN_DUMP_ASCII)
+ * @param	[in]		const void* pPayload	: yC[h(Mf[^ANULL:)
+ * @param	[in]		int nPayload			: yC[h̃TCY
+ * @param	[in]		const char* szFmt		: Oo͏(񃊃e)
+ * @param	[in]		...						: o͏p[^
+ * @return	0:, -1:s
+ */
+int CLog::Binary(int nID, int nLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, ...)
+{
+	va_list arg;
+	va_start(arg, szFmt);
+	int ret = binary(nID, nLevel, plFmtId, nDump, pPayload, nPayload, szFmt, arg);
+	va_end(arg);
+	return ret;
+}
+
 /**
  * @fn		Write
  * @brief
@@ -319,48 +556,36 @@ int CLog::write(int nID, int nLevel, const char* szFmt, va_list arg)
 #endif
 		return -1;
 	}
+	if (!IsEnabled(nID, nLevel)) {
+		// ̓WJOɔ
+		return 0;
+	}
 
-	//::EnterCriticalSection(&(m_stCS[nID]));
-	lock(nID);
+	if (m_bBinary[nID]) {
+		// `ς݂̃eLXg𕶎ƂċL^
+		static volatile LONG s_lFmtId = 0;
+		char szText[MAX_LOG_TEXT];
+		vsnprintf(szText, sizeof(szText), szFmt, arg);
+		return binaryText(nID, nLevel, &s_lFmtId, "%s", szText);
+	}
 
-	backupFile(nID);
+	CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[nID]);
 
 	char szBuff0[MAX_LOG_TEXT];
 	char szBuff1[MAX_LOG_TEXT * 2];
 	vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
 
-	errno = 0;
-	FILE *fp = fopen(m_szLogPath[nID], "ab+");
-	if (fp == NULL) {
-		if (errno != 0) perror(NULL);
-		return -1;
-	}
-
-	SYSTEMTIME stTime;
-	::GetLocalTime((LPSYSTEMTIME)&stTime);
+	char szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
 	snprintf(szBuff1, sizeof(szBuff1),
-		"%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, " \
+		"%s, %s, " \
 		"%s\r\n"
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
+		, szTime
 		, logLevel(nLevel)
 		, szBuff0);
-	fputs(szBuff1, fp);
+	int ret = output(nID, nLevel, szBuff1);
 
-	if (fclose(fp) != 0) {
-		if (errno != 0) perror(NULL);
-		//::LeaveCriticalSection(&(m_stCS[nID]));
-		unlock(nID);
-		return -1;
-	}
-	//::LeaveCriticalSection(&(m_stCS[nID]));
-	unlock(nID);
-	return 0;
+	return ret;
 }
 
 /**
@@ -381,57 +606,236 @@ int CLog::debug(int nID, int nLevel, const char* szFile, int nLine, const char*
 #endif
 		return -1;
 	}
-
-	//::EnterCriticalSection(&(m_stCS[nID]));
-	lock(nID);
-
-	backupFile(nID);
+	if (!IsEnabled(nID, nLevel)) {
+		// ̓WJOɔ
+		return 0;
+	}
 
 	char szFilename[MAX_PATH];
 	memset(szFilename, 0, sizeof(szFilename));
 
+	if (m_bBinary[nID]) {
+		// `ς݂̃eLXg𕶎ƂċL^
+		static volatile LONG s_lFmtId = 0;
+		char szText[MAX_LOG_TEXT];
+		vsnprintf(szText, sizeof(szText), szFmt, arg);
+		return binaryText(nID, nLevel, &s_lFmtId, "%s(%d), %s, %s"
+			, getFnameFromPath(szFile, szFilename, sizeof(szFilename))
+			, nLine
+			, szFunc
+			, szText);
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[nID]);
+
 	char szBuff0[MAX_LOG_TEXT];
 	char szBuff1[MAX_LOG_TEXT * 2];
 	vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
 
-	errno = 0;
-	FILE *fp = fopen(m_szLogPath[nID], "ab+");
-	if (fp == NULL) {
-		if (errno != 0) perror(NULL);
-		return -1;
-	}
-
-	SYSTEMTIME stTime;
-	::GetLocalTime((LPSYSTEMTIME)&stTime);
+	char szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
 	snprintf(szBuff1, sizeof(szBuff1),
-		"%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, " \
+		"%s, %s, " \
 		"%s(%d), %s, " \
 		"%s\r\n"
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
+		, szTime
 		, logLevel(nLevel)
 		, getFnameFromPath(szFile, szFilename, sizeof(szFilename))
 		, nLine
 		, szFunc
 		, szBuff0);
-	fputs(szBuff1, fp);
+	int ret = output(nID, nLevel, szBuff1);
 
-	if (fclose(fp) != 0) {
+	return ret;
+}
+
+/**
+ * @fn		output
+ * @brief	`ς݂̃O1st@C֏(bN擾ς݂ŌĂ)
+ * @param	[in]	int nID				: OID
+ * @param	[in]	int nLevel			: Ox(LOG_LEVEL)
+ * @param	[in]	const char* szLine	: O1s
+ * @return	0:, -1:s
+ */
+int CLog::output(int nID, int nLevel, const char* szLine)
+{
+	if (m_nFlushMode[nID] == LOG_FLUSH_CLOSE) {
+		// 1sɃt@CJ
+		backupFile(nID);
+
+		errno = 0;
+		FILE *fp = fopen(m_szLogPath[nID], "ab+");
+		if (fp == NULL) {
+			if (errno != 0) perror(NULL);
+			return -1;
+		}
+		fputs(szLine, fp);
+		if (fclose(fp) != 0) {
+			if (errno != 0) perror(NULL);
+			return -1;
+		}
+		return 0;
+	}
+
+	// t@CJ܂܏
+	// TCY̓Ő(ftell 1sɃV[ÑVXeR[ƂȂ邽)
+	if (m_fpLog[nID] != NULL && (LONGLONG)m_nFileSize[nID] * 1024 <= m_llWritten[nID]) {
+		// J܂܂ł̓l[łȂ߁AĂobNAbv
+		closeFile(nID);
+	}
+	if (m_fpLog[nID] == NULL) {
+		backupFile(nID);
+		if (openFile(nID) != 0) {
+			return -1;
+		}
+	}
+
+	if (fputs(szLine, m_fpLog[nID]) < 0) {
+		return -1;
+	}
+	m_llWritten[nID] += strlen(szLine);
+
+	DWORD now = ::GetTickCount();
+	BOOL bFlush = (nLevel == ERR);
+	switch (m_nFlushMode[nID]) {
+	case LOG_FLUSH_LINE:
+		bFlush = TRUE;
+		break;
+	case LOG_FLUSH_INTERVAL:
+		if (m_dwFlushTime[nID] <= now - m_dwLastFlush[nID]) {
+			bFlush = TRUE;
+		}
+		break;
+	default:
+		break;
+	}
+	if (bFlush) {
+		fflush(m_fpLog[nID]);
+		m_dwLastFlush[nID] = now;
+	}
+	return 0;
+}
+
+/**
+ * @fn		binary
+ * @brief	oCi`Oo
+ * @param	[in]		int nID					: OID
+ * @param	[in]		int nLevel				: Ox(LOG_LEVEL)
+ * @param	[in,out]	volatile LONG* plFmtId	: ďoӏ̏IDێϐ
+ * @param	[in]		int nDump				: yC[h̃eLXgϊ@
+ * @param	[in]		const void* pPayload	: yC[h
+ * @param	[in]		int nPayload			: yC[h̃TCY
+ * @param	[in]		const char* szFmt		: Oo͏
+ * @param	[in]		va_list arg				: o͏p[^
+ * @return	0:, -1:s
+ */
+int CLog::binary(int nID, int nLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, va_list arg)
+{
+	if (nID < 0 || MAX_LOG_ID <= nID || m_bUsed[nID] == FALSE || m_bBinary[nID] == FALSE
+		|| plFmtId == NULL || szFmt == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	if (!IsEnabled(nID, nLevel)) {
+		return 0;
+	}
+
+	int id = log_bin_register(plFmtId, szFmt);
+	if (id < 0) {
+		return -1;
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(m_cLock[nID]);
+	if (m_stBinary[nID].fp == NULL) {
+		// obNAbvA܂ SetFlush() ŕ
+		if (log_bin_open(&m_stBinary[nID], m_szLogPath[nID]) != 0) {
+			return -1;
+		}
+	}
+
+	int ret = 0;
+	if (log_bin_write(&m_stBinary[nID], nLevel, id, nDump, pPayload, nPayload, arg) < 0) {
+		ret = -1;
+	}
+	else if (nLevel == ERR) {
+		log_bin_flush(&m_stBinary[nID]);
+	}
+
+	if (m_nFileSize[nID] <= (m_stBinary[nID].llWritten >> 10)) {
+		// ĂobNAbv(񏑍ݎɐVt@CJ)
+		log_bin_close(&m_stBinary[nID]);
+		if (backupFile(nID) != 0 && log_bin_open(&m_stBinary[nID], m_szLogPath[nID]) == 0) {
+			// l[łȂ(vZX폜LŊJĂ铙)ꍇA1ɊJȂ悤
+			//  m_nFileSize ނ܂ŃobNAbvĎsȂ
+			m_stBinary[nID].llWritten = 0;
+		}
+	}
+	return ret;
+}
+
+/**
+ * @fn		binaryText
+ * @brief	oCi`OɃeLXgL^(Write/Debug p)
+ * @param	[in]		int nID					: OID
+ * @param	[in]		int nLevel				: Ox(LOG_LEVEL)
+ * @param	[in,out]	volatile LONG* plFmtId	: IDێϐ
+ * @param	[in]		const char* szFmt		: 
+ * @param	[in]		...						: p[^
+ * @return	0:, -1:s
+ */
+int CLog::binaryText(int nID, int nLevel, volatile LONG* plFmtId, const char* szFmt, ...)
+{
+	va_list arg;
+	va_start(arg, szFmt);
+	int ret = binary(nID, nLevel, plFmtId, LOG_BIN_DUMP_HEX, NULL, 0, szFmt, arg);
+	va_end(arg);
+	return ret;
+}
+
+/**
+ * @fn		openFile
+ * @brief	Ot@CJ܂܂ɂ邽߁A݃obt@ݒ肵ĊJ
+ * @param	[in]	int nID				: OID
+ * @return	0:, -1:s
+ */
+int CLog::openFile(int nID)
+{
+	errno = 0;
+	FILE *fp = fopen(m_szLogPath[nID], "ab+");
+	if (fp == NULL) {
 		if (errno != 0) perror(NULL);
-		//::LeaveCriticalSection(&(m_stCS[nID]));
-		unlock(nID);
 		return -1;
 	}
-	//::LeaveCriticalSection(&(m_stCS[nID]));
-	unlock(nID);
+	setvbuf(fp, NULL, _IOFBF, m_nBuffSize[nID]);
+	// ǋL̂߁Ãt@CTCY݃oCg̏lƂ(ȍ~͏ݖɉZ)
+	fseek(fp, 0, SEEK_END);
+	m_llWritten[nID] = _ftelli64(fp);
+	if (m_llWritten[nID] < 0) {
+		m_llWritten[nID] = 0;
+	}
+
+	m_fpLog[nID] = fp;
+	m_dwLastFlush[nID] = ::GetTickCount();
 	return 0;
 }
 
+/**
+ * @fn		closeFile
+ * @brief	J܂܂̃Ot@Cŕ
+ * @param	[in]	int nID				: OID
+ */
+void CLog::closeFile(int nID)
+{
+	if (m_fpLog[nID] != NULL) {
+		fclose(m_fpLog[nID]);
+		m_fpLog[nID] = NULL;
+	}
+	log_bin_close(&m_stBinary[nID]);
+}
+
 /**
  * @fn		logLevel
  * @brief	OxɑΉ閼̂擾
@@ -520,7 +924,7 @@ const char* CLog::getFnameFromPath(const char* szPath, char* szBuff, int nSize)
 inline void CLog::lockInit(int nID)
 {
 	if (0 <= nID && nID < MAX_LOG_ID) {
-		::InitializeCriticalSection(&(m_stCS[nID]));
+		m_cLock[nID].Init();
 	}
 }
 
@@ -532,31 +936,7 @@ inline void CLog::lockInit(int nID)
 inline void CLog::lockDelete(int nID)
 {
 	if (0 <= nID && nID < MAX_LOG_ID) {
-		::DeleteCriticalSection(&(m_stCS[nID]));
-	}
-}
-
-/**
- * @fn		_Lock
- * @brief	r
- * @param	[in]	int nID		 : OID
- */
-inline void CLog::lock(int nID)
-{
-	if (0 <= nID && nID < MAX_LOG_ID) {
-		::EnterCriticalSection(&(m_stCS[nID]));
-	}
-}
-
-/**
- * @fn		_Unlock
- * @brief	r
- * @param	[in]	int nID		 : OID
- */
-inline void CLog::unlock(int nID)
-{
-	if (0 <= nID && nID < MAX_LOG_ID) {
-		::LeaveCriticalSection(&(m_stCS[nID]));
+		m_cLock[nID].Exit();
 	}
 }
 
@@ -620,7 +1000,7 @@ int CLog::getBackupName(int nID, int nBkNo, char* szBuff, int nSize)
  * @fn		backupFile
  * @brief	Ot@CobNAbv
  * @param	[in]	int nID		:OID
- * @return	0:, -1:s
+ * @return	0:(obNAbvsv܂), -1:s(݂̃Ot@Cl[łȂ)
  */
 int CLog::backupFile(int nID)
 {
@@ -638,6 +1018,7 @@ int CLog::backupFile(int nID)
 
 	char szBefore[MAX_PATH + 1];
 	char szAfter[MAX_PATH + 1];
+	int ret = 0;
 
 	if (m_nFileSize[nID] <= fsize) {
 		// t@CobNAbv
@@ -651,13 +1032,16 @@ int CLog::backupFile(int nID)
 			getBackupName(nID, nBkNo, szBefore, sizeof(szBefore));
 			if (::PathFileExists(szBefore) && !::PathIsDirectory(szBefore)) {
 				getBackupName(nID, nBkNo + 1, szAfter, sizeof(szBefore));
-				::MoveFile(szBefore, szAfter);
+				if (!::MoveFile(szBefore, szAfter) && nBkNo == 0) {
+					// ݂̃Ot@C(_0)vZXɊJĂ铙
+					ret = -1;
+				}
 			}
 		}
 	}
 
 	//unlock(nID);
-	return 0;
+	return ret;
 }
 
 /**
@@ -7,16 +7,21 @@
 #pragma once
 
 #include <windows.h>
+#include "misc.h"
+#include "ring_core.h"
+#include "Lock.h"
 
 
 /**
- * @class	CQueue
+ * @class	CQueueT
  * @brief	L[f[^NX
+ * @tparam	L	: bN|V[(Lock.hA̓XsJEgtNeBJZNV)
  */
-class CQueue
+template <typename L = CLockCS<> >
+class CQueueT
 {
 private:
-	CRITICAL_SECTION	m_stCS;
+	L					m_cLock;
 	unsigned char*		m_pbyQueue;
 	int					m_nQueueSize;
 	int					m_nModMask;
@@ -24,9 +29,9 @@ private:
 	int					m_nLength;
 
 public:
-	CQueue();
-	CQueue(int nSize);
-	~CQueue();
+	CQueueT();
+	CQueueT(int nSize);
+	~CQueueT();
 
 	int					Clear();
 	int					Enqueue(const unsigned char* pbyData, int nLen);
@@ -38,22 +43,22 @@ public:
 private:
 	int					getPow2Size(int nSize);
 
-	void				lockInit();
-	void				lockDelete();
-	void				lock();
-	void				unlock();
-
 	void				debug_print();
 };
 
+//! L[f[^NX(̃bN|V[)
+typedef CQueueT<>	CQueue;
+
 
 /**
  * RXgN^
  */
-CQueue::CQueue() : CQueue(1024)
+template <typename L>
+CQueueT<L>::CQueueT() : CQueueT(1024)
 {
 }
-CQueue::CQueue(int nSize)
+template <typename L>
+CQueueT<L>::CQueueT(int nSize)
 {
 	m_nQueueSize = getPow2Size(nSize);
 	m_pbyQueue = new unsigned char[m_nQueueSize];
@@ -62,17 +67,15 @@ CQueue::CQueue(int nSize)
 	m_nModMask = m_nQueueSize - 1;
 	m_nHead = 0;
 	m_nLength = 0;
-
-	lockInit();
 }
 
 /**
  * fXgN^
  */
-CQueue::~CQueue()
+template <typename L>
+CQueueT<L>::~CQueueT()
 {
 	delete[] m_pbyQueue;
-	lockDelete();
 }
 
 /**
@@ -80,13 +83,13 @@ CQueue::~CQueue()
  * @brief	
  * @return	
  */
-int CQueue::Clear()
+template <typename L>
+int CQueueT<L>::Clear()
 {
-	lock();
+	CLockGuard<L> cGuard(m_cLock);
 	memset(m_pbyQueue, 0, m_nQueueSize);
 	m_nHead = 0;
 	m_nLength = 0;
-	unlock();
 
 	return 0;
 }
@@ -98,29 +101,24 @@ int CQueue::Clear()
  * @param	[IN]
  * @return
  */
-int CQueue::Enqueue(const unsigned char* pbyData, int nLen)
+template <typename L>
+int CQueueT<L>::Enqueue(const unsigned char* pbyData, int nLen)
 {
 	if (pbyData == NULL) {
 		return -1;
 	}
 
-	lock();
-	int count = 0;
-	int ptr = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (m_nLength < m_nQueueSize) {
-			ptr = ((m_nHead + m_nLength) & m_nModMask);
-			m_pbyQueue[ptr] = pbyData[i];
-			m_nLength++;
-			count++;
-		}
-		else {
-			break;
-		}
+	int count;
+	{
+		CLockGuard<L> cGuard(m_cLock);
+		count = ring_count(nLen, m_nQueueSize - m_nLength);
+		ring_write(m_pbyQueue, m_nQueueSize, ((m_nHead + m_nLength) & m_nModMask), pbyData, count);
+		m_nLength += count;
 	}
-	unlock();
 
+#if _DEBUG
 	debug_print();
+#endif
 
 	return count;
 }
@@ -132,29 +130,26 @@ int CQueue::Enqueue(const unsigned char* pbyData, int nLen)
  * @param	[IN]
  * @return
  */
-int CQueue::Dequeue(unsigned char* pbyBuff, int nLen)
+template <typename L>
+int CQueueT<L>::Dequeue(unsigned char* pbyBuff, int nLen)
 {
 	if (pbyBuff == NULL) {
 		return -1;
 	}
 
-	lock();
-	int count = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (0 < m_nLength) {
-			pbyBuff[i] = m_pbyQueue[m_nHead];
-			m_pbyQueue[m_nHead] = 0;
-			m_nHead = ((m_nHead + 1) & m_nModMask);
-			m_nLength--;
-			count++;
-		}
-		else {
-			break;
-		}
+	int count;
+	{
+		CLockGuard<L> cGuard(m_cLock);
+		count = ring_count(nLen, m_nLength);
+		ring_read(m_pbyQueue, m_nQueueSize, m_nHead, pbyBuff, count);
+		ring_erase(m_pbyQueue, m_nQueueSize, m_nHead, count);
+		m_nHead = ((m_nHead + count) & m_nModMask);
+		m_nLength -= count;
 	}
-	unlock();
 
+#if _DEBUG
 	debug_print();
+#endif
 
 	return count;
 }
@@ -166,29 +161,23 @@ int CQueue::Dequeue(unsigned char* pbyBuff, int nLen)
  * @param	[IN]
  * @return
  */
-int CQueue::Peek(unsigned char* pbyBuff, int nLen)
+template <typename L>
+int CQueueT<L>::Peek(unsigned char* pbyBuff, int nLen)
 {
 	if (pbyBuff == NULL) {
 		return -1;
 	}
 
-	lock();
-	int ptr = m_nHead;
-	int count = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (0 < m_nLength) {
-			pbyBuff[i] = m_pbyQueue[ptr];
-			ptr = ((ptr + 1) & m_nModMask);
-			count++;
-			if (ptr == m_nHead) break;
-		}
-		else {
-			break;
-		}
+	int count;
+	{
+		CLockGuard<L> cGuard(m_cLock);
+		count = ring_count(nLen, m_nLength);
+		ring_read(m_pbyQueue, m_nQueueSize, m_nHead, pbyBuff, count);
 	}
-	unlock();
 
+#if _DEBUG
 	debug_print();
+#endif
 
 	return count;
 }
@@ -198,7 +187,8 @@ int CQueue::Peek(unsigned char* pbyBuff, int nLen)
  * @brief	
  * @return	
  */
-int CQueue::IsEmpty()
+template <typename L>
+int CQueueT<L>::IsEmpty()
 {
 	return ((m_nLength == 0) ? (0) : (-1));
 }
@@ -208,7 +198,8 @@ int CQueue::IsEmpty()
  * @brief
  * @return
  */
-int CQueue::GetLength()
+template <typename L>
+int CQueueT<L>::GetLength()
 {
 	return m_nLength;
 }
@@ -219,7 +210,8 @@ int CQueue::GetLength()
  * @param	[IN]	
  * @return	
  */
-int CQueue::getPow2Size(int nSize)
+template <typename L>
+int CQueueT<L>::getPow2Size(int nSize)
 {
 	int exp_size = 1;
 	int org_size = nSize;
@@ -232,41 +224,8 @@ int CQueue::getPow2Size(int nSize)
 	return exp_size;
 }
 
-/**
- * @fn		lockInit
- * @brief	r
- */
-inline void CQueue::lockInit()
-{
-	::InitializeCriticalSection(&m_stCS);
-}
-/**
- * @fn		lockDelete
- * @brief	r
- */
-inline void CQueue::lockDelete()
-{
-	::DeleteCriticalSection(&m_stCS);
-}
-/**
- * @fn		lock
- * @brief	r
- */
-inline void CQueue::lock()
-{
-	::EnterCriticalSection(&m_stCS);
-}
-/**
- * @fn		unlock
- * @brief	r
- */
-inline void CQueue::unlock()
-{
-	::LeaveCriticalSection(&m_stCS);
-}
-
-
-void CQueue::debug_print()
+template <typename L>
+void CQueueT<L>::debug_print()
 {
 	char szBuff[256];
 	mem_dump(m_pbyQueue, m_nQueueSize, szBuff, sizeof(szBuff));
@@ -7,12 +7,32 @@
 #pragma once
 
 #include <windows.h>
+#include <avrt.h>
 #include "misc.h"
 
+#pragma comment(lib, "avrt.lib")
+
+// misc.h  DEBUG_PRINT ͖Ă邽߁A`̏ꍇ͂Œ`
+#ifndef DEBUG_PRINT
+#if _DEBUG
+#define DEBUG_PRINT(fmt, ...)			printf("%s: " fmt "\r\n", __FUNCTION__, __VA_ARGS__)
+#else
+#define DEBUG_PRINT(fmt, ...)
+#endif
+#endif
+
+#define THREAD_NAME_SIZE		(64)		//!< Xbh̍ő啶
+#define THREAD_MMCSS_SIZE		(64)		//!< MMCSS ̃^XN̍ő啶
+#define THREAD_PRIORITY_NONE	(THREAD_PRIORITY_ERROR_RETURN)	//!< Dxݒ肵Ȃ
+
 
 /**
  * @class	CThread
  * @brief	Xbh
+ * @remarks
+ *		SetAffinity/SetIdealProcessor/SetPriority/SetName Őݒ肵́AStart ŃXbh
+ *		TXyhԂŐĂĊJ܂ł̊ԂɓKp܂(Jnɕʂ̃vZbTֈړȂ悤)B
+ *		SetMmcssTask ݒ肵ꍇ́AXbhg֐̑O MMCSS ւ̓o^Es܂B
  */
 class CThread
 {
@@ -26,6 +46,13 @@ private:
 	DWORD					m_dwCreationFlags;
 	DWORD					m_dwThreadId;
 
+	// Xbh(Start ɓKp)
+	DWORD_PTR				m_dwpAffinity;							//!< AtBjeB}XN(0:ݒ肵Ȃ)
+	int						m_nIdealProcessor;						//!< D悵ĎsvZbTԍ(-1:ݒ肵Ȃ)
+	int						m_nPriority;							//!< Dx(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+	char					m_szMmcssTask[THREAD_MMCSS_SIZE];		//!< MMCSS ̃^XN(:o^Ȃ)
+	WCHAR					m_wszName[THREAD_NAME_SIZE];			//!< Xbh(:ݒ肵Ȃ)
+
 public:
 	CThread();
 	~CThread();
@@ -44,8 +71,21 @@ public:
 
 	HANDLE					GetHandle();
 
+	BOOL					SetAffinity(DWORD_PTR dwpMask);
+	BOOL					SetIdealProcessor(int nProcessor);
+	BOOL					SetPriority(int nPriority);
+	BOOL					SetMmcssTask(const char* szTask);
+	BOOL					SetName(const char* szName);
+
+	static BOOL				ApplyAttributes(HANDLE hThread, DWORD_PTR dwpAffinity, int nIdealProcessor, int nPriority, LPCWSTR pwszName);
+	static HANDLE			EnterMmcss(const char* szTask);
+	static void				LeaveMmcss(HANDLE hMmcss);
+	static DWORD_PTR		GetCacheMask(int nProcessor, int nLevel = 2);
+	static DWORD_PTR		GetNumaMask(int nProcessor);
+
 private:
 	void					clearHandle();
+	static DWORD WINAPI		mmcssThreadProc(LPVOID lpParam);
 };
 
 
@@ -62,6 +102,12 @@ CThread::CThread()
 	m_lpParameter = NULL;
 	m_dwCreationFlags = CREATE_SUSPENDED;	//0;
 	m_dwThreadId = 0;
+
+	m_dwpAffinity = 0;
+	m_nIdealProcessor = -1;
+	m_nPriority = THREAD_PRIORITY_NONE;
+	m_szMmcssTask[0] = '\0';
+	m_wszName[0] = L'\0';
 }
 
 /**
@@ -106,6 +152,8 @@ BOOL CThread::SetArgs(LPSECURITY_ATTRIBUTES lpThreadAttributes,
  * @brief	XbhJn
  * @return	TRUE:, FALSE:s
  * @remarks	֐ CreateThread, ResumeThread Ăł܂B
+ * 			Xbh̓TXyhԂœKpĂĊJ܂(Kp̎s̓Xbh̊JnW܂)B
+ * 			MMCSS gpꍇAXbhJn܂ŃCX^XjȂłB
  */
 BOOL CThread::Start()
 {
@@ -113,17 +161,21 @@ BOOL CThread::Start()
 		DEBUG_PRINT("ThreadProc is NULL.");
 		return FALSE;
 	}
+	BOOL bMmcss = (m_szMmcssTask[0] != '\0');
 	m_hThread = ::CreateThread(
 		m_lpThreadAttributes,
 		m_dwStackSize,
-		m_lpStartAddress,
-		m_lpParameter,
-		m_dwCreationFlags,
+		(bMmcss) ? (mmcssThreadProc) : (m_lpStartAddress),
+		(bMmcss) ? ((LPVOID)this) : (m_lpParameter),
+		m_dwCreationFlags | CREATE_SUSPENDED,
 		&m_dwThreadId);
 	if (m_hThread == NULL) {
 		DEBUG_PRINT("CreateThread failed.");
 		return FALSE;
 	}
+	if (!ApplyAttributes(m_hThread, m_dwpAffinity, m_nIdealProcessor, m_nPriority, m_wszName)) {
+		DEBUG_PRINT("ApplyAttributes failed.");
+	}
 	if (::ResumeThread(m_hThread) == -1) {		// 0xFFFFFFFF:s
 		DEBUG_PRINT("ResumeThread failed.");
 		return FALSE;
@@ -292,6 +344,256 @@ HANDLE CThread::GetHandle()
 	return m_hThread;
 }
 
+/**
+ * @fn		SetAffinity
+ * @brief	XbhsvZbT𐧌
+ * @param	[in]	DWORD_PTR dwpMask		: AtBjeB}XN(0:ȂBGetCacheMask/GetNumaMask Ŏ擾)
+ * @return	TRUE:, FALSE:s
+ * @remarks	Jnς݂̃Xbhɂ͂ɓKp܂B
+ */
+BOOL CThread::SetAffinity(DWORD_PTR dwpMask)
+{
+	m_dwpAffinity = dwpMask;
+	if (m_hThread != NULL && dwpMask != 0) {
+		if (::SetThreadAffinityMask(m_hThread, dwpMask) == 0) {
+			DEBUG_PRINT("SetThreadAffinityMask failed.(%d)", ::GetLastError());
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * @fn		SetIdealProcessor
+ * @brief	XbhD悵ĎsvZbTݒ肷
+ * @param	[in]	int nProcessor		: vZbTԍ(-1:ݒ肵Ȃ)
+ * @return	TRUE:, FALSE:s
+ * @remarks	AtBjeBƈقȂÃvZbTł̎s܂(XPW[ւ̃qg)B
+ */
+BOOL CThread::SetIdealProcessor(int nProcessor)
+{
+	m_nIdealProcessor = nProcessor;
+	if (m_hThread != NULL && 0 <= nProcessor) {
+		if (::SetThreadIdealProcessor(m_hThread, (DWORD)nProcessor) == (DWORD)-1) {
+			DEBUG_PRINT("SetThreadIdealProcessor failed.(%d)", ::GetLastError());
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * @fn		SetPriority
+ * @brief	Xbh̗Dxݒ肷
+ * @param	[in]	int nPriority		: THREAD_PRIORITY_*(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+ * @return	TRUE:, FALSE:s
+ */
+BOOL CThread::SetPriority(int nPriority)
+{
+	m_nPriority = nPriority;
+	if (m_hThread != NULL && nPriority != THREAD_PRIORITY_NONE) {
+		if (!::SetThreadPriority(m_hThread, nPriority)) {
+			DEBUG_PRINT("SetThreadPriority failed.(%d)", ::GetLastError());
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * @fn		SetMmcssTask
+ * @brief	Xbh MMCSS(Multimedia Class Scheduler Service)ɓo^^XNݒ肷
+ * @param	[in]	const char* szTask		: ^XN("Pro Audio", "Capture" BNULL/:o^Ȃ)
+ * @return	TRUE:, FALSE:s(Jnς݁A܂̓^XN)
+ * @remarks	MMCSS ւ̓o^̓Xbhgs߁AStart Oɐݒ肵ĂB
+ */
+BOOL CThread::SetMmcssTask(const char* szTask)
+{
+	if (m_hThread != NULL) {
+		DEBUG_PRINT("Thread already started.");
+		return FALSE;
+	}
+	if (szTask == NULL) {
+		m_szMmcssTask[0] = '\0';
+		return TRUE;
+	}
+	if (THREAD_MMCSS_SIZE <= strlen(szTask)) {
+		DEBUG_PRINT("MMCSS task name is too long.");
+		return FALSE;
+	}
+	strncpy(m_szMmcssTask, szTask, sizeof(m_szMmcssTask));
+	return TRUE;
+}
+
+/**
+ * @fn		SetName
+ * @brief	Xbhݒ肷(fobKEvt@Cł̕\p)
+ * @param	[in]	const char* szName		: Xbh(NULL/:ݒ肵ȂAꍇ͐؂l߂)
+ * @return	TRUE:, FALSE:s
+ */
+BOOL CThread::SetName(const char* szName)
+{
+	m_wszName[0] = L'\0';
+	if (szName != NULL && szName[0] != '\0') {
+		if (::MultiByteToWideChar(CP_ACP, 0, szName, -1, m_wszName, THREAD_NAME_SIZE) == 0) {
+			// ؂l߂ꍇsƂȂ邽߁AI[̂ݕ₤
+			m_wszName[THREAD_NAME_SIZE - 1] = L'\0';
+		}
+	}
+	if (m_hThread != NULL && m_wszName[0] != L'\0') {
+		return ApplyAttributes(m_hThread, 0, -1, THREAD_PRIORITY_NONE, m_wszName);
+	}
+	return TRUE;
+}
+
+/**
+ * @fn		ApplyAttributes
+ * @brief	XbhɑKp(CThread ȊOŐXbhɂgp)
+ * @param	[in]	HANDLE hThread				: Xbh̃nh
+ * @param	[in]	DWORD_PTR dwpAffinity		: AtBjeB}XN(0:ݒ肵Ȃ)
+ * @param	[in]	int nIdealProcessor			: D悵ĎsvZbTԍ(-1:ݒ肵Ȃ)
+ * @param	[in]	int nPriority				: Dx(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+ * @param	[in]	LPCWSTR pwszName			: Xbh(NULL/:ݒ肵Ȃ)
+ * @return	TRUE:, FALSE:ꂩ̐ݒɎs
+ * @remarks	SetThreadDescription  Windows 10 1607 ȍ~݂̂̂߁A݂ꍇ̂݌Ăяo܂B
+ */
+BOOL CThread::ApplyAttributes(HANDLE hThread, DWORD_PTR dwpAffinity, int nIdealProcessor, int nPriority, LPCWSTR pwszName)
+{
+	typedef HRESULT (WINAPI *SET_THREAD_DESCRIPTION)(HANDLE, PCWSTR);
+
+	BOOL bRet = TRUE;
+	if (dwpAffinity != 0 && ::SetThreadAffinityMask(hThread, dwpAffinity) == 0) {
+		DEBUG_PRINT("SetThreadAffinityMask failed.(%d)", ::GetLastError());
+		bRet = FALSE;
+	}
+	if (0 <= nIdealProcessor && ::SetThreadIdealProcessor(hThread, (DWORD)nIdealProcessor) == (DWORD)-1) {
+		DEBUG_PRINT("SetThreadIdealProcessor failed.(%d)", ::GetLastError());
+		bRet = FALSE;
+	}
+	if (nPriority != THREAD_PRIORITY_NONE && !::SetThreadPriority(hThread, nPriority)) {
+		DEBUG_PRINT("SetThreadPriority failed.(%d)", ::GetLastError());
+		bRet = FALSE;
+	}
+	if (pwszName != NULL && pwszName[0] != L'\0') {
+		static SET_THREAD_DESCRIPTION pfnSetThreadDescription
+			= (SET_THREAD_DESCRIPTION)::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription");
+		if (pfnSetThreadDescription != NULL && FAILED(pfnSetThreadDescription(hThread, pwszName))) {
+			DEBUG_PRINT("SetThreadDescription failed.");
+			bRet = FALSE;
+		}
+	}
+	return bRet;
+}
+
+/**
+ * @fn		EnterMmcss
+ * @brief	ĂяoXbh MMCSS ɓo^
+ * @param	[in]	const char* szTask		: ^XN("Pro Audio", "Capture" )
+ * @return	MMCSS ̃nh(NULL:sALeaveMmcss œo^邱)
+ * @remarks	o^Xbh̓^XN̐ݒɏ]ėDIɃXPW[܂(^XN̓WXg
+ * 			HKLM\SOFTWARE\Microsoft\Windows NT\CurrentVersion\Multimedia\SystemProfile\Tasks Q)B
+ */
+HANDLE CThread::EnterMmcss(const char* szTask)
+{
+	if (szTask == NULL || szTask[0] == '\0') {
+		return NULL;
+	}
+	DWORD dwTaskIndex = 0;
+	HANDLE hMmcss = ::AvSetMmThreadCharacteristicsA(szTask, &dwTaskIndex);
+	if (hMmcss == NULL) {
+		DEBUG_PRINT("AvSetMmThreadCharacteristics failed.(%d)", ::GetLastError());
+	}
+	return hMmcss;
+}
+
+/**
+ * @fn		LeaveMmcss
+ * @brief	EnterMmcss œo^Xbh MMCSS ւ̓o^
+ * @param	[in]	HANDLE hMmcss		: EnterMmcss ̖߂l(NULL ̏ꍇ͉Ȃ)
+ */
+void CThread::LeaveMmcss(HANDLE hMmcss)
+{
+	if (hMmcss != NULL) {
+		::AvRevertMmThreadCharacteristics(hMmcss);
+	}
+}
+
+/**
+ * @fn		GetCacheMask
+ * @brief	w肵vZbTƃLbVLvZbT̃}XN擾
+ * @param	[in]	int nProcessor		: vZbTԍ
+ * @param	[in]	int nLevel			: LbṼx(2:L2 LNX^, 3:L3 L_C)
+ * @return	AtBjeB}XN(0:s)
+ * @remarks	LbVLXbhԂł̓f[^̎󂯓n L2/L3 Ŋ܂B
+ * 			vZbTO[v͍l܂(O[v 0  64 vZbT܂)B
+ */
+DWORD_PTR CThread::GetCacheMask(int nProcessor, int nLevel/*=2*/)
+{
+	if (nProcessor < 0 || (int)(sizeof(DWORD_PTR) * 8) <= nProcessor) {
+		return 0;
+	}
+	DWORD dwSize = 0;
+	::GetLogicalProcessorInformation(NULL, &dwSize);
+	if (dwSize == 0) {
+		return 0;
+	}
+	PSYSTEM_LOGICAL_PROCESSOR_INFORMATION pstInfo = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION)new BYTE[dwSize];
+	DWORD_PTR dwpMask = 0;
+	if (::GetLogicalProcessorInformation(pstInfo, &dwSize)) {
+		DWORD_PTR dwpBit = (DWORD_PTR)1 << nProcessor;
+		int count = (int)(dwSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+		for (int i = 0; i < count; i++) {
+			if (pstInfo[i].Relationship == RelationCache
+				&& pstInfo[i].Cache.Level == nLevel
+				&& pstInfo[i].Cache.Type != CacheInstruction
+				&& (pstInfo[i].ProcessorMask & dwpBit)) {
+				dwpMask = pstInfo[i].ProcessorMask;
+				break;
+			}
+		}
+	}
+	delete[] (BYTE*)pstInfo;
+	return dwpMask;
+}
+
+/**
+ * @fn		GetNumaMask
+ * @brief	w肵vZbTƓ NUMA m[h̃vZbT̃}XN擾
+ * @param	[in]	int nProcessor		: vZbTԍ
+ * @return	AtBjeB}XN(0:s)
+ */
+DWORD_PTR CThread::GetNumaMask(int nProcessor)
+{
+	if (nProcessor < 0 || 255 < nProcessor) {
+		return 0;
+	}
+	UCHAR byNode = 0;
+	ULONGLONG ullMask = 0;
+	if (!::GetNumaProcessorNode((UCHAR)nProcessor, &byNode) || !::GetNumaNodeProcessorMask(byNode, &ullMask)) {
+		DEBUG_PRINT("GetNumaNodeProcessorMask failed.(%d)", ::GetLastError());
+		return 0;
+	}
+	return (DWORD_PTR)ullMask;
+}
+
+/**
+ * @fn		mmcssThreadProc
+ * @brief	MMCSS ɓo^Ă珈֐Ăяo
+ * @param	[in]	LPVOID lpParam		: CThread*
+ * @return	֐̖߂l
+ */
+DWORD WINAPI CThread::mmcssThreadProc(LPVOID lpParam)
+{
+	CThread* pcThread = (CThread*)lpParam;
+	LPTHREAD_START_ROUTINE lpStartAddress = pcThread->m_lpStartAddress;
+	LPVOID lpParameter = pcThread->m_lpParameter;
+
+	HANDLE hMmcss = EnterMmcss(pcThread->m_szMmcssTask);
+	DWORD dwRet = lpStartAddress(lpParameter);
+	LeaveMmcss(hMmcss);
+	return dwRet;
+}
+
 /**
  * @fn		clearHandle
  * @brief	Xbh̃nh폜
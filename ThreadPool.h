@@ -0,0 +1,722 @@
+/**
+ * @file	ThreadPool.h
+ * @brief	[NXeB[ÕXbhv[
+ * @author	?
+ * @date	?
+ * @remarks
+ *		[J[Xbh(CThread)Ƀ^XN̗[L[(deque)Ae[J[͎̃L[̖
+ *		^XNoĎs܂(Oɐς񂾃^XÑf[^LbVɎcĂ邤ɏ邽)B
+ *		̃L[ɂȂ[J[́Ã[J[̃L[̐擪(łÂ^XN)𓐂Ŏs܂B
+ *		[J[ȊÕXbh Submit ͊e[J[̃L[ɏԂɐU蕪A
+ *		[J[Ŏs̃^XN Submit ͂̃[J[g̃L[ɐς݂܂B
+ *		Submit Ŏ擾^XNnh(THREADPOOL_TASK) Wait Ŋ҂ARelease ŉĂB
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <malloc.h>
+#include <new>
+#include <atomic>
+#include <windows.h>
+#include "ring_core.h"
+#include "SimpleThread.h"
+
+
+#define THREADPOOL_MAX_WORKERS		(MAXIMUM_WAIT_OBJECTS)	//!< [J[Xbh̏(CThread::JoinAll őҋ@ł鐔)
+#define THREADPOOL_QUEUE_SIZE		(1024)		//!< [J[̃L[ɐς߂^XN(2ׂ̂)
+#define THREADPOOL_FREE_MAX			(1024)		//!< ėp̂߂ɕێĂ^XN
+#define THREADPOOL_IDLE_TIMEOUT		(100)		//!< ^XNꍇɃ[J[ҋ@鎞(msANR̕ی)
+
+
+//! ^XN֐̌`
+typedef void (*THREADPOOL_FUNC)(PVOID pParam);
+
+/**
+ * @enum	THREADPOOL_STATE
+ * @brief	^XN̏
+ */
+enum THREADPOOL_STATE {
+	THREADPOOL_STATE_QUEUED = 0,			//!< L[Ŏs҂
+	THREADPOOL_STATE_RUNNING,				//!< s
+	THREADPOOL_STATE_DONE,					//!< s
+	THREADPOOL_STATE_CANCELED,				//!< sɔj(Stop  bDrain=FALSE ̏ꍇ)
+};
+
+/**
+ * @struct	THREADPOOL_TASK
+ * @brief	^XN(Submit Ŏ擾^XNnh)
+ * @remarks	ς݂̃^XN InterlockedPushEntrySList ŕێ邽߁ASLIST_ENTRY 擪ɒu܂B
+ */
+struct DECLSPEC_ALIGN(MEMORY_ALLOCATION_ALIGNMENT) THREADPOOL_TASK {
+	SLIST_ENTRY			stEntry;							//!< ς݃^XÑXg
+	THREADPOOL_FUNC		pfnFunc;							//!< ^XN֐
+	PVOID				pParam;								//!< ^XN֐̈
+	volatile LONG		lState;								//!< (THREADPOOL_STATEAWaitOnAddress ŊĎ)
+	volatile LONG		lRef;								//!< QƐ(L[ + ^XNnh)
+	BOOL				bWaitable;							//!< ^XNnhԂ( Wait N)
+};
+
+class CThreadPool;
+
+/**
+ * @struct	THREADPOOL_WORKER
+ * @brief	[J[̃^XNL[
+ * @remarks
+ *		uiTail ()͏L郏[J[ SubmitAuiHead (擪)͓ޑgp܂B
+ *		ǂ stLock Ŕr܂(ێԂ̓|C^1̏ô)B
+ *		LbVCEv邽߁A_aligned_malloc Ŋmۂ placement new ō\z܂B
+ */
+struct alignas(CACHE_LINE_SIZE) THREADPOOL_WORKER {
+	CThreadPool*		pcPool;								//!< v[
+	int					nIndex;								//!< [J[ԍ
+	SRWLOCK				stLock;								//!< L[̔r
+	unsigned int		uiHead;								//!< 擪(łÂ^XN)
+	unsigned int		uiTail;								//!< (ɐςވʒu)
+	THREADPOOL_TASK*	apTask[THREADPOOL_QUEUE_SIZE];		//!< ^XN
+	unsigned int		uiRand;								//!< ޑIԗ(xorshift)
+	std::atomic<long long>	llExecuted;						//!< s^XN
+	std::atomic<long long>	llStolen;						//!< ̃[J[瓐񂾃^XN
+};
+
+
+/**
+ * @class	CThreadPool
+ * @brief	[NXeB[ÕXbhv[
+ * @remarks
+ *		[J[̊l CPUłBԃ[v^XN(M[v)̓[J[1L邽߁A
+ *		[v IsStopping ܂ GetStopEvent ̃CxgmFāAStop ɏI悤ɂĂB
+ */
+class CThreadPool
+{
+private:
+	CThread					m_acThread[THREADPOOL_MAX_WORKERS];		//!< [J[Xbh
+	THREADPOOL_WORKER*		m_apWorker[THREADPOOL_MAX_WORKERS];		//!< [J[̃^XNL[
+	int						m_nWorkers;								//!< [J[Xbh(^XNL[̐)
+	int						m_nStarted;								//!< Jn[J[Xbh
+	DWORD					m_dwTlsIndex;							//!< s̃[J[(TLS)
+	HANDLE					m_hStopEvent;							//!< Stop ŃVOiɂCxg
+	std::atomic<BOOL>		m_bStop;								//!< ~
+	std::atomic<BOOL>		m_bDrain;								//!< ~ɃL[̃^XNSĎs
+	std::atomic<LONG>		m_lQueued;								//!< L[Ŏs҂̃^XN
+	std::atomic<LONG>		m_lIdle;								//!< ҋ@̃[J[
+	std::atomic<LONG>		m_lSignal;								//!< ^XNǉ̒ʒm(WaitOnAddress ŊĎ)
+	std::atomic<unsigned int>	m_uiNext;							//!<  Submit U蕪郏[J[
+	std::atomic<LONG>		m_lSubmitting;							//!< s Submit ̐(Stop ͂ꂪ 0 ɂȂ܂ŃL[Ȃ)
+	SLIST_HEADER			m_stFree;								//!< ς݃^XN(ėp)
+	// [J[Xbh̑(Start ɓKp)
+	DWORD_PTR				m_dwpAffinity;							//!< AtBjeB}XN(0:ݒ肵Ȃ)
+	int						m_nPriority;							//!< Dx(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+	char					m_szMmcssTask[THREAD_MMCSS_SIZE];		//!< MMCSS ̃^XN(:o^Ȃ)
+	char					m_szName[THREAD_NAME_SIZE];				//!< Xbh(:ݒ肵ȂA"O#ԍ" Ƃ)
+
+public:
+	CThreadPool();
+	~CThreadPool();
+
+	int					SetThreadAttributes(DWORD_PTR dwpAffinity, int nPriority = THREAD_PRIORITY_NONE, const char* szMmcssTask = NULL, const char* szName = NULL);
+	int					Start(int nWorkers = 0);
+	int					Stop(BOOL bDrain = TRUE, DWORD dwTimeout = INFINITE);
+	int					Submit(THREADPOOL_FUNC pfnFunc, PVOID pParam, THREADPOOL_TASK** ppstTask = NULL);
+	int					Wait(THREADPOOL_TASK* pstTask, DWORD dwTimeout = INFINITE);
+	void				Release(THREADPOOL_TASK* pstTask);
+
+	//! Stop Ă΂ꂽ(ԃ[v^XN̏I)
+	BOOL				IsStopping() { return m_bStop.load(std::memory_order_acquire); }
+	//! Stop ŃVOiɂȂCxg(ԃ[v^XN WaitForMultipleObjects őҋ@ꍇ)
+	HANDLE				GetStopEvent() { return m_hStopEvent; }
+	int					GetWorkerCount() { return m_nWorkers; }
+	int					GetPendingCount() { return (int)m_lQueued.load(std::memory_order_relaxed); }
+	LONGLONG			GetExecutedCount();
+	LONGLONG			GetStealCount();
+
+private:
+	static DWORD WINAPI	workerThread(LPVOID pParam);
+	void				worker(THREADPOOL_WORKER* pstWorker);
+	int					submit(THREADPOOL_FUNC pfnFunc, PVOID pParam, THREADPOOL_TASK** ppstTask);
+	void				run(THREADPOOL_TASK* pstTask);
+	BOOL				push(THREADPOOL_WORKER* pstWorker, THREADPOOL_TASK* pstTask);
+	THREADPOOL_TASK*	popLocal(THREADPOOL_WORKER* pstWorker);
+	THREADPOOL_TASK*	steal(THREADPOOL_WORKER* pstWorker);
+	void				finish(THREADPOOL_TASK* pstTask, LONG lState);
+	THREADPOOL_TASK*	allocTask();
+	void				releaseTask(THREADPOOL_TASK* pstTask);
+};
+
+
+/**
+ * @fn			RXgN^
+ */
+CThreadPool::CThreadPool()
+{
+	m_nWorkers = 0;
+	m_nStarted = 0;
+	m_dwTlsIndex = TLS_OUT_OF_INDEXES;
+	m_hStopEvent = NULL;
+	m_bStop.store(FALSE);
+	m_bDrain.store(TRUE);
+	m_lQueued.store(0);
+	m_lIdle.store(0);
+	m_lSignal.store(0);
+	m_uiNext.store(0);
+	m_lSubmitting.store(0);
+	for (int i = 0; i < THREADPOOL_MAX_WORKERS; i++) {
+		m_apWorker[i] = NULL;
+	}
+	InitializeSListHead(&m_stFree);
+	m_dwpAffinity = 0;
+	m_nPriority = THREAD_PRIORITY_NONE;
+	m_szMmcssTask[0] = '\0';
+	m_szName[0] = '\0';
+}
+
+/**
+ * @fn			fXgN^
+ * @remarks		L[ɎcĂ^XN͎sĂI܂B
+ */
+CThreadPool::~CThreadPool()
+{
+	Stop();
+
+	PSLIST_ENTRY pstEntry = InterlockedFlushSList(&m_stFree);
+	while (pstEntry != NULL) {
+		PSLIST_ENTRY pstNext = pstEntry->Next;
+		_aligned_free(pstEntry);
+		pstEntry = pstNext;
+	}
+}
+
+/**
+ * @fn			SetThreadAttributes
+ * @brief		[J[Xbh̑ݒ肷(Start OɌĂԂ)
+ * @param[in]	DWORD_PTR dwpAffinity	: AtBjeB}XN(0:ݒ肵ȂBCThread::GetCacheMask/GetNumaMask Ŏ擾)
+ * @param[in]	int nPriority			: Dx(THREAD_PRIORITY_NONE:ݒ肵Ȃ)
+ * @param[in]	const char* szMmcssTask	: MMCSS ̃^XN("Pro Audio", "Capture" BNULL:o^Ȃ)
+ * @param[in]	const char* szName		: Xbh(NULL:ݒ肵ȂA"O#ԍ" Ƃ)
+ * @return		0:, -1:s(Jnς݁A܂͕񂪒)
+ */
+int CThreadPool::SetThreadAttributes(DWORD_PTR dwpAffinity, int nPriority/*=THREAD_PRIORITY_NONE*/, const char* szMmcssTask/*=NULL*/, const char* szName/*=NULL*/)
+{
+	if (0 < m_nWorkers
+		|| (szMmcssTask != NULL && THREAD_MMCSS_SIZE <= strlen(szMmcssTask))
+		|| (szName != NULL && THREAD_NAME_SIZE - 4 <= strlen(szName))) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	m_dwpAffinity = dwpAffinity;
+	m_nPriority = nPriority;
+	m_szMmcssTask[0] = '\0';
+	m_szName[0] = '\0';
+	if (szMmcssTask != NULL) {
+		strncpy(m_szMmcssTask, szMmcssTask, sizeof(m_szMmcssTask));
+	}
+	if (szName != NULL) {
+		strncpy(m_szName, szName, sizeof(m_szName));
+	}
+	return 0;
+}
+
+/**
+ * @fn			Start
+ * @brief		[J[XbhJn
+ * @param[in]	int nWorkers	: [J[Xbh(0:CPUA THREADPOOL_MAX_WORKERS)
+ * @return		0:, -1:s
+ */
+int CThreadPool::Start(int nWorkers/*=0*/)
+{
+	if (0 < m_nWorkers) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	if (nWorkers <= 0) {
+		SYSTEM_INFO stInfo;
+		GetSystemInfo(&stInfo);
+		nWorkers = (int)stInfo.dwNumberOfProcessors;
+	}
+	if (THREADPOOL_MAX_WORKERS < nWorkers) {
+		nWorkers = THREADPOOL_MAX_WORKERS;
+	}
+
+	m_dwTlsIndex = TlsAlloc();
+	if (m_dwTlsIndex == TLS_OUT_OF_INDEXES) {
+		return -1;
+	}
+	m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (m_hStopEvent == NULL) {
+		TlsFree(m_dwTlsIndex);
+		m_dwTlsIndex = TLS_OUT_OF_INDEXES;
+		return -1;
+	}
+	m_bStop.store(FALSE);
+	m_bDrain.store(TRUE);
+
+	for (int i = 0; i < nWorkers; i++) {
+		void* pMem = _aligned_malloc(sizeof(THREADPOOL_WORKER), alignof(THREADPOOL_WORKER));
+		if (pMem == NULL) {
+			// mۂłL[([J[͂܂JnĂȂ)
+			m_nWorkers = i;
+			Stop(FALSE);
+			return -1;
+		}
+		THREADPOOL_WORKER* pstWorker = new (pMem) THREADPOOL_WORKER;
+		pstWorker->pcPool = this;
+		pstWorker->nIndex = i;
+		InitializeSRWLock(&pstWorker->stLock);
+		pstWorker->uiHead = 0;
+		pstWorker->uiTail = 0;
+		pstWorker->uiRand = 0x9E3779B9u * (unsigned int)(i + 1);
+		pstWorker->llExecuted.store(0);
+		pstWorker->llStolen.store(0);
+		m_apWorker[i] = pstWorker;
+	}
+	m_nWorkers = nWorkers;
+
+	// S[J[̃L[pӂĂJn(steal 쐬̃L[QƂȂ悤)
+	for (int i = 0; i < nWorkers; i++) {
+		m_acThread[i].SetThreadProc(workerThread);
+		m_acThread[i].SetThreadParam(m_apWorker[i]);
+		m_acThread[i].SetAffinity(m_dwpAffinity);
+		m_acThread[i].SetPriority(m_nPriority);
+		m_acThread[i].SetMmcssTask(m_szMmcssTask);
+		if (m_szName[0] != '\0') {
+			char szName[THREAD_NAME_SIZE];
+			_snprintf(szName, sizeof(szName), "%s#%d", m_szName, i);
+			szName[sizeof(szName) - 1] = '\0';
+			m_acThread[i].SetName(szName);
+		}
+		if (!m_acThread[i].Start()) {
+			// Jnł[J[~߂đSĉ
+			Stop(FALSE);
+			return -1;
+		}
+		m_nStarted++;
+	}
+	return 0;
+}
+
+/**
+ * @fn			Stop
+ * @brief		[J[Xbh~
+ * @param[in]	BOOL bDrain			: TRUE:L[ɎcĂ^XNSĎsĂ~, FALSE:sɔj
+ * @param[in]	DWORD dwTimeout		: [J[Xbh̏I҂(ms)
+ * @return		0:, -1:^CAEg(^XNIȂ)
+ * @remarks
+ *		Ăяo_ňȍ~ Submit ͎sAGetStopEvent ̃CxgVOiɂȂ܂B
+ *		j^XN̏Ԃ THREADPOOL_STATE_CANCELED ƂȂAWait  1 Ԃ܂B
+ *		^CAEgꍇ͍ēx Stop Ăł(s̃^XN邽ߎ͉܂)B
+ *		[J[XbhI邽߁A^XN̒([J[)͌Ăׂ܂(-1 Ԃ܂)B
+ *		^XNv[~߂ꍇ́Aʂ̃Xbh Stop ˗ĂB
+ *		̃XbhŎs Submit ́AL[OɊ҂܂B
+ */
+int CThreadPool::Stop(BOOL bDrain/*=TRUE*/, DWORD dwTimeout/*=INFINITE*/)
+{
+	if (m_nWorkers == 0 && m_hStopEvent == NULL) {
+		return 0;
+	}
+	if (TlsGetValue(m_dwTlsIndex) != NULL) {
+		// g̏I҂ƂɂȂ(JoinAll fbhbN)
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	m_bDrain.store(bDrain);
+	m_bStop.store(TRUE);
+	SetEvent(m_hStopEvent);
+	m_lSignal.fetch_add(1);
+	WakeByAddressAll(&m_lSignal);
+
+	// m_bStop ̊mFʉ߂ Submit I܂ő҂(Submit  m_lSubmitting XVƑ)
+	while (0 < m_lSubmitting.load()) {
+		SwitchToThread();
+	}
+
+	if (0 < m_nStarted && !CThread::JoinAll(m_acThread, m_nStarted, dwTimeout)) {
+		return -1;
+	}
+	m_nStarted = 0;
+
+	// sꂸɎc^XNj
+	for (int i = 0; i < m_nWorkers; i++) {
+		THREADPOOL_WORKER* pstWorker = m_apWorker[i];
+		while (pstWorker->uiHead != pstWorker->uiTail) {
+			THREADPOOL_TASK* pstTask = pstWorker->apTask[pstWorker->uiHead & (THREADPOOL_QUEUE_SIZE - 1)];
+			pstWorker->uiHead++;
+			m_lQueued.fetch_sub(1);
+			finish(pstTask, THREADPOOL_STATE_CANCELED);
+		}
+		pstWorker->~THREADPOOL_WORKER();
+		_aligned_free(pstWorker);
+		m_apWorker[i] = NULL;
+	}
+	m_nWorkers = 0;
+
+	CloseHandle(m_hStopEvent);
+	m_hStopEvent = NULL;
+	TlsFree(m_dwTlsIndex);
+	m_dwTlsIndex = TLS_OUT_OF_INDEXES;
+	return 0;
+}
+
+/**
+ * @fn			Submit
+ * @brief		^XNo^
+ * @param[in]	THREADPOOL_FUNC pfnFunc			: ^XN֐
+ * @param[in]	PVOID pParam					: ^XN֐̈
+ * @param[out]	THREADPOOL_TASK** ppstTask		: ^XNnh(NULL:svA擾ꍇ Release ŉ邱)
+ * @return		0:, -1:s(~A܂͑SẴL[t)
+ */
+int CThreadPool::Submit(THREADPOOL_FUNC pfnFunc, PVOID pParam, THREADPOOL_TASK** ppstTask/*=NULL*/)
+{
+	if (ppstTask != NULL) {
+		*ppstTask = NULL;
+	}
+	if (pfnFunc == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	//  m_lSubmitting 𑝂₵Ă m_bStop mFAStop  m_bStop ݒ肵Ă m_lSubmitting 
+	// mF邽߁A~ Submit I܂ Stop ̓L[Ȃ
+	m_lSubmitting.fetch_add(1);
+	if (m_bStop.load() || m_nWorkers == 0) {
+		m_lSubmitting.fetch_sub(1);
+		return -1;
+	}
+	int ret = submit(pfnFunc, pParam, ppstTask);
+	m_lSubmitting.fetch_sub(1);
+	return ret;
+}
+
+/**
+ * @fn			submit
+ * @brief		^XNmۂăL[ɐς(Submit ̖{)
+ * @param[in]	THREADPOOL_FUNC pfnFunc			: ^XN֐
+ * @param[in]	PVOID pParam					: ^XN֐̈
+ * @param[out]	THREADPOOL_TASK** ppstTask		: ^XNnh(NULL:sv)
+ * @return		0:, -1:s(SẴL[t)
+ */
+int CThreadPool::submit(THREADPOOL_FUNC pfnFunc, PVOID pParam, THREADPOOL_TASK** ppstTask)
+{
+	THREADPOOL_TASK* pstTask = allocTask();
+	if (pstTask == NULL) {
+		return -1;
+	}
+	pstTask->pfnFunc = pfnFunc;
+	pstTask->pParam = pParam;
+	pstTask->lState = THREADPOOL_STATE_QUEUED;
+	pstTask->bWaitable = (ppstTask != NULL);
+	pstTask->lRef = (ppstTask != NULL) ? (2) : (1);
+
+	// [J[ォ̓o^͎̃L[ցAȊO͏ԂɐU蕪
+	THREADPOOL_WORKER* pstSelf = (THREADPOOL_WORKER*)TlsGetValue(m_dwTlsIndex);
+	int start = (pstSelf != NULL) ? (pstSelf->nIndex) : ((int)(m_uiNext.fetch_add(1, std::memory_order_relaxed) % (unsigned int)m_nWorkers));
+	BOOL bPushed = FALSE;
+	for (int i = 0; i < m_nWorkers && !bPushed; i++) {
+		bPushed = push(m_apWorker[(start + i) % m_nWorkers], pstTask);
+	}
+	if (!bPushed) {
+		releaseTask(pstTask);
+		if (ppstTask != NULL) {
+			releaseTask(pstTask);
+		}
+		return -1;
+	}
+
+	// ҋ@̃[J[ꍇ̂݋N(worker ̑ҋ@Ƒ)
+	m_lSignal.fetch_add(1);
+	if (0 < m_lIdle.load()) {
+		WakeByAddressSingle(&m_lSignal);
+	}
+
+	if (ppstTask != NULL) {
+		*ppstTask = pstTask;
+	}
+	return 0;
+}
+
+/**
+ * @fn			Wait
+ * @brief		^XN̊҂
+ * @param[in]	THREADPOOL_TASK* pstTask	: ^XNnh
+ * @param[in]	DWORD dwTimeout				: ^CAEg(ms)
+ * @return		0:s, 1:sɔjꂽ, -1:^CAEgEs
+ * @remarks		^XN̒瓯v[̕ʂ̃^XN҂ƁA[J[Sđҋ@Đi܂ȂȂ邱Ƃ܂B
+ */
+int CThreadPool::Wait(THREADPOOL_TASK* pstTask, DWORD dwTimeout/*=INFINITE*/)
+{
+	if (pstTask == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	ULONGLONG ullStart = ::GetTickCount64();
+
+	while (TRUE) {
+		LONG state = pstTask->lState;
+		if (state == THREADPOOL_STATE_DONE) {
+			return 0;
+		}
+		if (state == THREADPOOL_STATE_CANCELED) {
+			return 1;
+		}
+
+		DWORD wait = INFINITE;
+		if (dwTimeout != INFINITE) {
+			ULONGLONG elapsed = ::GetTickCount64() - ullStart;
+			if (dwTimeout <= elapsed) {
+				return -1;
+			}
+			wait = dwTimeout - (DWORD)elapsed;
+		}
+		::WaitOnAddress(&pstTask->lState, &state, sizeof(state), wait);
+	}
+}
+
+/**
+ * @fn			Release
+ * @brief		^XNnh
+ * @param[in]	THREADPOOL_TASK* pstTask	: ^XNnh(Submit Ŏ擾)
+ * @remarks		OɉĂ\܂(^XN͎s܂)B
+ */
+void CThreadPool::Release(THREADPOOL_TASK* pstTask)
+{
+	if (pstTask == NULL) {
+		return;
+	}
+	releaseTask(pstTask);
+}
+
+//! s^XN擾
+LONGLONG CThreadPool::GetExecutedCount()
+{
+	LONGLONG count = 0;
+	for (int i = 0; i < m_nWorkers; i++) {
+		count += m_apWorker[i]->llExecuted.load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+//! ̃[J[瓐Ŏs^XN擾
+LONGLONG CThreadPool::GetStealCount()
+{
+	LONGLONG count = 0;
+	for (int i = 0; i < m_nWorkers; i++) {
+		count += m_apWorker[i]->llStolen.load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+/**
+ * @fn			workerThread
+ * @brief		[J[Xbh̃Gg|Cg
+ * @param[in]	LPVOID pParam	: THREADPOOL_WORKER*
+ * @return		0
+ */
+DWORD WINAPI CThreadPool::workerThread(LPVOID pParam)
+{
+	THREADPOOL_WORKER* pstWorker = (THREADPOOL_WORKER*)pParam;
+	pstWorker->pcPool->worker(pstWorker);
+	return 0;
+}
+
+/**
+ * @fn			worker
+ * @brief		[J[Xbh̏(^XN̎oƎs)
+ * @param[in]	THREADPOOL_WORKER* pstWorker	: [J[̃^XNL[
+ * @remarks
+ *		̃L[  ̃[J[̃L[̏Ƀ^XNTA m_lSignal ̕ω҂܂B
+ *		ҋ@O m_lIdle 𑝂₵Ă m_lQueued mFASubmit  m_lQueued 𑝂₵Ă m_lIdle 
+ *		mF邽߁Aǂ炩K̍XVQƂ܂(NR̖h~)B
+ */
+void CThreadPool::worker(THREADPOOL_WORKER* pstWorker)
+{
+	TlsSetValue(m_dwTlsIndex, pstWorker);
+
+	while (TRUE) {
+		if (m_bStop.load() && !m_bDrain.load()) {
+			// c̃^XN Stop Ŕj
+			break;
+		}
+		THREADPOOL_TASK* pstTask = popLocal(pstWorker);
+		if (pstTask == NULL) {
+			pstTask = steal(pstWorker);
+		}
+		if (pstTask != NULL) {
+			run(pstTask);
+			pstWorker->llExecuted.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+
+		if (m_bStop.load()) {
+			// ~ Submit ͎󂯕tȂ߁As Submit L[Ȃȍ~^XN͑Ȃ
+			if (m_lQueued.load() == 0 && m_lSubmitting.load() == 0) {
+				break;
+			}
+			continue;
+		}
+
+		LONG signal = m_lSignal.load();
+		m_lIdle.fetch_add(1);
+		if (m_lQueued.load() == 0 && !m_bStop.load()) {
+			WaitOnAddress(&m_lSignal, &signal, sizeof(signal), THREADPOOL_IDLE_TIMEOUT);
+		}
+		m_lIdle.fetch_sub(1);
+	}
+
+	TlsSetValue(m_dwTlsIndex, NULL);
+}
+
+/**
+ * @fn			run
+ * @brief		^XNs
+ * @param[in]	THREADPOOL_TASK* pstTask	: ^XN
+ */
+void CThreadPool::run(THREADPOOL_TASK* pstTask)
+{
+	InterlockedExchange(&pstTask->lState, THREADPOOL_STATE_RUNNING);
+	pstTask->pfnFunc(pstTask->pParam);
+	finish(pstTask, THREADPOOL_STATE_DONE);
+}
+
+/**
+ * @fn			push
+ * @brief		^XNL[̖ɐς
+ * @param[in]	THREADPOOL_WORKER* pstWorker	: L[
+ * @param[in]	THREADPOOL_TASK* pstTask		: ^XN
+ * @return		TRUE:, FALSE:L[t
+ */
+BOOL CThreadPool::push(THREADPOOL_WORKER* pstWorker, THREADPOOL_TASK* pstTask)
+{
+	BOOL bPushed = FALSE;
+	AcquireSRWLockExclusive(&pstWorker->stLock);
+	if (pstWorker->uiTail - pstWorker->uiHead < THREADPOOL_QUEUE_SIZE) {
+		pstWorker->apTask[pstWorker->uiTail & (THREADPOOL_QUEUE_SIZE - 1)] = pstTask;
+		pstWorker->uiTail++;
+		// o m_lQueued 炷Oɑ₷(bN)
+		m_lQueued.fetch_add(1);
+		bPushed = TRUE;
+	}
+	ReleaseSRWLockExclusive(&pstWorker->stLock);
+	return bPushed;
+}
+
+/**
+ * @fn			popLocal
+ * @brief		[J[̃L[̖(łV^XN)o
+ * @param[in]	THREADPOOL_WORKER* pstWorker	: [J[̃L[
+ * @return		^XN(NULL:L[)
+ */
+THREADPOOL_TASK* CThreadPool::popLocal(THREADPOOL_WORKER* pstWorker)
+{
+	THREADPOOL_TASK* pstTask = NULL;
+	AcquireSRWLockExclusive(&pstWorker->stLock);
+	if (pstWorker->uiHead != pstWorker->uiTail) {
+		pstWorker->uiTail--;
+		pstTask = pstWorker->apTask[pstWorker->uiTail & (THREADPOOL_QUEUE_SIZE - 1)];
+		m_lQueued.fetch_sub(1);
+	}
+	ReleaseSRWLockExclusive(&pstWorker->stLock);
+	return pstTask;
+}
+
+/**
+ * @fn			steal
+ * @brief		̃[J[̃L[̐擪(łÂ^XN)𓐂
+ * @param[in]	THREADPOOL_WORKER* pstWorker	: [J[̃L[
+ * @return		^XN(NULL:SẴL[)
+ * @remarks		ޑ͗őI񂾃[J[珇ɒT܂([J[ɓ݂WȂ悤)B
+ */
+THREADPOOL_TASK* CThreadPool::steal(THREADPOOL_WORKER* pstWorker)
+{
+	if (m_nWorkers <= 1 || m_lQueued.load(std::memory_order_relaxed) == 0) {
+		return NULL;
+	}
+
+	unsigned int x = pstWorker->uiRand;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	pstWorker->uiRand = x;
+
+	int start = (int)(x % (unsigned int)m_nWorkers);
+	for (int i = 0; i < m_nWorkers; i++) {
+		THREADPOOL_WORKER* pstVictim = m_apWorker[(start + i) % m_nWorkers];
+		if (pstVictim == pstWorker) {
+			continue;
+		}
+		THREADPOOL_TASK* pstTask = NULL;
+		// ̃L[̓bNɔ΂(bNōĊmF)
+		if (!TryAcquireSRWLockExclusive(&pstVictim->stLock)) {
+			continue;
+		}
+		if (pstVictim->uiHead != pstVictim->uiTail) {
+			pstTask = pstVictim->apTask[pstVictim->uiHead & (THREADPOOL_QUEUE_SIZE - 1)];
+			pstVictim->uiHead++;
+			m_lQueued.fetch_sub(1);
+		}
+		ReleaseSRWLockExclusive(&pstVictim->stLock);
+		if (pstTask != NULL) {
+			pstWorker->llStolen.fetch_add(1, std::memory_order_relaxed);
+			return pstTask;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @fn			finish
+ * @brief		^XN(܂͔j)ɂAҋ@ Wait N
+ * @param[in]	THREADPOOL_TASK* pstTask	: ^XN
+ * @param[in]	LONG lState					: THREADPOOL_STATE_DONE/THREADPOOL_STATE_CANCELED
+ */
+void CThreadPool::finish(THREADPOOL_TASK* pstTask, LONG lState)
+{
+	BOOL bWaitable = pstTask->bWaitable;
+	InterlockedExchange(&pstTask->lState, lState);
+	if (bWaitable) {
+		WakeByAddressAll((PVOID)&pstTask->lState);
+	}
+	releaseTask(pstTask);
+}
+
+/**
+ * @fn			allocTask
+ * @brief		^XNmۂ(ς݂̃^XN΍ėp)
+ * @return		^XN(NULL:s)
+ */
+THREADPOOL_TASK* CThreadPool::allocTask()
+{
+	THREADPOOL_TASK* pstTask = (THREADPOOL_TASK*)InterlockedPopEntrySList(&m_stFree);
+	if (pstTask == NULL) {
+		pstTask = (THREADPOOL_TASK*)_aligned_malloc(sizeof(THREADPOOL_TASK), MEMORY_ALLOCATION_ALIGNMENT);
+	}
+	return pstTask;
+}
+
+/**
+ * @fn			releaseTask
+ * @brief		^XN̎QƂ(QƂȂΉς݃Xg֖߂)
+ * @param[in]	THREADPOOL_TASK* pstTask	: ^XN
+ */
+void CThreadPool::releaseTask(THREADPOOL_TASK* pstTask)
+{
+	if (InterlockedDecrement(&pstTask->lRef) != 0) {
+		return;
+	}
+	if (QueryDepthSList(&m_stFree) < THREADPOOL_FREE_MAX) {
+		InterlockedPushEntrySList(&m_stFree, &pstTask->stEntry);
+	}
+	else {
+		_aligned_free(pstTask);
+	}
+}
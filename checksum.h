@@ -0,0 +1,282 @@
+/**
+ * @file	checksum.h
+ * @brief	`FbNT/CRCvZ(BCC, LRC, CRC-16/CCITT, CRC-16/Modbus, CRC-32)
+ * @author	?
+ * @date	?
+ * @remarks
+ *		BCC(XOR) LRC(Z) SSE2 ɂ16oCgPʁA[8oCgPʂŌvZ܂B
+ *		CRC ̓XCVOEoCE8(8̃e[u8oCgvZ)ŌvZ܂B
+ *		e[u͏gpɍ쐬܂B
+ *
+ *		SĂ̌vZ͓ro߂Ŏ󂯎 xxx_update ֐ōs߁A
+ *		Oobt@̐܂Ԃ(CByteRingBuffer::RING_SPAN 2̈)AsAȃf[^
+ *		AɏɌvZł܂B
+ *			WORD crc = CRC16_MODBUS_INIT;
+ *			crc = crc16_modbus_update(crc, stSpan.apbyData[0], stSpan.anLen[0]);
+ *			crc = crc16_modbus_update(crc, stSpan.apbyData[1], stSpan.anLen[1]);
+ *		eASY̏lEŏI͈ȉ̒ʂłB
+ *			BCC				: l 0, ŏI
+ *			LRC				: Zl̏l 0, lrc_final() 2̕␔̉1oCg𓾂
+ *			CRC-16/CCITT	: l CRC16_CCITT_INIT(0xFFFF, CCITT-FALSE) ܂ 0(XMODEM), ŏI
+ *			CRC-16/Modbus	: l CRC16_MODBUS_INIT(0xFFFF), ŏI(M͉ʃoCg)
+ *			CRC-32			: l CRC32_INIT(0xFFFFFFFF), crc32_final() Ńrbg]
+ */
+#pragma once
+
+#include <string.h>
+#include <emmintrin.h>
+#include <windows.h>
+
+
+#define CRC16_CCITT_INIT		(0xFFFF)		//!< CRC-16/CCITT ̏l(CCITT-FALSE)
+#define CRC16_CCITT_POLY		(0x1021)		//!< CRC-16/CCITT ̐(MSBt@[Xg)
+#define CRC16_MODBUS_INIT		(0xFFFF)		//!< CRC-16/Modbus ̏l
+#define CRC16_MODBUS_POLY		(0xA001)		//!< CRC-16/Modbus ̐(rbg], LSBt@[Xg)
+#define CRC32_INIT				(0xFFFFFFFF)	//!< CRC-32 ̏l
+#define CRC32_POLY				(0xEDB88320)	//!< CRC-32 ̐(rbg], LSBt@[Xg)
+
+
+/**
+ * @struct	CRC_TABLE
+ * @brief	XCVOEoCE8 pCRCe[u
+ * @remarks	e[u[k][b] ̓oCg b ̌ k oCg0ꍇCRClłB
+ */
+typedef struct {
+	WORD		awCcitt[8][256];		//!< CRC-16/CCITT
+	WORD		awModbus[8][256];		//!< CRC-16/Modbus
+	DWORD		adwCrc32[8][256];		//!< CRC-32
+} CRC_TABLE;
+
+
+/**
+ * @fn			_crc_table_init
+ * @brief		CRCe[u쐬
+ * @param[out]	CRC_TABLE* pstTable		: CRCe[u
+ * @return		TRUE
+ */
+inline BOOL _crc_table_init(CRC_TABLE* pstTable)
+{
+	for (int b = 0; b < 256; b++) {
+		// MSBt@[Xg
+		WORD ccitt = (WORD)(b << 8);
+		// LSBt@[Xg
+		WORD modbus = (WORD)b;
+		DWORD crc32 = (DWORD)b;
+		for (int i = 0; i < 8; i++) {
+			ccitt = (ccitt & 0x8000) ? ((WORD)((ccitt << 1) ^ CRC16_CCITT_POLY)) : ((WORD)(ccitt << 1));
+			modbus = (modbus & 1) ? ((WORD)((modbus >> 1) ^ CRC16_MODBUS_POLY)) : ((WORD)(modbus >> 1));
+			crc32 = (crc32 & 1) ? ((crc32 >> 1) ^ CRC32_POLY) : (crc32 >> 1);
+		}
+		pstTable->awCcitt[0][b] = ccitt;
+		pstTable->awModbus[0][b] = modbus;
+		pstTable->adwCrc32[0][b] = crc32;
+	}
+	for (int k = 1; k < 8; k++) {
+		for (int b = 0; b < 256; b++) {
+			WORD ccitt = pstTable->awCcitt[k - 1][b];
+			WORD modbus = pstTable->awModbus[k - 1][b];
+			DWORD crc32 = pstTable->adwCrc32[k - 1][b];
+			pstTable->awCcitt[k][b] = (WORD)((ccitt << 8) ^ pstTable->awCcitt[0][ccitt >> 8]);
+			pstTable->awModbus[k][b] = (WORD)((modbus >> 8) ^ pstTable->awModbus[0][modbus & 0xFF]);
+			pstTable->adwCrc32[k][b] = (crc32 >> 8) ^ pstTable->adwCrc32[0][crc32 & 0xFF];
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * @fn			_crc_table
+ * @brief		CRCe[u擾(ďoɍ쐬, S|Pʂŋʂ1)
+ * @return		CRCe[u
+ */
+inline const CRC_TABLE* _crc_table()
+{
+	static CRC_TABLE s_stTable;
+	static const BOOL s_bInit = _crc_table_init(&s_stTable);	// ÓIǏϐ̏̓XbhZ[t
+	(void)s_bInit;
+	return &s_stTable;
+}
+
+
+/**
+ * @fn			bcc_update
+ * @brief		BCC(SoCgXOR)vZ
+ * @param[in]	BYTE byBcc			: r܂łBCCl(0)
+ * @param[in]	const void* pData	: vZΏۃf[^
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		BCCl
+ */
+inline BYTE bcc_update(BYTE byBcc, const void* pData, int nByteLen)
+{
+	const BYTE* p = (const BYTE*)pData;
+	int i = 0;
+
+	if (16 <= nByteLen) {
+		__m128i acc = _mm_setzero_si128();
+		for (; i + 16 <= nByteLen; i += 16) {
+			acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i*)(p + i)));
+		}
+		// 8oCg8oCgɏݍ
+		acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+		ULONGLONG ull;
+		_mm_storel_epi64((__m128i*)&ull, acc);
+		for (; i + 8 <= nByteLen; i += 8) {
+			ULONGLONG v;
+			memcpy(&v, p + i, sizeof(v));
+			ull ^= v;
+		}
+		ull ^= ull >> 32;
+		ull ^= ull >> 16;
+		ull ^= ull >> 8;
+		byBcc ^= (BYTE)ull;
+	}
+	for (; i < nByteLen; i++) {
+		byBcc ^= p[i];
+	}
+	return byBcc;
+}
+
+/**
+ * @fn			sum_update
+ * @brief		SoCg̉ZlvZ(LRC p)
+ * @param[in]	DWORD dwSum			: r܂ł̉Zl(0)
+ * @param[in]	const void* pData	: vZΏۃf[^
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		Zl(2^32 Ő܂Ԃ)
+ */
+inline DWORD sum_update(DWORD dwSum, const void* pData, int nByteLen)
+{
+	const BYTE* p = (const BYTE*)pData;
+	int i = 0;
+
+	if (16 <= nByteLen) {
+		// psadbw 16oCg264bitlɉZ
+		const __m128i zero = _mm_setzero_si128();
+		__m128i acc = _mm_setzero_si128();
+		for (; i + 16 <= nByteLen; i += 16) {
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(p + i)), zero));
+		}
+		acc = _mm_add_epi64(acc, _mm_srli_si128(acc, 8));
+		dwSum += (DWORD)_mm_cvtsi128_si32(acc);
+	}
+	for (; i < nByteLen; i++) {
+		dwSum += p[i];
+	}
+	return dwSum;
+}
+
+/**
+ * @fn			lrc_final
+ * @brief		Zl LRC(Zl2̕␔̉1oCg)𓾂
+ * @param[in]	DWORD dwSum		: sum_update ̉Zl
+ * @return		LRCl
+ */
+inline BYTE lrc_final(DWORD dwSum)
+{
+	return (BYTE)((~dwSum + 1) & 0xFF);
+}
+
+/**
+ * @fn			crc16_ccitt_update
+ * @brief		CRC-16/CCITT( 0x1021, MSBt@[Xg)vZ
+ * @param[in]	WORD wCrc			: r܂łCRCl( CRC16_CCITT_INIT ܂ 0)
+ * @param[in]	const void* pData	: vZΏۃf[^
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		CRCl
+ */
+inline WORD crc16_ccitt_update(WORD wCrc, const void* pData, int nByteLen)
+{
+	const CRC_TABLE* pstTable = _crc_table();
+	const BYTE* p = (const BYTE*)pData;
+	int i = 0;
+
+	for (; i + 8 <= nByteLen; i += 8) {
+		wCrc = (WORD)(pstTable->awCcitt[7][p[i] ^ (wCrc >> 8)]
+			^ pstTable->awCcitt[6][p[i + 1] ^ (wCrc & 0xFF)]
+			^ pstTable->awCcitt[5][p[i + 2]]
+			^ pstTable->awCcitt[4][p[i + 3]]
+			^ pstTable->awCcitt[3][p[i + 4]]
+			^ pstTable->awCcitt[2][p[i + 5]]
+			^ pstTable->awCcitt[1][p[i + 6]]
+			^ pstTable->awCcitt[0][p[i + 7]]);
+	}
+	for (; i < nByteLen; i++) {
+		wCrc = (WORD)((wCrc << 8) ^ pstTable->awCcitt[0][(wCrc >> 8) ^ p[i]]);
+	}
+	return wCrc;
+}
+
+/**
+ * @fn			crc16_modbus_update
+ * @brief		CRC-16/Modbus( 0xA001, LSBt@[Xg)vZ
+ * @param[in]	WORD wCrc			: r܂łCRCl( CRC16_MODBUS_INIT)
+ * @param[in]	const void* pData	: vZΏۃf[^
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		CRCl(dɂ͉ʃoCgAʃoCg̏ɕt)
+ */
+inline WORD crc16_modbus_update(WORD wCrc, const void* pData, int nByteLen)
+{
+	const CRC_TABLE* pstTable = _crc_table();
+	const BYTE* p = (const BYTE*)pData;
+	int i = 0;
+
+	for (; i + 8 <= nByteLen; i += 8) {
+		wCrc = (WORD)(pstTable->awModbus[7][p[i] ^ (wCrc & 0xFF)]
+			^ pstTable->awModbus[6][p[i + 1] ^ (wCrc >> 8)]
+			^ pstTable->awModbus[5][p[i + 2]]
+			^ pstTable->awModbus[4][p[i + 3]]
+			^ pstTable->awModbus[3][p[i + 4]]
+			^ pstTable->awModbus[2][p[i + 5]]
+			^ pstTable->awModbus[1][p[i + 6]]
+			^ pstTable->awModbus[0][p[i + 7]]);
+	}
+	for (; i < nByteLen; i++) {
+		wCrc = (WORD)((wCrc >> 8) ^ pstTable->awModbus[0][(wCrc ^ p[i]) & 0xFF]);
+	}
+	return wCrc;
+}
+
+/**
+ * @fn			crc32_update
+ * @brief		CRC-32( 0xEDB88320, LSBt@[Xg, ZIP/Ethernet ݊)vZ
+ * @param[in]	DWORD dwCrc			: r܂łCRCl( CRC32_INIT)
+ * @param[in]	const void* pData	: vZΏۃf[^
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		CRCl(ŏIl crc32_final œ)
+ */
+inline DWORD crc32_update(DWORD dwCrc, const void* pData, int nByteLen)
+{
+	const CRC_TABLE* pstTable = _crc_table();
+	const BYTE* p = (const BYTE*)pData;
+	int i = 0;
+
+	for (; i + 8 <= nByteLen; i += 8) {
+		DWORD lo, hi;
+		memcpy(&lo, p + i, sizeof(lo));
+		memcpy(&hi, p + i + 4, sizeof(hi));
+		lo ^= dwCrc;
+		dwCrc = pstTable->adwCrc32[7][lo & 0xFF]
+			^ pstTable->adwCrc32[6][(lo >> 8) & 0xFF]
+			^ pstTable->adwCrc32[5][(lo >> 16) & 0xFF]
+			^ pstTable->adwCrc32[4][lo >> 24]
+			^ pstTable->adwCrc32[3][hi & 0xFF]
+			^ pstTable->adwCrc32[2][(hi >> 8) & 0xFF]
+			^ pstTable->adwCrc32[1][(hi >> 16) & 0xFF]
+			^ pstTable->adwCrc32[0][hi >> 24];
+	}
+	for (; i < nByteLen; i++) {
+		dwCrc = (dwCrc >> 8) ^ pstTable->adwCrc32[0][(dwCrc ^ p[i]) & 0xFF];
+	}
+	return dwCrc;
+}
+
+/**
+ * @fn			crc32_final
+ * @brief		CRC-32 ̍ŏIl𓾂
+ * @param[in]	DWORD dwCrc		: crc32_update CRCl
+ * @return		CRC-32l
+ */
+inline DWORD crc32_final(DWORD dwCrc)
+{
+	return ~dwCrc;
+}
@@ -11,14 +11,18 @@
 #include <string.h>
 #include <errno.h>
 #include <windows.h>
+#include "time_cache.h"
+#include "Lock.h"
 
 
 #define MAX_ID		(10)
 #define LOG_MAX		(256)
+#define LOG_BUFF	(8 * 1024)		// t@CJ܂܂̏ꍇ̏݃obt@TCY
+#define LOG_PERIOD	(1000)			// LOG_FLUSH_INTERVAL ̃tbV(ms)
 
 
 //! OIDƂ̔rIuWFNg
-static CRITICAL_SECTION	g_cs[MAX_ID];
+static CLockCS<>		g_cLock[MAX_ID];
 //! Ot@CpX
 static char				g_szLogPath[MAX_ID][MAX_PATH];
 //! OIDgp
@@ -26,6 +30,16 @@ static BOOL				g_bUsed[MAX_ID] = {
 	FALSE, FALSE, FALSE, FALSE, FALSE,
 	FALSE, FALSE, FALSE, FALSE, FALSE
 };
+//! J܂܂̃Ot@C(LOG_FLUSH_CLOSE ȊO)
+static FILE*			g_fpLog[MAX_ID];
+//! tbV@
+static int				g_nFlush[MAX_ID];
+//! tbV(ms)
+static DWORD			g_dwPeriod[MAX_ID];
+//! OtbV(ms)
+static DWORD			g_dwLastFlush[MAX_ID];
+//! ݃obt@TCY
+static int				g_nBuffSize[MAX_ID];
 
 
 /**
@@ -40,6 +54,33 @@ typedef enum LOG_LEVEL {
 }_LOG_LEVEL;
 
 
+/**
+ * @enum	LOG_FLUSH_MODE
+ * @brief	Ot@C̏(tbV)@
+ * @remarks	LOG_FLUSH_CLOSE ȊO̓t@CJ܂܂ƂAERR x̃O͏ɑtbV
+ */
+typedef enum LOG_FLUSH_MODE {
+	LOG_FLUSH_CLOSE = 0,		// 1sɃt@CJ(])
+	LOG_FLUSH_LINE,				// 1sɃtbV
+	LOG_FLUSH_INTERVAL,			// ÕtbVw莞Ԍoߌ̏ݎɃtbV
+	LOG_FLUSH_ERROR				// ERR x̏ݎ(܂̓obt@t)̂݃tbV
+}_LOG_FLUSH_MODE;
+
+
+/**
+ * @fn		close_file
+ * @brief	J܂܂̃Ot@Cŕ
+ * @param	[in]	int nID		: OID
+ */
+static void close_file(int nID)
+{
+	if (g_fpLog[nID] != NULL) {
+		fclose(g_fpLog[nID]);
+		g_fpLog[nID] = NULL;
+	}
+}
+
+
 /**
  * @fn		log_level
  * @brief	
@@ -116,7 +157,11 @@ int log_start(int nID, const char* szPath)
 
 	memset(g_szLogPath[id], 0, sizeof(g_szLogPath[id]));
 	strncpy(g_szLogPath[id], szPath, sizeof(g_szLogPath[id]));
-	InitializeCriticalSection(&(g_cs[id]));
+	g_fpLog[id] = NULL;
+	g_nFlush[id] = LOG_FLUSH_CLOSE;
+	g_dwPeriod[id] = LOG_PERIOD;
+	g_nBuffSize[id] = LOG_BUFF;
+	g_cLock[id].Init();
 	g_bUsed[id] = TRUE;
 
 	return id;
@@ -151,7 +196,11 @@ int log_end(int nID)
 	if (0 <= nID) {
 		// wID̂݊J
 		if (g_bUsed[nID] == TRUE) {
-			DeleteCriticalSection(&(g_cs[nID]));
+			{
+				CLockGuard<CLockCS<> > cGuard(g_cLock[nID]);
+				close_file(nID);
+			}
+			g_cLock[nID].Exit();
 			g_bUsed[nID] = FALSE;
 		}
 	}
@@ -159,7 +208,11 @@ int log_end(int nID)
 		// SIDJ
 		for (int i = 0; i < MAX_ID; i++) {
 			if (g_bUsed[i] == TRUE) {
-				DeleteCriticalSection(&(g_cs[i]));
+				{
+					CLockGuard<CLockCS<> > cGuard(g_cLock[i]);
+					close_file(i);
+				}
+				g_cLock[i].Exit();
 				g_bUsed[i] = FALSE;
 			}
 		}
@@ -177,6 +230,55 @@ int _log_end()
 	return log_end(0);
 }
 
+/**
+ * @fn		log_set_flush
+ * @brief	Ot@C̏(tbV)@ݒ肷
+ * @param	[in]	int nID				: OID
+ * @param	[in]	int nMode			: tbV@(LOG_FLUSH_MODE)
+ * @param	[in]	DWORD dwPeriod		: LOG_FLUSH_INTERVAL ̃tbV(ms)
+ * @param	[in]	int nBuffSize		: ݃obt@TCY
+ * @return@0:, -1:s
+ * @remarks	͏ݎɔ肷邽߁A݂r₦ꍇ log_flush() ĂԂ
+ */
+int log_set_flush(int nID, int nMode, DWORD dwPeriod, int nBuffSize)
+{
+	if (nID < 0 || MAX_ID <= nID || g_bUsed[nID] != TRUE) {
+		return -1;
+	}
+	if (nMode < LOG_FLUSH_CLOSE || LOG_FLUSH_ERROR < nMode || nBuffSize <= 0) {
+		return -1;
+	}
+
+	CLockGuard<CLockCS<> > cGuard(g_cLock[nID]);
+	// 񏑍ݎɐVݒŊJ
+	close_file(nID);
+	g_nFlush[nID] = nMode;
+	g_dwPeriod[nID] = dwPeriod;
+	g_nBuffSize[nID] = nBuffSize;
+	return 0;
+}
+
+/**
+ * @fn		log_flush
+ * @brief	݃obt@̃Ot@Cɏ
+ * @param	[in]	int nID		: OID
+ * @return@0:, -1:s
+ */
+int log_flush(int nID)
+{
+	if (nID < 0 || MAX_ID <= nID || g_bUsed[nID] != TRUE) {
+		return -1;
+	}
+
+	int ret = 0;
+	CLockGuard<CLockCS<> > cGuard(g_cLock[nID]);
+	if (g_fpLog[nID] != NULL) {
+		ret = (fflush(g_fpLog[nID]) == 0) ? (0) : (-1);
+		g_dwLastFlush[nID] = GetTickCount();
+	}
+	return ret;
+}
+
 /**
  * @fn		_write
  * @brief	
@@ -204,35 +306,47 @@ static int _write(int nID, int nLevel, const char* szFmt, va_list arg)
 	vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
 	//va_end(arg);
 
-	EnterCriticalSection(&(g_cs[nID]));
-	errno = 0;
-	FILE *fp = fopen(g_szLogPath[nID], "a+");
+	CLockGuard<CLockCS<> > cGuard(g_cLock[nID]);
+	FILE *fp = g_fpLog[nID];
 	if (fp == NULL) {
-		if (errno != 0) perror(NULL);
-		return -1;
+		errno = 0;
+		fp = fopen(g_szLogPath[nID], "a+");
+		if (fp == NULL) {
+			if (errno != 0) perror(NULL);
+			return -1;
+		}
+		if (g_nFlush[nID] != LOG_FLUSH_CLOSE) {
+			// J܂܂ƂA݃obt@ɗ߂
+			setvbuf(fp, NULL, _IOFBF, g_nBuffSize[nID]);
+			g_fpLog[nID] = fp;
+			g_dwLastFlush[nID] = GetTickCount();
+		}
 	}
 
-	SYSTEMTIME stTime;
-	GetLocalTime((LPSYSTEMTIME)&stTime);
+	char szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
 	snprintf(szBuff1, sizeof(szBuff1),
-		"%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, %s\n"
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
+		"%s, %s, %s\n"
+		, szTime
 		, log_level(nLevel)
 		, szBuff0);
 	fputs(szBuff1, fp);
 
+	if (g_nFlush[nID] != LOG_FLUSH_CLOSE) {
+		DWORD now = GetTickCount();
+		if (nLevel == ERR
+			|| g_nFlush[nID] == LOG_FLUSH_LINE
+			|| (g_nFlush[nID] == LOG_FLUSH_INTERVAL && g_dwPeriod[nID] <= now - g_dwLastFlush[nID])) {
+			fflush(fp);
+			g_dwLastFlush[nID] = now;
+		}
+		return 0;
+	}
+
 	if (fclose(fp) != 0) {
 		if (errno != 0) perror(NULL);
-		LeaveCriticalSection(&(g_cs[nID]));
 		return -1;
 	}
-	LeaveCriticalSection(&(g_cs[nID]));
 	return 0;
 }
 
@@ -0,0 +1,539 @@
+/**
+ * @file	log_binary.h
+ * @brief	oCi`O(ID + ̐f[^ + QPC^CX^v + yC[h)
+ * @author	?
+ * @date	?
+ * @remarks
+ *		[g̒ʐMg[XɁAOo͎̕񐮌`E16i_vs킸
+ *		IDA̐f[^AQPCJE^lAyC[h(Mf[^)̂܂܋L^܂B
+ *		eLXgւ̕ϊ̓ItC log_decode.cpp (fR[hc[)ɂs܂B
+ *
+ *		t@C̓R[h̕тŁAȉ̃R[hʂ܂(gGfBAApfBO)B
+ *		- LOG_BIN_TYPE_SESSION	: t@CI[vɏóBQPCgƊ(QPClƃ[J)Asize_t ̃TCY
+ *		- LOG_BIN_TYPE_FORMAT	: IDɁÃt@C(ZbV)ŏ߂ĎgpɏóB
+ *		- LOG_BIN_TYPE_LOG		: O1BxAIDAQPClA̐f[^AyC[h
+ *		̓t@CɋL^邽߁AfR[hɃ\[Xst@C͕svłB
+ *
+ *		 printf `ŁǍ^͕ϊwq蔻肵܂(%n, Ch͖Ή)B
+ *		%zu, %Iu, %td ̈̃TCY͋L^vZX size_t ɏ]߁AfR[h̓ZbVR[h
+ *		bySizeT Ŕ肵܂(32bit/64bit ̂ǂŋL^t@CfR[_ŕϊł܂)B
+ *		(%s) LOG_BIN_MAX_STR ܂łL^܂(͋L^AfR[hʂ؂l߂܂)B
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <io.h>
+#include <windows.h>
+
+
+#define LOG_BIN_MAGIC			(0x474F4C42)	//!< ZbVR[h̎ʎq("BLOG")
+#define LOG_BIN_VERSION			(2)				//!< t@C`o[W
+#define LOG_BIN_MAX_FORMAT		(1024)			//!< o^\ȏ(ID:1`LOG_BIN_MAX_FORMAT-1)
+#define LOG_BIN_MAX_FMTLEN		(LOG_BIN_MAX_FORMAT - 1)	//!< ̍ő咷(I[AfR[_̓Ǎ݃obt@ɍ킹)
+#define LOG_BIN_MAX_ARGS		(16)			//!< ̍ő('*'w̕Ex܂)
+#define LOG_BIN_MAX_ARGBYTES	(1024)			//!< O1̈f[^̍őTCY
+#define LOG_BIN_MAX_STR			(255)			//!< ̍őL^
+#define LOG_BIN_MAX_PAYLOAD		(1024 * 1024)	//!< O1̃yC[h̍őTCY(͋L^Ȃ)
+#define LOG_BIN_BUFF_SIZE		(64 * 1024)		//!< t@C݃obt@TCY
+#define LOG_BIN_FMTID_FAILED	(-1)			//!< IDێϐ:o^s(Ȍ͓o^Ȃ)
+#define LOG_BIN_FMTID_PENDING	(-2)			//!< IDێϐ:̃Xbho^
+
+// R[h
+#define LOG_BIN_TYPE_SESSION	(1)
+#define LOG_BIN_TYPE_FORMAT		(2)
+#define LOG_BIN_TYPE_LOG		(3)
+
+// ̌^
+#define LOG_BIN_ARG_INT			(1)				//!< int(4byte)
+#define LOG_BIN_ARG_INT64		(2)				//!< long long(8byte)
+#define LOG_BIN_ARG_DOUBLE		(3)				//!< double(8byte)
+#define LOG_BIN_ARG_STR			(4)				//!< (2byte + , I[)
+#define LOG_BIN_ARG_PTR			(5)				//!< |C^(8byte)
+
+// yC[h̃eLXgϊ@
+#define LOG_BIN_DUMP_HEX		(0)				//!< mem_dump `("XX ")
+#define LOG_BIN_DUMP_ASCII		(1)				//!< mem_dump2 `("XX[ASC] ")
+
+
+#pragma pack(push, 1)
+/**
+ * @struct	LOG_BIN_SESSION
+ * @brief	ZbVR[h
+ */
+typedef struct {
+	BYTE		byType;				//!< LOG_BIN_TYPE_SESSION
+	DWORD		dwMagic;			//!< LOG_BIN_MAGIC
+	WORD		wVersion;			//!< LOG_BIN_VERSION
+	LONGLONG	llQpcFreq;			//!< QPCg
+	LONGLONG	llQpcBase;			//!< QPCl
+	ULONGLONG	ullTimeBase;		//!< ([JFILETIMEl)
+	BYTE		bySizeT;			//!< L^vZX size_t ̃TCY(4 or 8)
+} LOG_BIN_SESSION;
+
+/**
+ * @struct	LOG_BIN_FORMAT
+ * @brief	R[h(ɏ wLength )
+ */
+typedef struct {
+	BYTE		byType;				//!< LOG_BIN_TYPE_FORMAT
+	WORD		wId;				//!< ID
+	WORD		wLength;			//!< ̕
+} LOG_BIN_FORMAT;
+
+/**
+ * @struct	LOG_BIN_RECORD
+ * @brief	OR[h(Ɉf[^ wArgBytes oCgAyC[h dwPayload oCg)
+ */
+typedef struct {
+	BYTE		byType;				//!< LOG_BIN_TYPE_LOG
+	BYTE		byLevel;			//!< Ox
+	BYTE		byDump;				//!< yC[h̃eLXgϊ@(LOG_BIN_DUMP_xxx)
+	WORD		wId;				//!< ID
+	LONGLONG	llQpc;				//!< QPCl
+	WORD		wArgBytes;			//!< f[^̃TCY
+	DWORD		dwPayload;			//!< yC[h̃TCY
+} LOG_BIN_RECORD;
+#pragma pack(pop)
+
+
+/**
+ * @struct	LOG_BIN_FMTINFO
+ * @brief	o^ςݏ
+ */
+typedef struct {
+	const char*	szFmt;						//!< (񃊃eAvZXI܂ŗLȂ)
+	int			nArgs;						//!< 
+	BYTE		abyArgs[LOG_BIN_MAX_ARGS];	//!< ̌^(LOG_BIN_ARG_xxx)
+} LOG_BIN_FMTINFO;
+
+/**
+ * @struct	LOG_BINARY
+ * @brief	oCiOt@C
+ */
+typedef struct {
+	FILE*		fp;										//!< Ot@C
+	LONGLONG	llWritten;								//!< t@CTCY(݃oCg)
+	BYTE		abyEmitted[LOG_BIN_MAX_FORMAT / 8];		//!< R[ho͍ς݃tO(ID̃rbg)
+} LOG_BINARY;
+
+
+int			log_bin_parse_format(const char* szFmt, BYTE* pbyArgs, int nMax, int nSizeT);
+int			log_bin_register(volatile LONG* plFmtId, const char* szFmt);
+const LOG_BIN_FMTINFO* log_bin_get_format(int nId);
+int			log_bin_open(LOG_BINARY* pstBin, const char* szPath);
+int			log_bin_close(LOG_BINARY* pstBin);
+int			log_bin_flush(LOG_BINARY* pstBin);
+int			log_bin_write(LOG_BINARY* pstBin, int nLevel, int nId, int nDump, const void* pPayload, int nPayload, va_list arg);
+
+
+/**
+ * @fn			_log_bin_registry
+ * @brief		o^e[u擾(S|Pʂŋʂ1)
+ * @return		o^e[u(vf0͖gp)
+ */
+inline LOG_BIN_FMTINFO* _log_bin_registry()
+{
+	static LOG_BIN_FMTINFO s_astFmt[LOG_BIN_MAX_FORMAT];
+	return s_astFmt;
+}
+
+/**
+ * @fn			_log_bin_count
+ * @brief		o^ςݏ̃JE^擾(S|Pʂŋʂ1)
+ * @return		JE^
+ */
+inline volatile LONG* _log_bin_count()
+{
+	static volatile LONG s_lCount = 0;
+	return &s_lCount;
+}
+
+/**
+ * @fn			log_bin_parse_format
+ * @brief		printf `̏̌^̕т𓾂
+ * @param[in]	const char* szFmt		: 
+ * @param[out]	BYTE* pbyArgs			: ̌^(LOG_BIN_ARG_xxx)̊i[
+ * @param[in]	int nMax				: i[̗vf
+ * @param[in]	int nSizeT				: L^vZX size_t ̃TCY(%z, %I, %t ̈TCY)
+ * @return		0`:, -1:Ή̏(%n, Ch, )
+ * @remarks
+ *		GR[h(L^)ƃfR[h(log_decode.cpp)œsߋʉĂ܂B
+ *		fR[h nSizeT ɃZbVR[h bySizeT nĂ(fR[_g size_t ł͂Ȃ)B
+ */
+inline int log_bin_parse_format(const char* szFmt, BYTE* pbyArgs, int nMax, int nSizeT)
+{
+	if (szFmt == NULL || pbyArgs == NULL) {
+		return -1;
+	}
+
+	int n = 0;
+	const char* p = szFmt;
+	while (*p != '\0') {
+		if (*p++ != '%') {
+			continue;
+		}
+		if (*p == '%') {
+			p++;
+			continue;
+		}
+		// tO
+		while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+			p++;
+		}
+		// 
+		if (*p == '*') {
+			if (nMax <= n) return -1;
+			pbyArgs[n++] = LOG_BIN_ARG_INT;
+			p++;
+		}
+		while ('0' <= *p && *p <= '9') {
+			p++;
+		}
+		// x
+		if (*p == '.') {
+			p++;
+			if (*p == '*') {
+				if (nMax <= n) return -1;
+				pbyArgs[n++] = LOG_BIN_ARG_INT;
+				p++;
+			}
+			while ('0' <= *p && *p <= '9') {
+				p++;
+			}
+		}
+		// Cq(Windows  long 4byte)
+		int size = sizeof(int);
+		if (p[0] == 'l' && p[1] == 'l') { size = sizeof(long long); p += 2; }
+		else if (p[0] == 'I' && p[1] == '6' && p[2] == '4') { size = sizeof(long long); p += 3; }
+		else if (p[0] == 'I' && p[1] == '3' && p[2] == '2') { size = sizeof(int); p += 3; }
+		else if (*p == 'I' || *p == 'z' || *p == 't') { size = nSizeT; p++; }
+		else if (*p == 'j') { size = sizeof(long long); p++; }
+		else if (*p == 'h') { p++; if (*p == 'h') p++; }
+		else if (*p == 'l') { size = sizeof(long); p++; if (*p == 's' || *p == 'c') return -1; }
+		else if (*p == 'L') { p++; }
+		else if (*p == 'w') { return -1; }
+
+		BYTE type;
+		switch (*p) {
+		case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+			type = (size == sizeof(long long)) ? (LOG_BIN_ARG_INT64) : (LOG_BIN_ARG_INT);
+			break;
+		case 'c':
+			type = LOG_BIN_ARG_INT;
+			break;
+		case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+			type = LOG_BIN_ARG_DOUBLE;
+			break;
+		case 's':
+			type = LOG_BIN_ARG_STR;
+			break;
+		case 'p':
+			type = LOG_BIN_ARG_PTR;
+			break;
+		default:
+			// %n, %S, %C 
+			return -1;
+		}
+		if (nMax <= n) return -1;
+		pbyArgs[n++] = type;
+		p++;
+	}
+	return n;
+}
+
+/**
+ * @fn			_log_bin_reserve
+ * @brief		͂Ao^gmۂď
+ * @param[in]	const char* szFmt	: 
+ * @return		1`:ID, -1:s
+ */
+inline int _log_bin_reserve(const char* szFmt)
+{
+	// ؂l߂ƈ̉߂邽߁A鏑͓o^Ȃ
+	if (szFmt == NULL || LOG_BIN_MAX_FMTLEN < strnlen(szFmt, LOG_BIN_MAX_FMTLEN + 1)) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	BYTE abyArgs[LOG_BIN_MAX_ARGS];
+	int nArgs = log_bin_parse_format(szFmt, abyArgs, LOG_BIN_MAX_ARGS, (int)sizeof(size_t));
+	if (nArgs < 0) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	// o^̏(LOG_BIN_MAX_FORMAT - 1)𒴂Ȃ悤ɘgmۂ
+	volatile LONG* plCount = _log_bin_count();
+	LONG lCount = *plCount;
+	LONG id;
+	do {
+		if (lCount < 0 || LOG_BIN_MAX_FORMAT - 1 <= lCount) {
+			return -1;
+		}
+		id = lCount + 1;
+	} while ((lCount = ::InterlockedCompareExchange(plCount, id, lCount)) != id - 1);
+
+	LOG_BIN_FMTINFO* pstInfo = &_log_bin_registry()[id];
+	pstInfo->szFmt = szFmt;
+	pstInfo->nArgs = nArgs;
+	memcpy(pstInfo->abyArgs, abyArgs, nArgs);
+
+	return id;
+}
+
+/**
+ * @fn				log_bin_register
+ * @brief			o^ID𓾂(ďoӏ1̂ݓo^)
+ * @param[in,out]	volatile LONG* plFmtId	: ďoӏ̏IDێϐ(0:o^, 1`:o^ς݂ID, -1:o^s)
+ * @param[in]		const char* szFmt		: (vZXI܂ŗLȂ)
+ * @return			1`:ID, -1:s(o^߁AΉ̏A LOG_BIN_MAX_FMTLEN 𒴂)
+ * @remarks
+ *		rbN͎gpAo^g̊mۂ InterlockedCompareExchange ōs܂(LOG_BIN_MAX_FORMAT ͒Ȃ)B
+ *		ďoӏ͐ LOG_BIN_FMTID_PENDING 񂾃Xbho^AɌĂ񂾑̃Xbh
+ *		IDJ܂ő҂߁A1̌ďoӏ̘ggƂ͂܂B
+ *		s *plFmtId ɋL^邽߁Ao^ߌ̌ďo͘gmۂ -1 Ԃ܂B
+ */
+inline int log_bin_register(volatile LONG* plFmtId, const char* szFmt)
+{
+	LONG id = *plFmtId;
+	if (0 < id) {
+		return id;
+	}
+	if (id == LOG_BIN_FMTID_FAILED) {
+		return -1;
+	}
+
+	// ďoӏ̓o^擾(̃Xbho^ȂIĎJ҂)
+	while ((id = ::InterlockedCompareExchange(plFmtId, LOG_BIN_FMTID_PENDING, 0)) != 0) {
+		if (id != LOG_BIN_FMTID_PENDING) {
+			return (0 < id) ? (id) : (-1);
+		}
+		::SwitchToThread();
+	}
+
+	id = _log_bin_reserve(szFmt);
+
+	// łJ(Interlocked ̓toA)
+	::InterlockedExchange(plFmtId, (0 < id) ? (id) : (LOG_BIN_FMTID_FAILED));
+	return (0 < id) ? (id) : (-1);
+}
+
+/**
+ * @fn			log_bin_get_format
+ * @brief		o^ς݂̏擾
+ * @param[in]	int nId		: ID
+ * @return		(NULL:o^)
+ */
+inline const LOG_BIN_FMTINFO* log_bin_get_format(int nId)
+{
+	if (nId <= 0 || LOG_BIN_MAX_FORMAT <= nId || *_log_bin_count() < nId) {
+		return NULL;
+	}
+	return &_log_bin_registry()[nId];
+}
+
+/**
+ * @fn			log_bin_open
+ * @brief		oCiOt@CJ(ǋL)AZbVR[ho͂
+ * @param[out]	LOG_BINARY* pstBin		: oCiOt@C
+ * @param[in]	const char* szPath		: t@CpX
+ * @return		0:, -1:s
+ */
+inline int log_bin_open(LOG_BINARY* pstBin, const char* szPath)
+{
+	if (pstBin == NULL || szPath == NULL) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	memset(pstBin, 0, sizeof(LOG_BINARY));
+
+	errno = 0;
+	pstBin->fp = fopen(szPath, "ab");
+	if (pstBin->fp == NULL) {
+		if (errno != 0) perror(NULL);
+		return -1;
+	}
+	setvbuf(pstBin->fp, NULL, _IOFBF, LOG_BIN_BUFF_SIZE);
+	// ǋL̂߁Ãt@CTCY݃oCg̏lƂ
+	fseek(pstBin->fp, 0, SEEK_END);
+	pstBin->llWritten = _ftelli64(pstBin->fp);
+
+	// (QPClƃ[J̑g)
+	LOG_BIN_SESSION stSession;
+	LARGE_INTEGER liFreq, liQpc;
+	FILETIME ft, ftLocal;
+	::QueryPerformanceFrequency(&liFreq);
+	::QueryPerformanceCounter(&liQpc);
+	::GetSystemTimeAsFileTime(&ft);
+	::FileTimeToLocalFileTime(&ft, &ftLocal);
+
+	stSession.byType = LOG_BIN_TYPE_SESSION;
+	stSession.dwMagic = LOG_BIN_MAGIC;
+	stSession.wVersion = LOG_BIN_VERSION;
+	stSession.llQpcFreq = liFreq.QuadPart;
+	stSession.llQpcBase = liQpc.QuadPart;
+	stSession.ullTimeBase = ((ULONGLONG)ftLocal.dwHighDateTime << 32) | ftLocal.dwLowDateTime;
+	stSession.bySizeT = (BYTE)sizeof(size_t);
+	fwrite(&stSession, sizeof(stSession), 1, pstBin->fp);
+	pstBin->llWritten += sizeof(stSession);
+
+	return 0;
+}
+
+/**
+ * @fn			log_bin_close
+ * @brief		oCiOt@C
+ * @param[in]	LOG_BINARY* pstBin		: oCiOt@C
+ * @return		0:, -1:s
+ */
+inline int log_bin_close(LOG_BINARY* pstBin)
+{
+	if (pstBin == NULL) {
+		return -1;
+	}
+	int ret = 0;
+	if (pstBin->fp != NULL) {
+		ret = (fclose(pstBin->fp) == 0) ? (0) : (-1);
+		pstBin->fp = NULL;
+	}
+	return ret;
+}
+
+/**
+ * @fn			log_bin_flush
+ * @brief		݃obt@̓et@Cɏ
+ * @param[in]	LOG_BINARY* pstBin		: oCiOt@C
+ * @return		0:, -1:s
+ */
+inline int log_bin_flush(LOG_BINARY* pstBin)
+{
+	if (pstBin == NULL || pstBin->fp == NULL) {
+		return -1;
+	}
+	return (fflush(pstBin->fp) == 0) ? (0) : (-1);
+}
+
+/**
+ * @fn			log_bin_write
+ * @brief		OR[ho͂(r͌ďoōs)
+ * @param[in]	LOG_BINARY* pstBin		: oCiOt@C
+ * @param[in]	int nLevel				: Ox
+ * @param[in]	int nId					: ID(log_bin_register)
+ * @param[in]	int nDump				: yC[h̃eLXgϊ@(LOG_BIN_DUMP_xxx)
+ * @param[in]	const void* pPayload	: yC[h(NULL:)
+ * @param[in]	int nPayload			: yC[h̃TCY(LOG_BIN_MAX_PAYLOAD ܂ŋL^)
+ * @param[in]	va_list arg				: p[^
+ * @return		0`:o͂oCg, -1:s
+ * @remarks		R[ho͂̃t@Cł́AOR[h̑OɏR[ho͂܂B
+ */
+inline int log_bin_write(LOG_BINARY* pstBin, int nLevel, int nId, int nDump, const void* pPayload, int nPayload, va_list arg)
+{
+	const LOG_BIN_FMTINFO* pstInfo = log_bin_get_format(nId);
+	if (pstBin == NULL || pstBin->fp == NULL || pstInfo == NULL) {
+		return -1;
+	}
+	if (pPayload == NULL || nPayload < 0) {
+		nPayload = 0;
+	}
+	else if (LOG_BIN_MAX_PAYLOAD < nPayload) {
+		nPayload = LOG_BIN_MAX_PAYLOAD;
+	}
+
+	LARGE_INTEGER liQpc;
+	::QueryPerformanceCounter(&liQpc);
+
+	// ̐f[^
+	BYTE abyArgs[LOG_BIN_MAX_ARGBYTES];
+	int len = 0;
+	for (int i = 0; i < pstInfo->nArgs; i++) {
+		switch (pstInfo->abyArgs[i]) {
+		case LOG_BIN_ARG_INT: {
+			int val = va_arg(arg, int);
+			if (LOG_BIN_MAX_ARGBYTES < len + (int)sizeof(val)) return -1;
+			memcpy(abyArgs + len, &val, sizeof(val));
+			len += sizeof(val);
+			break;
+		}
+		case LOG_BIN_ARG_INT64: {
+			long long val = va_arg(arg, long long);
+			if (LOG_BIN_MAX_ARGBYTES < len + (int)sizeof(val)) return -1;
+			memcpy(abyArgs + len, &val, sizeof(val));
+			len += sizeof(val);
+			break;
+		}
+		case LOG_BIN_ARG_DOUBLE: {
+			double val = va_arg(arg, double);
+			if (LOG_BIN_MAX_ARGBYTES < len + (int)sizeof(val)) return -1;
+			memcpy(abyArgs + len, &val, sizeof(val));
+			len += sizeof(val);
+			break;
+		}
+		case LOG_BIN_ARG_PTR: {
+			ULONGLONG val = (ULONGLONG)(ULONG_PTR)va_arg(arg, void*);
+			if (LOG_BIN_MAX_ARGBYTES < len + (int)sizeof(val)) return -1;
+			memcpy(abyArgs + len, &val, sizeof(val));
+			len += sizeof(val);
+			break;
+		}
+		case LOG_BIN_ARG_STR: {
+			const char* str = va_arg(arg, const char*);
+			if (str == NULL) {
+				str = "(null)";
+			}
+			size_t slen = strnlen(str, LOG_BIN_MAX_STR);
+			WORD wLen = (WORD)slen;
+			if (LOG_BIN_MAX_ARGBYTES < len + (int)sizeof(wLen) + (int)slen) return -1;
+			memcpy(abyArgs + len, &wLen, sizeof(wLen));
+			memcpy(abyArgs + len + sizeof(wLen), str, slen);
+			len += sizeof(wLen) + (int)slen;
+			break;
+		}
+		default:
+			return -1;
+		}
+	}
+
+	int written = 0;
+
+	// R[h(̃t@Cŏ߂Ďgp鏑̂)
+	BYTE bit = (BYTE)(1 << (nId & 7));
+	if ((pstBin->abyEmitted[nId >> 3] & bit) == 0) {
+		LOG_BIN_FORMAT stFormat;
+		stFormat.byType = LOG_BIN_TYPE_FORMAT;
+		stFormat.wId = (WORD)nId;
+		stFormat.wLength = (WORD)strlen(pstInfo->szFmt);
+		fwrite(&stFormat, sizeof(stFormat), 1, pstBin->fp);
+		fwrite(pstInfo->szFmt, sizeof(char), stFormat.wLength, pstBin->fp);
+		written += sizeof(stFormat) + stFormat.wLength;
+		pstBin->abyEmitted[nId >> 3] |= bit;
+	}
+
+	LOG_BIN_RECORD stRec;
+	stRec.byType = LOG_BIN_TYPE_LOG;
+	stRec.byLevel = (BYTE)nLevel;
+	stRec.byDump = (BYTE)nDump;
+	stRec.wId = (WORD)nId;
+	stRec.llQpc = liQpc.QuadPart;
+	stRec.wArgBytes = (WORD)len;
+	stRec.dwPayload = (DWORD)nPayload;
+	fwrite(&stRec, sizeof(stRec), 1, pstBin->fp);
+	fwrite(abyArgs, 1, len, pstBin->fp);
+	if (0 < nPayload) {
+		fwrite(pPayload, 1, nPayload, pstBin->fp);
+	}
+	written += sizeof(stRec) + len + nPayload;
+
+	pstBin->llWritten += written;
+	return written;
+}
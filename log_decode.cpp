@@ -0,0 +1,383 @@
+/**
+ * @file	log_decode.cpp
+ * @brief	oCi`O(log_binary.h)̃fR[hc[
+ * @author	?
+ * @date	?
+ * @remarks
+ *		LOG_START_BINARY ŏo͂oCiOt@CAeLXg`OƓ
+ *		"YYYY/MM/DD, hh:mm:ss.mmm, LVL, eLXg" `ɕϊ܂B
+ *		̓ZbVR[h̊(QPClƃ[J̑g)ƊeR[hQPCl苁߂܂B
+ *		yC[h̓R[h̎wɏ] mem_dump / mem_dump2 `ŃeLXǧɕt܂B
+ *		PƂ̃R\[AvP[VƂărhĂ(main.cpp Ƃ͕ʃvWFNg)B
+ *		usage: log_decode <oCiOt@C> [o̓eLXgt@C(ȗ͕Wo)]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+#include <vector>
+#include "log_binary.h"
+#include "time_cache.h"
+#include "misc.h"
+
+#define DECODE_MAX_TEXT		(4096)		//!< 1̃eLXg̍ő啶(yC[h)
+
+
+/**
+ * @struct	DECODE_FORMAT
+ * @brief	fR[hp̏(t@Cǂݍ񂾂)
+ */
+typedef struct {
+	BOOL		bValid;							//!< R[hǍݍς
+	char		szFmt[LOG_BIN_MAX_FMTLEN + 1];	//!< 
+	int			nArgs;							//!< (-1:Ή̏)
+	BYTE		abyArgs[LOG_BIN_MAX_ARGS];		//!< ̌^
+} DECODE_FORMAT;
+
+/**
+ * @struct	DECODE_SESSION
+ * @brief	fR[hp̃ZbV
+ */
+typedef struct {
+	LONGLONG	llQpcFreq;			//!< QPCg
+	LONGLONG	llQpcBase;			//!< QPCl
+	ULONGLONG	ullTimeBase;		//!< ([JFILETIMEl)
+	int			nSizeT;				//!< L^vZX size_t ̃TCY
+} DECODE_SESSION;
+
+
+/**
+ * @fn			qpc_to_time
+ * @brief		QPCl[J̓ɕϊ
+ * @param[in]	const DECODE_SESSION* pstSession	: ZbV
+ * @param[in]	LONGLONG llQpc						: QPCl
+ * @param[out]	char* pszBuff						: o͐(TIME_CACHE_LEN + 1 ȏ)
+ */
+static void qpc_to_time(const DECODE_SESSION* pstSession, LONGLONG llQpc, char* pszBuff)
+{
+	LONGLONG diff = llQpc - pstSession->llQpcBase;
+	LONGLONG freq = (0 < pstSession->llQpcFreq) ? (pstSession->llQpcFreq) : (1);
+	// ӂ邽߁Abƒ[ɕ100nsPʂɊZ
+	LONGLONG ticks = (diff / freq) * 10000000 + ((diff % freq) * 10000000) / freq;
+
+	ULONGLONG t = pstSession->ullTimeBase + ticks;
+	FILETIME ft;
+	ft.dwLowDateTime = (DWORD)(t & 0xFFFFFFFF);
+	ft.dwHighDateTime = (DWORD)(t >> 32);
+	SYSTEMTIME st;
+	::FileTimeToSystemTime(&ft, &st);
+	time_cache_format(pszBuff, &st);
+}
+
+/**
+ * @fn			level_name
+ * @brief		Ox̕\L𓾂
+ * @param[in]	int nLevel		: Ox
+ * @return		\L
+ */
+static const char* level_name(int nLevel)
+{
+	static const char* aszLevel[] = { "---", "ERR", "WAR", "INF", "DBG" };
+	if (nLevel < 0 || (int)COUNT_OF_ARRAY(aszLevel) <= nLevel) {
+		return "---";
+	}
+	return aszLevel[nLevel];
+}
+
+/**
+ * @fn			format_text
+ * @brief		ƈ̐f[^eLXg쐬
+ * @param[in]	const DECODE_FORMAT* pstFmt	: 
+ * @param[in]	const BYTE* pbyArgs			: ̐f[^
+ * @param[in]	int nArgBytes				: ̐f[^̃TCY
+ * @param[out]	char* pszText				: o͐
+ * @param[in]	int nText					: o͐̃TCY
+ * @param[in]	int nSizeT					: L^vZX size_t(|C^)̃TCY
+ * @return		0:, -1:s(f[^s)
+ * @remarks
+ *		ϊw薈ɋ؂Aꂼ snprintf Ő`܂B
+ *		'*' w̕Ex͈f[^oln܂B
+ *		Cq(z, I, t, l, ll )͋L^̃vZX̃TCY\߁AfR[_ł͎g킸A
+ *		L^̌^ɍ킹ĕt܂(8byte  llA4byte ͖Bh, hh ͂̂܂)B
+ *		%p ͋L^vZX̃|C^TCY̌(8܂16)16iŕ\L܂B
+ *		%s ͋L^ LOG_BIN_MAX_STR Ő؂l߂Ă܂(͕ł܂)B
+ */
+static int format_text(const DECODE_FORMAT* pstFmt, const BYTE* pbyArgs, int nArgBytes, char* pszText, int nText, int nSizeT)
+{
+	const char* p = pstFmt->szFmt;
+	int pos = 0;
+	int arg = 0;
+	int off = 0;
+
+	pszText[0] = '\0';
+	while (*p != '\0' && pos < nText - 1) {
+		if (*p != '%') {
+			pszText[pos++] = *p++;
+			continue;
+		}
+		if (p[1] == '%') {
+			pszText[pos++] = '%';
+			p += 2;
+			continue;
+		}
+
+		// ϊw1o(log_bin_parse_format Ɠ؂)
+		const char* start = p++;
+		int anStar[2];
+		int nStar = 0;
+		while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') p++;
+		if (*p == '*') { nStar++; p++; }
+		while ('0' <= *p && *p <= '9') p++;
+		if (*p == '.') {
+			p++;
+			if (*p == '*') { nStar++; p++; }
+			while ('0' <= *p && *p <= '9') p++;
+		}
+		const char* mod = p;
+		while (*p == 'l' || *p == 'h' || *p == 'I' || *p == 'z' || *p == 't' || *p == 'j' || *p == 'L' || *p == '6' || *p == '4' || *p == '3' || *p == '2') {
+			p++;
+		}
+		if (*p == '\0') {
+			break;
+		}
+		char conv = *p++;
+
+		// '*' ̒l
+		for (int i = 0; i < nStar; i++) {
+			if (pstFmt->nArgs <= arg || nArgBytes < off + (int)sizeof(int)) return -1;
+			memcpy(&anStar[i], pbyArgs + off, sizeof(int));
+			off += sizeof(int);
+			arg++;
+		}
+		if (pstFmt->nArgs <= arg) {
+			return -1;
+		}
+
+		// L^̒CqAsnprintf ɓnľ^ɍCqt
+		BYTE type = pstFmt->abyArgs[arg++];
+		const char* szMod = "";
+		if (type == LOG_BIN_ARG_INT64) {
+			szMod = "ll";
+		}
+		else if (type == LOG_BIN_ARG_INT && mod[0] == 'h') {
+			szMod = (mod[1] == 'h') ? ("hh") : ("h");
+		}
+		char szSpec[64];
+		int nSpec = (int)(mod - start);
+		if ((int)sizeof(szSpec) <= nSpec + (int)strlen(szMod) + 1) {
+			return -1;
+		}
+		memcpy(szSpec, start, nSpec);
+		snprintf(szSpec + nSpec, sizeof(szSpec) - nSpec, "%s%c", szMod, conv);
+
+		char* dest = pszText + pos;
+		int rest = nText - pos;
+		int n = 0;
+		switch (type) {
+		case LOG_BIN_ARG_INT: {
+			int val;
+			if (nArgBytes < off + (int)sizeof(val)) return -1;
+			memcpy(&val, pbyArgs + off, sizeof(val));
+			off += sizeof(val);
+			n = (nStar == 2) ? snprintf(dest, rest, szSpec, anStar[0], anStar[1], val)
+				: (nStar == 1) ? snprintf(dest, rest, szSpec, anStar[0], val)
+				: snprintf(dest, rest, szSpec, val);
+			break;
+		}
+		case LOG_BIN_ARG_INT64: {
+			long long val;
+			if (nArgBytes < off + (int)sizeof(val)) return -1;
+			memcpy(&val, pbyArgs + off, sizeof(val));
+			off += sizeof(val);
+			n = (nStar == 2) ? snprintf(dest, rest, szSpec, anStar[0], anStar[1], val)
+				: (nStar == 1) ? snprintf(dest, rest, szSpec, anStar[0], val)
+				: snprintf(dest, rest, szSpec, val);
+			break;
+		}
+		case LOG_BIN_ARG_DOUBLE: {
+			double val;
+			if (nArgBytes < off + (int)sizeof(val)) return -1;
+			memcpy(&val, pbyArgs + off, sizeof(val));
+			off += sizeof(val);
+			n = (nStar == 2) ? snprintf(dest, rest, szSpec, anStar[0], anStar[1], val)
+				: (nStar == 1) ? snprintf(dest, rest, szSpec, anStar[0], val)
+				: snprintf(dest, rest, szSpec, val);
+			break;
+		}
+		case LOG_BIN_ARG_PTR: {
+			ULONGLONG val;
+			if (nArgBytes < off + (int)sizeof(val)) return -1;
+			memcpy(&val, pbyArgs + off, sizeof(val));
+			off += sizeof(val);
+			// L^vZX %p ƓA|C^TCY̌16iŕ\L
+			n = snprintf(dest, rest, (nSizeT == 4) ? ("%08llX") : ("%016llX"), val);
+			break;
+		}
+		case LOG_BIN_ARG_STR: {
+			WORD wLen;
+			if (nArgBytes < off + (int)sizeof(wLen)) return -1;
+			memcpy(&wLen, pbyArgs + off, sizeof(wLen));
+			off += sizeof(wLen);
+			if (LOG_BIN_MAX_STR < wLen || nArgBytes < off + wLen) return -1;
+			char szStr[LOG_BIN_MAX_STR + 1];
+			memcpy(szStr, pbyArgs + off, wLen);
+			szStr[wLen] = '\0';
+			off += wLen;
+			n = (nStar == 2) ? snprintf(dest, rest, szSpec, anStar[0], anStar[1], szStr)
+				: (nStar == 1) ? snprintf(dest, rest, szSpec, anStar[0], szStr)
+				: snprintf(dest, rest, szSpec, szStr);
+			break;
+		}
+		default:
+			return -1;
+		}
+		if (n < 0) {
+			return -1;
+		}
+		pos += (rest <= n) ? (rest - 1) : (n);
+	}
+	pszText[pos] = '\0';
+	return 0;
+}
+
+/**
+ * @fn			decode
+ * @brief		oCiOt@CeLXgɕϊďo͂
+ * @param[in]	FILE* fpIn		: (oCiOt@C)
+ * @param[in]	FILE* fpOut		: o͐
+ * @return		0`:ϊO, -1:s(t@C`s)
+ */
+static int decode(FILE* fpIn, FILE* fpOut)
+{
+	std::vector<DECODE_FORMAT> vFormat(LOG_BIN_MAX_FORMAT);
+	DECODE_SESSION stSession = { 0 };
+	BOOL bSession = FALSE;
+	std::vector<BYTE> vArgs;
+	std::vector<BYTE> vPayload;
+	std::vector<char> vDump;
+	char szText[DECODE_MAX_TEXT];
+	char szTime[TIME_CACHE_LEN + 1];
+	int count = 0;
+
+	int type;
+	while ((type = fgetc(fpIn)) != EOF) {
+		ungetc(type, fpIn);
+
+		switch (type) {
+		case LOG_BIN_TYPE_SESSION: {
+			LOG_BIN_SESSION stRec;
+			if (fread(&stRec, sizeof(stRec), 1, fpIn) != 1
+				|| stRec.dwMagic != LOG_BIN_MAGIC || stRec.wVersion != LOG_BIN_VERSION
+				|| (stRec.bySizeT != 4 && stRec.bySizeT != 8)) {
+				return -1;
+			}
+			// ID̓ZbV(t@CI[v)ɏo͂邽߁Aj
+			for (size_t i = 0; i < vFormat.size(); i++) {
+				vFormat[i].bValid = FALSE;
+			}
+			stSession.llQpcFreq = stRec.llQpcFreq;
+			stSession.llQpcBase = stRec.llQpcBase;
+			stSession.ullTimeBase = stRec.ullTimeBase;
+			stSession.nSizeT = stRec.bySizeT;
+			bSession = TRUE;
+			break;
+		}
+		case LOG_BIN_TYPE_FORMAT: {
+			LOG_BIN_FORMAT stRec;
+			if (!bSession || fread(&stRec, sizeof(stRec), 1, fpIn) != 1
+				|| LOG_BIN_MAX_FORMAT <= stRec.wId || LOG_BIN_MAX_FMTLEN < stRec.wLength) {
+				return -1;
+			}
+			DECODE_FORMAT* pstFmt = &vFormat[stRec.wId];
+			if (fread(pstFmt->szFmt, 1, stRec.wLength, fpIn) != stRec.wLength) {
+				return -1;
+			}
+			pstFmt->szFmt[stRec.wLength] = '\0';
+			// TCY̓fR[_ł͂ȂL^vZX size_t Ŕ肷
+			pstFmt->nArgs = log_bin_parse_format(pstFmt->szFmt, pstFmt->abyArgs, LOG_BIN_MAX_ARGS, stSession.nSizeT);
+			pstFmt->bValid = TRUE;
+			break;
+		}
+		case LOG_BIN_TYPE_LOG: {
+			LOG_BIN_RECORD stRec;
+			if (!bSession || fread(&stRec, sizeof(stRec), 1, fpIn) != 1 || LOG_BIN_MAX_FORMAT <= stRec.wId
+				|| LOG_BIN_MAX_ARGBYTES < stRec.wArgBytes || LOG_BIN_MAX_PAYLOAD < stRec.dwPayload) {
+				// ݑ̏𒴂TCY͉ꂽwb_(mۑOɒe)
+				return -1;
+			}
+			vArgs.resize(stRec.wArgBytes + 1);
+			vPayload.resize(stRec.dwPayload + 1);
+			if (fread(&vArgs[0], 1, stRec.wArgBytes, fpIn) != stRec.wArgBytes
+				|| fread(&vPayload[0], 1, stRec.dwPayload, fpIn) != stRec.dwPayload) {
+				// ݓrŏIt@C
+				return count;
+			}
+
+			const DECODE_FORMAT* pstFmt = &vFormat[stRec.wId];
+			if (!pstFmt->bValid) {
+				snprintf(szText, sizeof(szText), "(unknown format id %d)", stRec.wId);
+			}
+			else if (pstFmt->nArgs < 0 || format_text(pstFmt, &vArgs[0], stRec.wArgBytes, szText, sizeof(szText), stSession.nSizeT) != 0) {
+				snprintf(szText, sizeof(szText), "(bad record: %s)", pstFmt->szFmt);
+			}
+
+			qpc_to_time(&stSession, stRec.llQpc, szTime);
+
+			if (0 < stRec.dwPayload) {
+				int width = (stRec.byDump == LOG_BIN_DUMP_ASCII) ? (8) : (3);
+				vDump.resize((size_t)stRec.dwPayload * width + 2);
+				const char* dump = (stRec.byDump == LOG_BIN_DUMP_ASCII)
+					? mem_dump2(&vPayload[0], stRec.dwPayload, &vDump[0], (int)vDump.size())
+					: mem_dump(&vPayload[0], stRec.dwPayload, &vDump[0], (int)vDump.size());
+				fprintf(fpOut, "%s, %s, %s %s\r\n", szTime, level_name(stRec.byLevel), szText, dump);
+			}
+			else {
+				fprintf(fpOut, "%s, %s, %s\r\n", szTime, level_name(stRec.byLevel), szText);
+			}
+			count++;
+			break;
+		}
+		default:
+			return -1;
+		}
+	}
+	return count;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr, "usage: log_decode <binary log> [text log]\r\n");
+		return 1;
+	}
+
+	FILE* fpIn = fopen(argv[1], "rb");
+	if (fpIn == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+	FILE* fpOut = stdout;
+	if (2 < argc) {
+		// eLXg`OƓ "\r\n" ̂܂܏o
+		fpOut = fopen(argv[2], "wb");
+		if (fpOut == NULL) {
+			perror(argv[2]);
+			fclose(fpIn);
+			return 1;
+		}
+	}
+
+	int count = decode(fpIn, fpOut);
+	if (count < 0) {
+		fprintf(stderr, "%s: invalid binary log\r\n", argv[1]);
+	}
+	else {
+		fprintf(stderr, "%d records\r\n", count);
+	}
+
+	fclose(fpIn);
+	if (fpOut != stdout) {
+		fclose(fpOut);
+	}
+	return (count < 0) ? (1) : (0);
+}
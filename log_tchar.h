@@ -21,16 +21,29 @@
 #include <tchar.h>
 #include <windows.h>
 #include <Shlwapi.h>
+#include "time_cache.h"
+#include "Lock.h"
 
 
 #define MAX_LOG_TEXT		(256)		//!< Oo͓̍őeLXg
 #define MAX_FILE_SIZE		(1024)		//!< Ot@CőTCY[kByte]
 #define MAX_LOG_BACKUP		(3)			//!< OobNAbvۑ
+#define LOG_BUFF_SIZE		(8 * 1024)	//!< t@CJ܂܂̏ꍇ̏݃obt@TCY
+#define LOG_FLUSH_TIME		(1000)		//!< LOG_FLUSH_INTERVAL ̃tbV[ms]
+
+// OIDƂ̔rbN|V[(Lock.hAVOXbhŎgpꍇ CLockNone `)
+#ifndef LOG_LOCK_POLICY
+#define LOG_LOCK_POLICY		CLockCS<>
+#endif
 
 //! Oo͊Jn
 #define LOG_START(pInf, path)				log_start(pInf, path)
 //! Oo͏I
 #define LOG_END(pInf)						log_end(pInf)
+//! Ot@C̏(tbV)@ݒ
+#define LOG_SET_FLUSH(pInf, mode, ms, size)	log_set_flush(pInf, mode, ms, size)
+//! ݃obt@̃Ot@C֏
+#define LOG_FLUSH(pInf)						log_flush(pInf)
 //! Oo
 #define LOG_WRITE(pInf, level, fmt, ...)	log_write(pInf, level, fmt, __VA_ARGS__)
 //! Oo(fobO)
@@ -49,12 +62,25 @@ typedef enum {
 } LOG_LEVEL;
 
 
+/**
+ * @enum		LOG_FLUSH_MODE
+ * @brief		Ot@C̏(tbV)@
+ * @remarks		LOG_FLUSH_CLOSE ȊO̓t@CJ܂܂ƂAERR x̃O͏ɑtbV܂
+ */
+typedef enum {
+	LOG_FLUSH_CLOSE = 0,	//!< 1sɃt@CJ(])
+	LOG_FLUSH_LINE,			//!< 1sɃtbV
+	LOG_FLUSH_INTERVAL,		//!< ÕtbVw莞Ԍoߌ̏ݎɃtbV
+	LOG_FLUSH_ERROR			//!< ERR x̏ݎ(܂̓obt@t)̂݃tbV
+} LOG_FLUSH_MODE;
+
+
 /*
  * @struct		LOG_INFO
  * @brief		O
  */
 typedef struct {
-	CRITICAL_SECTION	stCS;						//!< OIDƂ̔rIuWFNg
+	LOG_LOCK_POLICY		cLock;						//!< OIDƂ̔rIuWFNg
 	TCHAR				szLogPath[MAX_PATH + 1];	//!< Ot@CpX
 	BOOL				bUsed;						//!< OIDgp
 	// OobNAbv
@@ -63,6 +89,13 @@ typedef struct {
 	TCHAR				szDir[MAX_PATH + 1];		//!< hCuAfBNg
 	TCHAR				szFname[MAX_PATH + 1];		//!< t@Cigqj
 	TCHAR				szFext[MAX_PATH + 1];		//!< gq
+	// t@Cݏ
+	FILE*				fpLog;						//!< J܂܂̃Ot@C
+	LONGLONG			llWritten;					//!< J܂܂̃Ot@C̃TCY(݃oCg)
+	LOG_FLUSH_MODE		enFlush;					//!< tbV@
+	DWORD				dwFlushTime;				//!< tbV[ms]
+	DWORD				dwLastFlush;				//!< OtbV[ms]
+	int					nBuffSize;					//!< ݃obt@TCY
 } LOG_INFO;
 
 
@@ -72,8 +105,18 @@ int					log_start(LOG_INFO* pstLog, LPCTSTR lpszPath);
 int					log_end(LOG_INFO* pstLog);
 //! Oo
 int					log_write(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszFmt, ...);
+//! Ot@C̏(tbV)@ݒ肷
+int					log_set_flush(LOG_INFO* pstLog, LOG_FLUSH_MODE enMode, DWORD dwFlushTime, int nBuffSize);
+//! ݃obt@̃Ot@C֏
+int					log_flush(LOG_INFO* pstLog);
 //! Oo(fobO)
 int					log_debug(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszFile, int nLine, LPCTSTR lpszFunc, LPCTSTR lpszFmt, ...);
+//! `ς݂̃O1st@C֏
+static int			_log_output(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszLine);
+//! Ot@CJ܂܂ɂ邽߁A݃obt@ݒ肵ĊJ
+static int			_log_open_file(LOG_INFO* pstLog);
+//! J܂܂̃Ot@Cŕ
+static void			_log_close_file(LOG_INFO* pstLog);
 //! OxɑΉ閼̂擾
 static LPCTSTR		_log_level(LOG_LEVEL enLevel);
 //! tpXt@Ĉ݂擾
@@ -82,10 +125,6 @@ static LPCTSTR		_get_fname_from_path(LPCTSTR lpszPath, LPTSTR lpszBuff, int nSiz
 static void			_log_lock_init(LOG_INFO* pstLog);
 //! rI
 static void			_log_lock_delete(LOG_INFO* pstLog);
-//! rbNJn
-static void			_log_lock(LOG_INFO* pstLog);
-//! rbN
-static void			_log_unlock(LOG_INFO* pstLog);
 //! Ot@CpXƗpϐɃRs[
 static int			_save_filepath(LOG_INFO* pstLog, LPCTSTR lpszPath);
 //! w胍Ot@CɃobNAbvԍt^
@@ -119,6 +158,11 @@ int log_start(LOG_INFO* pstLog, LPCTSTR lpszPath)
 	pstLog->bUsed = TRUE;
 	pstLog->nFileSize = MAX_FILE_SIZE;
 	pstLog->nLogBackup = MAX_LOG_BACKUP;
+	pstLog->fpLog = NULL;
+	pstLog->enFlush = LOG_FLUSH_CLOSE;
+	pstLog->dwFlushTime = LOG_FLUSH_TIME;
+	pstLog->dwLastFlush = 0;
+	pstLog->nBuffSize = LOG_BUFF_SIZE;
 
 	_log_lock_init(pstLog);
 
@@ -142,11 +186,70 @@ int log_end(LOG_INFO* pstLog)
 #endif
 		return -1;
 	}
+	{
+		CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+		_log_close_file(pstLog);
+	}
 	_log_lock_delete(pstLog);
 	pstLog->bUsed = FALSE;
 	return 0;
 }
 
+/**
+ * @fn			log_set_flush
+ * @brief		Ot@C̏(tbV)@ݒ肷
+ * @param[in]	LOG_INFO* pstLog		: O
+ * @param[in]	LOG_FLUSH_MODE enMode	: tbV@
+ * @param[in]	DWORD dwFlushTime		: LOG_FLUSH_INTERVAL ̃tbV[ms]
+ * @param[in]	int nBuffSize			: t@CJ܂܂̏ꍇ̏݃obt@TCY
+ * @return		0:, -1:s
+ * @remarks
+ *		LOG_FLUSH_CLOSE ȊO̓Ot@CJ܂܂ƂA݂̓obt@ɗ߂Ă܂Ƃ߂čs܂B
+ *		LOG_FLUSH_INTERVAL ̎͏ݎɔ肷邽߁A݂r₦ꍇ log_flush() ĂłB
+ */
+int log_set_flush(LOG_INFO* pstLog, LOG_FLUSH_MODE enMode, DWORD dwFlushTime, int nBuffSize)
+{
+	if (pstLog == NULL || pstLog->bUsed == FALSE
+		|| enMode < LOG_FLUSH_CLOSE || LOG_FLUSH_ERROR < enMode || nBuffSize <= 0) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+	// JĂt@C͏ŕA񏑍ݎɐVݒŊJ
+	_log_close_file(pstLog);
+	pstLog->enFlush = enMode;
+	pstLog->dwFlushTime = dwFlushTime;
+	pstLog->nBuffSize = nBuffSize;
+	return 0;
+}
+
+/**
+ * @fn			log_flush
+ * @brief		݃obt@̃Ot@C֏
+ * @param[in]	LOG_INFO* pstLog		: O
+ * @return		0:, -1:s
+ */
+int log_flush(LOG_INFO* pstLog)
+{
+	if (pstLog == NULL || pstLog->bUsed == FALSE) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	int ret = 0;
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+	if (pstLog->fpLog != NULL) {
+		ret = (fflush(pstLog->fpLog) == 0) ? (0) : (-1);
+		pstLog->dwLastFlush = GetTickCount();
+	}
+	return ret;
+}
+
 /**
  * @fn			log_write
  * @brief		Oo
@@ -168,44 +271,24 @@ int log_write(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszFmt, ...)
 	TCHAR szBuff0[MAX_LOG_TEXT];
 	TCHAR szBuff1[MAX_LOG_TEXT * 2];
 
-	_log_lock(pstLog);
-	_backup_file(pstLog);
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
 
 	va_list arg;
 	va_start(arg, lpszFmt);
 	_vsntprintf(szBuff0, sizeof(szBuff0), lpszFmt, arg);
 	va_end(arg);
 
-	errno = 0;
-	FILE *fp = _tfopen(pstLog->szLogPath, _T("ab+"));
-	if (fp == NULL) {
-		if (errno != 0) perror(NULL);
-		return -1;
-	}
-
-	SYSTEMTIME stTime;
-	GetLocalTime((LPSYSTEMTIME)&stTime);
+	TCHAR szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
 	_sntprintf(szBuff1, sizeof(szBuff1),
-		_T("%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, " \
+		_T("%s, %s, " \
 			"%s\r\n")
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
+		, szTime
 		, _log_level(enLevel)
 		, szBuff0);
-	_fputts(szBuff1, fp);
+	int ret = _log_output(pstLog, enLevel, szBuff1);
 
-	if (fclose(fp) != 0) {
-		if (errno != 0) perror(NULL);
-		_log_unlock(pstLog);
-		return -1;
-	}
-	_log_unlock(pstLog);
-	return 0;
+	return ret;
 }
 
 /**
@@ -229,8 +312,7 @@ int log_debug(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszFile, int nLine,
 		return -1;
 	}
 
-	_log_lock(pstLog);
-	_backup_file(pstLog);
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
 
 	TCHAR szBuff0[MAX_LOG_TEXT];
 	TCHAR szBuff1[MAX_LOG_TEXT * 2];
@@ -242,42 +324,130 @@ int log_debug(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszFile, int nLine,
 	_vsntprintf(szBuff0, sizeof(szBuff0), lpszFmt, arg);
 	va_end(arg);
 
-	errno = 0;
-	FILE *fp = _tfopen(pstLog->szLogPath, _T("ab+"));
-	if (fp == NULL) {
-		if (errno != 0) perror(NULL);
-		return -1;
-	}
-
-	SYSTEMTIME stTime;
-	GetLocalTime((LPSYSTEMTIME)&stTime);
+	TCHAR szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
 	_sntprintf(szBuff1, sizeof(szBuff1),
-		_T("%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, " \
+		_T("%s, %s, " \
 			"%s(%d), %s, " \
 			"%s\r\n")
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
+		, szTime
 		, _log_level(enLevel)
 		, _get_fname_from_path(lpszFile, szFilename, sizeof(szFilename))
 		, nLine
 		, lpszFunc
 		, szBuff0);
-	_fputts(szBuff1, fp);
+	int ret = _log_output(pstLog, enLevel, szBuff1);
 
-	if (fclose(fp) != 0) {
+	return ret;
+}
+
+/**
+ * @fn			_log_output
+ * @brief		`ς݂̃O1st@C֏(bN擾ς݂ŌĂ)
+ * @param[in]	LOG_INFO* pstLog		: O
+ * @param[in]	LOG_LEVEL enLevel		: Ox
+ * @param[in]	LPCTSTR lpszLine		: O1s
+ * @return		0:, -1:s
+ */
+static int _log_output(LOG_INFO* pstLog, LOG_LEVEL enLevel, LPCTSTR lpszLine)
+{
+	if (pstLog->enFlush == LOG_FLUSH_CLOSE) {
+		// 1sɃt@CJ
+		_backup_file(pstLog);
+
+		errno = 0;
+		FILE *fp = _tfopen(pstLog->szLogPath, _T("ab+"));
+		if (fp == NULL) {
+			if (errno != 0) perror(NULL);
+			return -1;
+		}
+		_fputts(lpszLine, fp);
+		if (fclose(fp) != 0) {
+			if (errno != 0) perror(NULL);
+			return -1;
+		}
+		return 0;
+	}
+
+	// t@CJ܂܏
+	// TCY̓Ő(ftell 1sɃV[ÑVXeR[ƂȂ邽)
+	if (pstLog->fpLog != NULL && (LONGLONG)pstLog->nFileSize * 1024 <= pstLog->llWritten) {
+		// J܂܂ł̓l[łȂ߁AĂobNAbv
+		_log_close_file(pstLog);
+	}
+	if (pstLog->fpLog == NULL) {
+		_backup_file(pstLog);
+		if (_log_open_file(pstLog) != 0) {
+			return -1;
+		}
+	}
+
+	if (_fputts(lpszLine, pstLog->fpLog) < 0) {
+		return -1;
+	}
+	pstLog->llWritten += _tcslen(lpszLine) * sizeof(TCHAR);
+
+	DWORD now = GetTickCount();
+	BOOL bFlush = (enLevel == ERR);
+	switch (pstLog->enFlush) {
+	case LOG_FLUSH_LINE:
+		bFlush = TRUE;
+		break;
+	case LOG_FLUSH_INTERVAL:
+		if (pstLog->dwFlushTime <= now - pstLog->dwLastFlush) {
+			bFlush = TRUE;
+		}
+		break;
+	default:
+		break;
+	}
+	if (bFlush) {
+		fflush(pstLog->fpLog);
+		pstLog->dwLastFlush = now;
+	}
+	return 0;
+}
+
+/**
+ * @fn			_log_open_file
+ * @brief		Ot@CJ܂܂ɂ邽߁A݃obt@ݒ肵ĊJ
+ * @param[in]	LOG_INFO* pstLog		: O
+ * @return		0:, -1:s
+ */
+static int _log_open_file(LOG_INFO* pstLog)
+{
+	errno = 0;
+	FILE *fp = _tfopen(pstLog->szLogPath, _T("ab+"));
+	if (fp == NULL) {
 		if (errno != 0) perror(NULL);
-		_log_unlock(pstLog);
 		return -1;
 	}
-	_log_unlock(pstLog);
+	setvbuf(fp, NULL, _IOFBF, pstLog->nBuffSize);
+	// ǋL̂߁Ãt@CTCY݃oCg̏lƂ(ȍ~͏ݖɉZ)
+	fseek(fp, 0, SEEK_END);
+	pstLog->llWritten = _ftelli64(fp);
+	if (pstLog->llWritten < 0) {
+		pstLog->llWritten = 0;
+	}
+
+	pstLog->fpLog = fp;
+	pstLog->dwLastFlush = GetTickCount();
 	return 0;
 }
 
+/**
+ * @fn			_log_close_file
+ * @brief		J܂܂̃Ot@Cŕ
+ * @param[in]	LOG_INFO* pstLog		: O
+ */
+static void _log_close_file(LOG_INFO* pstLog)
+{
+	if (pstLog->fpLog != NULL) {
+		fclose(pstLog->fpLog);
+		pstLog->fpLog = NULL;
+	}
+}
+
 /**
  * @fn			_log_level
  * @brief		OxɑΉ閼̂擾
@@ -331,7 +501,7 @@ static LPCTSTR _get_fname_from_path(LPCTSTR lpszPath, LPTSTR lpszBuff, int nSize
 static void _log_lock_init(LOG_INFO* pstLog)
 {
 	if (pstLog == NULL) { assert(FALSE); }
-	InitializeCriticalSection(&(pstLog->stCS));
+	pstLog->cLock.Init();
 }
 
 /**
@@ -342,29 +512,7 @@ static void _log_lock_init(LOG_INFO* pstLog)
 static void _log_lock_delete(LOG_INFO* pstLog)
 {
 	if (pstLog == NULL) { assert(FALSE); }
-	DeleteCriticalSection(&(pstLog->stCS));
-}
-
-/**
- * @fn			_log_lock
- * @brief		rbNJn
- * @param[in]	LOG_INFO* pstLog		: O
- */
-static void _log_lock(LOG_INFO* pstLog)
-{
-	if (pstLog == NULL) { assert(FALSE); }
-	EnterCriticalSection(&(pstLog->stCS));
-}
-
-/**
- * @fn			_log_unlock
- * @brief		rbN
- * @param[in]	LOG_INFO* pstLog		: O
- */
-static void _log_unlock(LOG_INFO* pstLog)
-{
-	if (pstLog == NULL) { assert(FALSE); }
-	LeaveCriticalSection(&(pstLog->stCS));
+	pstLog->cLock.Exit();
 }
 
 /**
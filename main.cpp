@@ -1,138 +1,389 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <conio.h>
 #include <stdarg.h>
 #include <windows.h>
 #include <process.h>
 #include "misc.h"
-#include "simple_queue2.h"
-
-#define RX_BUFF		(1024)		// Mobt@TCY
-#define TX_BUFF		(1024)		// Mobt@TCY
-
-
-int start_recvbuff_thread();
-unsigned __stdcall thread_recv_buff(PVOID pParam);
+#include "CByteRingBuffer.h"
+#include "FrameParser.h"
+#include "SerialStats.h"
+#include "ThreadPool.h"
+#include "SerialCapture.h"
+#include "serial_comm.h"
+#include "SerialIocp.h"
+
+
+void schedule_recv_buff();
+void task_recv_buff(PVOID pParam);
+int run_replay(const char* szPath, SERIAL_REPLAY_MODE enMode, double dScale);
+void replay_commit(PVOID pParam, int nLen);
+int run_iocp(const char* szPort);
+void iocp_recv_notify(int nId, int nBytes, BOOL bOk, PVOID pParam);
+void key_loop();
 
 int start_comm_thread();
 int end_comm_thread();
 
+void task_serial_comm(PVOID pParam);
 unsigned __stdcall thread_serial_comm(PVOID pParam);
 int ReportStatusEvent(unsigned char* bytebuff, DWORD cnt);
 
-HANDLE open_serial_async(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName);
-static void SetDCB(DCB* pDCB);
-int close_serial(HANDLE hComm, const char* szLogName);
-int clear_serial(HANDLE hComm);
-int serial_send(HANDLE hComm, unsigned char* puchData, int nLength, const char* szLogName);
-int serial_recv(HANDLE hComm, unsigned char* puchBuff, int nLength, int nTimeout, const char* szLogName);
-int check_buff_count_rx(HANDLE hComm);
-int check_buff_count_tx(HANDLE hComm);
-static void _com_log_output(const char* szLogName, const char* szFunc, const char* szOutput);
-
 
 HANDLE g_hComm;
 OVERLAPPED g_osReader = { 0 };
-HANDLE g_hThreadReader;
-DWORD g_dwThreadId;
+CThreadPool* g_pcPool;				// M[vEt[͂sXbhv[
 char g_szLog[] = "com14.log";
 
-HANDLE g_hThreadExitEvent;
-
-RING_BUFFER* g_pstRecvBuff;
-
-HANDLE g_hId_RecvBuff;
-DWORD g_dwId_RecvBuff;
-HANDLE g_hEvt_RecvBuff;
+CByteRingBuffer* g_pcRecvBuff;
+CFramePool* g_pcFramePool;			// Mt[̃obt@(L[ɂ̓|C^̂݊i[)
+CFrameQueue* g_pcFrameQueue;		// Mt[(task_recv_buff ŕ)
+CFrameParser* g_pcParser;			// t[(r܂ł̃t[ task_recv_buff ̌ďoԂŕێ)
+volatile LONG g_lRecvScheduled;		// task_recv_buff Xbhv[ɓo^ς(͓͂1̂)
+CSerialStats* g_pcStats;			// M̓v(JE^EMt[͂̒x)
+volatile BOOL g_bDump = TRUE;		// Mf[^Et[\('d' L[ŐؑւA\̂Mx点邽)
+CSerialCapture* g_pcCapture;		// Mf[^̃Lv`(-capture w莞̂)
+volatile DWORD_PTR g_dwpReaderMask;	// M[vŒ肵 L2 NX^(task_recv_buff NX^ŎsA0:Œ肵Ȃ)
 
 #define RING_BUFF_SIZE		(16)
 
-int main(int argc, char* argv)
+/**
+ * 
+ *	-capture <file>		: Mf[^Lv`t@CɋL^
+ *	-replay <file>		: VA|[g̑ɃLv`t@CĐ(L^̊Ԋu)
+ *	-scale <{>		: -replay ̍Đx̔{(2.0:2{)
+ *	-fast				: -replay ҋ@ɍĐAŜ̃X[vbg\
+ *	-iocp				: M[v̑ CSerialIocp ŎM(-capture ͖)
+ */
+int main(int argc, char* argv[])
 {
-	g_pstRecvBuff = create_queue(RING_BUFF_SIZE);
+	const char* szCapture = NULL;
+	const char* szReplay = NULL;
+	SERIAL_REPLAY_MODE enReplay = SERIAL_REPLAY_ORIGINAL;
+	double dScale = 1.0;
+	BOOL bIocp = FALSE;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-capture") == 0 && i + 1 < argc) {
+			szCapture = argv[++i];
+		}
+		else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc) {
+			szReplay = argv[++i];
+		}
+		else if (strcmp(argv[i], "-scale") == 0 && i + 1 < argc) {
+			enReplay = SERIAL_REPLAY_SCALED;
+			dScale = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-fast") == 0) {
+			enReplay = SERIAL_REPLAY_FAST;
+		}
+		else if (strcmp(argv[i], "-iocp") == 0) {
+			bIocp = TRUE;
+		}
+	}
+
+	// ݂͎M[vAǏo task_recv_buff ̂(1)̂߃bNt[Ŏgp
+	g_pcRecvBuff = new CByteRingBuffer(RING_BUFF_SIZE, CByteRingBuffer::RING_MODE_SPSC);
 
-	if (g_pstRecvBuff == NULL) {
+	if (g_pcRecvBuff == NULL) {
 		printf("RingBuffer create failed.");
 		return -1;
 	}
+	// L[𖞂鐔̃obt@\ߊmۂĂAM malloc Ȃ
+	g_pcFramePool = new CFramePool();
+	g_pcFramePool->Reserve(FRAME_MAX_SIZE, FRAME_QUEUE_SIZE);
+	g_pcFrameQueue = new CFrameQueue();
+	// STX ` ETX `Ńt[(r܂ł̃t[͎̎Mɑ珈)
+	g_pcParser = new CFrameParser(NULL, g_pcFrameQueue, g_pcFramePool);
+	g_pcStats = new CSerialStats(g_pcRecvBuff);
+
+	// M[vƃt[͂̓Oobt@L邽߁A[J[͋NvZbT
+	//  NUMA m[hɐAm[hCPUpӂ(M[v1L邽ߍŒ2)
+	// L2 NX^ւ̌Œ͎M[v(task_serial_comm)ƃt[(task_recv_buff)̃^XNł̂ݍsA
+	// ̃^XN̓m[hŜŎs
+	DWORD_PTR dwpNode = CThread::GetNumaMask((int)GetCurrentProcessorNumber());
+	int nWorkers = 0;
+	for (DWORD_PTR dwpBit = dwpNode; dwpBit != 0; dwpBit &= dwpBit - 1) {
+		nWorkers++;
+	}
+	if (nWorkers == 0) {
+		SYSTEM_INFO stInfo;
+		GetSystemInfo(&stInfo);
+		nWorkers = (int)stInfo.dwNumberOfProcessors;
+	}
+	g_pcPool = new CThreadPool();
+	g_pcPool->SetThreadAttributes(dwpNode, THREAD_PRIORITY_NONE, NULL, "serial pool");
+	if (g_pcPool->Start((nWorkers < 2) ? (2) : (nWorkers)) < 0) {
+		printf("ThreadPool start failed.");
+		return -1;
+	}
+
+	if (szReplay != NULL) {
+		run_replay(szReplay, enReplay, dScale);
+	}
+	else if (bIocp) {
+		run_iocp("COM4");
+	}
+	else {
+		if (szCapture != NULL) {
+			g_pcCapture = new CSerialCapture();
+			if (g_pcCapture->Open(szCapture) != 0) {
+				printf("capture open failed. (%s)\r\n", szCapture);
+				delete g_pcCapture;
+				g_pcCapture = NULL;
+			}
+		}
 
-	g_hEvt_RecvBuff = CreateEvent(NULL, FALSE, FALSE, NULL);
-	g_hThreadExitEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		// Mς݂̃f[^𑦎ɕԂxvt@CŊJ
+		// M[v EV_RXCHAR ҂ ReadFile 𔭍s邽߁AMԂ͍ŏ1oCg̓
+		// (ReadTotalTimeoutMultiplier = MAXDWORDAMȂ SERIAL_FIRST_TIMEOUT 0oCg)
+		SERIAL_CONFIG stConfig;
+		serial_make_config(&stConfig, SERIAL_PROFILE_LOW_LATENCY, CBR_9600, RING_BUFF_SIZE);
+		stConfig.dwEventMask = 0;
+		stConfig.stTimeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+		stConfig.stTimeouts.ReadTotalTimeoutConstant = SERIAL_FIRST_TIMEOUT;
+		// hCo̎ML[́AOobt@t̊ԂőTCỸt[1ێł傫ɂ
+		while (stConfig.dwInQueue < RING_BUFF_SIZE + FRAME_MAX_SIZE) {
+			stConfig.dwInQueue <<= 1;
+		}
+		g_hComm = open_serial_ex("COM4", CBR_9600, 8, NOPARITY, ONESTOPBIT, TRUE, &stConfig, g_szLog);
+		if (g_hComm == NULL) {
+			printf("COM4 open failed.\r\n");
+			getch();
+			return -1;
+		}
 
-	g_hComm = open_serial_async("COM4"
-		, CBR_9600, 8, NOPARITY, ONESTOPBIT, g_szLog);
+		if (start_comm_thread() < 0) {
+			clear_serial(g_hComm);
+			close_serial(g_hComm, NULL);
+			printf("start error.");
+			getch();
+			return -1;
+		}
 
-	start_recvbuff_thread();
+		key_loop();
 
-	if (start_comm_thread() < 0) {
-		close_serial(g_hComm, NULL);
-		printf("start error.");
-		getch();
-		return -1;
-	}
+		end_comm_thread();
 
-	while (getch() != 'q') {
-		Sleep(100);
+		// M[v̏Iɕ(gp̊g؂l߂)
+		if (g_pcCapture != NULL) {
+			printf("captured %lld records.\r\n", g_pcCapture->GetRecordCount());
+			delete g_pcCapture;
+			g_pcCapture = NULL;
+		}
 	}
 
-	end_comm_thread();
-
 	printf("end.\r\n");
 
 	getch();
 
-	delete_queue(g_pstRecvBuff);
+	delete g_pcPool;
+	delete g_pcRecvBuff;
+	delete g_pcParser;
+	FRAME_BUF* pstFrame;
+	while (g_pcFrameQueue->Dequeue(&pstFrame) == 0) {
+		CFramePool::Release(pstFrame);
+	}
+	delete g_pcFrameQueue;
+	delete g_pcFramePool;
+	delete g_pcStats;
 
 	return 0;
 }
 
 
-int start_recvbuff_thread()
+/**
+ * Lv`t@CĐAM[v̑ɃOobt@֏(CXbhŎs)
+ * ĐAt[͂c̃f[^IĂXbhv[~Aʂ\
+ */
+int run_replay(const char* szPath, SERIAL_REPLAY_MODE enMode, double dScale)
 {
-	g_hId_RecvBuff = (HANDLE)_beginthreadex(NULL
-		, 0
-		, thread_recv_buff
-		, NULL
-		, 0
-		, (unsigned int*)(&g_dwId_RecvBuff));
-
-	if (g_hId_RecvBuff == INVALID_HANDLE_VALUE) {
+	CSerialReplay cReplay;
+	if (cReplay.Open(szPath) != 0) {
+		printf("replay open failed. (%s)\r\n", szPath);
 		return -1;
 	}
+	// \͍Đxɉe邽߁AFAST ł͕\Ȃ
+	if (enMode == SERIAL_REPLAY_FAST) {
+		g_bDump = FALSE;
+	}
+	printf("replay %s, %lld records.\r\n", szPath, cReplay.GetRecordCount());
+
+	SERIAL_REPLAY_RESULT stResult;
+	int ret = cReplay.Run(g_pcRecvBuff, enMode, dScale, replay_commit, NULL, &stResult);
+	while (0 < g_pcRecvBuff->Count() || g_lRecvScheduled != 0) {
+		// o^ɎsĂꍇ͍ēo^
+		schedule_recv_buff();
+		Sleep(1);
+	}
+	if (g_pcPool->Stop(TRUE, 2000) != 0) {
+		printf("run_replay, ThreadPool Stop timeout.\r\n");
+	}
 
-	printf("thread start.\r\n");
+	double sec = (0 < stResult.llElapsedUs) ? (stResult.llElapsedUs / 1000000.0) : (1e-6);
+	printf("replay %s: %lld records, %lld bytes, %.3f s, %.0f bytes/s, %.0f frames/s, late max %lld us, full waits %lld\r\n"
+		, (ret == 0) ? ("done") : ("aborted")
+		, stResult.llRecords, stResult.llBytes, sec, stResult.llBytes / sec
+		, g_pcParser->GetFrameCount() / sec, stResult.llLateUs, stResult.llFullWaits);
+
+	SERIAL_STATS_SNAPSHOT stSnap;
+	char szStats[512];
+	g_pcStats->Snapshot(&stSnap);
+	CSerialStats::Format(&stSnap, szStats, sizeof(szStats));
+	printf("STATS: %s\r\n", szStats);
+	return ret;
+}
+
+
+/**
+ * CSerialIocp ŎM(M[vEOobt@Ev̑ CSerialIocp ̃|[ĝ̂gp)
+ * t[͎͂M̒ʒmXbhv[ɓo^(task_recv_buff ͎M[v̏ꍇƓ)
+ */
+int run_iocp(const char* szPort)
+{
+	CSerialIocp cIocp;
+	if (cIocp.Start(1) != 0) {
+		printf("CSerialIocp start failed.\r\n");
+		return -1;
+	}
+	int nId = cIocp.AddPort(szPort, CBR_9600, 8, NOPARITY, ONESTOPBIT, g_szLog);
+	if (nId < 0) {
+		printf("CSerialIocp AddPort failed. (%s)\r\n", szPort);
+		return -1;
+	}
+
+	// M̒ʒmOɐ؂ւ(task_recv_buffEReportStatusEvent Ɠϐgp邽)
+	CByteRingBuffer* pcRecvBuff = g_pcRecvBuff;
+	CSerialStats* pcStats = g_pcStats;
+	g_pcRecvBuff = cIocp.GetRecvBuffer(nId);
+	g_pcStats = cIocp.GetStats(nId);
+	cIocp.SetRecvNotify(nId, iocp_recv_notify, NULL, NULL);
+	printf("iocp start. (%s)\r\n", szPort);
+
+	key_loop();
+
+	// ͂IĂ|[g(Oobt@Ev̓|[gƋɍ폜)
+	cIocp.SetRecvNotify(nId, NULL, NULL, NULL);
+	if (g_pcPool->Stop(TRUE, 2000) != 0) {
+		printf("run_iocp, ThreadPool Stop timeout.\r\n");
+	}
+	cIocp.Stop();
+	g_pcRecvBuff = pcRecvBuff;
+	g_pcStats = pcStats;
 	return 0;
 }
 
 
-unsigned __stdcall thread_recv_buff(PVOID pParam)
+/**
+ * CSerialIocp ̎M̒ʒm([J[XbhĂ΂)
+ */
+void iocp_recv_notify(int nId, int nBytes, BOOL bOk, PVOID pParam)
+{
+	if (!bOk) {
+		printf("iocp receive stopped. (port %d)\r\n", nId);
+		return;
+	}
+	schedule_recv_buff();
+}
+
+
+/**
+ * 'q' L[܂ő҂('d':Mf[^\̐ؑւ, 's':v̕\)
+ */
+void key_loop()
+{
+	int key;
+	while ((key = getch()) != 'q') {
+		switch (key) {
+		case 'd':		// Mf[^\̐ؑւ
+			g_bDump = !g_bDump;
+			break;
+		case 's':		// v̕\
+			{
+				SERIAL_STATS_SNAPSHOT stSnap;
+				char szStats[512];
+				g_pcStats->Snapshot(&stSnap);
+				CSerialStats::Format(&stSnap, szStats, sizeof(szStats));
+				printf("STATS: %s\r\n", szStats);
+			}
+			break;
+		}
+		Sleep(100);
+	}
+}
+
+
+/**
+ * Đf[^Oobt@֏񂾌̏(ReportStatusEvent  Commit Ɠ)
+ */
+void replay_commit(PVOID pParam, int nLen)
 {
-	DWORD dwEvt;
-	int nLength = 0;
-	unsigned char buff[RING_BUFF_SIZE];
-	char dumpbuff[RING_BUFF_SIZE * 8];
-
-	while (TRUE) {
-		if (WaitForSingleObject(g_hEvt_RecvBuff, 500) == WAIT_OBJECT_0) {
-			nLength = queue_data_count(g_pstRecvBuff);
-			if (0 < nLength) {
-				queue_pop(g_pstRecvBuff, buff, nLength);
-				printf("3>>> QPOP: %s.\r\n", mem_dump2(buff, nLength, dumpbuff, RING_BUFF_SIZE * 8));
+	g_pcStats->Add(SERIAL_STAT_BYTES_IN, nLen);
+	g_pcStats->Produced();
+	schedule_recv_buff();
+}
+
+
+/**
+ * Mf[^̉͂Xbhv[ɓo^(M[vĂ)
+ * ͒̏ꍇ͓o^Ȃ(task_recv_buff IOɎc̃f[^)
+ */
+void schedule_recv_buff()
+{
+	if (InterlockedCompareExchange(&g_lRecvScheduled, 1, 0) != 0) {
+		return;
+	}
+	if (g_pcPool->Submit(task_recv_buff, NULL) != 0) {
+		// ~EL[t: ̎Mōēo^
+		InterlockedExchange(&g_lRecvScheduled, 0);
+	}
+}
+
+
+/**
+ * Oobt@̃f[^t[ĕ\(Xbhv[̃^XN)
+ * g_lRecvScheduled ɂ蓯1sȂ߁AOobt@̓ǏoECFrameParser ͔rsv
+ * M[v L2 LNX^ŎsAOobt@̃f[^LbVǂ([J[ɖ߂OɌɖ߂)
+ */
+void task_recv_buff(PVOID pParam)
+{
+	FRAME_BUF* pstFrame;
+
+	HANDLE hThread = GetCurrentThread();
+	DWORD_PTR dwpCluster = g_dwpReaderMask;
+	DWORD_PTR dwpOld = (dwpCluster != 0) ? (SetThreadAffinityMask(hThread, dwpCluster)) : (0);
+
+	do {
+		while (0 < g_pcRecvBuff->Count()) {
+			// obt@̃f[^Rs[ɉ͂A͍ς݂̃f[^폜
+			g_pcParser->ParseRing(g_pcRecvBuff);
+			g_pcStats->Consumed();
+			while (g_pcFrameQueue->Dequeue(&pstFrame) == 0) {
+				if (g_bDump) {
+					CFramePool::SetOwner(pstFrame, "task_recv_buff");
+					_lock_file(stdout);
+					fputs("3>>> FRAME: ", stdout);
+					mem_dump_stream(stdout, pstFrame->Data(), pstFrame->nLength, MEM_DUMP_ASCII);
+					fputs(".\r\n", stdout);
+					_unlock_file(stdout);
+				}
+				CFramePool::Release(pstFrame);
 			}
 		}
+		InterlockedExchange(&g_lRecvScheduled, 0);
+		// o^̒Oɒǉꂽf[^(schedule_recv_buff o^Ȃ)
+	} while (0 < g_pcRecvBuff->Count() && InterlockedCompareExchange(&g_lRecvScheduled, 1, 0) == 0);
+
+	if (dwpOld != 0) {
+		SetThreadAffinityMask(hThread, dwpOld);
 	}
 }
 
 
 int start_comm_thread()
 {
-	g_hThreadReader = (HANDLE)_beginthreadex(NULL
-		, 0
-		, thread_serial_comm
-		, NULL
-		, 0
-		, (unsigned int*)(&g_dwThreadId));
-
-	if (g_hThreadReader == INVALID_HANDLE_VALUE) {
+	// M[v Stop ܂ŏIȂ߃[J[1L
+	if (g_pcPool->Submit(task_serial_comm, NULL) != 0) {
 		return -1;
 	}
 
@@ -144,41 +395,49 @@ int end_comm_thread()
 {
 	printf("thread terminate.\r\n");
 
-	HANDLE hThreads[1] = { g_hThreadReader };
-
-	SetEvent(g_hThreadExitEvent);
-
 	// WaitCommEvent̑ҋ@Ԃ
-	if (SetCommMask(g_hComm, EV_ERR) == FALSE) {
+	BOOL bMask = SetCommMask(g_hComm, EV_ERR);
+
+	// M[v GetStopEvent ŏIAo^ς݂̃t[͎͂sĂ~
+	if (g_pcPool->Stop(TRUE, 2000) != 0) {
+		printf("end_comm_thread, ThreadPool Stop timeout.\r\n");
+		//Error
+	}
+	if (bMask == FALSE) {
 		return -1;
 	}
 
-	DWORD dwRes = WaitForMultipleObjects(1, hThreads, TRUE, 2000);
-	switch (dwRes) {
-	case WAIT_OBJECT_0:
-		break;
-	case WAIT_TIMEOUT:
-		if (WaitForSingleObject(g_hThreadReader, 0) == WAIT_TIMEOUT) {
-			printf("end_comm_thread, WaitForSingleObject WAIT_TIMEOUT error thread end.\r\n");
-			//Error
-		}
-		break;
-	default:
-		//Error
-		break;
+	// Mobt@̃f[^
+	clear_serial(g_hComm);
+	return close_serial(g_hComm, g_szLog);
+}
+
+
+void task_serial_comm(PVOID pParam)
+{
+	// M[vvZbTԂړĒx΂Ȃ悤As̃vZbT L2 L
+	// NX^ɌŒ肵ADxグ MMCSS ɓo^([J[ɖ߂OɌɖ߂)
+	HANDLE hThread = GetCurrentThread();
+	DWORD_PTR dwpCluster = CThread::GetCacheMask((int)GetCurrentProcessorNumber(), 2);
+	DWORD_PTR dwpOld = (dwpCluster != 0) ? (SetThreadAffinityMask(hThread, dwpCluster)) : (0);
+	int nOldPriority = GetThreadPriority(hThread);
+	SetThreadPriority(hThread, THREAD_PRIORITY_HIGHEST);
+	HANDLE hMmcss = CThread::EnterMmcss("Capture");
+	// NX^M[vCPÛ݂̏ꍇ́At[͂𓯂CPUɍڂȂ
+	if (dwpOld != 0 && (dwpCluster & (dwpCluster - 1)) != 0) {
+		g_dwpReaderMask = dwpCluster;
 	}
 
-	ResetEvent(g_hThreadExitEvent);
+	thread_serial_comm(pParam);
 
-	// beginthreadexł͕Kv, _beginthreadł͕sv(nh͎Iɕ)
-	if (CloseHandle(g_hThreadReader) == 0) {
-		// TODO:
+	g_dwpReaderMask = 0;
+	CThread::LeaveMmcss(hMmcss);
+	if (nOldPriority != THREAD_PRIORITY_ERROR_RETURN) {
+		SetThreadPriority(hThread, nOldPriority);
 	}
-	if (CloseHandle(g_hThreadExitEvent) == 0) {
-		// TODO:
+	if (dwpOld != 0) {
+		SetThreadAffinityMask(hThread, dwpOld);
 	}
-
-	return close_serial(g_hComm, g_szLog);
 }
 
 
@@ -194,7 +453,7 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 	BOOL fWaitingOnRead = FALSE;
 	char szError[512];
 
-	unsigned char bytebuff[256] = { 0 };
+	CByteRingBuffer::RING_SPAN stSpan;
 	int cnt = 0;
 
 	dwStoredFlags = EV_BREAK \
@@ -220,7 +479,7 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 
 	char szTimeBuff[256];
 
-	HANDLE hArray[2] = { g_osReader.hEvent, g_hThreadExitEvent };
+	HANDLE hArray[2] = { g_osReader.hEvent, g_pcPool->GetStopEvent() };
 
 	g_bLive = TRUE;
 	while (g_bLive)
@@ -228,7 +487,18 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 		//printf("%s loop.\r\n", str_time_now(szTimeBuff, sizeof(szTimeBuff)));
 		// Issue a status event check if one hasn't been issued already.
 		if (!fWaitingOnRead) {
-			if (!ReadFile(g_hComm, bytebuff, 512, &dwRead, &g_osReader)) {
+			// Oobt@̋󂫗̈֒ڎM(܂ԂO̘Ä̂ݎgp)
+			if (g_pcRecvBuff->Reserve(RING_BUFF_SIZE, &stSpan) <= 0) {
+				// obt@t̂ߓǏȍ҂(o^ɎsĂꍇ͍ēo^)
+				schedule_recv_buff();
+				g_pcRecvBuff->WaitSpace(1, Status_Check_Timeout);
+				if (g_pcPool->IsStopping()) {
+					g_bLive = FALSE;
+				}
+				continue;
+			}
+			g_pcStats->Add(SERIAL_STAT_READS_ISSUED);
+			if (!ReadFile(g_hComm, stSpan.apbyData[0], stSpan.anLen[0], &dwRead, &g_osReader)) {
 			//if (!WaitCommEvent(g_hComm, &dwCommEvent, &g_osReader)) {
 				dwRes = GetLastError();
 				if (dwRes == ERROR_IO_PENDING) {
@@ -239,17 +509,21 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 					// error in WaitCommEvent; abort
 					get_error_msg(dwRes, szError, sizeof(szError));
 					printf("WaitCommEvent error thread end. (%X:%s)\r\n", dwRes, szError);
+					g_pcStats->Add(SERIAL_STAT_READ_ERRORS);
 					//CloseHandle(g_osReader.hEvent);
 					//return -1;
 				}
 				fWaitingOnRead = TRUE;
 			}
 			else {
+				g_pcStats->Add(SERIAL_STAT_READ_COMPLETIONS);
 				if (0 < dwRead) {
 					// WaitCommEvent returned immediately.
 					// Deal with status event as appropriate.
-					printf("1>>> ");
-					ReportStatusEvent(bytebuff, dwRead);
+					if (g_bDump) {
+						printf("1>>> ");
+					}
+					ReportStatusEvent(stSpan.apbyData[0], dwRead);
 					dwCommEvent = 0;
 				}
 			}
@@ -272,18 +546,28 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 						printf("WaitForSingleObject GetOverlappedResult error=%d.\r\n", dwRes);
 						get_error_msg(dwRes, szError, sizeof(szError));
 						printf("WaitCommEvent error thread end. (%X:%s)\r\n", dwRes, szError);
+						{
+							DWORD dwErrorMask = 0;
+							COMSTAT stComStat;
+							ClearCommError(g_hComm, &dwErrorMask, &stComStat);
+							g_pcStats->Add(SERIAL_STAT_READ_ERRORS);
+							g_pcStats->AddCommErrors(dwErrorMask);
+						}
 						dwCommEvent = 0;
 						//fWaitingOnRead = FALSE;
 					}
 				}
 				else {
 					//printf("GetOverlappedResult\r\n");
+					g_pcStats->Add(SERIAL_STAT_READ_COMPLETIONS);
 					if (0 < dwRead) {
 						// Status event is stored in the event flag
 						// specified in the original WaitCommEvent call.
 						// Deal with the status event as appropriate.
-						printf("2>>> ");
-						ReportStatusEvent(bytebuff, dwRead);
+						if (g_bDump) {
+							printf("2>>> ");
+						}
+						ReportStatusEvent(stSpan.apbyData[0], dwRead);
 						dwCommEvent = 0;
 						//fWaitingOnRead = FALSE;
 					}
@@ -293,7 +577,7 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 				// WaitCommEvent is to be issued.
 				//fWaitingOnStat = FALSE;
 				break;
-			case WAIT_OBJECT_0 + 1:		// ThreadExitEvent
+			case WAIT_OBJECT_0 + 1:		// ThreadPool  StopEvent
 				g_bLive = FALSE;
 				break;
 			case WAIT_TIMEOUT:
@@ -340,7 +624,6 @@ unsigned __stdcall thread_serial_comm(PVOID pParam)
 int ReportStatusEvent(unsigned char* bytebuff, DWORD cnt)
 {
 	//unsigned char bytebuff[256] = { 0 };
-	char txtbuf[512 * 8] = { 0 };
 	//int cnt = 0;
 
 	//if (dwEvtMask == 0) {
@@ -364,9 +647,22 @@ int ReportStatusEvent(unsigned char* bytebuff, DWORD cnt)
 	//	}
 	//	serial_recv(g_hComm, bytebuff, cnt, 0, NULL);
 
-		printf("RECV: %s.\r\n", mem_dump2(bytebuff, cnt, txtbuf, sizeof(txtbuf)));
-		queue_push(g_pstRecvBuff, bytebuff, cnt);
-		SetEvent(g_hEvt_RecvBuff);
+		if (g_bDump) {
+			_lock_file(stdout);
+			fputs("RECV: ", stdout);
+			mem_dump_stream(stdout, bytebuff, cnt, MEM_DUMP_ASCII);
+			fputs(".\r\n", stdout);
+			_unlock_file(stdout);
+		}
+		// M܂܂̋؂ƎŋL^(run_replay œoHɍĐ)
+		if (g_pcCapture != NULL) {
+			g_pcCapture->Write(bytebuff, cnt);
+		}
+		// Mf[^ Reserve ̈ɏݍς݂̂߁Aǉm肷̂
+		g_pcRecvBuff->Commit(cnt);
+		g_pcStats->Add(SERIAL_STAT_BYTES_IN, cnt);
+		g_pcStats->Produced();
+		schedule_recv_buff();
 	//}
 	//if (dwEvtMask & EV_ERR) {
 	//	// COM|[gď
@@ -377,211 +673,3 @@ int ReportStatusEvent(unsigned char* bytebuff, DWORD cnt)
 	//}
 	return 0;
 }
-
-
-HANDLE open_serial_async(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName)
-{
-	HANDLE hComm;
-
-	// COM|[gnh擾
-	hComm = CreateFile(szPort
-		, (GENERIC_READ | GENERIC_WRITE)
-		, 0
-		, NULL
-		, OPEN_EXISTING
-		, FILE_FLAG_OVERLAPPED		// FILE_FLAG_OVERLAPPED : FILE_ATTRIBUTE_NORMAL
-		, NULL);
-
-	if (hComm == INVALID_HANDLE_VALUE) {
-		_com_log_output(szLogName, __FUNCTION__, "CreateFile failed");
-		return NULL;
-	}
-
-	// Mobt@
-	if (!SetupComm(hComm, RX_BUFF, TX_BUFF)) {
-		_com_log_output(szLogName, __FUNCTION__, "SetupComm failed");
-		CloseHandle(hComm);
-		return NULL;
-	}
-
-	// Mobt@̃f[^
-	if (!PurgeComm(hComm, (PURGE_TXABORT | PURGE_RXABORT | PURGE_TXCLEAR | PURGE_RXCLEAR))) {
-		_com_log_output(szLogName, __FUNCTION__, "PurgeComm failed");
-		CloseHandle(hComm);
-		return NULL;
-	}
-
-	// ʐM̐ݒ
-	DCB stDCB;
-	if (!GetCommState(hComm, &stDCB)) {
-		_com_log_output(szLogName, __FUNCTION__, "GetCommState failed");
-		CloseHandle(hComm);
-		return NULL;
-	}
-
-	stDCB.BaudRate = nBaud;			// CBR_9600;
-	stDCB.ByteSize = nDataBit;		// 8;
-	stDCB.fParity = nParity;		// NOPARITY, ODDPARITY, EVENPARITY
-	stDCB.StopBits = nStopBit;		// ONESTOPBIT, ONE5STOPBITS, TWOSTOPBITS
-
-	if (!SetCommState(hComm, &stDCB)) {
-		_com_log_output(szLogName, __FUNCTION__, "SetCommState failed");
-		CloseHandle(hComm);
-		return NULL;
-	}
-
-	// ^CAEgԂ̐ݒ
-	COMMTIMEOUTS stCTO;
-	//if (!GetCommTimeouts(hComm, &stCommTO)) {
-	//	CloseHandle(hComm);
-	//	return NULL;
-	//}
-
-	// MC^[o
-	// ReadIntervalTimeoutɐݒ肷
-	// ReadFile֐1Mۂɂ͌ʂȂ
-	// [ɐݒuƁAMC^[oԂ͎gȂ
-	stCTO.ReadIntervalTimeout = 500;
-	// Mg[^
-	// ReadTotalTimeoutMultiplier * (MoCg)+ReadTotalTimeoutConstant
-	// ReadTotalTimeoutMultiplier  ReadTotalTimeoutConstant [̂ƂAMg[^Ԃ͎gȂ
-	stCTO.ReadTotalTimeoutMultiplier = 0;
-	stCTO.ReadTotalTimeoutConstant = 500;
-	// Mg[^
-	// WriteTotalTimeoutMultiplier * (MoCg)+WriteTotalTimeoutConstant
-	// WriteTotalTimeoutMultiplier  WriteTotalTimeoutConstant [̂ƂAMg[^Ԃ͎gȂ
-	stCTO.WriteTotalTimeoutMultiplier = 0;
-	stCTO.WriteTotalTimeoutConstant = 500;
-
-	if (!SetCommTimeouts(hComm, &stCTO)) {
-		_com_log_output(szLogName, __FUNCTION__, "SetCommTimeouts failed");
-		CloseHandle(hComm);
-		return NULL;
-	}
-
-	return hComm;
-}
-
-
-static void SetDCB(DCB* pDCB)
-{
-	pDCB->DCBlength = sizeof(DCB);
-	pDCB->fBinary = TRUE;
-	//pDCB->BaudRate = 9600;
-	//pDCB->ByteSize = 8;
-	//pDCB->fParity = NOPARITY;
-	//pDCB->StopBits = ONESTOPBIT;
-	// n[hEFAt[
-	pDCB->fOutxCtsFlow = FALSE;
-	pDCB->fOutxDsrFlow = FALSE;
-	pDCB->fDtrControl = DTR_CONTROL_DISABLE;
-	pDCB->fRtsControl = RTS_CONTROL_DISABLE;
-	// \tgEFAt[
-	pDCB->fOutX = FALSE;
-	pDCB->fInX = FALSE;
-	pDCB->fTXContinueOnXoff = TRUE;
-	pDCB->XonLim = 512;
-	pDCB->XoffLim = 512;
-	pDCB->XonChar = 0x11;
-	pDCB->XoffChar = 0x13;
-	// ̑
-	pDCB->fNull = TRUE;
-	pDCB->fAbortOnError = TRUE;
-	pDCB->fErrorChar = FALSE;
-	pDCB->ErrorChar = 0x00;
-	pDCB->EofChar = 0x03;
-	pDCB->EvtChar = 0x02;
-}
-
-int close_serial(HANDLE hComm, const char* szLogName)
-{
-	// Mobt@̃f[^
-	if (!PurgeComm(hComm, (PURGE_TXABORT | PURGE_RXABORT | PURGE_TXCLEAR | PURGE_RXCLEAR))) {
-		_com_log_output(szLogName, __FUNCTION__, "PurgeComm failed");
-	}
-
-	if (!CloseHandle(hComm)) {
-		_com_log_output(szLogName, __FUNCTION__, "CloseHandle failed");
-		// TODO:
-		return -1;
-	}
-	return 0;
-}
-
-int clear_serial(HANDLE hComm)
-{
-	// Mobt@̃f[^
-	if (!PurgeComm(hComm, (PURGE_TXABORT | PURGE_RXABORT | PURGE_TXCLEAR | PURGE_RXCLEAR))) {
-		return -1;
-	}
-	return 0;
-}
-
-int serial_send(HANDLE hComm, unsigned char* puchData, int nLength, const char* szLogName)
-{
-	int nWrite = 0;
-	if (!WriteFile(hComm, puchData, nLength, (LPDWORD)&nWrite, NULL)) {
-		_com_log_output(szLogName, __FUNCTION__, "WriteFile failed");
-		return -1;
-	}
-	char szDump[1024];
-	_com_log_output(szLogName, __FUNCTION__, mem_dump(puchData, nLength, szDump, sizeof(szDump)));
-	return nWrite;
-}
-
-int serial_recv(HANDLE hComm, unsigned char* puchBuff, int nLength, int nTimeout, const char* szLogName)
-{
-	int nRead = 0;
-	//if (!ReadFile(hComm, puchBuff, nLength, (LPDWORD)&nRead, NULL)) {
-	if (!ReadFile(hComm, puchBuff, nLength, (LPDWORD)&nRead, &g_osReader)) {
-		_com_log_output(szLogName, __FUNCTION__, "ReadFile failed");
-		return -1;
-	}
-	char szDump[1024];
-	_com_log_output(szLogName, __FUNCTION__, mem_dump(puchBuff, nRead, szDump, sizeof(szDump)));
-	return nRead;
-}
-
-
-int check_buff_count_rx(HANDLE hComm)
-{
-	int nCount = 0;
-	DWORD dwErrorMask;
-	COMSTAT stComStat;
-	if (ClearCommError(hComm, &dwErrorMask, &stComStat) == 0) {
-		return -1;
-	}
-	nCount = (int)stComStat.cbInQue;
-	return nCount;
-}
-
-
-int check_buff_count_tx(HANDLE hComm)
-{
-	int nCount = 0;
-	DWORD dwErrorMask;
-	COMSTAT stComStat;
-	if (ClearCommError(hComm, &dwErrorMask, &stComStat) == 0) {
-		return -1;
-	}
-	nCount = (int)stComStat.cbOutQue;
-	return nCount;
-}
-
-
-static void _com_log_output(const char* szLogName, const char* szFunc, const char* szOutput)
-{
-	//if (szLogName == NULL || szFunc == NULL || szOutput == NULL) {
-	//	return;
-	//}
-	char szTime[32];
-	//errno = 0;
-	//FILE* fp = fopen(szLogName, "ab+");
-	//if (fp == NULL) {
-	//	//if (errno != 0) perror(NULL);
-	//	return;
-	//}
-	//fprintf(fp, "%s, %s, %s.\r\n", str_time_now(szTime, sizeof(szTime)), szFunc, szOutput);
-	printf("%s, %s, %s.\r\n", str_time_now(szTime, sizeof(szTime)), szFunc, szOutput);
-	//fclose(fp);
-}
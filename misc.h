@@ -18,6 +18,11 @@
 #include <io.h>
 #include <Windows.h>
 #include <tchar.h>
+#include <intrin.h>
+#include <tmmintrin.h>
+#include <nmmintrin.h>
+#include "time_cache.h"
+#include "checksum.h"
 
 
  // [jOC4996}~}N
@@ -51,6 +56,21 @@
 //#define DEBUG_PRINT(fmt, ...)			printf("%s: " fmt "\r\n", __FUNCTION__, __VA_ARGS__)
 
 
+//! mem_dump ̕\L
+#define MEM_DUMP_HEX					(0)			// "XX "
+#define MEM_DUMP_ASCII					(1)			// "XX[ASC] "
+#define MEM_DUMP_HEX_WIDTH				(3)			// 1oCg̕(MEM_DUMP_HEX)
+#define MEM_DUMP_ASCII_WIDTH			(8)			// 1oCg̕(MEM_DUMP_ASCII)
+#define MEM_DUMP_SIMD_MIN				(16)		// SIMD(SSSE3)ŕϊŏoCg(1ubN\葬)
+
+//! str_tok ̓w
+#define STR_TOK_SKIP_EMPTY				(0)			// A؂蕶1Ƃ݂Ȃ(strtok Ɠ)
+#define STR_TOK_KEEP_EMPTY				(1)			// ؂蕶Ԃ̗̋vfԂ("a,,b"  "a", "", "b")
+#define STR_TOK_SIMD_MAX_DELIM			(16)		// SIMD(SSE4.2)Ōł؂蕶̍ő吔
+#define STR_TOK_SIMD_MIN				(32)		// SIMDŌŏ
+#define STR_TOK_SIMD_CMPEQ_MAX			(4)			// ؂蕶̐ȉ̏ꍇ SSE2 ̔rŌ
+
+
 //! mem_dump2p̃AXL[R[hf[^
 static const char* aszAscii[] = {
 	"NUL", "SOH", "STX", "ETX", "EOT", "ENG", "ACK", "BEL", " BS", " HT", " LF", " VT", " FF", " CR", " SO", " SI",
@@ -72,13 +92,58 @@ static const char* aszAscii[] = {
 };
 
 
+/**
+ * @struct			STR_DELIM
+ * @brief			str_tok p̋؂蕶W
+ */
+typedef struct {
+	unsigned int	auBits[8];						//!< R[h̋؂蕶tO(256rbg)
+	char			achSet[STR_TOK_SIMD_MAX_DELIM];	//!< ؂蕶̈ꗗ(SIMDp)
+	int				nSet;							//!< ؂蕶̐(STR_TOK_SIMD_MAX_DELIM 𒴂ꍇSIMDsgp)
+} STR_DELIM;
+
+/**
+ * @struct			STR_TOKEN
+ * @brief			str_tok Ő؂ovf(f[^QƂ, I[)
+ * @remarks			Oobt@̐܂Ԃʒu܂vf2̕ɕ
+ */
+typedef struct {
+	const char*		apStr[2];		//!< e̐擪AhX
+	int				anLen[2];		//!< e̕(gp̕0)
+} STR_TOKEN;
+
+/**
+ * @struct			STR_TOK
+ * @brief			str_tok ̕(ďoێ邽ߕXbhœɎgp\)
+ */
+typedef struct {
+	const char*		apSpan[2];		//!< Ώۃf[^̊ë
+	int				anSpan[2];		//!< Ώۃf[^̊ë̕
+	int				nSpan;			//!< ݂̗̈
+	int				nPos;			//!< ݂̗̈̈ʒu
+	const STR_DELIM* pstDelim;		//!< ؂蕶W
+	int				nFlags;			//!< STR_TOK_SKIP_EMPTY/STR_TOK_KEEP_EMPTY
+	BOOL			bDone;			//!< Svf؂oς
+} STR_TOK;
+
+
 int				_mem_dump(void* pData, int nByteLen, char* pszDump, int nDumpLen);
 const char*		mem_dump(void* pData, int nByteLen, char* pszDump, int nDumpLen);
 int				_mem_dump2(void* pData, int nByteLen, char* pszDump, int nDumpLen);
 const char*		mem_dump2(void* pData, int nByteLen, char* pszDump, int nDumpLen);
+int				mem_dump_append(void* pData, int nByteLen, int nStyle, char* pszBuff, int nBuffSize, int nPos);
+int				mem_dump_stream(FILE* fp, void* pData, int nByteLen, int nStyle);
 int				_fmt_str(char* szBuff, int n, const char* szFmt, ...);
 const char*		fmt_str(char* szBuff, int n, const char* szFmt, ...);
 int				split_str(const char* szSrc, char* szDelim, char* szDest, int nDest, char* apToken[], int nToken);
+int				str_delim_init(STR_DELIM* pstDelim, const char* szDelim);
+int				str_tok_init(STR_TOK* pstTok, const char* pSrc, int nLen, const STR_DELIM* pstDelim, int nFlags);
+int				str_tok_init2(STR_TOK* pstTok, const char* pSrc1, int nLen1, const char* pSrc2, int nLen2, const STR_DELIM* pstDelim, int nFlags);
+BOOL			str_tok_next(STR_TOK* pstTok, STR_TOKEN* pstToken);
+int				str_split(const char* pSrc, int nLen, const STR_DELIM* pstDelim, int nFlags, STR_TOKEN astToken[], int nToken);
+int				str_token_len(const STR_TOKEN* pstToken);
+int				str_token_copy(const STR_TOKEN* pstToken, char* szBuff, int nSize);
+BOOL			str_token_equal(const STR_TOKEN* pstToken, const char* szStr);
 const char*		str_time_now(char* szBuff, int nSize);
 const char*		get_filename(const char* szPath, char* szBuff, int nSize);
 long			get_filesize(const char* szPath);
@@ -88,6 +153,223 @@ int				calc_crc16(void* pData, int nByteLen);
 int				get_error_msg(DWORD dwError, LPTSTR lpszDest, int nDestSize);
 
 
+/**
+ * @struct			MEM_DUMP_TABLE
+ * @brief			mem_dump/mem_dump2 p1oCg̏o͕e[u
+ */
+typedef struct {
+	char			aszHex[256][MEM_DUMP_HEX_WIDTH];		//!< "XX " (I[)
+	char			aszAscii[256][MEM_DUMP_ASCII_WIDTH];	//!< "XX[ASC] " (I[)
+} MEM_DUMP_TABLE;
+
+/**
+ * @fn				_mem_dump_table_init
+ * @brief			o͕e[u쐬
+ * @param[out]		MEM_DUMP_TABLE* pstTable	: o͕e[u
+ * @return			TRUE
+ */
+static BOOL _mem_dump_table_init(MEM_DUMP_TABLE* pstTable)
+{
+	static const char szHex[] = "0123456789ABCDEF";
+	for (int i = 0; i < 256; i++) {
+		char* p = pstTable->aszHex[i];
+		p[0] = szHex[i >> 4];
+		p[1] = szHex[i & 0x0F];
+		p[2] = ' ';
+		p = pstTable->aszAscii[i];
+		p[0] = szHex[i >> 4];
+		p[1] = szHex[i & 0x0F];
+		p[2] = '[';
+		memcpy(p + 3, aszAscii[i], 3);
+		p[6] = ']';
+		p[7] = ' ';
+	}
+	return TRUE;
+}
+
+/**
+ * @fn				_mem_dump_table
+ * @brief			o͕e[u擾(ďoɍ쐬)
+ * @return			o͕e[u
+ */
+static const MEM_DUMP_TABLE* _mem_dump_table()
+{
+	static MEM_DUMP_TABLE s_stTable;
+	static const BOOL s_bInit = _mem_dump_table_init(&s_stTable);	// ÓIǏϐ̏̓XbhZ[t
+	(void)s_bInit;
+	return &s_stTable;
+}
+
+/**
+ * @fn				_mem_dump_cpuid_ssse3
+ * @brief			CPUID  SSSE3 (pshufb)̑Ή𒲂ׂ
+ * @return			TRUE:Ή, FALSE:Ή
+ */
+static BOOL _mem_dump_cpuid_ssse3()
+{
+	int anInfo[4] = { 0 };
+	__cpuid(anInfo, 1);
+	return (anInfo[2] & (1 << 9)) ? (TRUE) : (FALSE);	// ECX bit9:SSSE3
+}
+
+/**
+ * @fn				_mem_dump_has_ssse3
+ * @brief			SSSE3 ߂gp\肷(CPUID ͏̂ݎs)
+ * @return			TRUE:gp\, FALSE:gps
+ */
+static BOOL _mem_dump_has_ssse3()
+{
+	static const BOOL s_bSsse3 = _mem_dump_cpuid_ssse3();
+	return s_bSsse3;
+}
+
+/**
+ * @fn				_mem_dump_hex_ssse3
+ * @brief			16oCgPʂ "XX " `16i\Lo͂(SSSE3)
+ * @param[in]		const unsigned char* p	: Ώۂ̃f[^
+ * @param[in]		int nBlocks				: 16oCgPʂ̃ubN
+ * @param[out]		char* pszDest			: o͐(nBlocks * 48 , I[)
+ */
+static void _mem_dump_hex_ssse3(const unsigned char* p, int nBlocks, char* pszDest)
+{
+	const __m128i hex = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	// o48̊eʒuɑΉ16ïʒu(O8oCg:L, 㔼8oCg:H, -1:󔒂̈ʒu)
+	const __m128i sh0L = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+	const __m128i sh1L = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i sh1H = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5);
+	const __m128i sh2H = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1);
+	const __m128i sp0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+	const __m128i sp1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+	const __m128i sp2 = _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ');
+
+	for (int i = 0; i < nBlocks; i++) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(p + i * 16));
+		__m128i hi = _mm_shuffle_epi8(hex, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+		__m128i lo = _mm_shuffle_epi8(hex, _mm_and_si128(v, nibble));
+		__m128i L = _mm_unpacklo_epi8(hi, lo);		// O8oCg16i(16)
+		__m128i H = _mm_unpackhi_epi8(hi, lo);		// 㔼8oCg16i(16)
+
+		__m128i out0 = _mm_or_si128(_mm_shuffle_epi8(L, sh0L), sp0);
+		__m128i out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(L, sh1L), _mm_shuffle_epi8(H, sh1H)), sp1);
+		__m128i out2 = _mm_or_si128(_mm_shuffle_epi8(H, sh2H), sp2);
+
+		char* dest = pszDest + i * 48;
+		_mm_storeu_si128((__m128i*)(dest + 0), out0);
+		_mm_storeu_si128((__m128i*)(dest + 16), out1);
+		_mm_storeu_si128((__m128i*)(dest + 32), out2);
+	}
+}
+
+/**
+ * @fn				_mem_dump_write
+ * @brief			Ώۂ̃f[^̕\Lo͐ɏ(ȗEI[)
+ * @param[in]		const unsigned char* p	: Ώۂ̃f[^
+ * @param[in]		int nByteLen			: Ώۂ̃f[^̑傫(oCgP)
+ * @param[in]		int nStyle				: \L(MEM_DUMP_HEX/MEM_DUMP_ASCII)
+ * @param[out]		char* pszDest			: o͐(nByteLen * \L̕ ȏ)
+ * @return			񂾕
+ */
+static int _mem_dump_write(const unsigned char* p, int nByteLen, int nStyle, char* pszDest)
+{
+	const MEM_DUMP_TABLE* pstTable = _mem_dump_table();
+	char* dest = pszDest;
+	int i = 0;
+
+	if (nStyle == MEM_DUMP_ASCII) {
+		for (; i < nByteLen; i++) {
+			memcpy(dest, pstTable->aszAscii[p[i]], MEM_DUMP_ASCII_WIDTH);
+			dest += MEM_DUMP_ASCII_WIDTH;
+		}
+		return (int)(dest - pszDest);
+	}
+
+	if (MEM_DUMP_SIMD_MIN <= nByteLen && _mem_dump_has_ssse3()) {
+		int nBlocks = nByteLen / 16;
+		_mem_dump_hex_ssse3(p, nBlocks, dest);
+		i = nBlocks * 16;
+		dest += nBlocks * 48;
+	}
+	for (; i < nByteLen; i++) {
+		memcpy(dest, pstTable->aszHex[p[i]], MEM_DUMP_HEX_WIDTH);
+		dest += MEM_DUMP_HEX_WIDTH;
+	}
+	return (int)(dest - pszDest);
+}
+
+/**
+ * @fn				mem_dump_append
+ * @brief			Ώۂ̃f[^̕\Lo͐obt@̎wʒuɒǋL
+ * @param[in]		void* pData		: Ώۂ̃f[^
+ * @param[in]		int nByteLen	: Ώۂ̃f[^̑傫(oCgP)
+ * @param[in]		int nStyle		: \L(MEM_DUMP_HEX:"XX ", MEM_DUMP_ASCII:"XX[ASC] ")
+ * @param[in,out]	char* pszBuff	: o͐obt@̈
+ * @param[in]		int nBuffSize	: o͐obt@̈̑傫
+ * @param[in]		int nPos		: ǋLʒu(pszBuff ̕)
+ * @return			0`:ǋL̕, -1:s
+ * @remarks
+ *		Os̍쐬̃obt@ɒڒǋL邽߁Aꎞobt@ւ̏o͂ƃRs[svłB
+ *		o͐Ɏ܂肫Ȃꍇ́A܂镪̍Ō1oCg "..." Ƃďȗ\܂B
+ *		o͐̎c肪 nByteLen * \L̕ + 1 ȏłΏȗ܂B
+ */
+int mem_dump_append(void* pData, int nByteLen, int nStyle, char* pszBuff, int nBuffSize, int nPos)
+{
+	if (pData == NULL || pszBuff == NULL || nByteLen < 0 || nPos < 0 || nBuffSize <= nPos) {
+		return -1;
+	}
+
+	int width = (nStyle == MEM_DUMP_ASCII) ? (MEM_DUMP_ASCII_WIDTH) : (MEM_DUMP_HEX_WIDTH);
+	char* dest = pszBuff + nPos;
+	int rest = nBuffSize - nPos;
+	int count = (rest - 1) / width;		// I[Ď܂oCg
+
+	if (nByteLen <= count) {
+		int len = _mem_dump_write((const unsigned char*)pData, nByteLen, nStyle, dest);
+		dest[len] = '\0';
+		return nPos + len;
+	}
+	if (count == 0) {
+		dest[0] = '\0';
+		return nPos;
+	}
+	// ܂肫Ȃꍇ͏ȗ\
+	int len = _mem_dump_write((const unsigned char*)pData, count - 1, nStyle, dest);
+	memcpy(dest + len, "...", 4);
+	return nPos + len + 3;
+}
+
+/**
+ * @fn				mem_dump_stream
+ * @brief			Ώۂ̃f[^̕\Lt@C(Wo͓)ɒڏo͂
+ * @param[in]		FILE* fp		: o͐
+ * @param[in]		void* pData		: Ώۂ̃f[^
+ * @param[in]		int nByteLen	: Ώۂ̃f[^̑傫(oCgP)
+ * @param[in]		int nStyle		: \L(MEM_DUMP_HEX/MEM_DUMP_ASCII)
+ * @return			0`:o͂, -1:s
+ * @remarks			f[^S̏̕o̓obt@͎gpAȒPʂŕϊď݂܂(ȗ\)B
+ */
+int mem_dump_stream(FILE* fp, void* pData, int nByteLen, int nStyle)
+{
+	if (fp == NULL || pData == NULL || nByteLen < 0) {
+		return -1;
+	}
+
+	const int nChunk = 128;
+	char szBuff[nChunk * MEM_DUMP_ASCII_WIDTH];
+	const unsigned char* p = (const unsigned char*)pData;
+	int total = 0;
+
+	for (int i = 0; i < nByteLen; i += nChunk) {
+		int n = (nChunk < nByteLen - i) ? (nChunk) : (nByteLen - i);
+		int len = _mem_dump_write(p + i, n, nStyle, szBuff);
+		if (fwrite(szBuff, 1, len, fp) != (size_t)len) {
+			return -1;
+		}
+		total += len;
+	}
+	return total;
+}
+
 /**
  * @fn				_mem_dump
  * @brief			Ώۂ̃f[^16i\Lŏo͐obt@ɏo
@@ -102,23 +384,10 @@ int _mem_dump(void* pData, int nByteLen, char* pszDump, int nDumpLen)
 	if (pData == NULL || pszDump == NULL /*|| nDumpLen < (nByteLen * 3 + 1)*/) {
 		return -1;
 	}
-
-	unsigned char* p = (unsigned char*)pData;
-	char buff[4] = { 0,0,0,0 };
-	int bp = 0;
-
-	memset(pszDump, 0, nDumpLen);
-
-	for (int i = 0; i < nByteLen && bp < nDumpLen - 3; i++) {
-		snprintf(buff, sizeof(buff), "%02X ", *(p + i));
-		strncpy(pszDump + bp, buff, strlen(buff));
-		bp += strlen(buff);
-	}
-	// o͐obt@Ƀf[^܂肫Ȃꍇ͏ȗ\
-	if (nDumpLen < (nByteLen * 3 + 1) && 3 <= bp) {
-		strncpy(pszDump + (bp - 3), "...", 3);
+	if (nDumpLen <= 0) {
+		return 0;
 	}
-	return 0;
+	return (mem_dump_append(pData, nByteLen, MEM_DUMP_HEX, pszDump, nDumpLen, 0) < 0) ? (-1) : (0);
 }
 /**
  * @fn				mem_dump
@@ -151,25 +420,10 @@ int _mem_dump2(void* pData, int nByteLen, char* pszDump, int nDumpLen)
 	if (pData == NULL || pszDump == NULL /*|| nDumpLen < (nByteLen * 8 + 1)*/) {
 		return -1;
 	}
-
-	unsigned char* p = (unsigned char*)pData;
-	char buff[9] = { 0 };
-	int bp = 0;
-	unsigned char uch = 0;
-
-	memset(pszDump, 0, nDumpLen);
-
-	for (int i = 0; i < nByteLen && bp < nDumpLen - 8; i++) {
-		uch = *(p + i);
-		snprintf(buff, sizeof(buff), "%02X[%s] ", uch, aszAscii[uch]);
-		strncpy(pszDump + bp, buff, strlen(buff));
-		bp += strlen(buff);
+	if (nDumpLen <= 0) {
+		return 0;
 	}
-	// o͐obt@Ƀf[^܂肫Ȃꍇ͏ȗ\
-	if (nDumpLen < (nByteLen * 8 + 1) && 8 <= bp) {
-		strncpy(pszDump + (bp - 8), "...", 8);
-	}
-	return 0;
+	return (mem_dump_append(pData, nByteLen, MEM_DUMP_ASCII, pszDump, nDumpLen, 0) < 0) ? (-1) : (0);
 }
 /**
  * @fn				mem_dump2
@@ -240,6 +494,328 @@ const char* fmt_str(char* szBuff, int n, const char* szFmt, ...)
 }
 
 
+/**
+ * @fn				_str_tok_cpuid_sse42
+ * @brief			CPUID  SSE4.2 (pcmpestri)̑Ή𒲂ׂ
+ * @return			TRUE:Ή, FALSE:Ή
+ */
+static BOOL _str_tok_cpuid_sse42()
+{
+	int anInfo[4] = { 0 };
+	__cpuid(anInfo, 1);
+	return (anInfo[2] & (1 << 20)) ? (TRUE) : (FALSE);	// ECX bit20:SSE4.2
+}
+
+/**
+ * @fn				_str_tok_has_sse42
+ * @brief			SSE4.2 ߂gp\肷(CPUID ͏̂ݎs)
+ * @return			TRUE:gp\, FALSE:gps
+ */
+static BOOL _str_tok_has_sse42()
+{
+	static const BOOL s_bSse42 = _str_tok_cpuid_sse42();
+	return s_bSse42;
+}
+
+/**
+ * @fn				_str_tok_scan
+ * @brief			؂蕶(܂͋؂蕶ȊO)̈ʒu
+ * @param[in]		const char* p				: Ώ
+ * @param[in]		int nLen					: Ώۂ̕
+ * @param[in]		const STR_DELIM* pstDelim	: ؂蕶W
+ * @param[in]		BOOL bDelim					: TRUE:؂蕶, FALSE:؂蕶ȊO
+ * @return			ʒu(Ȃꍇ nLen)
+ */
+static int _str_tok_scan(const char* p, int nLen, const STR_DELIM* pstDelim, BOOL bDelim)
+{
+	// Zvfߐ擪16͕\Ŕ肵Aȍ~͈̒͂SIMDŌ
+	int nHead = (16 < nLen) ? (16) : (nLen);
+	int i = 0;
+
+	for (; i < nHead; i++) {
+		unsigned char c = (unsigned char)p[i];
+		BOOL bHit = (pstDelim->auBits[c >> 5] & (1u << (c & 31))) ? (TRUE) : (FALSE);
+		if (bHit == bDelim) {
+			return i;
+		}
+	}
+	if (STR_TOK_SIMD_MIN <= nLen - i && 0 < pstDelim->nSet && pstDelim->nSet <= STR_TOK_SIMD_CMPEQ_MAX) {
+		// ؂蕶Ȃꍇ1rʂ(SSE2)
+		__m128i d0 = _mm_set1_epi8(pstDelim->achSet[0]);
+		__m128i d1 = _mm_set1_epi8(pstDelim->achSet[(1 < pstDelim->nSet) ? (1) : (0)]);
+		__m128i d2 = _mm_set1_epi8(pstDelim->achSet[(2 < pstDelim->nSet) ? (2) : (0)]);
+		__m128i d3 = _mm_set1_epi8(pstDelim->achSet[(3 < pstDelim->nSet) ? (3) : (0)]);
+		unsigned int uiInv = (bDelim) ? (0) : (0xFFFF);
+		for (; i + 16 <= nLen; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+			__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, d0), _mm_cmpeq_epi8(v, d1)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, d2), _mm_cmpeq_epi8(v, d3)));
+			unsigned int uiMask = (unsigned int)_mm_movemask_epi8(m) ^ uiInv;
+			if (uiMask != 0) {
+				unsigned long ulIdx;
+				_BitScanForward(&ulIdx, uiMask);
+				return i + (int)ulIdx;
+			}
+		}
+	}
+	else if (STR_TOK_SIMD_MIN <= nLen - i && 0 < pstDelim->nSet && pstDelim->nSet <= STR_TOK_SIMD_MAX_DELIM && _str_tok_has_sse42()) {
+		const __m128i set = _mm_loadu_si128((const __m128i*)pstDelim->achSet);
+		for (; i + 16 <= nLen; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+			int idx = (bDelim)
+				? (_mm_cmpestri(set, pstDelim->nSet, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT))
+				: (_mm_cmpestri(set, pstDelim->nSet, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT));
+			if (idx < 16) {
+				return i + idx;
+			}
+		}
+	}
+	for (; i < nLen; i++) {
+		unsigned char c = (unsigned char)p[i];
+		BOOL bHit = (pstDelim->auBits[c >> 5] & (1u << (c & 31))) ? (TRUE) : (FALSE);
+		if (bHit == bDelim) {
+			return i;
+		}
+	}
+	return nLen;
+}
+
+/**
+ * @fn				str_delim_init
+ * @brief			؂蕶W쐬
+ * @param[out]		STR_DELIM* pstDelim		: ؂蕶W
+ * @param[in]		const char* szDelim		: ؂蕶(w, :" ,\t")
+ * @return			0`:؂蕶̐, -1:s
+ * @remarks			؂蕶ŌJԂꍇ͈x쐬Ďg
+ */
+int str_delim_init(STR_DELIM* pstDelim, const char* szDelim)
+{
+	if (pstDelim == NULL || szDelim == NULL) {
+		return -1;
+	}
+
+	memset(pstDelim, 0, sizeof(STR_DELIM));
+	int cnt = 0;
+	for (const unsigned char* p = (const unsigned char*)szDelim; *p != '\0'; p++) {
+		if (pstDelim->auBits[*p >> 5] & (1u << (*p & 31))) {
+			continue;		// d
+		}
+		pstDelim->auBits[*p >> 5] |= (1u << (*p & 31));
+		if (cnt < STR_TOK_SIMD_MAX_DELIM) {
+			pstDelim->achSet[cnt] = (char)*p;
+		}
+		cnt++;
+	}
+	pstDelim->nSet = cnt;
+	return cnt;
+}
+
+/**
+ * @fn				str_tok_init
+ * @brief			Jn
+ * @param[out]		STR_TOK* pstTok				: 
+ * @param[in]		const char* pSrc			: Ώ(I[sv, ύXȂ)
+ * @param[in]		int nLen					: Ώۂ̕
+ * @param[in]		const STR_DELIM* pstDelim	: ؂蕶W
+ * @param[in]		int nFlags					: STR_TOK_SKIP_EMPTY/STR_TOK_KEEP_EMPTY
+ * @return			0:, -1:s
+ */
+int str_tok_init(STR_TOK* pstTok, const char* pSrc, int nLen, const STR_DELIM* pstDelim, int nFlags)
+{
+	return str_tok_init2(pstTok, pSrc, nLen, NULL, 0, pstDelim, nFlags);
+}
+
+/**
+ * @fn				str_tok_init2
+ * @brief			2̗̈ɕꂽf[^(Oobt@ PeekSpan )̕Jn
+ * @param[out]		STR_TOK* pstTok				: 
+ * @param[in]		const char* pSrc1			: Ώۂ̑O
+ * @param[in]		int nLen1					: O̕
+ * @param[in]		const char* pSrc2			: Ώۂ̌㔼(NULL:Ȃ)
+ * @param[in]		int nLen2					: 㔼̕
+ * @param[in]		const STR_DELIM* pstDelim	: ؂蕶W
+ * @param[in]		int nFlags					: STR_TOK_SKIP_EMPTY/STR_TOK_KEEP_EMPTY
+ * @return			0:, -1:s
+ */
+int str_tok_init2(STR_TOK* pstTok, const char* pSrc1, int nLen1, const char* pSrc2, int nLen2, const STR_DELIM* pstDelim, int nFlags)
+{
+	if (pstTok == NULL || pstDelim == NULL || nLen1 < 0 || nLen2 < 0) {
+		return -1;
+	}
+	if ((pSrc1 == NULL && 0 < nLen1) || (pSrc2 == NULL && 0 < nLen2)) {
+		return -1;
+	}
+
+	pstTok->apSpan[0] = pSrc1;
+	pstTok->anSpan[0] = nLen1;
+	pstTok->apSpan[1] = pSrc2;
+	pstTok->anSpan[1] = (pSrc2 != NULL) ? (nLen2) : (0);
+	pstTok->nSpan = 0;
+	pstTok->nPos = 0;
+	pstTok->pstDelim = pstDelim;
+	pstTok->nFlags = nFlags;
+	pstTok->bDone = FALSE;
+	return 0;
+}
+
+/**
+ * @fn				str_tok_next
+ * @brief			̗vf؂o
+ * @param[in,out]	STR_TOK* pstTok			: 
+ * @param[out]		STR_TOKEN* pstToken		: ؂ovf(ΏۓQƂ)
+ * @return			TRUE:؂o, FALSE:vfȂ(I)
+ * @remarks			strtok ƈقȂ蕪ΏۂύXAɏԂȂߍē\łB
+ */
+BOOL str_tok_next(STR_TOK* pstTok, STR_TOKEN* pstToken)
+{
+	if (pstTok == NULL || pstToken == NULL || pstTok->bDone) {
+		return FALSE;
+	}
+
+	memset(pstToken, 0, sizeof(STR_TOKEN));
+
+	// 擪̋؂蕶ǂݔ΂
+	if (pstTok->nFlags != STR_TOK_KEEP_EMPTY) {
+		for (;;) {
+			int s = pstTok->nSpan;
+			pstTok->nPos += _str_tok_scan(pstTok->apSpan[s] + pstTok->nPos, pstTok->anSpan[s] - pstTok->nPos, pstTok->pstDelim, FALSE);
+			if (pstTok->nPos < pstTok->anSpan[s]) {
+				break;
+			}
+			if (s == 1) {
+				pstTok->bDone = TRUE;
+				return FALSE;
+			}
+			pstTok->nSpan = 1;
+			pstTok->nPos = 0;
+		}
+	}
+	else if (pstTok->nSpan == 0 && pstTok->anSpan[0] <= pstTok->nPos && 0 < pstTok->anSpan[1]) {
+		pstTok->nSpan = 1;
+		pstTok->nPos = 0;
+	}
+
+	// ؂蕶܂(̈̋E܂ꍇ2̕ɕ)
+	for (int k = 0; ; k++) {
+		int s = pstTok->nSpan;
+		const char* p = pstTok->apSpan[s] + pstTok->nPos;
+		int rest = pstTok->anSpan[s] - pstTok->nPos;
+		int len = _str_tok_scan(p, rest, pstTok->pstDelim, TRUE);
+
+		if (0 < len || k == 0) {
+			pstToken->apStr[k] = p;
+			pstToken->anLen[k] = len;
+		}
+		if (len < rest) {
+			pstTok->nPos += len + 1;	// ؂蕶̎
+			if (pstTok->nPos == pstTok->anSpan[s] && (s == 1 || pstTok->anSpan[1] == 0) && pstTok->nFlags != STR_TOK_KEEP_EMPTY) {
+				pstTok->bDone = TRUE;
+			}
+			return TRUE;
+		}
+		if (s == 1 || pstTok->anSpan[1] == 0) {
+			pstTok->nPos += len;
+			pstTok->bDone = TRUE;		// f[^̏I[
+			return TRUE;
+		}
+		pstTok->nSpan = 1;
+		pstTok->nPos = 0;
+	}
+}
+
+/**
+ * @fn				str_split
+ * @brief			񕪊 (Rs[Ɋevf̈ʒuƕԂ)
+ * @param[in]		const char* pSrc			: Ώ(I[sv, ύXȂ)
+ * @param[in]		int nLen					: Ώۂ̕
+ * @param[in]		const STR_DELIM* pstDelim	: ؂蕶W
+ * @param[in]		int nFlags					: STR_TOK_SKIP_EMPTY/STR_TOK_KEEP_EMPTY
+ * @param[out]		STR_TOKEN astToken[]		: evf̏o͐
+ * @param[in]		int nToken					: o̗͐vf
+ * @return			0`:(nToken 𒴂镪͐؂̂), -1:s
+ */
+int str_split(const char* pSrc, int nLen, const STR_DELIM* pstDelim, int nFlags, STR_TOKEN astToken[], int nToken)
+{
+	if (astToken == NULL || nToken < 0) {
+		return -1;
+	}
+
+	STR_TOK stTok;
+	if (str_tok_init(&stTok, pSrc, nLen, pstDelim, nFlags) < 0) {
+		return -1;
+	}
+
+	int cnt = 0;
+	while (cnt < nToken && str_tok_next(&stTok, &astToken[cnt])) {
+		cnt++;
+	}
+	return cnt;
+}
+
+/**
+ * @fn				str_token_len
+ * @brief			vf̕擾
+ * @param[in]		const STR_TOKEN* pstToken	: vf
+ * @return			0`:, -1:s
+ */
+int str_token_len(const STR_TOKEN* pstToken)
+{
+	if (pstToken == NULL) {
+		return -1;
+	}
+	return pstToken->anLen[0] + pstToken->anLen[1];
+}
+
+/**
+ * @fn				str_token_copy
+ * @brief			vfI[t̕Ƃăobt@ɃRs[
+ * @param[in]		const STR_TOKEN* pstToken	: vf
+ * @param[out]		char* szBuff				: o͐obt@̈
+ * @param[in]		int nSize					: o͐obt@̈̃TCY
+ * @return			0`:Rs[, -1:s(obt@s)
+ */
+int str_token_copy(const STR_TOKEN* pstToken, char* szBuff, int nSize)
+{
+	if (pstToken == NULL || szBuff == NULL || nSize <= 0) {
+		return -1;
+	}
+	int len = pstToken->anLen[0] + pstToken->anLen[1];
+	if (nSize <= len) {
+		szBuff[0] = '\0';
+		return -1;
+	}
+	if (0 < pstToken->anLen[0]) {
+		memcpy(szBuff, pstToken->apStr[0], pstToken->anLen[0]);
+	}
+	if (0 < pstToken->anLen[1]) {
+		memcpy(szBuff + pstToken->anLen[0], pstToken->apStr[1], pstToken->anLen[1]);
+	}
+	szBuff[len] = '\0';
+	return len;
+}
+
+/**
+ * @fn				str_token_equal
+ * @brief			vfƕ񂪈v邩r
+ * @param[in]		const STR_TOKEN* pstToken	: vf
+ * @param[in]		const char* szStr			: r镶
+ * @return			TRUE:v, FALSE:sv
+ */
+BOOL str_token_equal(const STR_TOKEN* pstToken, const char* szStr)
+{
+	if (pstToken == NULL || szStr == NULL) {
+		return FALSE;
+	}
+	int len = (int)strlen(szStr);
+	if (len != pstToken->anLen[0] + pstToken->anLen[1]) {
+		return FALSE;
+	}
+	if (0 < pstToken->anLen[0] && memcmp(pstToken->apStr[0], szStr, pstToken->anLen[0]) != 0) {
+		return FALSE;
+	}
+	return (pstToken->anLen[1] == 0 || memcmp(pstToken->apStr[1], szStr + pstToken->anLen[0], pstToken->anLen[1]) == 0) ? (TRUE) : (FALSE);
+}
+
 /**
  * @fn				split_str
  * @brief			񕪊 (̃f[^ъevfւ̃|C^Ԃ)
@@ -251,30 +827,36 @@ const char* fmt_str(char* szBuff, int n, const char* szFmt, ...)
  * @param[in]		int nToken		: ̊evfւ̃|C^o͂z̃TCY
  * @return			1`:, -1:s
  * @remarks			apToken̊evfszDest̑ΉAhXw, nTokenȏゾƎs
+ *					strtok ͎gpȂߍē\, Rs[svȏꍇ str_split gp
  */
 int split_str(const char* szSrc, char* szDelim, char* szDest, int nDest, char* apToken[], int nToken)
 {
 	if (szSrc == NULL || szDelim == NULL || szDest == NULL || apToken == NULL || nDest < 0) {
 		return -1;
 	}
-	if (nDest <= (int)strlen(szSrc)) {
+	int len = (int)strlen(szSrc);
+	if (nDest <= len) {
 		return -1;
 	}
 
-	char* tp = NULL;
+	STR_DELIM stDelim;
+	STR_TOK stTok;
+	STR_TOKEN stToken;
 	int cnt = 0;
 
-	strncpy(szDest, szSrc, nDest);
+	memcpy(szDest, szSrc, len + 1);
+	str_delim_init(&stDelim, szDelim);
+	str_tok_init(&stTok, szDest, len, &stDelim, STR_TOK_SKIP_EMPTY);
 
-	tp = strtok(szDest, szDelim);
-	while (tp != NULL) {
+	while (str_tok_next(&stTok, &stToken)) {
 		if (nToken <= cnt) {
 			//return -1;
 			break;
 		}
+		char* tp = (char*)stToken.apStr[0];
+		tp[stToken.anLen[0]] = '\0';		// ؂蕶(܂͏I[)'\0'ɒu
 		apToken[cnt] = tp;
 		cnt++;
-		tp = strtok(NULL, szDelim);
 	}
 
 	return cnt;
@@ -293,17 +875,16 @@ const char* str_time_now(char* szBuff, int nSize)
 	if (szBuff == NULL) {
 		return "(NULL)";
 	}
-	SYSTEMTIME stTime;
-	GetLocalTime((LPSYSTEMTIME)&stTime);
-	snprintf(szBuff, nSize,
-		"%04d/%02d/%02d, %02d:%02d:%02d.%03d"
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds);
+	if (TIME_CACHE_LEN < nSize) {
+		time_cache_now(szBuff, NULL);
+	}
+	else if (0 < nSize) {
+		// obt@ꍇ͓镪̂(] snprintf Ɠ؂l)
+		char szTime[TIME_CACHE_LEN + 1];
+		time_cache_now(szTime, NULL);
+		memcpy(szBuff, szTime, nSize - 1);
+		szBuff[nSize - 1] = '\0';
+	}
 	return szBuff;
 }
 
@@ -376,50 +957,44 @@ int calc_bcc(void* pData, int nByteLen)
 		return -1;
 	}
 
-	unsigned char* pbyData = (unsigned char*)pData;
-	unsigned char byVal = 0;
-
-	for (int i = 0; i < nByteLen; i++) {
-		byVal ^= *(pbyData + i);
-	}
-	return byVal;
+	// ̈ɕꂽf[^ bcc_update(checksum.h)ŏɌvZ
+	return bcc_update(0, pData, nByteLen);
 }
 
 
+/**
+ * @fn			calc_lrc
+ * @brief		LRCvZ
+ * @param[in]	void* pData			: vZΏۃf[^ւ̎Q
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		LRCvZl
+ */
 int calc_lrc(void* pData, int nByteLen)
 {
 	if (pData == NULL) {
 		return -1;
 	}
 
-	unsigned char* pbyData = (unsigned char*)pData;
-	unsigned int sum = 0;
-	unsigned char byVal = 0;
-
-	for (int i = 0; i < nByteLen; i++) {
-		sum += *(pbyData + i);
-	}
-	//byVal = (unsigned char)((~sum + 1) & 0xFF);
-	byVal = (unsigned char)(COMPL2(sum) & 0xFF);
-	return byVal;
+	// ̈ɕꂽf[^ sum_update(checksum.h)ŉZAlrc_final  LRC 𓾂
+	return lrc_final(sum_update(0, pData, nByteLen));
 }
 
 
+/**
+ * @fn			calc_crc16
+ * @brief		CRC-16/ModbusvZ
+ * @param[in]	void* pData			: vZΏۃf[^ւ̎Q
+ * @param[in]	int nByteLen		: Ώۃf[^̃oCg
+ * @return		CRCvZl(dɂ͉ʃoCgAʃoCg̏ɕt)
+ * @remarks		CRC-16/CCITT, CRC-32  checksum.h  crc16_ccitt_update, crc32_update gp
+ */
 int calc_crc16(void* pData, int nByteLen)
 {
 	if (pData == NULL) {
 		return -1;
 	}
 
-	unsigned char* pbyData = (unsigned char*)pData;
-	unsigned int sum = 0;
-	unsigned char byVal = 0;
-
-	//for (int i = 0; i < nByteLen; i++) {
-	//	sum += *(pbyData + i);
-	//}
-	//byVal = (unsigned char)((~sum + 1) & 0xFF);
-	return byVal;
+	return crc16_modbus_update(CRC16_MODBUS_INIT, pData, nByteLen);
 }
 
 
@@ -2,11 +2,17 @@
 
 #include <windows.h>
 #include "misc.h"
+#include "Lock.h"
+
+// L[̔rbN|V[(Lock.hAVOXbhŎgpꍇ̓CN[hO CLockNone `)
+#ifndef QUEUE_LOCK_POLICY
+#define QUEUE_LOCK_POLICY		CLockCS<>
+#endif
 
 #define QUEUE_SIZE		(16)		// 2**n
 #define MAX_LOG_ID			(1)
 
-static CRITICAL_SECTION g_stCS[MAX_LOG_ID];
+static QUEUE_LOCK_POLICY g_cLock[MAX_LOG_ID];
 static unsigned char g_byQueue[MAX_LOG_ID][QUEUE_SIZE];
 static int g_nHead = 0;
 static int g_nLength = 0;
@@ -141,7 +147,7 @@ void debug_print()
 static void lock_init(int nID)
 {
 	if (0 <= nID && nID < MAX_LOG_ID) {
-		::InitializeCriticalSection(&(g_stCS[nID]));
+		g_cLock[nID].Init();
 	}
 }
 /**
@@ -152,7 +158,7 @@ static void lock_init(int nID)
 static void lock_delete(int nID)
 {
 	if (0 <= nID && nID < MAX_LOG_ID) {
-		::DeleteCriticalSection(&(g_stCS[nID]));
+		g_cLock[nID].Exit();
 	}
 }
 /**
@@ -163,7 +169,7 @@ static void lock_delete(int nID)
 static void lock(int nID)
 {
 	if (0 <= nID && nID < MAX_LOG_ID) {
-		::EnterCriticalSection(&(g_stCS[nID]));
+		g_cLock[nID].Lock();
 	}
 }
 /**
@@ -174,6 +180,6 @@ static void lock(int nID)
 static void unlock(int nID)
 {
 	if (0 <= nID && nID < MAX_LOG_ID) {
-		::LeaveCriticalSection(&(g_stCS[nID]));
+		g_cLock[nID].Unlock();
 	}
 }
@@ -0,0 +1,448 @@
+/**
+ * @file	ring_bench.cpp
+ * @brief	Oobt@/L[̃x`}[N
+ * @author	?
+ * @date	?
+ * @remarks
+ *		eL[ɂāAX[vbg(MB/s)ƑMx(p50/p99/p999)v܂B
+ *		v:
+ *			bZ[WTCY	: 1B`64KB
+ *			݃Xbh	: 1`N (ǏoXbh1)
+ *			RAŒ			: Œ肠(Ǐo=RA0, =RA1`) / ŒȂ
+ *		x͏ݑbZ[W擪ɖߍ QPC lƁAǏoŃbZ[W
+ *		oI̍łBoCgPʂ̃L[ŏ݃Xbh̏ꍇ
+ *		bZ[WEۂȂ߁AX[vbĝ݌v܂B
+ *		ݑ͑҂ŏݑ邽߁Ax̓obt@ؗԂ܂ޖOa̒lłB
+ *		C ŃL[(queue_push/queue_pop)̓wb_m̊֐`邽߁A
+ *		RING_BENCH_C_QUEUE ŌvΏۂ1Iărh܂B
+ *			1:ring_buffer.h, 2:simple_queue.h, 3:simple_queue2.h
+ *		PƂ̃R\[AvP[VƂărhĂ(main.cpp Ƃ͕ʃvWFNg)B
+ *		usage: ring_bench [ő发݃Xbh] [1̓](MB)]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <windows.h>
+#include <process.h>
+#include <algorithm>
+#include <vector>
+#include "misc.h"
+#include "CByteRingBuffer.h"
+#include "SimpleQueue.h"
+#include "MessageQueue.h"
+#include "MpmcQueue.h"
+
+#ifndef RING_BENCH_C_QUEUE
+#define RING_BENCH_C_QUEUE		(1)
+#endif
+
+#if RING_BENCH_C_QUEUE == 1
+#include "ring_buffer.h"
+#define C_QUEUE_NAME			"ring_buffer.h"
+#elif RING_BENCH_C_QUEUE == 2
+#include "simple_queue.h"
+#define C_QUEUE_NAME			"simple_queue.h"
+#elif RING_BENCH_C_QUEUE == 3
+#include "simple_queue2.h"
+#define C_QUEUE_NAME			"simple_queue2.h"
+#endif
+
+
+#define BENCH_RING_SIZE			(256 * 1024)		// oCgPʂ̃L[̃obt@TCY
+#define BENCH_ELEMENT_COUNT		(1024)				// vfPʂ̃L[̗vf
+#define BENCH_MSG_MAX			(60)				// vfPʂ̃L[ň郁bZ[WTCY
+#define BENCH_MAX_MSGS			(2 * 1024 * 1024)	// 1̍ő僁bZ[W
+#define BENCH_MIN_MSGS			(1000)				// 1̍ŏbZ[W
+#define BENCH_MAX_PRODUCER		(16)
+
+
+/**
+ * @struct	BENCH_MSG
+ * @brief	vfPʂ̃L[Ŏ󂯓nbZ[W(64byte)
+ */
+typedef struct _BENCH_MSG {
+	int					nLen;							//!< bZ[WTCY
+	unsigned char		abyData[BENCH_MSG_MAX];			//!< bZ[W
+} BENCH_MSG;
+
+
+/**
+ * @class	CBenchTarget
+ * @brief	vΏۃL[̋ʃC^tF[X
+ * @remarks	Sœz֐ďooR邽߁AďoRXg͔rɉe܂B
+ */
+class CBenchTarget
+{
+public:
+	virtual ~CBenchTarget() {}
+	//! \
+	virtual const char*	Name() = 0;
+	//! ݃Xbh𕡐ɂł邩
+	virtual BOOL		IsMultiProducer() = 0;
+	//! bZ[WPʂŎ󂯓n(FALSE:oCg)
+	virtual BOOL		IsElement() { return FALSE; }
+	//! f[^ǉ(߂l:ǉoCg)
+	virtual int			Push(const unsigned char* pbyData, int nLen) = 0;
+	//! f[^o(߂l:ooCg)
+	virtual int			Pop(unsigned char* pbyBuff, int nLen) = 0;
+};
+
+/**
+ * @class	CBenchRing
+ * @brief	CByteRingBuffer
+ */
+class CBenchRing : public CBenchTarget
+{
+private:
+	CByteRingBuffer*	m_pcRing;		// oɎ CBenchRing ̂LbVCEv邽ߕʂɊm
+public:
+	CBenchRing(CByteRingBuffer::RING_MODE enMode) { m_pcRing = new CByteRingBuffer(BENCH_RING_SIZE, enMode); }
+	~CBenchRing() { delete m_pcRing; }
+	const char*	Name() { return (m_pcRing->GetMode() == CByteRingBuffer::RING_MODE_SPSC) ? ("CByteRingBuffer(SPSC)") : ("CByteRingBuffer(LOCK)"); }
+	BOOL		IsMultiProducer() { return (m_pcRing->GetMode() == CByteRingBuffer::RING_MODE_LOCK); }
+	int			Push(const unsigned char* pbyData, int nLen) { return m_pcRing->Push(pbyData, nLen); }
+	int			Pop(unsigned char* pbyBuff, int nLen) { return m_pcRing->Pop(pbyBuff, nLen); }
+};
+
+/**
+ * @class	CBenchCQueue
+ * @brief	CQueue
+ */
+class CBenchCQueue : public CBenchTarget
+{
+private:
+	CQueue				m_cQueue;
+public:
+	CBenchCQueue() : m_cQueue(BENCH_RING_SIZE - 1) {}
+	const char*	Name() { return "CQueue"; }
+	BOOL		IsMultiProducer() { return TRUE; }
+	int			Push(const unsigned char* pbyData, int nLen) { return m_cQueue.Enqueue(pbyData, nLen); }
+	int			Pop(unsigned char* pbyBuff, int nLen) { return m_cQueue.Dequeue(pbyBuff, nLen); }
+};
+
+#ifdef C_QUEUE_NAME
+/**
+ * @class	CBenchCQueueC
+ * @brief	C ŃL[(queue_push/queue_pop)
+ */
+class CBenchCQueueC : public CBenchTarget
+{
+private:
+	RING_BUFFER*		m_pstRing;
+public:
+#if RING_BENCH_C_QUEUE == 1
+	CBenchCQueueC() { m_pstRing = init_queue(BENCH_RING_SIZE); }
+	~CBenchCQueueC() { delete_queue(m_pstRing); }
+#elif RING_BENCH_C_QUEUE == 2
+	CBenchCQueueC() { m_pstRing = (RING_BUFFER*)_aligned_malloc(sizeof(RING_BUFFER), CACHE_LINE_SIZE); queue_init(m_pstRing, BENCH_RING_SIZE); }
+	~CBenchCQueueC() { queue_end(m_pstRing); _aligned_free(m_pstRing); }
+#else
+	CBenchCQueueC() { m_pstRing = create_queue(BENCH_RING_SIZE); }
+	~CBenchCQueueC() { delete_queue(m_pstRing); }
+#endif
+	const char*	Name() { return C_QUEUE_NAME; }
+	BOOL		IsMultiProducer() { return TRUE; }
+	int			Push(const unsigned char* pbyData, int nLen) { return queue_push(m_pstRing, pbyData, nLen); }
+	int			Pop(unsigned char* pbyBuff, int nLen) { return queue_pop(m_pstRing, pbyBuff, nLen); }
+};
+#endif
+
+/**
+ * @class	CBenchElement
+ * @brief	vfPʂ̃L[(CMessageQueue/CMpmcQueue)
+ */
+template <class Q>
+class CBenchElement : public CBenchTarget
+{
+private:
+	Q*					m_pcQueue;
+	const char*			m_szName;
+public:
+	CBenchElement(Q* pcQueue, const char* szName) : m_pcQueue(pcQueue), m_szName(szName) {}
+	~CBenchElement() { delete m_pcQueue; }
+	const char*	Name() { return m_szName; }
+	BOOL		IsMultiProducer() { return TRUE; }
+	BOOL		IsElement() { return TRUE; }
+	int			Push(const unsigned char* pbyData, int nLen)
+	{
+		BENCH_MSG stMsg;
+		stMsg.nLen = nLen;
+		memcpy(stMsg.abyData, pbyData, nLen);
+		return (m_pcQueue->Enqueue(stMsg) == 0) ? (nLen) : (0);
+	}
+	int			Pop(unsigned char* pbyBuff, int nLen)
+	{
+		BENCH_MSG stMsg;
+		if (m_pcQueue->Dequeue(&stMsg) != 0) {
+			return 0;
+		}
+		memcpy(pbyBuff, stMsg.abyData, stMsg.nLen);
+		return stMsg.nLen;
+	}
+};
+
+
+/**
+ * @struct	BENCH_PARAM
+ * @brief	vXbhp[^
+ */
+typedef struct _BENCH_PARAM {
+	CBenchTarget*		pcTarget;			//!< vΏ
+	HANDLE				hStart;				//!< vJnCxg
+	int					nMsgSize;			//!< bZ[WTCY
+	int					nMsgs;				//!< ݃Xbh̃bZ[W
+	int					nProducers;			//!< ݃Xbh
+	DWORD_PTR			dwAffinity;			//!< Œ肷RÃ}XN(0:Œ肵Ȃ)
+	std::vector<LONGLONG>*	pvLatency;		//!< x(QPC JEg)̊i[(ǏoXbh)
+} BENCH_PARAM;
+
+
+/**
+ * @fn		qpc_now
+ * @brief	QPC ̌ݒl擾
+ */
+static inline LONGLONG qpc_now()
+{
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+
+/**
+ * @fn		thread_producer
+ * @brief	݃Xbh
+ */
+unsigned __stdcall thread_producer(PVOID pParam)
+{
+	BENCH_PARAM* pstParam = (BENCH_PARAM*)pParam;
+	std::vector<unsigned char> vMsg(pstParam->nMsgSize, 0x55);
+	unsigned char* pbyMsg = &vMsg[0];
+	int size = pstParam->nMsgSize;
+
+	if (pstParam->dwAffinity != 0) {
+		::SetThreadAffinityMask(::GetCurrentThread(), pstParam->dwAffinity);
+	}
+	::WaitForSingleObject(pstParam->hStart, INFINITE);
+
+	for (int i = 0; i < pstParam->nMsgs; i++) {
+		if (sizeof(LONGLONG) <= (size_t)size) {
+			LONGLONG stamp = qpc_now();
+			memcpy(pbyMsg, &stamp, sizeof(stamp));
+		}
+		int sent = 0;
+		while (sent < size) {
+			int count = pstParam->pcTarget->Push(pbyMsg + sent, size - sent);
+			if (count <= 0) {
+				::SwitchToThread();
+				continue;
+			}
+			sent += count;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * @fn		thread_consumer
+ * @brief	ǏoXbh
+ * @remarks	bZ[WEۂꍇ̂݁A1bZ[WɒxL^܂B
+ */
+unsigned __stdcall thread_consumer(PVOID pParam)
+{
+	BENCH_PARAM* pstParam = (BENCH_PARAM*)pParam;
+	std::vector<unsigned char> vMsg(pstParam->nMsgSize, 0);
+	unsigned char* pbyMsg = &vMsg[0];
+	int size = pstParam->nMsgSize;
+	long long total = (long long)size * pstParam->nMsgs * pstParam->nProducers;
+	long long recv = 0;
+	int offset = 0;
+	BOOL bLatency = ((pstParam->pcTarget->IsElement() || pstParam->nProducers == 1) && sizeof(LONGLONG) <= (size_t)size);
+
+	if (pstParam->dwAffinity != 0) {
+		::SetThreadAffinityMask(::GetCurrentThread(), pstParam->dwAffinity);
+	}
+	::WaitForSingleObject(pstParam->hStart, INFINITE);
+
+	while (recv < total) {
+		int count = pstParam->pcTarget->Pop(pbyMsg + offset, size - offset);
+		if (count <= 0) {
+			::SwitchToThread();
+			continue;
+		}
+		recv += count;
+		offset += count;
+		if (size <= offset) {
+			// 1bZ[WM
+			if (bLatency) {
+				LONGLONG stamp;
+				memcpy(&stamp, pbyMsg, sizeof(stamp));
+				pstParam->pvLatency->push_back(qpc_now() - stamp);
+			}
+			offset = 0;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * @fn		percentile
+ * @brief	\[gςݒx̎wp[Z^Cl ns ŕԂ
+ */
+static double percentile(const std::vector<LONGLONG>& vSorted, double dRate, LONGLONG llFreq)
+{
+	size_t index = (size_t)(dRate * (double)(vSorted.size() - 1));
+	return (double)vSorted[index] * 1.0e9 / (double)llFreq;
+}
+
+
+/**
+ * @fn		run_bench
+ * @brief	1̌vsAʂ1so͂
+ */
+void run_bench(CBenchTarget* pcTarget, int nMsgSize, int nProducers, BOOL bPinned, long long llBytes)
+{
+	LARGE_INTEGER freq;
+	SYSTEM_INFO stInfo;
+	BENCH_PARAM stCons;
+	BENCH_PARAM astProd[BENCH_MAX_PRODUCER];
+	HANDLE ahProd[BENCH_MAX_PRODUCER];
+	std::vector<LONGLONG> vLatency;
+
+	::QueryPerformanceFrequency(&freq);
+	::GetSystemInfo(&stInfo);
+	int cores = (0 < stInfo.dwNumberOfProcessors) ? ((int)stInfo.dwNumberOfProcessors) : (1);
+
+	long long msgs = llBytes / nMsgSize / nProducers;
+	if (BENCH_MAX_MSGS < msgs) msgs = BENCH_MAX_MSGS;
+	if (msgs < BENCH_MIN_MSGS) msgs = BENCH_MIN_MSGS;
+	if (pcTarget->IsElement() || nProducers == 1) {
+		vLatency.reserve((size_t)msgs * nProducers);
+	}
+
+	HANDLE hStart = ::CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	stCons.pcTarget = pcTarget;
+	stCons.hStart = hStart;
+	stCons.nMsgSize = nMsgSize;
+	stCons.nMsgs = (int)msgs;
+	stCons.nProducers = nProducers;
+	stCons.dwAffinity = (bPinned) ? ((DWORD_PTR)1) : (0);
+	stCons.pvLatency = &vLatency;
+	HANDLE hCons = (HANDLE)_beginthreadex(NULL, 0, thread_consumer, &stCons, 0, NULL);
+
+	for (int i = 0; i < nProducers; i++) {
+		astProd[i] = stCons;
+		astProd[i].dwAffinity = (bPinned) ? ((DWORD_PTR)1 << ((i + 1) % cores)) : (0);
+		astProd[i].pvLatency = NULL;
+		ahProd[i] = (HANDLE)_beginthreadex(NULL, 0, thread_producer, &astProd[i], 0, NULL);
+	}
+
+	// SXbh̏(RAŒ)҂ĂJn
+	::Sleep(50);
+	LONGLONG start = qpc_now();
+	::SetEvent(hStart);
+
+	::WaitForSingleObject(hCons, INFINITE);
+	LONGLONG end = qpc_now();
+	::WaitForMultipleObjects(nProducers, ahProd, TRUE, INFINITE);
+
+	for (int i = 0; i < nProducers; i++) {
+		::CloseHandle(ahProd[i]);
+	}
+	::CloseHandle(hCons);
+	::CloseHandle(hStart);
+
+	double sec = (double)(end - start) / (double)freq.QuadPart;
+	double bytes = (double)nMsgSize * (double)msgs * (double)nProducers;
+
+	printf("%-22s,%6d,%3d,%-3s,%10.1f,%12.0f", pcTarget->Name(), nMsgSize, nProducers, (bPinned) ? ("yes") : ("no")
+		, bytes / (1024.0 * 1024.0) / sec, (double)msgs * nProducers / sec);
+	if (vLatency.empty()) {
+		printf(",%10s,%10s,%10s\r\n", "-", "-", "-");
+	}
+	else {
+		std::sort(vLatency.begin(), vLatency.end());
+		printf(",%10.0f,%10.0f,%10.0f\r\n"
+			, percentile(vLatency, 0.50, freq.QuadPart)
+			, percentile(vLatency, 0.99, freq.QuadPart)
+			, percentile(vLatency, 0.999, freq.QuadPart));
+	}
+}
+
+
+/**
+ * @fn		create_target
+ * @brief	vΏۂ𐶐
+ * @param	[IN]	nIndex	: vΏ۔ԍ
+ * @return	vΏ(NULL:ԍ̏I[)
+ */
+CBenchTarget* create_target(int nIndex)
+{
+	switch (nIndex) {
+	case 0:	return new CBenchRing(CByteRingBuffer::RING_MODE_LOCK);
+	case 1:	return new CBenchRing(CByteRingBuffer::RING_MODE_SPSC);
+	case 2:	return new CBenchCQueue();
+#ifdef C_QUEUE_NAME
+	case 3:	return new CBenchCQueueC();
+#else
+	case 3:	return create_target(4);
+#endif
+	case 4:	return new CBenchElement<CMessageQueue<BENCH_MSG, BENCH_ELEMENT_COUNT> >(new CMessageQueue<BENCH_MSG, BENCH_ELEMENT_COUNT>(), "CMessageQueue");
+	case 5:	return new CBenchElement<CMpmcQueue<BENCH_MSG> >(new CMpmcQueue<BENCH_MSG>(BENCH_ELEMENT_COUNT), "CMpmcQueue");
+	default:
+		return NULL;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	static const int anMsgSize[] = { 1, 8, 64, 512, 4096, 65536 };
+	int max_producers = 4;
+	long long bytes = 64LL * 1024 * 1024;
+
+	if (1 < argc) max_producers = atoi(argv[1]);
+	if (2 < argc) bytes = _atoi64(argv[2]) * 1024 * 1024;
+	if (max_producers < 1) max_producers = 1;
+	if (BENCH_MAX_PRODUCER < max_producers) max_producers = BENCH_MAX_PRODUCER;
+
+	printf("%-22s,%6s,%3s,%-3s,%10s,%12s,%10s,%10s,%10s\r\n"
+		, "target", "size", "prd", "pin", "MB/s", "msg/s", "p50(ns)", "p99(ns)", "p999(ns)");
+
+	for (int t = 0; ; t++) {
+		CBenchTarget* pcProbe = create_target(t);
+		if (pcProbe == NULL) {
+			break;
+		}
+		BOOL bMulti = pcProbe->IsMultiProducer();
+		BOOL bElement = pcProbe->IsElement();
+		delete pcProbe;
+		if (t == 3 && bElement) {
+			// C ŃL[I
+			continue;
+		}
+
+		for (int s = 0; s < (int)COUNT_OF_ARRAY(anMsgSize); s++) {
+			if (bElement && BENCH_MSG_MAX < anMsgSize[s]) {
+				continue;
+			}
+			for (int p = 1; p <= max_producers; p <<= 1) {
+				if (!bMulti && 1 < p) {
+					break;
+				}
+				for (int pin = 1; 0 <= pin; pin--) {
+					// ɐAȌ̏ԂzȂ
+					CBenchTarget* pcTarget = create_target(t);
+					run_bench(pcTarget, anMsgSize[s], p, pin, bytes);
+					delete pcTarget;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file	ring_core.h
+ * @brief	Oobt@ʃRs[
+ * @author	?
+ * @date	?
+ * @remarks
+ *		eOobt@/L[(CByteRingBuffer, CQueue, ring_buffer.h, simple_queue.h, simple_queue2.h)
+ *		f[^Rs[ʉ̂łB
+ *		obt@̐܂ԂʒuŕAő2 memcpy ŃRs[܂B
+ *		obt@TCYEʒuEf[^̐(󂫗e/f[^𒴂Ȃ)͌Ăяoŕۏ؂ĂB
+ */
+#pragma once
+
+#include <string.h>
+#include <type_traits>
+
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE		(64)		//!< LbVCTCY(ULh~̃pfBOP)
+#endif
+
+
+/**
+ * @fn			ring_count
+ * @brief		vƏlۂɏf[^߂
+ * @param[in]	int nReq		: vf[^
+ * @param[in]	int nAvail		: \ȃf[^(󂫗e or i[f[^)
+ * @return		0`nAvail:f[^
+ */
+inline int ring_count(int nReq, int nAvail)
+{
+	if (nReq <= 0 || nAvail <= 0) {
+		return 0;
+	}
+	return (nReq < nAvail) ? (nReq) : (nAvail);
+}
+
+
+/**
+ * @fn				ring_write
+ * @brief			Oobt@̎wʒuփf[^
+ * @param[in,out]	T* pBuff			: obt@̈
+ * @param[in]		int nBuffSize		: obt@TCY(vf)
+ * @param[in]		int nPos			: ݊Jnʒu(0`nBuffSize-1)
+ * @param[in]		const T* pSrc		: ރf[^
+ * @param[in]		int nLen			: ރf[^(󂫗eʈȉ)
+ */
+template <typename T>
+inline void ring_write(T* pBuff, int nBuffSize, int nPos, const T* pSrc, int nLen)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "ring_write requires trivially copyable type");
+
+	int first = nBuffSize - nPos;
+	if (nLen < first) {
+		first = nLen;
+	}
+	memcpy(pBuff + nPos, pSrc, sizeof(T) * first);
+	if (first < nLen) {
+		// ܂Ԃobt@擪
+		memcpy(pBuff, pSrc + first, sizeof(T) * (nLen - first));
+	}
+}
+
+
+/**
+ * @fn				ring_read
+ * @brief			Oobt@̎wʒuf[^ǂݏo
+ * @param[in]		const T* pBuff		: obt@̈
+ * @param[in]		int nBuffSize		: obt@TCY(vf)
+ * @param[in]		int nPos			: ǏoJnʒu(0`nBuffSize-1)
+ * @param[out]		T* pDest			: ǂݏof[^̊i[
+ * @param[in]		int nLen			: ǂݏof[^(i[f[^ȉ)
+ */
+template <typename T>
+inline void ring_read(const T* pBuff, int nBuffSize, int nPos, T* pDest, int nLen)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "ring_read requires trivially copyable type");
+
+	int first = nBuffSize - nPos;
+	if (nLen < first) {
+		first = nLen;
+	}
+	memcpy(pDest, pBuff + nPos, sizeof(T) * first);
+	if (first < nLen) {
+		// ܂Ԃobt@擪
+		memcpy(pDest + first, pBuff, sizeof(T) * (nLen - first));
+	}
+}
+
+
+/**
+ * @fn				ring_erase
+ * @brief			Ǐoςݗ̈[NA(fobOrĥ)
+ * @param[in,out]	T* pBuff			: obt@̈
+ * @param[in]		int nBuffSize		: obt@TCY(vf)
+ * @param[in]		int nPos			: NAJnʒu(0`nBuffSize-1)
+ * @param[in]		int nLen			: NAf[^
+ * @remarks			[Xrhł͉܂(Ǐoςݗ͎݂̈̏ŏ㏑邽)
+ */
+template <typename T>
+inline void ring_erase(T* pBuff, int nBuffSize, int nPos, int nLen)
+{
+#if _DEBUG
+	int first = nBuffSize - nPos;
+	if (nLen < first) {
+		first = nLen;
+	}
+	memset(pBuff + nPos, 0, sizeof(T) * first);
+	if (first < nLen) {
+		memset(pBuff, 0, sizeof(T) * (nLen - first));
+	}
+#else
+	(void)pBuff; (void)nBuffSize; (void)nPos; (void)nLen;
+#endif
+}
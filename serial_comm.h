@@ -8,8 +8,35 @@
 #define RX_BUFF		(1024)		// Mobt@TCY
 #define TX_BUFF		(1024)		// Mobt@TCY
 
+#define SERIAL_QUEUE_MAX		(65536)		// SetupComm Ɏw肷L[TCY̏
+#define SERIAL_FIRST_TIMEOUT	(500)		// ŏ1oCg҂(ms)
+#define SERIAL_WRITE_TIMEOUT	(500)		// Mg[^Ԃ̌Œ蕪(ms)
 
+
+// ʐMvt@C(open_serial_ex)
+enum SERIAL_PROFILE {
+	SERIAL_PROFILE_BALANCED = 0,		// Bt[̖ʐM(3.5)ŎM
+	SERIAL_PROFILE_LOW_LATENCY,			// Mς݂̃f[^𑦎ɕԂBEV_RXCHAR ŎM҂(serial_wait_recv)
+	SERIAL_PROFILE_BULK,				// X[vbgDB傫ȎMPʂƃhCoL[
+};
+
+// ʐMݒ(serial_make_config ō쐬AKvȂ獀ڂύX open_serial_ex ɓn)
+struct SERIAL_CONFIG {
+	SERIAL_PROFILE	enProfile;			// 쐬̃vt@C
+	DWORD			dwInQueue;			// SetupComm ̎ML[TCY
+	DWORD			dwOutQueue;			// SetupComm ̑ML[TCY
+	DWORD			dwEventMask;		// SetCommMask ɐݒ肷Cxg(0:ݒ肵Ȃ)
+	int				nReadSize;			// ReadFile 1񂠂̎MTCY(Oobt@eʂZo)
+	COMMTIMEOUTS	stTimeouts;			// ^CAEg
+};
+
+
+void serial_make_config(SERIAL_CONFIG* pstConfig, SERIAL_PROFILE enProfile, int nBaud, int nRingSize);
+HANDLE open_serial_ex(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, BOOL bOverlapped, const SERIAL_CONFIG* pstConfig, const char* szLogName);
+int serial_wait_recv(HANDLE hComm, OVERLAPPED* pstOv, unsigned char* puchBuff, int nLength, DWORD dwTimeout);
+static DWORD _serial_queue_size(int nBaud, int nMsec, DWORD dwMin);
 HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName);
+HANDLE open_serial_async(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName);
 static void SetDCB(DCB* pDCB);
 int close_serial(HANDLE hComm, const char* szLogName);
 int clear_serial(HANDLE hComm);
@@ -21,8 +48,98 @@ static void _com_log_output(const char* szLogName, const char* szFunc, const cha
 
 
 HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName)
+{
+	SERIAL_CONFIG stConfig;
+	serial_make_config(&stConfig, SERIAL_PROFILE_BALANCED, nBaud, RX_BUFF);
+	return open_serial_ex(szPort, nBaud, nDataBit, nParity, nStopBit, FALSE, &stConfig, szLogName);
+}
+
+
+HANDLE open_serial_async(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, const char* szLogName)
+{
+	SERIAL_CONFIG stConfig;
+	serial_make_config(&stConfig, SERIAL_PROFILE_BALANCED, nBaud, RX_BUFF);
+	return open_serial_ex(szPort, nBaud, nDataBit, nParity, nStopBit, TRUE, &stConfig, szLogName);
+}
+
+
+// vt@CʐMݒ쐬
+// nRingSize : Mf[^ރOobt@̗e(nReadSize ̎ZoɎgp)
+void serial_make_config(SERIAL_CONFIG* pstConfig, SERIAL_PROFILE enProfile, int nBaud, int nRingSize)
+{
+	if (pstConfig == NULL) {
+		return;
+	}
+	if (nBaud <= 0) {
+		nBaud = CBR_9600;
+	}
+	if (nRingSize <= 0) {
+		nRingSize = RX_BUFF;
+	}
+	memset(pstConfig, 0, sizeof(SERIAL_CONFIG));
+	pstConfig->enProfile = enProfile;
+
+	// 1(X^[g+f[^8+Xgbv = 10rbg)̎Ԃ 10000 / nBaud (ms)
+	COMMTIMEOUTS* pstCTO = &pstConfig->stTimeouts;
+	switch (enProfile) {
+	case SERIAL_PROFILE_LOW_LATENCY:
+		// ReadIntervalTimeout = MAXDWORD, ReadTotal = 0 : Mς݂̃f[^𑦎ɕԂ(0oCg)
+		// ǂ݂JԂȂ悤AEV_RXCHAR ҂Ăǂ(serial_wait_recv)
+		pstConfig->dwInQueue = RX_BUFF;
+		pstConfig->dwOutQueue = TX_BUFF;
+		pstConfig->dwEventMask = EV_RXCHAR;
+		pstConfig->nReadSize = nRingSize / 4;
+		pstCTO->ReadIntervalTimeout = MAXDWORD;
+		pstCTO->ReadTotalTimeoutMultiplier = 0;
+		pstCTO->ReadTotalTimeoutConstant = 0;
+		break;
+	case SERIAL_PROFILE_BULK:
+		// hCoL[ 200ms AMPʂ̓Oobt@̔
+		// MC^[o10(ŏ10ms)ƂAAM͑傫ȒPʂŊ
+		pstConfig->dwInQueue = _serial_queue_size(nBaud, 200, 4096);
+		pstConfig->dwOutQueue = _serial_queue_size(nBaud, 200, 4096);
+		pstConfig->nReadSize = nRingSize / 2;
+		pstCTO->ReadIntervalTimeout = (100000 / nBaud + 1 < 10) ? (10) : (100000 / nBaud + 1);
+		pstCTO->ReadTotalTimeoutMultiplier = 0;
+		pstCTO->ReadTotalTimeoutConstant = SERIAL_FIRST_TIMEOUT;
+		break;
+	case SERIAL_PROFILE_BALANCED:
+	default:
+		// hCoL[ 50ms AMPʂ̓Oobt@1/4
+		// MC^[o3.5(ŏ2ms)ƂAt[̎MシɊ
+		pstConfig->dwInQueue = _serial_queue_size(nBaud, 50, RX_BUFF);
+		pstConfig->dwOutQueue = _serial_queue_size(nBaud, 50, TX_BUFF);
+		pstConfig->nReadSize = nRingSize / 4;
+		pstCTO->ReadIntervalTimeout = (35000 / nBaud + 1 < 2) ? (2) : (35000 / nBaud + 1);
+		pstCTO->ReadTotalTimeoutMultiplier = 0;
+		pstCTO->ReadTotalTimeoutConstant = SERIAL_FIRST_TIMEOUT;
+		break;
+	}
+	if (pstConfig->nReadSize < 1) {
+		pstConfig->nReadSize = 1;
+	}
+	if ((int)pstConfig->dwInQueue < pstConfig->nReadSize) {
+		pstConfig->nReadSize = (int)pstConfig->dwInQueue;
+	}
+
+	// M1oCg̑MԂ^CAEgɉ
+	pstCTO->WriteTotalTimeoutMultiplier = 10000 / nBaud + 1;
+	pstCTO->WriteTotalTimeoutConstant = SERIAL_WRITE_TIMEOUT;
+}
+
+
+// ʐMݒw肵COM|[gJ
+// bOverlapped : TRUE:FILE_FLAG_OVERLAPPED ŊJ
+// pstConfig   : ʐMݒ(NULL:SERIAL_PROFILE_BALANCED)
+HANDLE open_serial_ex(const char* szPort, int nBaud, int nDataBit, int nParity, int nStopBit, BOOL bOverlapped, const SERIAL_CONFIG* pstConfig, const char* szLogName)
 {
 	HANDLE hComm;
+	SERIAL_CONFIG stConfig;
+
+	if (pstConfig == NULL) {
+		serial_make_config(&stConfig, SERIAL_PROFILE_BALANCED, nBaud, RX_BUFF);
+		pstConfig = &stConfig;
+	}
 
 	// COM|[gnh擾
 	hComm = CreateFile(szPort
@@ -30,7 +147,7 @@ HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int
 		, 0
 		, NULL
 		, OPEN_EXISTING
-		, FILE_ATTRIBUTE_NORMAL
+		, (bOverlapped) ? (FILE_FLAG_OVERLAPPED) : (FILE_ATTRIBUTE_NORMAL)
 		, NULL);
 
 	if (hComm == INVALID_HANDLE_VALUE) {
@@ -38,8 +155,8 @@ HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int
 		return NULL;
 	}
 
-	// Mobt@
-	if (!SetupComm(hComm, RX_BUFF, TX_BUFF)) {
+	// Mobt@(hCõL[TCY)
+	if (!SetupComm(hComm, pstConfig->dwInQueue, pstConfig->dwOutQueue)) {
 		_com_log_output(szLogName, __FUNCTION__, "SetupComm failed");
 		CloseHandle(hComm);
 		return NULL;
@@ -59,7 +176,7 @@ HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int
 		CloseHandle(hComm);
 		return NULL;
 	}
-	
+
 	stDCB.BaudRate = nBaud;			// CBR_9600;
 	stDCB.ByteSize = nDataBit;		// 8;
 	stDCB.fParity = nParity;		// NOPARITY, ODDPARITY, EVENPARITY
@@ -72,27 +189,17 @@ HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int
 	}
 
 	// ^CAEgԂ̐ݒ
-	COMMTIMEOUTS stCTO;
-	//if (!GetCommTimeouts(hComm, &stCommTO)) {
-	//	CloseHandle(hComm);
-	//	return NULL;
-	//}
-
 	// MC^[o
 	// ReadIntervalTimeoutɐݒ肷
 	// ReadFile֐1Mۂɂ͌ʂȂ
 	// [ɐݒuƁAMC^[oԂ͎gȂ
-	stCTO.ReadIntervalTimeout = 500;
 	// Mg[^
 	// ReadTotalTimeoutMultiplier * (MoCg)+ReadTotalTimeoutConstant
 	// ReadTotalTimeoutMultiplier  ReadTotalTimeoutConstant [̂ƂAMg[^Ԃ͎gȂ
-	stCTO.ReadTotalTimeoutMultiplier = 0;
-	stCTO.ReadTotalTimeoutConstant = 500;
 	// Mg[^
 	// WriteTotalTimeoutMultiplier * (MoCg)+WriteTotalTimeoutConstant
 	// WriteTotalTimeoutMultiplier  WriteTotalTimeoutConstant [̂ƂAMg[^Ԃ͎gȂ
-	stCTO.WriteTotalTimeoutMultiplier = 0;
-	stCTO.WriteTotalTimeoutConstant = 500;
+	COMMTIMEOUTS stCTO = pstConfig->stTimeouts;
 
 	if (!SetCommTimeouts(hComm, &stCTO)) {
 		_com_log_output(szLogName, __FUNCTION__, "SetCommTimeouts failed");
@@ -100,10 +207,98 @@ HANDLE open_serial(const char* szPort, int nBaud, int nDataBit, int nParity, int
 		return NULL;
 	}
 
+	// MCxg̐ݒ(SERIAL_PROFILE_LOW_LATENCY  EV_RXCHAR )
+	if (pstConfig->dwEventMask != 0 && !SetCommMask(hComm, pstConfig->dwEventMask)) {
+		_com_log_output(szLogName, __FUNCTION__, "SetCommMask failed");
+		CloseHandle(hComm);
+		return NULL;
+	}
 
 	return hComm;
 }
 
+
+// Mf[^͂܂ő҂AMς݂̃f[^ǂݏo(SERIAL_PROFILE_LOW_LATENCY p)
+// pstOv     : FILE_FLAG_OVERLAPPED ŊJnh̏ꍇɎgp OVERLAPPED(hEvent ͎蓮Zbg̃Cxg)
+//             NULL ̏ꍇ͓nhƂĈAdwTimeout ͎gpȂ(M܂Ŗ߂Ȃ)
+// ߂l    : 0`:MoCg(0:^CAEg), -1:s
+// EV_RXCHAR ͓Ǐoς݂̃f[^łcĂ邽߁ANĂf[^ꍇ͎c莞Ԃő҂
+int serial_wait_recv(HANDLE hComm, OVERLAPPED* pstOv, unsigned char* puchBuff, int nLength, DWORD dwTimeout)
+{
+	DWORD dwErrorMask;
+	COMSTAT stComStat;
+	DWORD dwRead = 0;
+
+	if (puchBuff == NULL || nLength <= 0) {
+		return -1;
+	}
+	if (ClearCommError(hComm, &dwErrorMask, &stComStat) == 0) {
+		return -1;
+	}
+
+	DWORD dwStart = GetTickCount();
+	while (stComStat.cbInQue == 0) {
+		DWORD dwWait = INFINITE;
+		if (dwTimeout != INFINITE) {
+			DWORD dwElapsed = GetTickCount() - dwStart;
+			if (dwTimeout <= dwElapsed) {
+				return 0;
+			}
+			dwWait = dwTimeout - dwElapsed;
+		}
+
+		// EV_RXCHAR ҂(Mς݂ȂCxg͑ɕԂ)
+		DWORD dwEvent = 0;
+		if (pstOv != NULL) {
+			ResetEvent(pstOv->hEvent);
+		}
+		if (!WaitCommEvent(hComm, &dwEvent, pstOv)) {
+			if (pstOv == NULL || GetLastError() != ERROR_IO_PENDING) {
+				return -1;
+			}
+			if (WaitForSingleObject(pstOv->hEvent, dwWait) != WAIT_OBJECT_0) {
+				// SetCommMask őҋ@ WaitCommEvent I
+				DWORD dwMask = 0;
+				GetCommMask(hComm, &dwMask);
+				SetCommMask(hComm, dwMask);
+			}
+			DWORD dwDummy;
+			GetOverlappedResult(hComm, pstOv, &dwDummy, TRUE);
+		}
+		if (ClearCommError(hComm, &dwErrorMask, &stComStat) == 0) {
+			return -1;
+		}
+	}
+
+	// Mς݂̃oCgǂނ߁AReadFile ͑҂Ɋ
+	int nRead = ((int)stComStat.cbInQue < nLength) ? ((int)stComStat.cbInQue) : (nLength);
+	if (pstOv != NULL) {
+		ResetEvent(pstOv->hEvent);
+	}
+	if (!ReadFile(hComm, puchBuff, nRead, &dwRead, pstOv)) {
+		if (pstOv == NULL || GetLastError() != ERROR_IO_PENDING) {
+			return -1;
+		}
+		if (!GetOverlappedResult(hComm, pstOv, &dwRead, TRUE)) {
+			return -1;
+		}
+	}
+	return (int)dwRead;
+}
+
+
+// nMsec ̒ʐMf[^L[TCY(2ׂ̂AdwMin`SERIAL_QUEUE_MAX)
+static DWORD _serial_queue_size(int nBaud, int nMsec, DWORD dwMin)
+{
+	DWORD dwBytes = (DWORD)(((LONGLONG)nBaud / 10) * nMsec / 1000);
+	DWORD dwSize = dwMin;
+	while (dwSize < dwBytes && dwSize < SERIAL_QUEUE_MAX) {
+		dwSize <<= 1;
+	}
+	return dwSize;
+}
+
+
 static void SetDCB(DCB* pDCB)
 {
 	pDCB->DCBlength = sizeof(DCB);
@@ -8,22 +8,56 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <io.h>
 #include <windows.h>
+#include <process.h>
 #include <Shlwapi.h>
+#include "MpmcQueue.h"
+#include "time_cache.h"
+#include "log_binary.h"
+#include "Lock.h"
 
 
 #define MAX_LOG_TEXT						(256)
 #define MAX_FILE_SIZE						(1024)		// 1kByteP
 #define MAX_LOG_BACKUP						(3)
+#define MAX_LOG_GENERATION					(9999)		// obNAbvԍ̏(1ɖ߂)
+
+// OIDƂ̔rbN|V[(Lock.hAVOXbhŎgpꍇ CLockNone `)
+#ifndef LOG_LOCK_POLICY
+#define LOG_LOCK_POLICY						CLockCS<>
+#endif
+
+// 񓯊o̓[h
+#define LOG_ASYNC_QUEUE_SIZE				(1024)		// OR[hL[̗vf
+#define LOG_ASYNC_BATCH_SIZE				(64 * 1024)	// ݃Xbĥ܂Ƃߏobt@TCY
+#define LOG_ASYNC_FLUSH_BYTES				(32 * 1024)	// ؗ̃TCYȏŃt@C֏
+#define LOG_ASYNC_FLUSH_INTERVAL			(100)		// ؗꍇɃt@C֏ގ(ms)
+
+// o͂郍Ox̏(1:ERR ` 4:DBG, 0:Sďo͂Ȃ)
+// ڍׂȃx̃Oo̓}N͒萔ƂȂA̕]܂߂ăRpCɏ
+#ifndef LOG_ACTIVE_LEVEL
+#define LOG_ACTIVE_LEVEL					(4)
+#endif
 
 #define LOG_START(inf, path)				log_start(inf, path)
+#define LOG_START_ASYNC(inf, path)			log_start_async(inf, path, LOG_ASYNC_QUEUE_SIZE)
 #define LOG_END(inf)						log_end(inf)
-#define LOG_WRITE(inf, level, fmt, ...)		log_write(inf, level, fmt, __VA_ARGS__)
-#define LOG_DEBUG(inf, level, fmt, ...)		log_debug(inf, level, __FILE__, __LINE__, __FUNCTION__, fmt, __VA_ARGS__)
+#define LOG_SET_LEVEL(inf, level)			log_set_level(inf, level)
+// Ox̔(RpC̏As̃x̏)
+// NULLEJñO͏o͊֐̃`FbNŃG[(-1)Ƃ邽߁Ao͂鑤ɔ肷
+#define LOG_ENABLED(inf, level)				((level) <= LOG_ACTIVE_LEVEL && ((inf) == NULL || (inf)->bUsed == FALSE || (level) <= (inf)->enActiveLevel))
+// o͂Ȃx̏ꍇ͈(mem_dump )]Ȃ
+#define LOG_WRITE(inf, level, fmt, ...)		(LOG_ENABLED(inf, level) ? log_write(inf, level, fmt, __VA_ARGS__) : 0)
+#define LOG_DEBUG(inf, level, fmt, ...)		(LOG_ENABLED(inf, level) ? log_debug(inf, level, __FILE__, __LINE__, __FUNCTION__, fmt, __VA_ARGS__) : 0)
+// oCi`O(ID͌ďoӏɏ̂ݓo^)
+#define LOG_START_BINARY(inf, path)			log_start_binary(inf, path)
+#define LOG_BINARY(inf, level, dump, data, len, fmt, ...) \
+	do { if (LOG_ENABLED(inf, level)) { static volatile LONG s_lFmtId = 0; log_binary(inf, level, &s_lFmtId, dump, data, len, fmt, __VA_ARGS__); } } while (0)
 
 
 /**
@@ -38,37 +72,71 @@ typedef enum {
 } LOG_LEVEL;
 
 
+/*
+ * @struct	_LOG_RECORD
+ * @brief	񓯊o͗pOR[h(ďoŖ{܂ō쐬A݃Xbh1sɐ`)
+ */
+typedef struct _LOG_RECORD {
+	SYSTEMTIME			stTime;						//! o͎
+	LOG_LEVEL			enLevel;					//! Ox
+	char				szText[MAX_LOG_TEXT * 2];	//! O{
+} LOG_RECORD;
+
+
 /*
  * @struct	_LOG_INFO
  * @brief	O
  */
 typedef struct _LOG_INFO {
-	CRITICAL_SECTION	stCS;						//! OIDƂ̔rIuWFNg
+	LOG_LOCK_POLICY		cLock;						//! OIDƂ̔rIuWFNg
 	char				szLogPath[MAX_PATH + 1];	//! Ot@CpX
 	BOOL				bUsed;						//! OIDgp
+	LOG_LEVEL			enActiveLevel;				//! o͂郍Ox̏(ڍׂȃx͏o͂Ȃ)
 	// OobNAbv
-	int					nFileSize;					//! Ot@CTCY
+	int					nFileSize;					//! Ot@CTCY(1kByteP)
 	int					nLogBackup;					//! t@CobNAbv
+	int					nGeneration;				//! ŐṼobNAbvԍ
+	LONGLONG			llWritten;					//! ݂̃Ot@C̃TCY(݃oCg)
 	char				szDir[MAX_PATH + 1];		//! hCuAfBNg
 	char				szFname[MAX_PATH + 1];		//! t@Cigqj
 	char				szFext[MAX_PATH + 1];		//! gq
+	// 񓯊o͏
+	BOOL				bAsync;						//! 񓯊o̓[h
+	CMpmcQueue<LOG_RECORD>*	pcQueue;				//! OR[hL[
+	HANDLE				hWriter;					//! ݃Xbh
+	HANDLE				hWakeEvent;					//! ݃XbhNCxg
+	volatile LONG		lStop;						//! ݃XbhIv
+	volatile LONG		lDropped;					//! L[tŔjO
+	// oCi`o͏
+	BOOL				bBinary;					//! oCi`o̓[h
+	LOG_BINARY			stBinary;					//! oCiOt@C
 } LOG_INFO;
 
 
 int					log_start(LOG_INFO* pstLog, const char* szPath);
+int					log_start_async(LOG_INFO* pstLog, const char* szPath, int nQueueSize);
+int					log_start_binary(LOG_INFO* pstLog, const char* szPath);
 int					log_end(LOG_INFO* pstLog);
+int					log_set_level(LOG_INFO* pstLog, LOG_LEVEL enLevel);
 int					log_write(LOG_INFO* pstLog, LOG_LEVEL enLevel, const char* szFmt, ...);
 int					log_debug(LOG_INFO* pstLog, LOG_LEVEL enLevel, const char* szFile, int nLine, const char* szFunc, const char* szFmt, ...);
+int					log_binary(LOG_INFO* pstLog, LOG_LEVEL enLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, ...);
+static int			_log_binary(LOG_INFO* pstLog, LOG_LEVEL enLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, va_list arg);
+static int			_log_binary_text(LOG_INFO* pstLog, LOG_LEVEL enLevel, volatile LONG* plFmtId, const char* szFmt, ...);
 static const char*	_log_level(LOG_LEVEL enLevel);
+static int			_log_format_line(char* szBuff, int nSize, const char* szTime, LOG_LEVEL enLevel, const char* szText);
+static int			_log_enqueue(LOG_INFO* pstLog, LOG_RECORD* pstRec);
+static int			_log_flush_batch(LOG_INFO* pstLog, FILE** ppFile, const char* pszBatch, int nLen);
+static unsigned __stdcall _log_writer_thread(PVOID pParam);
 static const char*	_get_fname_from_path(const char* szPath, char* szBuff, int nSize);
 static void			_log_lock_init(LOG_INFO* pstLog);
 static void			_log_lock_delete(LOG_INFO* pstLog);
-static void			_log_lock(LOG_INFO* pstLog);
-static void			_log_unlock(LOG_INFO* pstLog);
 static int			_copy_filepath(LOG_INFO* pstLog, const char* szPath);
 static int			_get_backupname(LOG_INFO* pstLog, int nBkNo, char* szBuff, int nSize);
 static int			_backup_file(LOG_INFO* pstLog);
-static long			_get_filesize(const char* szPath);
+static int			_get_generation(LOG_INFO* pstLog);
+static int			_wrap_generation(int nGen);
+static LONGLONG		_get_filesize(const char* szPath);
 
 
 /**
@@ -92,14 +160,92 @@ int log_start(LOG_INFO* pstLog, const char* szPath)
 	memset(pstLog->szFname, 0, sizeof(pstLog->szFname));
 	memset(pstLog->szFext, 0, sizeof(pstLog->szFext));
 	pstLog->bUsed = TRUE;
+	pstLog->enActiveLevel = (LOG_LEVEL)LOG_ACTIVE_LEVEL;
 	pstLog->nFileSize = MAX_FILE_SIZE;
 	pstLog->nLogBackup = MAX_LOG_BACKUP;
+	pstLog->bAsync = FALSE;
+	pstLog->pcQueue = NULL;
+	pstLog->hWriter = NULL;
+	pstLog->hWakeEvent = NULL;
+	pstLog->lStop = 0;
+	pstLog->lDropped = 0;
+	pstLog->bBinary = FALSE;
+	pstLog->stBinary.fp = NULL;
 
 	_log_lock_init(pstLog);
 
 	// Ot@CɃobNAbvԍt^
 	_copy_filepath(pstLog, szPath);
 
+	// Ȍ̃t@CTCY͏݃oCgŊǗ(ݖɃt@CTCY𒲂ׂȂ)
+	pstLog->nGeneration = _get_generation(pstLog);
+	pstLog->llWritten = _get_filesize(pstLog->szLogPath);
+	if (pstLog->llWritten < 0) {
+		pstLog->llWritten = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * @fn		log_start_async
+ * @brief	񓯊[hŃOo͂Jn
+ * @param	[in]	LOG_INFO* pstLog		: O
+ * @param	[in]	const char* szPath		: Ot@CpX
+ * @param	[in]	int nQueueSize			: OR[hL[̗vf
+ * @return	0:, -1:s
+ * @remarks
+ *		log_write/log_debug ͖{쐬ăL[ɒǉ݂̂Ŗ߂A
+ *		t@Cւ݂̏͏݃Xbh܂Ƃ߂čs܂(t@C͊J܂)B
+ *		݂͂܂Ƃߏobt@ LOG_ASYNC_FLUSH_BYTES 𒴂A
+ *		܂ LOG_ASYNC_FLUSH_INTERVAL ɍs܂BERR x̃O͑ɏ݃XbhN܂B
+ *		L[t̏ꍇÃO͔jAjŃOɏo͂܂B
+ */
+int log_start_async(LOG_INFO* pstLog, const char* szPath, int nQueueSize)
+{
+	if (log_start(pstLog, szPath) != 0) {
+		return -1;
+	}
+
+	pstLog->pcQueue = new CMpmcQueue<LOG_RECORD>(nQueueSize);
+	pstLog->hWakeEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (pstLog->pcQueue == NULL || pstLog->pcQueue->GetCapacity() <= 0 || pstLog->hWakeEvent == NULL) {
+		log_end(pstLog);
+		return -1;
+	}
+	pstLog->hWriter = (HANDLE)_beginthreadex(NULL, 0, _log_writer_thread, pstLog, 0, NULL);
+	if (pstLog->hWriter == NULL) {
+		log_end(pstLog);
+		return -1;
+	}
+	pstLog->bAsync = TRUE;
+
+	return 0;
+}
+
+/**
+ * @fn		log_start_binary
+ * @brief	oCi`ŃOo͂Jn
+ * @param	[in]	LOG_INFO* pstLog		: O
+ * @param	[in]	const char* szPath		: Ot@CpX
+ * @return	0:, -1:s
+ * @remarks
+ *		log_binary ŏIDE̐f[^EQPClEyC[hL^܂(log_binary.h)B
+ *		log_write/log_debug eLXg𕶎Ƃēt@CɋL^܂B
+ *		eLXgւ̕ϊ log_decode c[ōs܂Bt@CTCYɂobNAbv̓eLXg`ƓłB
+ */
+int log_start_binary(LOG_INFO* pstLog, const char* szPath)
+{
+	if (log_start(pstLog, szPath) != 0) {
+		return -1;
+	}
+	if (log_bin_open(&pstLog->stBinary, pstLog->szLogPath) != 0) {
+		log_end(pstLog);
+		return -1;
+	}
+	pstLog->llWritten = pstLog->stBinary.llWritten;
+	pstLog->bBinary = TRUE;
+
 	return 0;
 }
 
@@ -108,6 +254,9 @@ int log_start(LOG_INFO* pstLog, const char* szPath)
  * @brief	Oo͂I
  * @param	[in]	LOG_INFO* pstLog		: O
  * @return	0:, -1:s
+ * @remarks
+ *		񓯊[h̏ꍇAL[ɎcĂ郍OSďłI܂B
+ *		Xbh̃Oo͂IɌĂłB
  */
 int log_end(LOG_INFO* pstLog)
 {
@@ -117,11 +266,55 @@ int log_end(LOG_INFO* pstLog)
 #endif
 		return -1;
 	}
+	if (pstLog->hWriter != NULL) {
+		// ݃XbhɏIvAL[̏݊҂
+		::InterlockedExchange(&pstLog->lStop, 1);
+		::SetEvent(pstLog->hWakeEvent);
+		::WaitForSingleObject(pstLog->hWriter, INFINITE);
+		::CloseHandle(pstLog->hWriter);
+		pstLog->hWriter = NULL;
+	}
+	if (pstLog->hWakeEvent != NULL) {
+		::CloseHandle(pstLog->hWakeEvent);
+		pstLog->hWakeEvent = NULL;
+	}
+	delete pstLog->pcQueue;
+	pstLog->pcQueue = NULL;
+	pstLog->bAsync = FALSE;
+	if (pstLog->bBinary) {
+		{
+			CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+			log_bin_close(&pstLog->stBinary);
+		}
+		pstLog->bBinary = FALSE;
+	}
 	_log_lock_delete(pstLog);
 	pstLog->bUsed = FALSE;
 	return 0;
 }
 
+/**
+ * @fn		log_set_level
+ * @brief	o͂郍Ox̏ݒ肷
+ * @param	[in]	LOG_INFO* pstLog		: O
+ * @param	[in]	LOG_LEVEL enLevel		: Ox(ڍׂȃx̃O͏o͂Ȃ)
+ * @return	0:, -1:s
+ * @remarks
+ *		LOG_ACTIVE_LEVEL(RpC̏)ڍׂȃx͐ݒ肵Ăo͂܂B
+ *		x̎QƂ͔rȂ߁Ao͒̑Xbhɂ͎̃Oo͂甽f܂B
+ */
+int log_set_level(LOG_INFO* pstLog, LOG_LEVEL enLevel)
+{
+	if (pstLog == NULL || pstLog->bUsed == FALSE) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+	pstLog->enActiveLevel = enLevel;
+	return 0;
+}
+
 /**
  * @fn		log_write
  * @brief	Oo
@@ -139,11 +332,37 @@ int log_write(LOG_INFO* pstLog, LOG_LEVEL enLevel, const char* szFmt, ...)
 #endif
 		return -1;
 	}
+	if (!LOG_ENABLED(pstLog, enLevel)) {
+		// ̓WJOɔ
+		return 0;
+	}
 
 	char szBuff0[MAX_LOG_TEXT];
 	char szBuff1[MAX_LOG_TEXT * 2];
 
-	_log_lock(pstLog);
+	if (pstLog->bAsync) {
+		// ďoXbh̃X^bNŖ{쐬AL[ɒǉ̂
+		// (o͂Ɠ MAX_LOG_TEXT Ő؂l߂)
+		LOG_RECORD stRec;
+		va_list arg;
+		va_start(arg, szFmt);
+		vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
+		va_end(arg);
+		snprintf(stRec.szText, sizeof(stRec.szText), "%s", szBuff0);
+		stRec.enLevel = enLevel;
+		return _log_enqueue(pstLog, &stRec);
+	}
+	if (pstLog->bBinary) {
+		// `ς݂̃eLXg𕶎ƂċL^
+		static volatile LONG s_lFmtId = 0;
+		va_list arg;
+		va_start(arg, szFmt);
+		vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
+		va_end(arg);
+		return _log_binary_text(pstLog, enLevel, &s_lFmtId, "%s", szBuff0);
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
 	_backup_file(pstLog);
 
 	va_list arg;
@@ -158,28 +377,16 @@ int log_write(LOG_INFO* pstLog, LOG_LEVEL enLevel, const char* szFmt, ...)
 		return -1;
 	}
 
-	SYSTEMTIME stTime;
-	::GetLocalTime((LPSYSTEMTIME)&stTime);
-	snprintf(szBuff1, sizeof(szBuff1),
-		"%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, " \
-		"%s\r\n"
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
-		, _log_level(enLevel)
-		, szBuff0);
+	char szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
+	_log_format_line(szBuff1, sizeof(szBuff1), szTime, enLevel, szBuff0);
 	fputs(szBuff1, fp);
+	pstLog->llWritten += strlen(szBuff1);
 
 	if (fclose(fp) != 0) {
 		if (errno != 0) perror(NULL);
-		_log_unlock(pstLog);
 		return -1;
 	}
-	_log_unlock(pstLog);
 	return 0;
 }
 
@@ -203,15 +410,48 @@ int log_debug(LOG_INFO* pstLog, LOG_LEVEL enLevel, const char* szFile, int nLine
 #endif
 		return -1;
 	}
-
-	_log_lock(pstLog);
-	_backup_file(pstLog);
+	if (!LOG_ENABLED(pstLog, enLevel)) {
+		// ̓WJOɔ
+		return 0;
+	}
 
 	char szBuff0[MAX_LOG_TEXT];
 	char szBuff1[MAX_LOG_TEXT * 2];
 	char szFilename[MAX_PATH];
 	memset(szFilename, 0, sizeof(szFilename));
 
+	if (pstLog->bAsync) {
+		// ďoXbh̃X^bNŖ{쐬AL[ɒǉ̂
+		LOG_RECORD stRec;
+		va_list arg;
+		va_start(arg, szFmt);
+		vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
+		va_end(arg);
+		snprintf(stRec.szText, sizeof(stRec.szText), "%s(%d), %s, %s"
+			, _get_fname_from_path(szFile, szFilename, sizeof(szFilename))
+			, nLine
+			, szFunc
+			, szBuff0);
+		stRec.enLevel = enLevel;
+		return _log_enqueue(pstLog, &stRec);
+	}
+	if (pstLog->bBinary) {
+		// `ς݂̃eLXg𕶎ƂċL^
+		static volatile LONG s_lFmtId = 0;
+		va_list arg;
+		va_start(arg, szFmt);
+		vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
+		va_end(arg);
+		return _log_binary_text(pstLog, enLevel, &s_lFmtId, "%s(%d), %s, %s"
+			, _get_fname_from_path(szFile, szFilename, sizeof(szFilename))
+			, nLine
+			, szFunc
+			, szBuff0);
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+	_backup_file(pstLog);
+
 	va_list arg;
 	va_start(arg, szFmt);
 	vsnprintf(szBuff0, sizeof(szBuff0), szFmt, arg);
@@ -224,35 +464,135 @@ int log_debug(LOG_INFO* pstLog, LOG_LEVEL enLevel, const char* szFile, int nLine
 		return -1;
 	}
 
-	SYSTEMTIME stTime;
-	::GetLocalTime((LPSYSTEMTIME)&stTime);
+	char szTime[TIME_CACHE_LEN + 1];
+	time_cache_now(szTime, NULL);
 	snprintf(szBuff1, sizeof(szBuff1),
-		"%04d/%02d/%02d, %02d:%02d:%02d.%03d, %s, " \
+		"%s, %s, " \
 		"%s(%d), %s, " \
 		"%s\r\n"
-		, stTime.wYear
-		, stTime.wMonth
-		, stTime.wDay
-		, stTime.wHour
-		, stTime.wMinute
-		, stTime.wSecond
-		, stTime.wMilliseconds
+		, szTime
 		, _log_level(enLevel)
 		, _get_fname_from_path(szFile, szFilename, sizeof(szFilename))
 		, nLine
 		, szFunc
 		, szBuff0);
 	fputs(szBuff1, fp);
+	pstLog->llWritten += strlen(szBuff1);
 
 	if (fclose(fp) != 0) {
 		if (errno != 0) perror(NULL);
-		_log_unlock(pstLog);
 		return -1;
 	}
-	_log_unlock(pstLog);
 	return 0;
 }
 
+/**
+ * @fn		log_binary
+ * @brief	oCi`Oo(LOG_BINARY }NĂ)
+ * @param	[in]		LOG_INFO* pstLog		: O(log_start_binary ŊJn)
+ * @param	[in]		LOG_LEVEL enLevel		: Ox
+ * @param	[in,out]	volatile LONG* plFmtId	: ďoӏ̏IDێϐ(l0)
+ * @param	[in]		int nDump				: yC[h̃eLXgϊ@(LOG_BIN_DUMP_HEX/LOG_BIN_DUMP_ASCII)
+ * @param	[in]		const void* pPayload	: yC[h(Mf[^ANULL:)
+ * @param	[in]		int nPayload			: yC[h̃TCY
+ * @param	[in]		const char* szFmt		: Oo͏(񃊃e)
+ * @param	[in]		...						: o͏p[^
+ * @return	0:, -1:s
+ * @remarks	fR[h̃eLXǵA𐮌`̌ɃyC[h̃_v܂B
+ */
+int log_binary(LOG_INFO* pstLog, LOG_LEVEL enLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, ...)
+{
+	va_list arg;
+	va_start(arg, szFmt);
+	int ret = _log_binary(pstLog, enLevel, plFmtId, nDump, pPayload, nPayload, szFmt, arg);
+	va_end(arg);
+	return ret;
+}
+
+/**
+ * @fn		_log_binary
+ * @brief	oCi`Oo
+ * @param	[in]		LOG_INFO* pstLog		: O
+ * @param	[in]		LOG_LEVEL enLevel		: Ox
+ * @param	[in,out]	volatile LONG* plFmtId	: ďoӏ̏IDێϐ
+ * @param	[in]		int nDump				: yC[h̃eLXgϊ@
+ * @param	[in]		const void* pPayload	: yC[h
+ * @param	[in]		int nPayload			: yC[h̃TCY
+ * @param	[in]		const char* szFmt		: Oo͏
+ * @param	[in]		va_list arg				: o͏p[^
+ * @return	0:, -1:s
+ */
+static int _log_binary(LOG_INFO* pstLog, LOG_LEVEL enLevel, volatile LONG* plFmtId, int nDump, const void* pPayload, int nPayload, const char* szFmt, va_list arg)
+{
+	if (pstLog == NULL || plFmtId == NULL || szFmt == NULL || pstLog->bUsed == FALSE || pstLog->bBinary == FALSE) {
+#if _DEBUG
+		assert(FALSE);
+#endif
+		return -1;
+	}
+
+	if (!LOG_ENABLED(pstLog, enLevel)) {
+		return 0;
+	}
+
+	int id = log_bin_register(plFmtId, szFmt);
+	if (id < 0) {
+		return -1;
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+	if (pstLog->stBinary.fp == NULL) {
+		// obNAbvɊJȂꍇ͍Ďs
+		if (log_bin_open(&pstLog->stBinary, pstLog->szLogPath) != 0) {
+			return -1;
+		}
+		pstLog->llWritten = pstLog->stBinary.llWritten;
+	}
+
+	int len = log_bin_write(&pstLog->stBinary, enLevel, id, nDump, pPayload, nPayload, arg);
+	if (len < 0) {
+		return -1;
+	}
+	pstLog->llWritten += len;
+	if (enLevel == ERR) {
+		log_bin_flush(&pstLog->stBinary);
+	}
+
+	if ((LONGLONG)pstLog->nFileSize * 1024 <= pstLog->llWritten) {
+		// ĂobNAbvAVt@C(VZbV)J
+		log_bin_close(&pstLog->stBinary);
+		int backup = _backup_file(pstLog);
+		if (log_bin_open(&pstLog->stBinary, pstLog->szLogPath) == 0) {
+			pstLog->llWritten = pstLog->stBinary.llWritten;
+		}
+		if (backup != 0) {
+			// l[łȂ(vZX폜LŊJĂ铙)ꍇA1ɊJȂ悤
+			//  nFileSize ނ܂ŃobNAbvĎsȂ
+			pstLog->llWritten = 0;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @fn		_log_binary_text
+ * @brief	oCi`OɃeLXgL^(log_write/log_debug p)
+ * @param	[in]		LOG_INFO* pstLog		: O
+ * @param	[in]		LOG_LEVEL enLevel		: Ox
+ * @param	[in,out]	volatile LONG* plFmtId	: IDێϐ
+ * @param	[in]		const char* szFmt		: 
+ * @param	[in]		...						: p[^
+ * @return	0:, -1:s
+ */
+static int _log_binary_text(LOG_INFO* pstLog, LOG_LEVEL enLevel, volatile LONG* plFmtId, const char* szFmt, ...)
+{
+	va_list arg;
+	va_start(arg, szFmt);
+	int ret = _log_binary(pstLog, enLevel, plFmtId, LOG_BIN_DUMP_HEX, NULL, 0, szFmt, arg);
+	va_end(arg);
+	return ret;
+}
+
 /**
  * @fn		_log_level
  * @brief	OxɑΉ閼̂擾
@@ -275,6 +615,162 @@ static const char* _log_level(LOG_LEVEL enLevel)
 	}
 }
 
+/**
+ * @fn		_log_format_line
+ * @brief	O1s𐮌`(, x, {)
+ * @param	[out]	char* szBuff				: o͐obt@̈
+ * @param	[in]	int nSize					: obt@̈̃TCY
+ * @param	[in]	const char* szTime			: o͎(time_cache_now/time_cache_format)
+ * @param	[in]	LOG_LEVEL enLevel			: Ox
+ * @param	[in]	const char* szText			: O{
+ * @return	`̕(obt@Ɏ܂Ȃꍇ nSize ȏ)
+ */
+static int _log_format_line(char* szBuff, int nSize, const char* szTime, LOG_LEVEL enLevel, const char* szText)
+{
+	return snprintf(szBuff, nSize,
+		"%s, %s, " \
+		"%s\r\n"
+		, szTime
+		, _log_level(enLevel)
+		, szText);
+}
+
+/**
+ * @fn		_log_enqueue
+ * @brief	OR[hɎt^ăL[ɒǉ(񓯊[h)
+ * @param	[in]	LOG_INFO* pstLog		: O
+ * @param	[in]	LOG_RECORD* pstRec		: OR[h({Axݒς)
+ * @return	0:, -1:s(L[t̂ߔj)
+ * @remarks
+ *		݃Xbh̋N̓L[ȏ㖄܂ ERR x݂̎̂ƂA
+ *		ȊO͏݃Xbh̎ɔC܂(ÕVXeR[邽)B
+ */
+static int _log_enqueue(LOG_INFO* pstLog, LOG_RECORD* pstRec)
+{
+	time_cache_now<char>(NULL, &pstRec->stTime);
+
+	if (pstLog->pcQueue->Enqueue(*pstRec) != 0) {
+		::InterlockedIncrement(&pstLog->lDropped);
+		::SetEvent(pstLog->hWakeEvent);
+		return -1;
+	}
+	if (pstRec->enLevel == ERR || pstLog->pcQueue->GetCapacity() / 2 <= pstLog->pcQueue->GetLength()) {
+		::SetEvent(pstLog->hWakeEvent);
+	}
+	return 0;
+}
+
+/**
+ * @fn		_log_flush_batch
+ * @brief	܂Ƃߏobt@Ot@Cɏ(񓯊[h̏݃Xbh)
+ * @param	[in]		LOG_INFO* pstLog		: O
+ * @param	[in,out]	FILE** ppFile			: Ot@C(I[v̏ꍇ̓I[v)
+ * @param	[in]		const char* pszBatch	: ܂Ƃߏobt@
+ * @param	[in]		int nLen				: ރTCY
+ * @return	0:, -1:s
+ * @remarks
+ *		݌Ƀt@CTCY𒴂ꍇ́At@CăobNAbv܂B
+ *		Ot@CpXE݃oCgEԍ͓o͂ƋL邽߁AÕbN擾ď܂B
+ */
+static int _log_flush_batch(LOG_INFO* pstLog, FILE** ppFile, const char* pszBatch, int nLen)
+{
+	if (nLen <= 0) {
+		return 0;
+	}
+
+	CLockGuard<LOG_LOCK_POLICY> cGuard(pstLog->cLock);
+	if (*ppFile == NULL) {
+		errno = 0;
+		*ppFile = fopen(pstLog->szLogPath, "ab+");
+		if (*ppFile == NULL) {
+			if (errno != 0) perror(NULL);
+			return -1;
+		}
+	}
+
+	fwrite(pszBatch, sizeof(char), nLen, *ppFile);
+	fflush(*ppFile);
+	pstLog->llWritten += nLen;
+
+	if ((LONGLONG)pstLog->nFileSize * 1024 <= pstLog->llWritten) {
+		// J܂܂ł̓l[łȂ߁AĂobNAbv(񏑍ݎɐVK쐬)
+		fclose(*ppFile);
+		*ppFile = NULL;
+		_backup_file(pstLog);
+	}
+
+	return 0;
+}
+
+/**
+ * @fn		_log_writer_thread
+ * @brief	񓯊[h̏݃Xbh
+ * @param	[in]	PVOID pParam		: O(LOG_INFO*)
+ * @return	0
+ * @remarks
+ *		L[̃OR[h𐮌`Ă܂Ƃߏobt@ɗ߁A
+ *		LOG_ASYNC_FLUSH_BYTES ȏ܂ LOG_ASYNC_FLUSH_INTERVAL o߂Ńt@Cɏ݂܂B
+ *		Iv̓L[ɂĂI܂B
+ */
+static unsigned __stdcall _log_writer_thread(PVOID pParam)
+{
+	LOG_INFO* pstLog = (LOG_INFO*)pParam;
+	char* pszBatch = (char*)malloc(LOG_ASYNC_BATCH_SIZE);
+	int nBatch = 0;
+	FILE* fp = NULL;
+	LOG_RECORD stRec;
+	char szTime[TIME_CACHE_LEN + 1];
+	ULONGLONG ullLastFlush = ::GetTickCount64();
+
+	if (pszBatch == NULL) {
+		return 0;
+	}
+
+	while (TRUE) {
+		::WaitForSingleObject(pstLog->hWakeEvent, LOG_ASYNC_FLUSH_INTERVAL);
+		// Iv̊mF̓L[oOɍs(vOɒǉꂽOSďނ)
+		BOOL bStop = (::InterlockedCompareExchange(&pstLog->lStop, 0, 0) != 0);
+
+		LONG dropped = ::InterlockedExchange(&pstLog->lDropped, 0);
+		if (0 < dropped) {
+			time_cache_now(szTime, NULL);
+			stRec.enLevel = WAR;
+			snprintf(stRec.szText, sizeof(stRec.szText), "log queue full, %ld messages dropped", dropped);
+			nBatch += _log_format_line(pszBatch + nBatch, LOG_ASYNC_BATCH_SIZE - nBatch, szTime, stRec.enLevel, stRec.szText);
+		}
+
+		while (pstLog->pcQueue->Dequeue(&stRec) == 0) {
+			time_cache_format(szTime, &stRec.stTime);
+			int len = _log_format_line(pszBatch + nBatch, LOG_ASYNC_BATCH_SIZE - nBatch, szTime, stRec.enLevel, stRec.szText);
+			if (LOG_ASYNC_BATCH_SIZE - nBatch <= len) {
+				// ܂Ƃߏobt@ɓ肫Ȃ߁Ał擪ɐ`
+				_log_flush_batch(pstLog, &fp, pszBatch, nBatch);
+				ullLastFlush = ::GetTickCount64();
+				nBatch = 0;
+				len = _log_format_line(pszBatch, LOG_ASYNC_BATCH_SIZE, szTime, stRec.enLevel, stRec.szText);
+			}
+			nBatch += len;
+		}
+
+		ULONGLONG now = ::GetTickCount64();
+		if (bStop || LOG_ASYNC_FLUSH_BYTES <= nBatch || (0 < nBatch && LOG_ASYNC_FLUSH_INTERVAL <= now - ullLastFlush)) {
+			_log_flush_batch(pstLog, &fp, pszBatch, nBatch);
+			ullLastFlush = now;
+			nBatch = 0;
+		}
+		if (bStop) {
+			break;
+		}
+	}
+
+	if (fp != NULL) {
+		fclose(fp);
+	}
+	free(pszBatch);
+
+	return 0;
+}
+
 /**
  * @fn		_get_fname_from_path
  * @brief	tpXt@Ĉ݂擾
@@ -306,7 +802,7 @@ static const char* _get_fname_from_path(const char* szPath, char* szBuff, int nS
 static void _log_lock_init(LOG_INFO* pstLog)
 {
 	if (pstLog == NULL) { assert(FALSE); }
-	::InitializeCriticalSection(&(pstLog->stCS));
+	pstLog->cLock.Init();
 }
 
 /**
@@ -317,29 +813,7 @@ static void _log_lock_init(LOG_INFO* pstLog)
 static void _log_lock_delete(LOG_INFO* pstLog)
 {
 	if (pstLog == NULL) { assert(FALSE); }
-	::DeleteCriticalSection(&(pstLog->stCS));
-}
-
-/**
- * @fn		_log_lock
- * @brief	r
- * @param	[in]	LOG_INFO* pstLog		: O
- */
-static void _log_lock(LOG_INFO* pstLog)
-{
-	if (pstLog == NULL) { assert(FALSE); }
-	::EnterCriticalSection(&(pstLog->stCS));
-}
-
-/**
- * @fn		_log_unlock
- * @brief	r
- * @param	[in]	LOG_INFO* pstLog		: O
- */
-static void _log_unlock(LOG_INFO* pstLog)
-{
-	if (pstLog == NULL) { assert(FALSE); }
-	::LeaveCriticalSection(&(pstLog->stCS));
+	pstLog->cLock.Exit();
 }
 
 /**
@@ -391,7 +865,7 @@ static int _copy_filepath(LOG_INFO* pstLog, const char* szPath)
  */
 static int _get_backupname(LOG_INFO* pstLog, int nBkNo, char* szBuff, int nSize)
 {
-	if (pstLog == NULL || szBuff == NULL || nBkNo < 0 || pstLog->nLogBackup < nBkNo) {
+	if (pstLog == NULL || szBuff == NULL || nBkNo < 0 || MAX_LOG_GENERATION < nBkNo) {
 #if _DEBUG
 		assert(FALSE);
 #endif
@@ -406,6 +880,15 @@ static int _get_backupname(LOG_INFO* pstLog, int nBkNo, char* szBuff, int nSize)
  * @brief	Ot@CobNAbv
  * @param	[in]	LOG_INFO* pstLog		: O
  * @return	0:, -1:s
+ * @remarks
+ *		݃oCgt@CTCY𒴂ꍇÃ݂Ot@C(t@C_0)
+ *		̐ԍ(t@C_ԍ)Ƀl[Aۑ𒴂łÂ폜܂B
+ *		l[݂͌̃t@C1݂̂ŁAobNAbvɔႵl[͍s܂B
+ *		ԍ MAX_LOG_GENERATION ̎1ɖ߂Al[ɎcĂÂt@C͍폜܂B
+ *		(_1ŐV)̃obNAbvt@Cԍ̐Ƃď㏑E폜邽߁A
+ *		ۑ̃[e[Vœւ܂(MAX_LOG_GENERATION 𒴂ԍ̃t@C͎c܂)B
+ *		l[Ɏsꍇ͏݃oCg0ɖ߂A nFileSize ނ܂ōĎs܂B
+ *		ÕbN擾ĂĂłB
  */
 static int _backup_file(LOG_INFO* pstLog)
 {
@@ -416,41 +899,97 @@ static int _backup_file(LOG_INFO* pstLog)
 		return -1;
 	}
 
-	long fsize = _get_filesize(pstLog->szLogPath);
-	if (fsize < 0) {
+	if (pstLog->llWritten < (LONGLONG)pstLog->nFileSize * 1024) {
 		return 0;
 	}
 
-	char szBefore[MAX_PATH + 1];
-	char szAfter[MAX_PATH + 1];
+	char szBackup[MAX_PATH + 1];
 
-	if (pstLog->nFileSize <= fsize) {
-		// t@CobNAbv
-		// łÂt@C͍폜
-		_get_backupname(pstLog, pstLog->nLogBackup, szBefore, sizeof(szBefore));
-		if (::PathFileExists(szBefore) && !::PathIsDirectory(szBefore)) {
-			::DeleteFile(szBefore);
-		}
-		// t@Cl[A1Â炷
-		for (int nBkNo = pstLog->nLogBackup - 1; 0 <= nBkNo; nBkNo--) {
-			_get_backupname(pstLog, nBkNo, szBefore, sizeof(szBefore));
-			if (::PathFileExists(szBefore) && !::PathIsDirectory(szBefore)) {
-				_get_backupname(pstLog, nBkNo + 1, szAfter, sizeof(szBefore));
-				::MoveFile(szBefore, szAfter);
-			}
+	// ݂̃t@C̐Ƀl[
+	int gen = _wrap_generation(pstLog->nGeneration + 1);
+	_get_backupname(pstLog, gen, szBackup, sizeof(szBackup));
+	if (::PathFileExists(szBackup) && !::PathIsDirectory(szBackup)) {
+		// ꏄA܂͋̃obNAbvt@C
+		::DeleteFile(szBackup);
+	}
+	if (!::MoveFile(pstLog->szLogPath, szBackup)) {
+		// l[łȂꍇ(vZXgp)AݖɍĎsȂ悤
+		// ݃oCg߂A nFileSize łĎs
+		pstLog->llWritten = 0;
+		return -1;
+	}
+	pstLog->nGeneration = gen;
+	pstLog->llWritten = 0;
+
+	// ۑ𒴂폜
+	if (0 < pstLog->nLogBackup && pstLog->nLogBackup < MAX_LOG_GENERATION) {
+		_get_backupname(pstLog, _wrap_generation(gen - pstLog->nLogBackup), szBackup, sizeof(szBackup));
+		if (::PathFileExists(szBackup) && !::PathIsDirectory(szBackup)) {
+			::DeleteFile(szBackup);
 		}
 	}
 
 	return 0;
 }
 
+/**
+ * @fn		_get_generation
+ * @brief	̃obNAbvt@CŐV̐ԍ擾
+ * @param	[in]	LOG_INFO* pstLog		: O
+ * @return	ŐV̐ԍ(obNAbvꍇ0)
+ * @remarks	ԍ͈ꏄ1ɖ߂邽߁Aԍ̑召ł͂ȂXVłVt@CŐVƂ܂B
+ */
+static int _get_generation(LOG_INFO* pstLog)
+{
+	char szPattern[MAX_PATH + 1];
+	snprintf(szPattern, sizeof(szPattern), "%s%s_*%s", pstLog->szDir, pstLog->szFname, pstLog->szFext);
+
+	WIN32_FIND_DATA stFind;
+	HANDLE hFind = ::FindFirstFile(szPattern, &stFind);
+	if (hFind == INVALID_HANDLE_VALUE) {
+		return 0;
+	}
+
+	int gen = 0;
+	FILETIME ftNewest = { 0, 0 };
+	size_t len = strlen(pstLog->szFname);
+	do {
+		// t@C_ԍ.gq ̐ԍ(_0 ݂͌̃t@CA𒴂ԍ͑ΏۊO)
+		if (strncmp(stFind.cFileName, pstLog->szFname, len) == 0 && stFind.cFileName[len] == '_') {
+			int no = atoi(&stFind.cFileName[len + 1]);
+			if (0 < no && no <= MAX_LOG_GENERATION) {
+				LONG cmp = ::CompareFileTime(&stFind.ftLastWriteTime, &ftNewest);
+				if (gen == 0 || 0 < cmp || (cmp == 0 && gen < no)) {
+					gen = no;
+					ftNewest = stFind.ftLastWriteTime;
+				}
+			}
+		}
+	} while (::FindNextFile(hFind, &stFind));
+	::FindClose(hFind);
+
+	return gen;
+}
+
+/**
+ * @fn		_wrap_generation
+ * @brief	ԍ1`MAX_LOG_GENERATION ͈̔͂Ɋۂ߂
+ * @param	[in]	int nGen				: ԍ
+ * @return	ۂ߂ԍ
+ */
+static int _wrap_generation(int nGen)
+{
+	return ((nGen - 1) % MAX_LOG_GENERATION + MAX_LOG_GENERATION) % MAX_LOG_GENERATION + 1;
+}
+
 /**
  * @fn		_get_filesize
- * @brief	t@CTCY擾(2GB܂)
+ * @brief	t@CTCY擾
  * @param	[in]	const char* szPath		: t@CpX
- * @return	t@CTCY(-1:s)
+ * @return	t@CTCY(oCg, -1:s)
+ * @remarks	t@CJɑ擾܂(2GBȏ̃t@CɂΉ)
  */
-static long _get_filesize(const char* szPath)
+static LONGLONG _get_filesize(const char* szPath)
 {
 	if (szPath == NULL) {
 #if _DEBUG
@@ -459,19 +998,9 @@ static long _get_filesize(const char* szPath)
 		return -1;
 	}
 
-	//errno = 0;
-	FILE *fp = fopen(szPath, "rb");
-	if (fp == NULL) {
-		//if (errno != 0) perror(NULL);
-		return -1;
-	}
-
-	long fsize = _filelength(_fileno(fp));
-	fsize >>= 10;		// fsize/1024
-
-	if (fclose(fp) != 0) {
-		//if (errno != 0) perror(NULL);
+	WIN32_FILE_ATTRIBUTE_DATA stAttr;
+	if (!::GetFileAttributesEx(szPath, GetFileExInfoStandard, &stAttr)) {
 		return -1;
 	}
-	return fsize;
+	return ((LONGLONG)stAttr.nFileSizeHigh << 32) | stAttr.nFileSizeLow;
 }
@@ -7,17 +7,31 @@
 #pragma once
 
 #include <stdlib.h>
+#include <malloc.h>
+#include <new>
 #include <assert.h>
 #include <windows.h>
 #include "misc.h"
+#include "ring_core.h"
+#include "Lock.h"
+
+// Oobt@̔rbN|V[(Lock.hAVOXbhŎgpꍇ̓CN[hO CLockNone `)
+#ifndef QUEUE_LOCK_POLICY
+#define QUEUE_LOCK_POLICY		CLockCS<>
+#endif
 
 
 /**
  * @struct	RING_BUFFER
  * @brief	Oobt@
+ * @remarks
+ *		擪ʒuEf[^̓bNœǂݏXV邽߁A͂܂Ƃ߂
+ *		LbVCEɔzuAאڂ鑼̃f[^Ƃ̋ULh܂B
+ *		cLock  queue_init Ŕzu new ɂ\zAqueue_end ŃfXgN^ĂŔj܂
+ *		(\̗̂̈ malloc ŊmۂRXgN^Ă΂Ȃ)B
  */
-typedef struct _RING_BUFFER {
-	CRITICAL_SECTION	stCS;
+typedef struct alignas(CACHE_LINE_SIZE) _RING_BUFFER {
+	QUEUE_LOCK_POLICY	cLock;
 	unsigned char*		puchBuff;
 	int					nBuffSize;
 	int					nDataHead;
@@ -58,7 +72,7 @@ int queue_init(RING_BUFFER* pstRing, int nSize)
 
 	pstRing->nBuffSize = _calc_buffsize(nSize);
 	pstRing->nModMask = pstRing->nBuffSize - 1;
-	pstRing->puchBuff = (unsigned char*)malloc(sizeof(unsigned char) * pstRing->nBuffSize);
+	pstRing->puchBuff = (unsigned char*)_aligned_malloc(sizeof(unsigned char) * pstRing->nBuffSize, CACHE_LINE_SIZE);
 	if (pstRing->puchBuff == NULL) {
 		return -1;
 	}
@@ -83,7 +97,7 @@ int queue_end(RING_BUFFER* pstRing)
 		return -1;
 	}
 
-	free(pstRing->puchBuff);
+	_aligned_free(pstRing->puchBuff);
 	_queue_lock_delete(pstRing);
 
 	return 0;
@@ -129,22 +143,15 @@ int queue_push(RING_BUFFER* pstRing, const unsigned char* puchData, int nLen)
 	}
 
 	_lock_queue(pstRing);
-	int count = 0;
-	int ptr = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (pstRing->nDataLength < pstRing->nBuffSize) {
-			ptr = ((pstRing->nDataHead + pstRing->nDataLength) & pstRing->nModMask);
-			pstRing->puchBuff[ptr] = puchData[i];
-			pstRing->nDataLength++;
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	int count = ring_count(nLen, pstRing->nBuffSize - pstRing->nDataLength);
+	ring_write(pstRing->puchBuff, pstRing->nBuffSize
+		, ((pstRing->nDataHead + pstRing->nDataLength) & pstRing->nModMask), puchData, count);
+	pstRing->nDataLength += count;
 	_unlock_queue(pstRing);
 
+#if _DEBUG
 	debug_print(pstRing);
+#endif
 
 	return count;
 }
@@ -165,22 +172,16 @@ int queue_pop(RING_BUFFER* pstRing, unsigned char* puchBuff, int nLen)
 	}
 
 	_lock_queue(pstRing);
-	int count = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (0 < pstRing->nDataLength) {
-			puchBuff[i] = pstRing->puchBuff[pstRing->nDataHead];
-			pstRing->puchBuff[pstRing->nDataHead] = 0;
-			pstRing->nDataHead = ((pstRing->nDataHead + 1) & pstRing->nModMask);
-			pstRing->nDataLength--;
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	int count = ring_count(nLen, pstRing->nDataLength);
+	ring_read(pstRing->puchBuff, pstRing->nBuffSize, pstRing->nDataHead, puchBuff, count);
+	ring_erase(pstRing->puchBuff, pstRing->nBuffSize, pstRing->nDataHead, count);
+	pstRing->nDataHead = ((pstRing->nDataHead + count) & pstRing->nModMask);
+	pstRing->nDataLength -= count;
 	_unlock_queue(pstRing);
 
+#if _DEBUG
 	debug_print(pstRing);
+#endif
 
 	return count;
 }
@@ -201,21 +202,13 @@ int queue_peek(RING_BUFFER* pstRing, unsigned char* puchBuff, int nLen)
 	}
 
 	_lock_queue(pstRing);
-	int ptr = pstRing->nDataHead;
-	int count = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (0 < pstRing->nDataLength) {
-			puchBuff[i] = pstRing->puchBuff[ptr];
-			ptr = ((ptr + 1) & pstRing->nModMask);
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	int count = ring_count(nLen, pstRing->nDataLength);
+	ring_read(pstRing->puchBuff, pstRing->nBuffSize, pstRing->nDataHead, puchBuff, count);
 	_unlock_queue(pstRing);
 
+#if _DEBUG
 	debug_print(pstRing);
+#endif
 
 	return count;
 }
@@ -265,7 +258,8 @@ static int _calc_buffsize(int nSize)
 static void _queue_lock_init(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::InitializeCriticalSection(&(pstRing->stCS));
+	// Ăяomۂ̈̂߃RXgN^Ă΂ĂȂ(zu new ō\z)
+	new (&pstRing->cLock) QUEUE_LOCK_POLICY();
 }
 
 /**
@@ -277,7 +271,8 @@ static void _queue_lock_init(RING_BUFFER* pstRing)
 static void _queue_lock_delete(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::DeleteCriticalSection(&(pstRing->stCS));
+	typedef QUEUE_LOCK_POLICY LOCK_POLICY;
+	pstRing->cLock.~LOCK_POLICY();
 }
 
 /**
@@ -289,7 +284,7 @@ static void _queue_lock_delete(RING_BUFFER* pstRing)
 static void _lock_queue(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::EnterCriticalSection(&(pstRing->stCS));
+	pstRing->cLock.Lock();
 }
 
 /**
@@ -301,7 +296,7 @@ static void _lock_queue(RING_BUFFER* pstRing)
 static void _unlock_queue(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::LeaveCriticalSection(&(pstRing->stCS));
+	pstRing->cLock.Unlock();
 }
 
 /**
@@ -7,17 +7,31 @@
 #pragma once
 
 #include <stdlib.h>
+#include <malloc.h>
+#include <new>
 #include <assert.h>
 #include <windows.h>
 #include "misc.h"
+#include "ring_core.h"
+#include "Lock.h"
+
+// Oobt@̔rbN|V[(Lock.hAVOXbhŎgpꍇ̓CN[hO CLockNone `)
+#ifndef QUEUE_LOCK_POLICY
+#define QUEUE_LOCK_POLICY		CLockCS<>
+#endif
 
 
 /**
  * @struct	RING_BUFFER
  * @brief	Oobt@
+ * @remarks
+ *		擪ʒuEf[^̓bNœǂݏXV邽߁A͂܂Ƃ߂
+ *		LbVCEɔzuAאڂ鑼̃f[^Ƃ̋ULh܂B
+ *		cLock  create_queue Ŕzu new ɂ\zAdelete_queue ŃfXgN^ĂŔj܂
+ *		(\̗̂̈ malloc ŊmۂRXgN^Ă΂Ȃ)B
  */
-typedef struct _RING_BUFFER {
-	CRITICAL_SECTION	stCS;
+typedef struct alignas(CACHE_LINE_SIZE) _RING_BUFFER {
+	QUEUE_LOCK_POLICY	cLock;
 	unsigned char*		puchBuff;
 	int					nBuffSize;
 	int					nDataHead;
@@ -51,15 +65,15 @@ RING_BUFFER* create_queue(int nSize)
 {
 	RING_BUFFER* pstRing;
 
-	pstRing = (RING_BUFFER*)malloc(sizeof(RING_BUFFER));
+	pstRing = (RING_BUFFER*)_aligned_malloc(sizeof(RING_BUFFER), CACHE_LINE_SIZE);
 	if (pstRing == NULL) {
 		return NULL;
 	}
 	pstRing->nBuffSize = _calc_buffsize(nSize);
 	pstRing->nModMask = pstRing->nBuffSize - 1;
-	pstRing->puchBuff = (unsigned char*)malloc(sizeof(unsigned char) * pstRing->nBuffSize);
+	pstRing->puchBuff = (unsigned char*)_aligned_malloc(sizeof(unsigned char) * pstRing->nBuffSize, CACHE_LINE_SIZE);
 	if (pstRing->puchBuff == NULL) {
-		free(pstRing);
+		_aligned_free(pstRing);
 		return NULL;
 	}
 	_queue_lock_init(pstRing);
@@ -83,9 +97,9 @@ int delete_queue(RING_BUFFER* pstRing)
 		return -1;
 	}
 	// obt@ArNAɃOobt@J
-	free(pstRing->puchBuff);
+	_aligned_free(pstRing->puchBuff);
 	_queue_lock_delete(pstRing);
-	free(pstRing);
+	_aligned_free(pstRing);
 
 	return 0;
 }
@@ -130,22 +144,15 @@ int queue_push(RING_BUFFER* pstRing, const unsigned char* puchData, int nLen)
 	}
 
 	_lock_queue(pstRing);
-	int count = 0;
-	int ptr = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (pstRing->nDataLength < pstRing->nBuffSize) {
-			ptr = ((pstRing->nDataHead + pstRing->nDataLength) & pstRing->nModMask);
-			pstRing->puchBuff[ptr] = puchData[i];
-			pstRing->nDataLength++;
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	int count = ring_count(nLen, pstRing->nBuffSize - pstRing->nDataLength);
+	ring_write(pstRing->puchBuff, pstRing->nBuffSize
+		, ((pstRing->nDataHead + pstRing->nDataLength) & pstRing->nModMask), puchData, count);
+	pstRing->nDataLength += count;
 	_unlock_queue(pstRing);
 
+#if _DEBUG
 	debug_print(pstRing);
+#endif
 
 	return count;
 }
@@ -166,22 +173,16 @@ int queue_pop(RING_BUFFER* pstRing, unsigned char* puchBuff, int nLen)
 	}
 
 	_lock_queue(pstRing);
-	int count = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (0 < pstRing->nDataLength) {
-			puchBuff[i] = pstRing->puchBuff[pstRing->nDataHead];
-			pstRing->puchBuff[pstRing->nDataHead] = 0;
-			pstRing->nDataHead = ((pstRing->nDataHead + 1) & pstRing->nModMask);
-			pstRing->nDataLength--;
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	int count = ring_count(nLen, pstRing->nDataLength);
+	ring_read(pstRing->puchBuff, pstRing->nBuffSize, pstRing->nDataHead, puchBuff, count);
+	ring_erase(pstRing->puchBuff, pstRing->nBuffSize, pstRing->nDataHead, count);
+	pstRing->nDataHead = ((pstRing->nDataHead + count) & pstRing->nModMask);
+	pstRing->nDataLength -= count;
 	_unlock_queue(pstRing);
 
+#if _DEBUG
 	debug_print(pstRing);
+#endif
 
 	return count;
 }
@@ -202,21 +203,13 @@ int queue_peek(RING_BUFFER* pstRing, unsigned char* puchBuff, int nLen)
 	}
 
 	_lock_queue(pstRing);
-	int ptr = pstRing->nDataHead;
-	int count = 0;
-	for (int i = 0; i < nLen; i++) {
-		if (0 < pstRing->nDataLength) {
-			puchBuff[i] = pstRing->puchBuff[ptr];
-			ptr = ((ptr + 1) & pstRing->nModMask);
-			count++;
-		}
-		else {
-			break;
-		}
-	}
+	int count = ring_count(nLen, pstRing->nDataLength);
+	ring_read(pstRing->puchBuff, pstRing->nBuffSize, pstRing->nDataHead, puchBuff, count);
 	_unlock_queue(pstRing);
 
+#if _DEBUG
 	debug_print(pstRing);
+#endif
 
 	return count;
 }
@@ -266,7 +259,8 @@ static int _calc_buffsize(int nSize)
 static void _queue_lock_init(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::InitializeCriticalSection(&(pstRing->stCS));
+	// Ăяomۂ̈̂߃RXgN^Ă΂ĂȂ(zu new ō\z)
+	new (&pstRing->cLock) QUEUE_LOCK_POLICY();
 }
 
 /**
@@ -278,7 +272,8 @@ static void _queue_lock_init(RING_BUFFER* pstRing)
 static void _queue_lock_delete(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::DeleteCriticalSection(&(pstRing->stCS));
+	typedef QUEUE_LOCK_POLICY LOCK_POLICY;
+	pstRing->cLock.~LOCK_POLICY();
 }
 
 /**
@@ -290,7 +285,7 @@ static void _queue_lock_delete(RING_BUFFER* pstRing)
 static void _lock_queue(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::EnterCriticalSection(&(pstRing->stCS));
+	pstRing->cLock.Lock();
 }
 
 /**
@@ -302,7 +297,7 @@ static void _lock_queue(RING_BUFFER* pstRing)
 static void _unlock_queue(RING_BUFFER* pstRing)
 {
 	if (pstRing == NULL) { assert(FALSE); }
-	::LeaveCriticalSection(&(pstRing->stCS));
+	pstRing->cLock.Unlock();
 }
 
 /**
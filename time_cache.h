@@ -0,0 +1,159 @@
+/**
+ * @file	time_cache.h
+ * @brief	Op^CX^ṽLbV
+ * @author	?
+ * @date	?
+ * @remarks
+ *		Oo͂ "YYYY/MM/DD, hh:mm:ss.mmm" `̓쐬܂(simple_log.h, log.h, SimpleLog.h, log_tchar.h, misc.h )B
+ *		XbhɕbPʂ܂ł̕LbVAbς̂ݓtE蒼܂B
+ *		b̊Ԃ̓~b3݂̂Aprintf n֐͎gp܂B
+ *		^(char/wchar_t)̓ev[gŎw肵܂B
+ */
+#pragma once
+
+#include <string.h>
+#include <windows.h>
+
+
+#define TIME_CACHE_LEN		(24)		//!< ̕("YYYY/MM/DD, hh:mm:ss.mmm", I[)
+#define TIME_CACHE_SEC_LEN	(20)		//!< b܂ł̕("YYYY/MM/DD, hh:mm:ss")
+
+
+/**
+ * @struct	TIME_CACHE
+ * @brief	bPʂ܂ł̓LbV(Xbh)
+ */
+template <typename T>
+struct TIME_CACHE {
+	ULONGLONG	ullKey;							//!< LbVς݂̕b(0:ݒ)
+	SYSTEMTIME	stTime;							//!< LbVς݂̓(~b)
+	T			szText[TIME_CACHE_SEC_LEN];		//!< LbVς݂̓(I[)
+};
+
+
+/**
+ * @fn				_time_cache_digits
+ * @brief			lw茅0߂10iƂď
+ * @param[out]		T* pDest		: o͐(nWidth)
+ * @param[in]		unsigned nVal	: l
+ * @param[in]		int nWidth		: 
+ */
+template <typename T>
+inline void _time_cache_digits(T* pDest, unsigned nVal, int nWidth)
+{
+	for (int i = nWidth - 1; 0 <= i; i--) {
+		pDest[i] = (T)('0' + (nVal % 10));
+		nVal /= 10;
+	}
+}
+
+/**
+ * @fn				_time_cache_build
+ * @brief			LbV̓(b܂)쐬
+ * @param[in,out]	TIME_CACHE<T>* pstCache		: LbV(stTime ݒς)
+ */
+template <typename T>
+inline void _time_cache_build(TIME_CACHE<T>* pstCache)
+{
+	T* p = pstCache->szText;
+	const SYSTEMTIME* t = &pstCache->stTime;
+
+	_time_cache_digits(p + 0, t->wYear, 4);
+	p[4] = '/';
+	_time_cache_digits(p + 5, t->wMonth, 2);
+	p[7] = '/';
+	_time_cache_digits(p + 8, t->wDay, 2);
+	p[10] = ',';
+	p[11] = ' ';
+	_time_cache_digits(p + 12, t->wHour, 2);
+	p[14] = ':';
+	_time_cache_digits(p + 15, t->wMinute, 2);
+	p[17] = ':';
+	_time_cache_digits(p + 18, t->wSecond, 2);
+}
+
+/**
+ * @fn				_time_cache_output
+ * @brief			LbV̓Ƀ~bt^ďo͂
+ * @param[in]		const TIME_CACHE<T>* pstCache	: LbV
+ * @param[in]		unsigned nMsec					: ~b(0`999)
+ * @param[out]		T* pszBuff						: o͐(TIME_CACHE_LEN + 1 ȏ)
+ */
+template <typename T>
+inline void _time_cache_output(const TIME_CACHE<T>* pstCache, unsigned nMsec, T* pszBuff)
+{
+	memcpy(pszBuff, pstCache->szText, sizeof(T) * TIME_CACHE_SEC_LEN);
+	pszBuff[TIME_CACHE_SEC_LEN] = '.';
+	_time_cache_digits(pszBuff + TIME_CACHE_SEC_LEN + 1, nMsec, 3);
+	pszBuff[TIME_CACHE_LEN] = '\0';
+}
+
+
+/**
+ * @fn				time_cache_now
+ * @brief			ݓ([J)̕𓾂
+ * @param[out]		T* pszBuff				: i[obt@̈(TIME_CACHE_LEN + 1 ȏ, NULL:sv)
+ * @param[out]		SYSTEMTIME* pstTime		: ݓ̊i[(NULL:sv)
+ * @return			̕(TIME_CACHE_LEN)
+ * @remarks
+ *		GetSystemTimeAsFileTime Ōݎ擾Abς̂݃[Jւ̕ϊƕ̍쐬s܂B
+ *		Kvȏꍇ(񓯊O̎L^) GetLocalTime yʂɎ擾ł܂B
+ */
+template <typename T>
+inline int time_cache_now(T* pszBuff, SYSTEMTIME* pstTime)
+{
+	static thread_local TIME_CACHE<T> s_stCache = { 0 };
+
+	FILETIME ft;
+	::GetSystemTimeAsFileTime(&ft);
+	ULONGLONG now = ((ULONGLONG)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+	ULONGLONG sec = now / 10000000;				// 100nsP  b
+	unsigned msec = (unsigned)((now / 10000) % 1000);
+
+	if (sec != s_stCache.ullKey) {
+		// bς߁A[Jɕϊč蒼(Ďԓ̐ؑւŔf)
+		FILETIME ftLocal;
+		::FileTimeToLocalFileTime(&ft, &ftLocal);
+		::FileTimeToSystemTime(&ftLocal, &s_stCache.stTime);
+		s_stCache.stTime.wMilliseconds = 0;
+		_time_cache_build(&s_stCache);
+		s_stCache.ullKey = sec;
+	}
+
+	if (pstTime != NULL) {
+		*pstTime = s_stCache.stTime;
+		pstTime->wMilliseconds = (WORD)msec;
+	}
+	if (pszBuff != NULL) {
+		_time_cache_output(&s_stCache, msec, pszBuff);
+	}
+	return TIME_CACHE_LEN;
+}
+
+/**
+ * @fn				time_cache_format
+ * @brief			w̕𓾂
+ * @param[out]		T* pszBuff					: i[obt@̈(TIME_CACHE_LEN + 1 ȏ)
+ * @param[in]		const SYSTEMTIME* pstTime	: 
+ * @return			̕(TIME_CACHE_LEN)
+ * @remarks			L^ς݂̎܂Ƃ߂Đ`ꍇ(񓯊Ȍ݃Xbh)Ɏgp܂B
+ */
+template <typename T>
+inline int time_cache_format(T* pszBuff, const SYSTEMTIME* pstTime)
+{
+	static thread_local TIME_CACHE<T> s_stCache = { 0 };
+
+	// N`b1̒lɂ܂Ƃ߂ăLbVƔr(N1601ȏ̂0ɂ͂ȂȂ)
+	ULONGLONG key = ((((((ULONGLONG)pstTime->wYear * 16 + pstTime->wMonth) * 32 + pstTime->wDay)
+		* 32 + pstTime->wHour) * 64 + pstTime->wMinute) * 64 + pstTime->wSecond);
+
+	if (key != s_stCache.ullKey) {
+		s_stCache.stTime = *pstTime;
+		s_stCache.stTime.wMilliseconds = 0;
+		_time_cache_build(&s_stCache);
+		s_stCache.ullKey = key;
+	}
+
+	_time_cache_output(&s_stCache, pstTime->wMilliseconds % 1000, pszBuff);
+	return TIME_CACHE_LEN;
+}